@@ -35,10 +35,14 @@ private:
 public:
 	void clear_messages();
 
+	void discard_module(const std::string& moduleName);
+
 	ASXModule_Ptr get_module(const std::string& moduleName) const;
 
 	bool load_and_build_script(const std::string& filename, const std::string& moduleName);
 
+	bool load_bytecode(const std::vector<unsigned char>& bytecode, const std::string& moduleName);
+
 	const std::vector<ASXMessage>& messages() const;
 
 	void output_messages(std::ostream& os) const;
@@ -71,6 +75,8 @@ public:
 	template <typename T> void register_uninstantiable_ref_type();
 	template <typename T> void register_uninstantiable_ref_type(const std::string& obj);
 
+	bool save_bytecode(const std::string& moduleName, std::vector<unsigned char>& bytecode) const;
+
 	//#################### PRIVATE METHODS ####################
 private:
 	void message_callback(const asSMessageInfo *msg);
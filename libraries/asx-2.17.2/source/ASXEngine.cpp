@@ -5,12 +5,50 @@
 
 #include "ASXEngine.h"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <vector>
 
 #include <scriptbuilder.h>
 #include <scriptstdstring.h>
 
+//#################### LOCAL CLASSES ####################
+/**
+An AngelScript binary stream which reads and writes module bytecode from and to memory.
+*/
+class ASXBytecodeStream : public asIBinaryStream
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<unsigned char>& m_bytecode;
+	size_t m_readPos;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit ASXBytecodeStream(std::vector<unsigned char>& bytecode)
+	:	m_bytecode(bytecode), m_readPos(0)
+	{}
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void Read(void *ptr, asUINT size)
+	{
+		// Note: Exceptions mustn't propagate through AngelScript, so reading past the end just yields zeros.
+		size_t available = m_readPos < m_bytecode.size() ? m_bytecode.size() - m_readPos : 0;
+		size_t count = std::min<size_t>(size, available);
+		if(count > 0) memcpy(ptr, &m_bytecode[m_readPos], count);
+		if(count < size) memset(static_cast<unsigned char *>(ptr) + count, 0, size - count);
+		m_readPos += count;
+	}
+
+	void Write(const void *ptr, asUINT size)
+	{
+		const unsigned char *bytes = static_cast<const unsigned char *>(ptr);
+		m_bytecode.insert(m_bytecode.end(), bytes, bytes + size);
+	}
+};
+
 //#################### CONSTRUCTORS ####################
 ASXEngine::ASXEngine()
 {
@@ -39,6 +77,17 @@ void ASXEngine::clear_messages()
 	std::swap(m_messages, dummy);
 }
 
+/**
+Discards the specified module (if it exists). Any ASXModule or ASXFunction objects
+referring to the module must not be used afterwards.
+
+@param moduleName	The name of the module
+*/
+void ASXEngine::discard_module(const std::string& moduleName)
+{
+	m_engine->DiscardModule(moduleName.c_str());
+}
+
 ASXModule_Ptr ASXEngine::get_module(const std::string& moduleName) const
 {
 	asIScriptModule *module = m_engine->GetModule(moduleName.c_str(), asGM_ONLY_IF_EXISTS);
@@ -54,6 +103,25 @@ bool ASXEngine::load_and_build_script(const std::string& filename, const std::st
 	return builder.BuildModule() == 0;
 }
 
+/**
+Creates a new module from bytecode previously saved using save_bytecode(). This is much
+cheaper than building the module's script again, and the new module gets its own copies
+of the script's global variables.
+
+@param bytecode		The bytecode
+@param moduleName	The name of the module to create (any existing module with the same name is replaced)
+@return				true, if the module was successfully loaded, or false otherwise
+*/
+bool ASXEngine::load_bytecode(const std::vector<unsigned char>& bytecode, const std::string& moduleName)
+{
+	asIScriptModule *module = m_engine->GetModule(moduleName.c_str(), asGM_ALWAYS_CREATE);
+	if(!module) return false;
+
+	// Note: The stream only writes to the bytecode array when saving, so the const_cast is safe.
+	ASXBytecodeStream stream(const_cast<std::vector<unsigned char>&>(bytecode));
+	return module->LoadByteCode(&stream) >= 0;
+}
+
 const std::vector<ASXMessage>& ASXEngine::messages() const
 {
 	return m_messages;
@@ -67,6 +135,23 @@ void ASXEngine::output_messages(std::ostream& os) const
 	}
 }
 
+/**
+Saves the bytecode of the specified module, so that copies of it can later be created using load_bytecode().
+
+@param moduleName	The name of the module
+@param bytecode		Used to return the bytecode
+@return				true, if the bytecode was successfully saved, or false otherwise
+*/
+bool ASXEngine::save_bytecode(const std::string& moduleName, std::vector<unsigned char>& bytecode) const
+{
+	asIScriptModule *module = m_engine->GetModule(moduleName.c_str(), asGM_ONLY_IF_EXISTS);
+	if(!module) return false;
+
+	bytecode.clear();
+	ASXBytecodeStream stream(bytecode);
+	return module->SaveByteCode(&stream) >= 0;
+}
+
 //#################### PRIVATE METHODS ####################
 void ASXEngine::message_callback(const asSMessageInfo *msg)
 {
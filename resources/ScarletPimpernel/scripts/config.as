@@ -8,6 +8,8 @@ int height = 768;
 
 bool fullScreen = false;
 string levelName = "tricky";
+int physicsThreads = 2;
+bool physicsDeterministic = false;
 string profile = "smg";
 bool renderNavMeshes = false;
 bool renderPortals = false;
@@ -73,8 +73,8 @@ REM #########################
 del *.dgm
 del *.hgm
 del *.lbt
+del *.lmp
 del *.lum
-del *.png
 del *.rbr
 del *.rg*
 del *.rp*
@@ -21,8 +21,8 @@ function cleanup
 	/bin/rm -fR *.dgm
 	/bin/rm -fR *.hgm
 	/bin/rm -fR *.lbt
+	/bin/rm -fR *.lmp
 	/bin/rm -fR *.lum
-	/bin/rm -fR *.png
 	/bin/rm -fR *.rbr
 	/bin/rm -fR *.rg*
 	/bin/rm -fR *.rp*
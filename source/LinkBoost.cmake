@@ -3,3 +3,6 @@
 ###################
 
 TARGET_LINK_LIBRARIES(${targetname} ${Boost_LIBRARIES})
+IF(UNIX)
+	TARGET_LINK_LIBRARIES(${targetname} pthread)
+ENDIF(UNIX)
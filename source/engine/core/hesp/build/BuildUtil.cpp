@@ -0,0 +1,265 @@
+/***
+ * hesperus: BuildUtil.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "BuildUtil.h"
+
+#include <cmath>
+#include <list>
+
+#include <hesp/bounds/Bounds.h>
+#include <hesp/bounds/BoundsManager.h>
+#include <hesp/brushes/BrushExpander.h>
+#include <hesp/csg/CSGUtil.h>
+#include <hesp/exceptions/Exception.h>
+#include <hesp/math/Constants.h>
+#include <hesp/nav/AdjacencyList.h>
+#include <hesp/nav/NavDataset.h>
+#include <hesp/nav/NavManager.h>
+#include <hesp/nav/NavMeshGenerator.h>
+#include <hesp/nav/PathTableGenerator.h>
+#include <hesp/trees/BSPUtil.h>
+#include <hesp/trees/OnionTree.h>
+
+namespace hesp {
+
+//#################### PUBLIC METHODS ####################
+/**
+Adds the detail brushes to a rendering tree, by performing a CSG union on them, clipping
+the resulting faces to the tree and adding the face fragments to the relevant leaves.
+
+@param polygons			The polygons in the tree (the face fragments are appended to these)
+@param tree				The tree
+@param detailBrushes	The detail brushes
+*/
+void BuildUtil::add_detail(TexPolyVector& polygons, const BSPTree_Ptr& tree, const TexPolyBrushVector& detailBrushes)
+{
+	typedef TexturedPolygon::Vert Vert;
+	typedef TexturedPolygon::AuxData AuxData;
+	typedef std::list<TexturedPolygon_Ptr> TexPolyList;
+	typedef shared_ptr<TexPolyList> TexPolyList_Ptr;
+
+	// Perform a CSG union on the detail brushes.
+	TexPolyList_Ptr detailFaces = CSGUtil<Vert,AuxData>::union_all(detailBrushes);
+
+	// Clip the detail faces to the tree.
+	TexPolyList fragments = CSGUtil<Vert,AuxData>::clip_polygons_to_tree(*detailFaces, tree, true);
+
+	// Add the face fragments to the polygons array.
+	int firstFragment = static_cast<int>(polygons.size());
+	std::copy(fragments.begin(), fragments.end(), std::back_inserter(polygons));
+	int lastFragment = static_cast<int>(polygons.size()) - 1;
+
+	// Add the face fragments to the relevant leaves.
+	for(int i=firstFragment; i<=lastFragment; ++i)
+	{
+		std::list<int> leafIndices = BSPUtil::find_leaf_indices(*polygons[i], tree);
+		for(std::list<int>::const_iterator jt=leafIndices.begin(), jend=leafIndices.end(); jt!=jend; ++jt)
+		{
+			BSPLeaf *leaf = tree->leaf(*jt);
+			leaf->add_polygon_index(i);
+		}
+	}
+}
+
+/**
+Separates the input brushes for a level according to their functions.
+
+@param inputBrushes		The input brushes
+@param renderingBrushes	Used to return the brushes which make up the rendering geometry
+@param collisionBrushes	Used to return the brushes which make up the collision geometry
+@param detailBrushes	Used to return the detail brushes
+@param hintPolygons		Used to return the hint polygons taken from the hint brushes
+@param specialBrushes	Used to return the special (e.g. water) brushes
+*/
+void BuildUtil::divide_brushes(const TexPolyBrushVector& inputBrushes, TexPolyBrushVector& renderingBrushes, ColPolyBrushVector& collisionBrushes,
+							   TexPolyBrushVector& detailBrushes, TexPolyVector& hintPolygons, TexPolyBrushVector& specialBrushes)
+{
+	TexPolyBrushVector texCollisionBrushes, hintBrushes;
+	for(size_t i=0, size=inputBrushes.size(); i<size; ++i)
+	{
+		switch(inputBrushes[i]->function())
+		{
+			case BF_COLLISION:
+				texCollisionBrushes.push_back(inputBrushes[i]);
+				break;
+			case BF_DETAIL:
+				detailBrushes.push_back(inputBrushes[i]);
+				break;
+			case BF_HINT:
+				hintBrushes.push_back(inputBrushes[i]);
+				break;
+			case BF_NORMAL:
+				renderingBrushes.push_back(inputBrushes[i]);
+				texCollisionBrushes.push_back(inputBrushes[i]);		// normal brushes are also used as collision brushes
+				break;
+			case BF_WATER:
+				specialBrushes.push_back(inputBrushes[i]);
+				break;
+			default:
+				throw Exception("Forgot to handle one of the brush function cases");
+		}
+	}
+
+	// Convert the collision brushes to the right format.
+	int collisionBrushCount = static_cast<int>(texCollisionBrushes.size());
+	collisionBrushes.resize(collisionBrushCount);
+	for(int i=0; i<collisionBrushCount; ++i)
+	{
+		collisionBrushes[i] = convert_brush(texCollisionBrushes[i]);
+	}
+
+	// Extract the hint polygons from the hint brushes.
+	hintPolygons = extract_hint_polygons(hintBrushes);
+}
+
+/**
+Expands the collision brushes for a level against each of the bounds used by its objects.
+
+@param brushes			The collision brushes
+@param boundsManager	The bounds manager containing the bounds
+@return					The expanded brushes for each bounds, indexed by bounds
+*/
+std::vector<BuildUtil::ColPolyBrushVector> BuildUtil::expand_brushes(const ColPolyBrushVector& brushes, const BoundsManager_CPtr& boundsManager)
+{
+	int boundsCount = boundsManager->bounds_count();
+	int brushCount = static_cast<int>(brushes.size());
+
+	std::vector<ColPolyBrushVector> expandedBrushes(boundsCount, ColPolyBrushVector(brushCount));
+	for(int i=0; i<boundsCount; ++i)
+	{
+		for(int j=0; j<brushCount; ++j)
+		{
+			expandedBrushes[i][j] = BrushExpander::expand_brush(brushes[j], *boundsManager->bounds(i), i);
+		}
+	}
+	return expandedBrushes;
+}
+
+/**
+Generates the navigation datasets for each map in a collision onion tree whose bounds
+has its nav flag set.
+
+@param polygons			The polygons in the onion tree
+@param tree				The onion tree
+@param boundsManager	The bounds manager containing the bounds for each map
+@param threadCount		The number of threads to use when generating the path tables
+@return					A nav manager containing the navigation datasets
+@throws Exception		If the number of bounds and the number of maps in the tree differ
+*/
+NavManager_Ptr BuildUtil::generate_nav_data(const ColPolyVector& polygons, const OnionTree_CPtr& tree, const BoundsManager_CPtr& boundsManager, int threadCount)
+{
+	// Check that the number of bounds and the number of maps in the tree match up.
+	int boundsCount = boundsManager->bounds_count();
+	int mapCount = tree->map_count();
+	if(boundsCount != mapCount) throw Exception("There must be exactly one bounds per map in the onion tree");
+
+	NavManager_Ptr navManager(new NavManager);
+
+	// For each separate map.
+	for(int i=0; i<mapCount; ++i)
+	{
+		// Skip this map if the bounds for it has its nav flag set to false.
+		if(!boundsManager->nav_flags()[i]) continue;
+
+		// Make a copy of the polygon array in which all the polygons that aren't
+		// in this map are set to non-walkable.
+		int polyCount = static_cast<int>(polygons.size());
+		ColPolyVector mapPolygons(polyCount);
+		for(int j=0; j<polyCount; ++j)
+		{
+			mapPolygons[j].reset(new CollisionPolygon(*polygons[j]));
+			if(mapPolygons[j]->auxiliary_data().map_index() != i)
+				mapPolygons[j]->auxiliary_data().set_walkable(false);
+		}
+
+		// Generate the navigation mesh.
+		double maxHeightDifference = boundsManager->bounds(i)->height() / 2;
+		NavMeshGenerator generator(mapPolygons, maxHeightDifference);
+		NavMesh_Ptr mesh = generator.generate_mesh();
+
+		// Build the navigation graph adjacency list.
+		AdjacencyList_Ptr adjList(new AdjacencyList(mesh));
+
+		// Generate the path table (the graph is generally quite sparse, so we run Dijkstra's
+		// algorithm from each node rather than using Floyd-Warshall on an adjacency table).
+		PathTable_Ptr pathTable = PathTableGenerator::dijkstra(*adjList, threadCount);
+
+		navManager->set_dataset(i, NavDataset_Ptr(new NavDataset(adjList, mesh, pathTable)));
+	}
+
+	return navManager;
+}
+
+//#################### PRIVATE METHODS ####################
+BuildUtil::ColPolyBrush_Ptr BuildUtil::convert_brush(const TexPolyBrush_Ptr& texBrush)
+{
+	AABB3d bounds = texBrush->bounds();
+	const TexPolyVector& texFaces = texBrush->faces();
+	int faceCount = static_cast<int>(texFaces.size());
+	ColPolyVector colFaces(faceCount);
+	for(int i=0; i<faceCount; ++i)
+	{
+		int vertCount = texFaces[i]->vertex_count();
+		std::vector<Vector3d> colVertices;
+		colVertices.reserve(vertCount);
+		for(int j=0; j<vertCount; ++j)
+		{
+			// Note: There is an implicit conversion from TexturedVector3d -> Vector3d taking place here.
+			colVertices.push_back(texFaces[i]->vertex(j));
+		}
+		CollisionPolygon::AuxData colAuxData = make_aux_data(texFaces[i]->normal());
+		colFaces[i].reset(new CollisionPolygon(colVertices, colAuxData));
+	}
+	return ColPolyBrush_Ptr(new ColPolyBrush(bounds, colFaces, texBrush->function()));
+}
+
+BuildUtil::TexPolyVector BuildUtil::extract_hint_polygons(const TexPolyBrushVector& hintBrushes)
+{
+	TexPolyVector ret;
+	for(TexPolyBrushVector::const_iterator it=hintBrushes.begin(), iend=hintBrushes.end(); it!=iend; ++it)
+	{
+		const TexPolyVector& brushFaces = (*it)->faces();
+		for(TexPolyVector::const_iterator jt=brushFaces.begin(), jend=brushFaces.end(); jt!=jend; ++jt)
+		{
+			const TexturedPolygon_Ptr& brushFace = *jt;
+			if(brushFace->auxiliary_data() == "HINT") ret.push_back(brushFace);
+		}
+	}
+	return ret;
+}
+
+void BuildUtil::flood_from(int leaf, const std::map<int,std::vector<Portal_Ptr> >& portalsFromLeaf, std::set<int>& reachableLeaves)
+{
+	reachableLeaves.insert(leaf);
+
+	std::map<int,std::vector<Portal_Ptr> >::const_iterator it = portalsFromLeaf.find(leaf);
+	if(it != portalsFromLeaf.end())
+	{
+		const std::vector<Portal_Ptr>& outPortals = it->second;
+		int outPortalCount = static_cast<int>(outPortals.size());
+		for(int j=0; j<outPortalCount; ++j)
+		{
+			Portal_Ptr outPortal = outPortals[j];
+			int toLeaf = outPortal->auxiliary_data().toLeaf;
+
+			// If the destination of this portal is already marked as reachable, don't recurse.
+			if(reachableLeaves.find(toLeaf) != reachableLeaves.end()) continue;
+
+			// Otherwise, recursively flood from the leaf on the other side of this portal.
+			flood_from(toLeaf, portalsFromLeaf, reachableLeaves);
+		}
+	}
+}
+
+ColPolyAuxData BuildUtil::make_aux_data(const Vector3d& faceNormal)
+{
+	// TODO: CPAuxData will eventually store more interesting things (see its definition).
+	const double MAX_ANGLE_TO_VERTICAL = 45 * PI/180;	// i.e. 45 degrees
+	double angleToVertical = acos(faceNormal.dot(Vector3d(0,0,1)));
+	bool walkable = fabs(angleToVertical) <= MAX_ANGLE_TO_VERTICAL;
+	return ColPolyAuxData(walkable);
+}
+
+}
@@ -0,0 +1,68 @@
+/***
+ * hesperus: BuildUtil.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_BUILDUTIL
+#define H_HESP_BUILDUTIL
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <hesp/brushes/PolyhedralBrush.h>
+#include <hesp/portals/Portal.h>
+#include <hesp/trees/BSPTree.h>
+#include <hesp/util/PolygonTypes.h>
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<const class BoundsManager> BoundsManager_CPtr;
+typedef shared_ptr<class NavManager> NavManager_Ptr;
+typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
+
+/**
+This class contains the level-building stages which don't correspond directly to a single
+engine class (e.g. the CSG and BSP stages just use CSGUtil and BSPCompiler). They're shared
+by the individual level-building tools and the in-process build driver.
+*/
+class BuildUtil
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef PolyhedralBrush<CollisionPolygon> ColPolyBrush;
+	typedef shared_ptr<ColPolyBrush> ColPolyBrush_Ptr;
+	typedef std::vector<ColPolyBrush_Ptr> ColPolyBrushVector;
+	typedef std::vector<CollisionPolygon_Ptr> ColPolyVector;
+	typedef PolyhedralBrush<TexturedPolygon> TexPolyBrush;
+	typedef shared_ptr<TexPolyBrush> TexPolyBrush_Ptr;
+	typedef std::vector<TexPolyBrush_Ptr> TexPolyBrushVector;
+	typedef std::vector<TexturedPolygon_Ptr> TexPolyVector;
+
+	//#################### PUBLIC METHODS ####################
+public:
+	static void add_detail(TexPolyVector& polygons, const BSPTree_Ptr& tree, const TexPolyBrushVector& detailBrushes);
+	static void divide_brushes(const TexPolyBrushVector& inputBrushes, TexPolyBrushVector& renderingBrushes, ColPolyBrushVector& collisionBrushes,
+							   TexPolyBrushVector& detailBrushes, TexPolyVector& hintPolygons, TexPolyBrushVector& specialBrushes);
+	static std::vector<ColPolyBrushVector> expand_brushes(const ColPolyBrushVector& brushes, const BoundsManager_CPtr& boundsManager);
+	template <typename Poly> static std::vector<shared_ptr<Poly> > flood_fill(const std::vector<shared_ptr<Poly> >& polygons, const BSPTree_CPtr& tree,
+																			   int emptyLeafCount, const std::vector<Portal_Ptr>& portals);
+	static NavManager_Ptr generate_nav_data(const ColPolyVector& polygons, const OnionTree_CPtr& tree, const BoundsManager_CPtr& boundsManager, int threadCount);
+
+	//#################### PRIVATE METHODS ####################
+private:
+	static ColPolyBrush_Ptr convert_brush(const TexPolyBrush_Ptr& texBrush);
+	static TexPolyVector extract_hint_polygons(const TexPolyBrushVector& hintBrushes);
+	static void flood_from(int leaf, const std::map<int,std::vector<Portal_Ptr> >& portalsFromLeaf, std::set<int>& reachableLeaves);
+	static ColPolyAuxData make_aux_data(const Vector3d& faceNormal);
+};
+
+}
+
+#include "BuildUtil.tpp"
+
+#endif
@@ -0,0 +1,67 @@
+/***
+ * hesperus: BuildUtil.tpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <algorithm>
+#include <iterator>
+
+#include <hesp/trees/TreeUtil.h>
+
+namespace hesp {
+
+//#################### PUBLIC METHODS ####################
+/**
+Flood-fills a level from a point outside it to find the leaves which aren't valid (i.e. the ones
+which can be reached from outside), and returns the polygons in the remaining leaves.
+
+@param polygons			The polygons in the tree
+@param tree				The tree
+@param emptyLeafCount	The number of empty leaves in the tree
+@param portals			The portals between the empty leaves
+@return					The polygons in the valid leaves
+*/
+template <typename Poly>
+std::vector<shared_ptr<Poly> > BuildUtil::flood_fill(const std::vector<shared_ptr<Poly> >& polygons, const BSPTree_CPtr& tree,
+													 int emptyLeafCount, const std::vector<Portal_Ptr>& portals)
+{
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::vector<Poly_Ptr> PolyVector;
+
+	// Build the "portals from leaf" data structure.
+	std::map<int,std::vector<Portal_Ptr> > portalsFromLeaf;
+	for(std::vector<Portal_Ptr>::const_iterator it=portals.begin(), iend=portals.end(); it!=iend; ++it)
+	{
+		int fromLeaf = (*it)->auxiliary_data().fromLeaf;
+		portalsFromLeaf[fromLeaf].push_back(*it);
+	}
+
+	// Flood from an arbitrary point outside the level to figure out which leaves aren't valid.
+	int startLeaf = TreeUtil::find_leaf_index(Vector3d(100000, 0, 0), tree);
+	std::set<int> reachableLeaves;
+	flood_from(startLeaf, portalsFromLeaf, reachableLeaves);
+
+	// Determine the set of valid leaves, i.e. the ones which aren't reachable from outside the level.
+	std::set<int> emptyLeaves;
+	for(int i=0; i<emptyLeafCount; ++i) emptyLeaves.insert(i);
+
+	std::set<int> validLeaves;
+	std::set_difference(emptyLeaves.begin(), emptyLeaves.end(), reachableLeaves.begin(), reachableLeaves.end(), std::inserter(validLeaves, validLeaves.end()));
+
+	// Copy all the polygons from them to an array.
+	PolyVector validPolygons;
+	validPolygons.reserve(polygons.size());
+	for(std::set<int>::const_iterator it=validLeaves.begin(), iend=validLeaves.end(); it!=iend; ++it)
+	{
+		const BSPLeaf *leaf = tree->leaf(*it);
+		const std::vector<int>& polyIndices = leaf->polygon_indices();
+		for(std::vector<int>::const_iterator jt=polyIndices.begin(), jend=polyIndices.end(); jt!=jend; ++jt)
+		{
+			validPolygons.push_back(polygons[*jt]);
+		}
+	}
+
+	return validPolygons;
+}
+
+}
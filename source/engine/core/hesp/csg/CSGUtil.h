@@ -7,9 +7,11 @@
 #define H_HESP_CSGUTIL
 
 #include <list>
+#include <string>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 using boost::shared_ptr;
 
 #include <hesp/brushes/PolyhedralBrush.h>
@@ -18,6 +20,15 @@ using boost::shared_ptr;
 
 namespace hesp {
 
+/**
+This class provides the CSG operations used to turn a set of brushes into valid polygon geometry.
+
+When unioning brushes, the pairs of brushes which are within range of each other are found
+by sweeping along the axis on which the brushes are most spread out, rather than by testing
+every brush against every other one. The faces of each brush are then clipped independently
+of those of the other brushes, so the brushes can be shared out between several threads; the
+fragments are output in brush order, so the result doesn't depend on the number of threads.
+*/
 template <typename Vert, typename AuxData>
 class CSGUtil
 {
@@ -36,12 +47,18 @@ private:
 	//#################### PUBLIC METHODS ####################
 public:
 	static PolyList clip_polygons_to_tree(const PolyList& polys, const BSPTree_CPtr& tree, bool coplanarFlag);
-	static PolyList_Ptr union_all(const PolyBrushVector& brushes);
+	static PolyList_Ptr union_all(const PolyBrushVector& brushes, int threadCount = 1);
 
 	//#################### PRIVATE METHODS ####################
 private:
 	static BSPTree_Ptr build_tree(const PolyBrush& brush);
-	static std::pair<PolyList,bool> clip_polygon_to_subtree(const Poly_Ptr& poly, const BSPNode_CPtr& node, bool coplanarFlag);	
+	static PolyList clip_brush_faces(int i, const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<int>& interactingBrushes);
+	static void clip_brush_faces_task(const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<std::vector<int> >& interactingBrushes,
+									  std::vector<PolyList>& results, int& nextBrush, boost::mutex& nextBrushMutex, std::string& error);
+	static void clip_brush_faces_worker(const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<std::vector<int> >& interactingBrushes,
+										std::vector<PolyList>& results, int& nextBrush, boost::mutex& nextBrushMutex);
+	static std::pair<PolyList,bool> clip_polygon_to_subtree(const Poly_Ptr& poly, const BSPNode_CPtr& node, bool coplanarFlag);
+	static std::vector<std::vector<int> > find_interacting_brushes(const PolyBrushVector& brushes, double tolerance);
 };
 
 }
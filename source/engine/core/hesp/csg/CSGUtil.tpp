@@ -6,6 +6,14 @@
 #define CSGUtil_HEADER	template <typename Vert, typename AuxData>
 #define CSGUtil_THIS	CSGUtil<Vert,AuxData>
 
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <hesp/exceptions/Exception.h>
 #include <hesp/trees/BSPBranch.h>
 
 namespace hesp {
@@ -35,12 +43,13 @@ CSGUtil_THIS::clip_polygons_to_tree(const PolyList& polys, const BSPTree_CPtr& t
 /**
 Unions the polygons in a set of convex brushes to produce a valid set of polygon geometry
 
-@param brushes	The brushes
-@return			The valid polygon geometry
+@param brushes		The brushes
+@param threadCount	The number of threads to use for clipping the brush faces
+@return				The valid polygon geometry
 */
 CSGUtil_HEADER
 typename CSGUtil_THIS::PolyList_Ptr
-CSGUtil_THIS::union_all(const PolyBrushVector& brushes)
+CSGUtil_THIS::union_all(const PolyBrushVector& brushes, int threadCount)
 {
 	PolyList_Ptr ret(new PolyList);
 
@@ -54,35 +63,38 @@ CSGUtil_THIS::union_all(const PolyBrushVector& brushes)
 
 	// Determine which brushes can interact with each other.
 	const double TOLERANCE = 1.0;
-	std::vector<std::vector<unsigned char> > brushesInteract(brushCount);
-	for(int i=0; i<brushCount; ++i)
+	std::vector<std::vector<int> > interactingBrushes = find_interacting_brushes(brushes, TOLERANCE);
+
+	// Clip the faces of each brush to the trees of the brushes within range of it.
+	std::vector<PolyList> results(brushCount);
+	int nextBrush = 0;
+	boost::mutex nextBrushMutex;
+
+	if(threadCount <= 1)
 	{
-		brushesInteract[i].reserve(brushCount);
-		for(int j=0; j<brushCount; ++j)
+		clip_brush_faces_worker(brushes, trees, interactingBrushes, results, nextBrush, nextBrushMutex);
+	}
+	else
+	{
+		std::vector<std::string> errors(threadCount);
+		boost::thread_group workers;
+		for(int i=0; i<threadCount; ++i)
+		{
+			workers.create_thread(boost::bind(&CSGUtil::clip_brush_faces_task, boost::cref(brushes), boost::cref(trees), boost::cref(interactingBrushes),
+											  boost::ref(results), boost::ref(nextBrush), boost::ref(nextBrushMutex), boost::ref(errors[i])));
+		}
+		workers.join_all();
+
+		// Re-raise the first error from the workers (if any) on this thread.
+		for(int i=0; i<threadCount; ++i)
 		{
-			if(j == i) brushesInteract[i].push_back(false);
-			else brushesInteract[i].push_back(AABB3d::within_range(brushes[i]->bounds(), brushes[j]->bounds(), TOLERANCE));
+			if(!errors[i].empty()) throw Exception(errors[i]);
 		}
 	}
 
-	// Clip each polygon to the tree of each brush within range of its own brush.
 	for(int i=0; i<brushCount; ++i)
 	{
-		const PolyVector& faces = brushes[i]->faces();
-		int faceCount = static_cast<int>(faces.size());
-		for(int j=0; j<faceCount; ++j)
-		{
-			PolyList fragments;
-			fragments.push_back(faces[j]);
-			for(int k=0; k<brushCount; ++k)
-			{
-				if(brushesInteract[i][k])
-				{
-					fragments = clip_polygons_to_tree(fragments, trees[k], i < k);
-				}
-			}
-			ret->splice(ret->end(), fragments);
-		}
+		ret->splice(ret->end(), results[i]);
 	}
 
 	return ret;
@@ -117,6 +129,71 @@ BSPTree_Ptr CSGUtil_THIS::build_tree(const PolyBrush& brush)
 	return BSPTree_Ptr(new BSPTree(nodes));
 }
 
+/**
+Clips the faces of a brush to the trees of the brushes within range of it.
+
+@param i					The index of the brush
+@param brushes				The brushes
+@param trees				The trees for the brushes
+@param interactingBrushes	The indices of the brushes within range of brush i, in ascending order
+@return						The fragments of the faces which survived the clipping process
+*/
+CSGUtil_HEADER
+typename CSGUtil_THIS::PolyList
+CSGUtil_THIS::clip_brush_faces(int i, const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<int>& interactingBrushes)
+{
+	PolyList ret;
+	const PolyVector& faces = brushes[i]->faces();
+	int faceCount = static_cast<int>(faces.size());
+	for(int j=0; j<faceCount; ++j)
+	{
+		PolyList fragments;
+		fragments.push_back(faces[j]);
+		for(std::vector<int>::const_iterator it=interactingBrushes.begin(), iend=interactingBrushes.end(); it!=iend; ++it)
+		{
+			int k = *it;
+			fragments = clip_polygons_to_tree(fragments, trees[k], i < k);
+		}
+		ret.splice(ret.end(), fragments);
+	}
+	return ret;
+}
+
+/**
+Runs clip_brush_faces_worker on a worker thread, recording any error it raises (an exception
+which escaped the thread function would terminate the program).
+
+@param error	Used to return a description of the error raised by the worker (if any)
+*/
+CSGUtil_HEADER
+void CSGUtil_THIS::clip_brush_faces_task(const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<std::vector<int> >& interactingBrushes,
+										 std::vector<PolyList>& results, int& nextBrush, boost::mutex& nextBrushMutex, std::string& error)
+try
+{
+	clip_brush_faces_worker(brushes, trees, interactingBrushes, results, nextBrush, nextBrushMutex);
+}
+catch(Exception& e)			{ error = e.cause(); }
+catch(std::exception& e)	{ error = std::string("Error whilst clipping brush faces: ") + e.what(); }
+catch(...)					{ error = "Unknown error whilst clipping brush faces"; }
+
+CSGUtil_HEADER
+void CSGUtil_THIS::clip_brush_faces_worker(const PolyBrushVector& brushes, const std::vector<BSPTree_Ptr>& trees, const std::vector<std::vector<int> >& interactingBrushes,
+										   std::vector<PolyList>& results, int& nextBrush, boost::mutex& nextBrushMutex)
+{
+	int brushCount = static_cast<int>(brushes.size());
+	for(;;)
+	{
+		int i;
+		{
+			boost::mutex::scoped_lock lock(nextBrushMutex);
+			if(nextBrush == brushCount) return;
+			i = nextBrush++;
+		}
+
+		results[i] = clip_brush_faces(i, brushes, trees, interactingBrushes[i]);
+	}
+}
+
 /**
 Clips a polygon to a subtree.
 
@@ -192,6 +269,71 @@ CSGUtil_THIS::clip_polygon_to_subtree(const Poly_Ptr& poly, const BSPNode_CPtr&
 	}
 }
 
+/**
+Finds the brushes which are within range of each brush, using sweep-and-prune: the brushes are
+sorted by the minimum of their bounds along the axis on which they're most spread out, and each
+brush is then only tested against the brushes which start before it ends along that axis.
+
+@param brushes		The brushes
+@param tolerance	How far apart the bounds of two brushes can be while still being in range of each other
+@return				The indices of the brushes within range of each brush, in ascending order
+*/
+CSGUtil_HEADER
+std::vector<std::vector<int> > CSGUtil_THIS::find_interacting_brushes(const PolyBrushVector& brushes, double tolerance)
+{
+	int brushCount = static_cast<int>(brushes.size());
+	std::vector<std::vector<int> > ret(brushCount);
+	if(brushCount == 0) return ret;
+
+	// Pick the axis along which the brush centres are most spread out.
+	Vector3d lowestCentre, highestCentre;
+	for(int i=0; i<brushCount; ++i)
+	{
+		const AABB3d& bounds = brushes[i]->bounds();
+		Vector3d centre = (bounds.minimum() + bounds.maximum()) / 2;
+		if(i == 0) lowestCentre = highestCentre = centre;
+		lowestCentre = Vector3d(std::min(lowestCentre.x, centre.x), std::min(lowestCentre.y, centre.y), std::min(lowestCentre.z, centre.z));
+		highestCentre = Vector3d(std::max(highestCentre.x, centre.x), std::max(highestCentre.y, centre.y), std::max(highestCentre.z, centre.z));
+	}
+	Vector3d spread = highestCentre - lowestCentre;
+	double Vector3d::*axis = &Vector3d::x;
+	if(spread.y > spread.*axis) axis = &Vector3d::y;
+	if(spread.z > spread.*axis) axis = &Vector3d::z;
+
+	// Sort the brushes by the minimum of their bounds along that axis.
+	std::vector<std::pair<double,int> > starts(brushCount);
+	for(int i=0; i<brushCount; ++i)
+	{
+		starts[i] = std::make_pair(brushes[i]->bounds().minimum().*axis, i);
+	}
+	std::sort(starts.begin(), starts.end());
+
+	// Sweep along the axis, testing each brush against the brushes which start before it ends.
+	for(int s=0; s<brushCount; ++s)
+	{
+		int i = starts[s].second;
+		const AABB3d& bounds = brushes[i]->bounds();
+		double end = bounds.maximum().*axis + tolerance;
+		for(int t=s+1; t<brushCount && starts[t].first <= end; ++t)
+		{
+			int j = starts[t].second;
+			if(AABB3d::within_range(bounds, brushes[j]->bounds(), tolerance))
+			{
+				ret[i].push_back(j);
+				ret[j].push_back(i);
+			}
+		}
+	}
+
+	// Sort the brushes within range of each brush, so that its faces are clipped in a consistent order.
+	for(int i=0; i<brushCount; ++i)
+	{
+		std::sort(ret[i].begin(), ret[i].end());
+	}
+
+	return ret;
+}
+
 }
 
 #undef CSGUtil_THIS
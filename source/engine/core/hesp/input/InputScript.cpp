@@ -0,0 +1,77 @@
+/***
+ * hesperus: InputScript.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "InputScript.h"
+
+#include <algorithm>
+
+#include "InputState.h"
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs an input script from a set of events. Events which happen on the
+same tick are applied in the order in which they were specified.
+
+@param events	The events
+*/
+InputScript::InputScript(const std::vector<Event>& events)
+:	m_events(events)
+{
+	std::stable_sort(m_events.begin(), m_events.end(), EarlierEvent());
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Applies the events which happen on the specified tick to an input state. As in the game,
+the mouse motion only lasts for a single tick, so it's reset before the events are applied.
+
+@param tick		The tick
+@param input	The input state
+*/
+void InputScript::apply(int tick, InputState& input) const
+{
+	input.set_mouse_motion(0, 0);
+
+	typedef std::vector<Event>::const_iterator Iter;
+	std::pair<Iter,Iter> range = std::equal_range(m_events.begin(), m_events.end(), tick, EarlierEvent());
+	for(Iter it=range.first; it!=range.second; ++it)
+	{
+		switch(it->type)
+		{
+			case EVENT_KEY_DOWN:
+				input.press_key(it->key);
+				break;
+			case EVENT_KEY_UP:
+				input.release_key(it->key);
+				break;
+			case EVENT_MOUSE_BUTTON_DOWN:
+				input.press_mouse_button(it->button, it->x, it->y);
+				break;
+			case EVENT_MOUSE_BUTTON_UP:
+				input.release_mouse_button(it->button);
+				break;
+			case EVENT_MOUSE_MOTION:
+				input.set_mouse_motion(it->x, it->y);
+				break;
+			case EVENT_MOUSE_POSITION:
+				input.set_mouse_position(it->x, it->y);
+				break;
+		}
+	}
+}
+
+/**
+Returns the last tick on which an event happens.
+
+@return	As stated, or -1 if the script is empty
+*/
+int InputScript::last_tick() const
+{
+	return m_events.empty() ? -1 : m_events.back().tick;
+}
+
+}
@@ -0,0 +1,85 @@
+/***
+ * hesperus: InputScript.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_INPUTSCRIPT
+#define H_HESP_INPUTSCRIPT
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <SDL_keysym.h>
+
+#include "MouseButton.h"
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+class InputState;
+
+/**
+This class represents a scripted (or recorded) sequence of input events, each of which
+happens on a particular tick of a fixed-timestep simulation. It allows the simulation
+to be driven without a window or any real input devices.
+*/
+class InputScript
+{
+	//#################### ENUMERATIONS ####################
+public:
+	enum EventType
+	{
+		EVENT_KEY_DOWN,
+		EVENT_KEY_UP,
+		EVENT_MOUSE_BUTTON_DOWN,
+		EVENT_MOUSE_BUTTON_UP,
+		EVENT_MOUSE_MOTION,
+		EVENT_MOUSE_POSITION
+	};
+
+	//#################### NESTED CLASSES ####################
+public:
+	struct Event
+	{
+		int tick;
+		EventType type;
+		SDLKey key;				// for key events
+		MouseButton button;		// for mouse button events
+		int x, y;				// for mouse events (the button press location, motion or position)
+
+		Event(int tick_, EventType type_, SDLKey key_ = SDLK_UNKNOWN, MouseButton button_ = MOUSE_BUTTON_LEFT, int x_ = 0, int y_ = 0)
+		:	tick(tick_), type(type_), key(key_), button(button_), x(x_), y(y_)
+		{}
+	};
+
+private:
+	struct EarlierEvent
+	{
+		bool operator()(const Event& lhs, const Event& rhs) const	{ return lhs.tick < rhs.tick; }
+		bool operator()(const Event& lhs, int rhs) const			{ return lhs.tick < rhs; }
+		bool operator()(int lhs, const Event& rhs) const			{ return lhs < rhs.tick; }
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<Event> m_events;	// in ascending order of tick
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit InputScript(const std::vector<Event>& events);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void apply(int tick, InputState& input) const;
+	int last_tick() const;
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<InputScript> InputScript_Ptr;
+typedef shared_ptr<const InputScript> InputScript_CPtr;
+
+}
+
+#endif
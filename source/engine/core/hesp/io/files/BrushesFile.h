@@ -6,6 +6,7 @@
 #ifndef H_HESP_BRUSHESFILE
 #define H_HESP_BRUSHESFILE
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -20,9 +21,11 @@ struct BrushesFile
 {
 	//#################### LOADING METHODS ####################
 	template <typename Poly> static std::vector<shared_ptr<PolyhedralBrush<Poly> > > load(const std::string& filename);
+	template <typename Poly> static std::vector<shared_ptr<PolyhedralBrush<Poly> > > load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	template <typename Poly> static void save(const std::string& filename, const std::vector<shared_ptr<PolyhedralBrush<Poly> > >& brushes);
+	template <typename Poly> static void save(std::ostream& os, const std::vector<shared_ptr<PolyhedralBrush<Poly> > >& brushes);
 };
 
 }
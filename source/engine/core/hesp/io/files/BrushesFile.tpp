@@ -21,7 +21,18 @@ std::vector<shared_ptr<PolyhedralBrush<Poly> > > BrushesFile::load(const std::st
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	return load<Poly>(is);
+}
+
+/**
+Loads an array of polyhedral brushes from the specified std::istream.
 
+@param is		The std::istream
+@return			The brushes
+*/
+template <typename Poly>
+std::vector<shared_ptr<PolyhedralBrush<Poly> > > BrushesFile::load(std::istream& is)
+{
 	typedef PolyhedralBrush<Poly> PolyBrush;
 	typedef shared_ptr<PolyBrush> PolyBrush_Ptr;
 	typedef std::vector<PolyBrush_Ptr> PolyBrushVector;
@@ -49,7 +60,18 @@ void BrushesFile::save(const std::string& filename, const std::vector<shared_ptr
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, brushes);
+}
+
+/**
+Saves an array of polyhedral brushes to the specified std::ostream.
 
+@param os			The std::ostream
+@param brushes		The brushes to save
+*/
+template <typename Poly>
+void BrushesFile::save(std::ostream& os, const std::vector<shared_ptr<PolyhedralBrush<Poly> > >& brushes)
+{
 	int brushCount = static_cast<int>(brushes.size());
 	for(int i=0; i<brushCount; ++i)
 	{
@@ -17,6 +17,11 @@ std::string DefinitionsSpecifierFile::load(const std::string& filename)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	return load(is);
+}
+
+std::string DefinitionsSpecifierFile::load(std::istream& is)
+{
 	return DefinitionsSpecifierSection::load(is);
 }
 
@@ -25,6 +30,11 @@ void DefinitionsSpecifierFile::save(const std::string& filename, const std::stri
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, definitionsFilename);
+}
+
+void DefinitionsSpecifierFile::save(std::ostream& os, const std::string& definitionsFilename)
+{
 	DefinitionsSpecifierSection::save(os, definitionsFilename);
 }
 
@@ -6,6 +6,7 @@
 #ifndef H_HESP_DEFINITIONSSPECIFIERFILE
 #define H_HESP_DEFINITIONSSPECIFIERFILE
 
+#include <iosfwd>
 #include <string>
 
 namespace hesp {
@@ -14,9 +15,11 @@ struct DefinitionsSpecifierFile
 {
 	//#################### LOADING METHODS ####################
 	static std::string load(const std::string& filename);
+	static std::string load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, const std::string& definitionsFilename);
+	static void save(std::ostream& os, const std::string& definitionsFilename);
 };
 
 }
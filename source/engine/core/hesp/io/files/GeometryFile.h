@@ -6,6 +6,7 @@
 #ifndef H_HESP_GEOMETRYFILE
 #define H_HESP_GEOMETRYFILE
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -18,9 +19,11 @@ struct GeometryFile
 {
 	//#################### LOADING METHODS ####################
 	template <typename Poly> static void load(const std::string& filename, std::vector<shared_ptr<Poly> >& polygons);
+	template <typename Poly> static void load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons);
 
 	//#################### SAVING METHODS ####################
 	template <typename Poly> static void save(const std::string& filename, const std::vector<shared_ptr<Poly> >& polygons);
+	template <typename Poly> static void save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons);
 };
 
 }
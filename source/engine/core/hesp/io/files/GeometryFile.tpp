@@ -21,6 +21,18 @@ void GeometryFile::load(const std::string& filename, std::vector<shared_ptr<Poly
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	load(is, polygons);
+}
+
+/**
+Loads an array of polygons from the specified std::istream.
+
+@param is			The std::istream
+@param polygons		Used to return the polygons to the caller
+*/
+template <typename Poly>
+void GeometryFile::load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons)
+{
 	IOUtil::read_uncounted_polygons(is, polygons);
 }
 
@@ -36,6 +48,18 @@ void GeometryFile::save(const std::string& filename, const std::vector<shared_pt
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open" + filename + " for writing");
+	save(os, polygons);
+}
+
+/**
+Saves an array of polygons to the specified std::ostream.
+
+@param os			The std::ostream
+@param polygons		The polygons
+*/
+template <typename Poly>
+void GeometryFile::save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons)
+{
 	IOUtil::write_polygons(os, polygons, false);
 }
 
@@ -0,0 +1,166 @@
+/***
+ * hesperus: InputScriptFile.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "InputScriptFile.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/util/LineIO.h>
+
+namespace hesp {
+
+//#################### LOADING METHODS ####################
+/**
+Loads an input script from the specified file.
+
+@param filename	The name of the file from which to load the input script
+@return			The input script
+*/
+InputScript_Ptr InputScriptFile::load(const std::string& filename)
+{
+	std::ifstream is(filename.c_str());
+	if(is.fail()) throw Exception("The input script file could not be read");
+	return load(is);
+}
+
+/**
+Loads an input script from the specified std::istream. Each line of the script is either
+blank, a comment (starting with #), or an event of one of the following forms:
+
+<tick> key_down <key>
+<tick> key_up <key>
+<tick> mouse_down {left|middle|right} <x> <y>
+<tick> mouse_up {left|middle|right}
+<tick> mouse_motion <dx> <dy>
+<tick> mouse_position <x> <y>
+
+Keys are specified either by their names (as in the input binding files, e.g. "w",
+"space" or "left shift"), or by their numeric SDL key codes.
+
+@param is			The std::istream
+@return				The input script
+@throws Exception	If the script is malformed
+*/
+InputScript_Ptr InputScriptFile::load(std::istream& is)
+{
+	std::vector<InputScript::Event> events;
+
+	std::string line;
+	for(int lineNumber=1; LineIO::portable_getline(is, line); ++lineNumber)
+	{
+		std::istringstream ss(line);
+		std::string tickString, command;
+		if(!(ss >> tickString) || tickString[0] == '#') continue;
+
+		int tick;
+		try							{ tick = lexical_cast<int>(tickString); }
+		catch(bad_lexical_cast&)	{ throw Exception("Bad tick on line " + lexical_cast<std::string>(lineNumber) + " of the input script"); }
+
+		if(!(ss >> command)) throw Exception("Missing command on line " + lexical_cast<std::string>(lineNumber) + " of the input script");
+
+		if(command == "key_down" || command == "key_up")
+		{
+			std::string name;
+			std::getline(ss >> std::ws, name);
+			InputScript::EventType type = command == "key_down" ? InputScript::EVENT_KEY_DOWN : InputScript::EVENT_KEY_UP;
+			events.push_back(InputScript::Event(tick, type, parse_key(name)));
+		}
+		else if(command == "mouse_down")
+		{
+			std::string button;
+			int x, y;
+			if(!(ss >> button >> x >> y)) throw Exception("Bad mouse_down event on line " + lexical_cast<std::string>(lineNumber) + " of the input script");
+			events.push_back(InputScript::Event(tick, InputScript::EVENT_MOUSE_BUTTON_DOWN, SDLK_UNKNOWN, parse_button(button), x, y));
+		}
+		else if(command == "mouse_up")
+		{
+			std::string button;
+			if(!(ss >> button)) throw Exception("Bad mouse_up event on line " + lexical_cast<std::string>(lineNumber) + " of the input script");
+			events.push_back(InputScript::Event(tick, InputScript::EVENT_MOUSE_BUTTON_UP, SDLK_UNKNOWN, parse_button(button)));
+		}
+		else if(command == "mouse_motion" || command == "mouse_position")
+		{
+			int x, y;
+			if(!(ss >> x >> y)) throw Exception("Bad " + command + " event on line " + lexical_cast<std::string>(lineNumber) + " of the input script");
+			InputScript::EventType type = command == "mouse_motion" ? InputScript::EVENT_MOUSE_MOTION : InputScript::EVENT_MOUSE_POSITION;
+			events.push_back(InputScript::Event(tick, type, SDLK_UNKNOWN, MOUSE_BUTTON_LEFT, x, y));
+		}
+		else throw Exception("Unknown command on line " + lexical_cast<std::string>(lineNumber) + " of the input script: " + command);
+	}
+
+	return InputScript_Ptr(new InputScript(events));
+}
+
+//#################### LOADING SUPPORT METHODS ####################
+MouseButton InputScriptFile::parse_button(const std::string& name)
+{
+	if(name == "left") return MOUSE_BUTTON_LEFT;
+	else if(name == "middle") return MOUSE_BUTTON_MIDDLE;
+	else if(name == "right") return MOUSE_BUTTON_RIGHT;
+	else throw Exception("Unknown mouse button in the input script: " + name);
+}
+
+/**
+Looks up a key by name. (The names are the ones SDL uses, but SDL can only look them up once
+its video subsystem has been initialised, which isn't the case when running headless.)
+
+@param name			The name of the key, or its numeric SDL key code
+@return				The key
+@throws Exception	If the key is unknown
+*/
+SDLKey InputScriptFile::parse_key(const std::string& name)
+{
+	struct NamedKey
+	{
+		const char *name;
+		SDLKey key;
+	};
+
+	static const NamedKey NAMED_KEYS[] =
+	{
+		{ "backspace", SDLK_BACKSPACE },
+		{ "down", SDLK_DOWN },
+		{ "escape", SDLK_ESCAPE },
+		{ "left", SDLK_LEFT },
+		{ "left alt", SDLK_LALT },
+		{ "left ctrl", SDLK_LCTRL },
+		{ "left shift", SDLK_LSHIFT },
+		{ "return", SDLK_RETURN },
+		{ "right", SDLK_RIGHT },
+		{ "right alt", SDLK_RALT },
+		{ "right ctrl", SDLK_RCTRL },
+		{ "right shift", SDLK_RSHIFT },
+		{ "space", SDLK_SPACE },
+		{ "tab", SDLK_TAB },
+		{ "up", SDLK_UP },
+	};
+
+	// Printable keys are named after their (lower-case) characters, which are also their key codes.
+	if(name.length() == 1 && isgraph(static_cast<unsigned char>(name[0])))
+	{
+		return SDLKey(tolower(static_cast<unsigned char>(name[0])));
+	}
+
+	for(size_t i=0, count=sizeof(NAMED_KEYS)/sizeof(NamedKey); i<count; ++i)
+	{
+		if(name == NAMED_KEYS[i].name) return NAMED_KEYS[i].key;
+	}
+
+	int code;
+	try							{ code = lexical_cast<int>(name); }
+	catch(bad_lexical_cast&)	{ throw Exception("Unknown key in the input script: " + name); }
+	if(code <= SDLK_UNKNOWN || code >= SDLK_LAST) throw Exception("Key code out of range in the input script: " + name);
+	return SDLKey(code);
+}
+
+}
@@ -0,0 +1,30 @@
+/***
+ * hesperus: InputScriptFile.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_INPUTSCRIPTFILE
+#define H_HESP_INPUTSCRIPTFILE
+
+#include <iosfwd>
+#include <string>
+
+#include <hesp/input/InputScript.h>
+
+namespace hesp {
+
+struct InputScriptFile
+{
+	//#################### LOADING METHODS ####################
+	static InputScript_Ptr load(const std::string& filename);
+	static InputScript_Ptr load(std::istream& is);
+
+	//#################### LOADING SUPPORT METHODS ####################
+private:
+	static MouseButton parse_button(const std::string& name);
+	static SDLKey parse_key(const std::string& name);
+};
+
+}
+
+#endif
@@ -26,18 +26,22 @@ namespace bf = boost::filesystem;
 #include <hesp/level/LitGeometryRenderer.h>
 #include <hesp/level/UnlitGeometryRenderer.h>
 #include <hesp/models/ModelManager.h>
+#include <hesp/nav/PathQueryService.h>
 #include <hesp/objects/components/ICmpModelRender.h>
 
 namespace hesp {
 
 //#################### LOADING METHODS ####################
 /**
-Loads a level from the specified file.
+Loads a level from the specified file. Tools which only simulate the level can skip loading
+the data that's only needed to render it (the textures and lightmaps for the geometry renderer,
+and the sprites), in which case the level will have no geometry renderer.
 
-@param filename	The name of the level file
-@return			The level
+@param filename				The name of the level file
+@param loadRenderingData	Whether or not to load the data needed to render the level
+@return						The level
 */
-Level_Ptr LevelFile::load(const std::string& filename)
+Level_Ptr LevelFile::load(const std::string& filename, bool loadRenderingData)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
@@ -45,8 +49,8 @@ Level_Ptr LevelFile::load(const std::string& filename)
 	std::string fileType;
 	if(!LineIO::portable_getline(is, fileType)) throw Exception("Unexpected EOF whilst trying to read file type");
 
-	if(fileType == "HBSPL") return load_lit(is);
-	else if(fileType == "HBSPU") return load_unlit(is);
+	if(fileType == "HBSPL") return load_lit(is, loadRenderingData);
+	else if(fileType == "HBSPU") return load_unlit(is, loadRenderingData);
 	else throw Exception(filename + " is not a valid level file");
 }
 
@@ -59,7 +63,7 @@ Saves all the relevant pieces of information to the specified level file.
 @param tree						The BSP tree for the level
 @param portals					The portals for the level
 @param leafVis					The leaf visibility table for the level
-@param lightmaps				The lightmaps for the level
+@param lightmaps				The lightmap atlas for the level
 @param onionPolygons			The polygons for the onion tree
 @param onionTree				The onion tree for the level
 @param onionPortals				The onion portals for the level
@@ -71,7 +75,7 @@ void LevelFile::save_lit(const std::string& filename,
 						 const std::vector<TexturedLitPolygon_Ptr>& polygons, const BSPTree_CPtr& tree,
 						 const std::vector<Portal_Ptr>& portals,
 						 const LeafVisTable_CPtr& leafVis,
-						 const std::vector<Image24_Ptr>& lightmaps,
+						 const LightmapAtlas_CPtr& lightmaps,
 						 const std::vector<CollisionPolygon_Ptr>& onionPolygons, const OnionTree_CPtr& onionTree,
 						 const std::vector<OnionPortal_Ptr>& onionPortals,
 						 const NavManager_CPtr& navManager,
@@ -144,10 +148,11 @@ void LevelFile::save_unlit(const std::string& filename,
 /**
 Loads a lit level from the specified std::istream.
 
-@param is	The std::istream
-@return		The lit level
+@param is					The std::istream
+@param loadRenderingData	Whether or not to load the data needed to render the level
+@return						The lit level
 */
-Level_Ptr LevelFile::load_lit(std::istream& is)
+Level_Ptr LevelFile::load_lit(std::istream& is, bool loadRenderingData)
 {
 	// Load the rendering polygons.
 	std::vector<TexturedLitPolygon_Ptr> polygons;
@@ -164,7 +169,7 @@ Level_Ptr LevelFile::load_lit(std::istream& is)
 	LeafVisTable_Ptr leafVis = VisSection::load(is);
 
 	// Load the lightmaps.
-	std::vector<Image24_Ptr> lightmaps = LightmapsSection::load(is);
+	LightmapAtlas_Ptr lightmaps = LightmapsSection::load(is);
 
 	// Load the onion polygons.
 	shared_ptr<std::vector<CollisionPolygon_Ptr> > onionPolygons(new std::vector<CollisionPolygon_Ptr>);
@@ -193,20 +198,22 @@ Level_Ptr LevelFile::load_lit(std::istream& is)
 	modelManager->load_all();
 
 	SpriteManager_Ptr spriteManager = SpriteNamesSection().load(is);
-	spriteManager->load_all();
+	if(loadRenderingData) spriteManager->load_all();
 
 	Database_Ptr database(new Database);
 	database->set("db://BSPTree", tree);
 	database->set("db://NavManager", navManager);
 	database->set("db://OnionPolygons", onionPolygons);
 	database->set("db://OnionTree", onionTree);
+	database->set("db://PathQueryService", PathQueryService_Ptr(new PathQueryService(navManager)));
 
 	ObjectManager_Ptr objectManager = ObjectsSection::load(is, boundsManager, componentPropertyTypes, archetypes, modelManager, spriteManager, database);
 
 	database->set("db://ObjectManager", objectManager);
 
-	// Construct the geometry renderer.
-	GeometryRenderer_Ptr geomRenderer(new LitGeometryRenderer(polygons, lightmaps));
+	// Construct the geometry renderer (if needed).
+	GeometryRenderer_Ptr geomRenderer;
+	if(loadRenderingData) geomRenderer.reset(new LitGeometryRenderer(polygons, lightmaps));
 
 	// Construct and return the level.
 	return Level_Ptr(new Level(geomRenderer, tree, portals, leafVis, onionPolygons, onionTree, onionPortals, navManager, objectManager));
@@ -215,10 +222,11 @@ Level_Ptr LevelFile::load_lit(std::istream& is)
 /**
 Loads an unlit level from the specified std::istream.
 
-@param is	The std::istream
-@return		The unlit level
+@param is					The std::istream
+@param loadRenderingData	Whether or not to load the data needed to render the level
+@return						The unlit level
 */
-Level_Ptr LevelFile::load_unlit(std::istream& is)
+Level_Ptr LevelFile::load_unlit(std::istream& is, bool loadRenderingData)
 {
 	// Load the rendering polygons.
 	std::vector<TexturedPolygon_Ptr> polygons;
@@ -261,20 +269,22 @@ Level_Ptr LevelFile::load_unlit(std::istream& is)
 	modelManager->load_all();
 
 	SpriteManager_Ptr spriteManager = SpriteNamesSection().load(is);
-	spriteManager->load_all();
+	if(loadRenderingData) spriteManager->load_all();
 
 	Database_Ptr database(new Database);
 	database->set("db://BSPTree", tree);
 	database->set("db://NavManager", navManager);
 	database->set("db://OnionPolygons", onionPolygons);
 	database->set("db://OnionTree", onionTree);
+	database->set("db://PathQueryService", PathQueryService_Ptr(new PathQueryService(navManager)));
 
 	ObjectManager_Ptr objectManager = ObjectsSection::load(is, boundsManager, componentPropertyTypes, archetypes, modelManager, spriteManager, database);
 
 	database->set("db://ObjectManager", objectManager);
 
-	// Construct the geometry renderer.
-	GeometryRenderer_Ptr geomRenderer(new UnlitGeometryRenderer(polygons));
+	// Construct the geometry renderer (if needed).
+	GeometryRenderer_Ptr geomRenderer;
+	if(loadRenderingData) geomRenderer.reset(new UnlitGeometryRenderer(polygons));
 
 	// Construct and return the level.
 	return Level_Ptr(new Level(geomRenderer, tree, portals, leafVis, onionPolygons, onionTree, onionPortals, navManager, objectManager));
@@ -6,8 +6,8 @@
 #ifndef H_HESP_LEVELFILE
 #define H_HESP_LEVELFILE
 
-#include <hesp/images/Image.h>
 #include <hesp/level/Level.h>
+#include <hesp/lighting/LightmapAtlas.h>
 
 namespace hesp {
 
@@ -15,7 +15,7 @@ class LevelFile
 {
 	//#################### LOADING METHODS ####################
 public:
-	static Level_Ptr load(const std::string& filename);
+	static Level_Ptr load(const std::string& filename, bool loadRenderingData = true);
 
 	//#################### SAVING METHODS ####################
 public:
@@ -23,7 +23,7 @@ public:
 						 const std::vector<TexturedLitPolygon_Ptr>& polygons, const BSPTree_CPtr& tree,
 						 const std::vector<Portal_Ptr>& portals,
 						 const LeafVisTable_CPtr& leafVis,
-						 const std::vector<Image24_Ptr>& lightmaps,
+						 const LightmapAtlas_CPtr& lightmaps,
 						 const std::vector<CollisionPolygon_Ptr>& onionPolygons, const OnionTree_CPtr& onionTree,
 						 const std::vector<OnionPortal_Ptr>& onionPortals,
 						 const NavManager_CPtr& navManager,
@@ -41,8 +41,8 @@ public:
 
 	//#################### LOADING SUPPORT METHODS ####################
 private:
-	static Level_Ptr load_lit(std::istream& is);
-	static Level_Ptr load_unlit(std::istream& is);
+	static Level_Ptr load_lit(std::istream& is, bool loadRenderingData);
+	static Level_Ptr load_unlit(std::istream& is, bool loadRenderingData);
 };
 
 }
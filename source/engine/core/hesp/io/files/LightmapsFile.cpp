@@ -0,0 +1,65 @@
+/***
+ * hesperus: LightmapsFile.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "LightmapsFile.h"
+
+#include <fstream>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/sections/LightmapsSection.h>
+
+namespace hesp {
+
+//#################### LOADING METHODS ####################
+/**
+Loads a lightmap atlas from the specified file.
+
+@param filename	The name of the file from which to load the lightmap atlas
+@return			The lightmap atlas
+*/
+LightmapAtlas_Ptr LightmapsFile::load(const std::string& filename)
+{
+	std::ifstream is(filename.c_str(), std::ios_base::binary);
+	if(is.fail()) throw Exception("The lightmaps file could not be read");
+	return load(is);
+}
+
+/**
+Loads a lightmap atlas from the specified std::istream.
+
+@param is	The std::istream
+@return		The lightmap atlas
+*/
+LightmapAtlas_Ptr LightmapsFile::load(std::istream& is)
+{
+	return LightmapsSection::load(is);
+}
+
+//#################### SAVING METHODS ####################
+/**
+Saves a lightmaps file.
+
+@param filename	The name of the file to which to save the lightmap atlas
+@param atlas	The lightmap atlas
+*/
+void LightmapsFile::save(const std::string& filename, const LightmapAtlas_CPtr& atlas)
+{
+	std::ofstream os(filename.c_str(), std::ios_base::binary);
+	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, atlas);
+}
+
+/**
+Saves a lightmap atlas to the specified std::ostream.
+
+@param os		The std::ostream
+@param atlas	The lightmap atlas
+*/
+void LightmapsFile::save(std::ostream& os, const LightmapAtlas_CPtr& atlas)
+{
+	LightmapsSection::save(os, atlas);
+}
+
+}
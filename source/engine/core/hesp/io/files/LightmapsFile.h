@@ -0,0 +1,29 @@
+/***
+ * hesperus: LightmapsFile.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_LIGHTMAPSFILE
+#define H_HESP_LIGHTMAPSFILE
+
+#include <iosfwd>
+#include <string>
+
+#include <hesp/lighting/LightmapAtlas.h>
+
+namespace hesp {
+
+struct LightmapsFile
+{
+	//#################### LOADING METHODS ####################
+	static LightmapAtlas_Ptr load(const std::string& filename);
+	static LightmapAtlas_Ptr load(std::istream& is);
+
+	//#################### SAVING METHODS ####################
+	static void save(const std::string& filename, const LightmapAtlas_CPtr& atlas);
+	static void save(std::ostream& os, const LightmapAtlas_CPtr& atlas);
+};
+
+}
+
+#endif
@@ -23,6 +23,17 @@ std::vector<Light> LightsFile::load(const std::string& filename)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	return load(is);
+}
+
+/**
+Loads an array of lights from the specified std::istream.
+
+@param is		The std::istream
+@return			The array of lights
+*/
+std::vector<Light> LightsFile::load(std::istream& is)
+{
 	return LightsSection::load(is);
 }
 
@@ -31,6 +42,11 @@ void LightsFile::save(const std::string& filename, const std::vector<Light>& lig
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, lights);
+}
+
+void LightsFile::save(std::ostream& os, const std::vector<Light>& lights)
+{
 	LightsSection::save(os, lights);
 }
 
@@ -6,6 +6,7 @@
 #ifndef H_HESP_LIGHTSFILE
 #define H_HESP_LIGHTSFILE
 
+#include <iosfwd>
 #include <vector>
 
 #include <hesp/lighting/Light.h>
@@ -16,9 +17,11 @@ struct LightsFile
 {
 	//#################### LOADING METHODS ####################
 	static std::vector<Light> load(const std::string& filename);
+	static std::vector<Light> load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, const std::vector<Light>& lights);
+	static void save(std::ostream& os, const std::vector<Light>& lights);
 };
 
 }
@@ -6,6 +6,8 @@
 #ifndef H_HESP_LITTREEFILE
 #define H_HESP_LITTREEFILE
 
+#include <iosfwd>
+
 #include <hesp/trees/BSPTree.h>
 
 namespace hesp {
@@ -15,10 +17,14 @@ struct LitTreeFile
 	//#################### LOADING METHODS ####################
 	template <typename Poly> static void load(const std::string& filename, std::vector<shared_ptr<Poly> >& polygons,
 											  BSPTree_Ptr& tree, std::string& lightmapPrefix);
+	template <typename Poly> static void load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons,
+											  BSPTree_Ptr& tree, std::string& lightmapPrefix);
 
 	//#################### SAVING METHODS ####################
 	template <typename Poly> static void save(const std::string& filename, const std::vector<shared_ptr<Poly> >& polygons,
 											  const BSPTree_CPtr& tree, const std::string& lightmapPrefix);
+	template <typename Poly> static void save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons,
+											  const BSPTree_CPtr& tree, const std::string& lightmapPrefix);
 };
 
 }
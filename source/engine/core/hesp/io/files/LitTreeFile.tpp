@@ -26,7 +26,21 @@ void LitTreeFile::load(const std::string& filename, std::vector<shared_ptr<Poly>
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	load(is, polygons, tree, lightmapPrefix);
+}
+
+/**
+Loads the polygons, tree and lightmap prefix from the specified std::istream.
 
+@param is				The std::istream
+@param polygons			Used to return the polygons to the caller
+@param tree				Used to return the tree to the caller
+@param lightmapPrefix	Used to return the lightmap prefix to the caller
+*/
+template <typename Poly>
+void LitTreeFile::load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons, BSPTree_Ptr& tree,
+					   std::string& lightmapPrefix)
+{
 	PolygonsSection::load(is, "Polygons", polygons);
 	tree = TreeSection::load(is);
 	lightmapPrefix = LightmapPrefixSection::load(is);
@@ -47,7 +61,21 @@ void LitTreeFile::save(const std::string& filename, const std::vector<shared_ptr
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, polygons, tree, lightmapPrefix);
+}
+
+/**
+Saves the polygons, tree and lightmap prefix to the specified std::ostream.
 
+@param os				The std::ostream
+@param polygons			The polygons
+@param tree				The tree
+@param lightmapPrefix	The lightmap prefix
+*/
+template <typename Poly>
+void LitTreeFile::save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons,
+					   const BSPTree_CPtr& tree, const std::string& lightmapPrefix)
+{
 	PolygonsSection::save(os, "Polygons", polygons);
 	TreeSection::save(os, tree);
 	LightmapPrefixSection::save(os, lightmapPrefix);
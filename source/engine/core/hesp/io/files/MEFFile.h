@@ -0,0 +1,45 @@
+/***
+ * hesperus: MEFFile.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_MEFFILE
+#define H_HESP_MEFFILE
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <hesp/brushes/PolyhedralBrush.h>
+#include <hesp/lighting/Light.h>
+#include <hesp/util/PolygonTypes.h>
+
+namespace hesp {
+
+/**
+This class loads the brushes and lights from MapEditor's MEF files.
+*/
+class MEFFile
+{
+	//#################### TYPEDEFS ####################
+private:
+	typedef PolyhedralBrush<TexturedPolygon> TexPolyBrush;
+	typedef shared_ptr<TexPolyBrush> TexPolyBrush_Ptr;
+	typedef std::vector<TexPolyBrush_Ptr> TexPolyBrushVector;
+
+	//#################### LOADING METHODS ####################
+public:
+	static void load(const std::string& filename, TexPolyBrushVector& brushes, std::vector<Light>& lights);
+	static void load(std::istream& is, TexPolyBrushVector& brushes, std::vector<Light>& lights);
+
+	//#################### LOADING SUPPORT METHODS ####################
+private:
+	static void read_architecture_brush_composite(std::istream& is, TexPolyBrushVector& brushes);
+	static void read_light_brush(std::istream& is, std::vector<Light>& lights);
+	static void read_polyhedral_brush(std::istream& is, TexPolyBrushVector& brushes);
+	static void skip_section(std::istream& is);
+};
+
+}
+
+#endif
@@ -5,7 +5,9 @@
 
 #include "ModelFiles.h"
 
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include <boost/lexical_cast.hpp>
 using boost::bad_lexical_cast;
@@ -18,6 +20,7 @@ using boost::lexical_cast;
 #include <hesp/materials/BasicMaterial.h>
 #include <hesp/materials/TextureMaterial.h>
 #include <hesp/math/matrices/RBTMatrix.h>
+#include <hesp/models/BoneWeight.h>
 #include <hesp/models/Animation.h>
 #include <hesp/models/Bone.h>
 #include <hesp/models/BoneHierarchy.h>
@@ -35,11 +38,215 @@ namespace {
 //#################### CONSTANTS ####################
 const double SCALE = 1.0/10;	// the models are built such that 10 units in Blender corresponds to 1 unit in the game
 
+// Compiled model files start with an ID and a format version. The data is stored in the
+// native byte order, since the files are only a cache of the Ogre XML files.
+const char *COMPILED_MESH_ID = "HMSH";
+const char *COMPILED_SKELETON_ID = "HSKL";
+const int COMPILED_MODEL_VERSION = 1;
+
+//#################### LOCAL METHODS ####################
+/**
+Returns the number of bytes left to read in the specified (seekable) stream.
+*/
+std::streamoff bytes_left(std::istream& is)
+{
+	std::streampos cur = is.tellg();
+	is.seekg(0, std::ios_base::end);
+	std::streamoff left = is.tellg() - cur;
+	is.seekg(cur);
+	return left;
+}
+
+template <typename T>
+T read_value(std::istream& is)
+{
+	T value;
+	is.read(reinterpret_cast<char*>(&value), sizeof(T));
+	if(is.fail()) throw hesp::Exception("Unexpected end of compiled model file");
+	return value;
+}
+
+/**
+Reads a count of elements from a compiled model file. Since every element takes up at least
+minElementSize bytes in the file, the count is checked against the bytes left in the stream,
+so that a corrupt count can't cause a huge allocation.
+*/
+size_t read_count(std::istream& is, size_t minElementSize)
+{
+	int count = read_value<int>(is);
+	if(count < 0 || static_cast<std::streamoff>(count) > bytes_left(is) / static_cast<std::streamoff>(minElementSize))
+	{
+		throw hesp::Exception("Bad count in compiled model file");
+	}
+	return count;
+}
+
+/**
+Reads an entire compiled model file into memory, so that it can be checked and read cheaply.
+*/
+void read_file(const std::string& filename, std::stringstream& ss)
+{
+	std::ifstream is(filename.c_str(), std::ios_base::binary);
+	if(is.fail()) throw hesp::Exception("Could not open " + filename + " for reading");
+	ss << is.rdbuf();
+	ss.clear();
+}
+
+template <typename T>
+void read_array(std::istream& is, std::vector<T>& arr)
+{
+	arr.resize(read_count(is, sizeof(T)));
+	if(!arr.empty())
+	{
+		is.read(reinterpret_cast<char*>(&arr[0]), arr.size() * sizeof(T));
+		if(is.fail()) throw hesp::Exception("Unexpected end of compiled model file");
+	}
+}
+
+void read_header(std::istream& is, const std::string& id)
+{
+	std::string fileID(4, ' ');
+	is.read(&fileID[0], 4);
+	if(is.fail() || fileID != id) throw hesp::Exception("Not a compiled model file of the right type");
+	if(read_value<int>(is) != COMPILED_MODEL_VERSION) throw hesp::Exception("Wrong compiled model file version");
+}
+
+std::string read_string(std::istream& is)
+{
+	std::vector<char> chars;
+	read_array(is, chars);
+	return std::string(chars.begin(), chars.end());
+}
+
+hesp::Vector3d read_vector3d(std::istream& is)
+{
+	double x = read_value<double>(is);
+	double y = read_value<double>(is);
+	double z = read_value<double>(is);
+	return hesp::Vector3d(x,y,z);
+}
+
+template <typename T>
+void write_value(std::ostream& os, const T& value)
+{
+	os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void write_array(std::ostream& os, const std::vector<T>& arr)
+{
+	write_value(os, static_cast<int>(arr.size()));
+	if(!arr.empty()) os.write(reinterpret_cast<const char*>(&arr[0]), arr.size() * sizeof(T));
+}
+
+void write_header(std::ostream& os, const std::string& id)
+{
+	os.write(id.c_str(), 4);
+	write_value(os, COMPILED_MODEL_VERSION);
+}
+
+void write_string(std::ostream& os, const std::string& s)
+{
+	write_array(os, std::vector<char>(s.begin(), s.end()));
+}
+
+void write_vector3d(std::ostream& os, const hesp::Vector3d& v)
+{
+	write_value(os, v.x);
+	write_value(os, v.y);
+	write_value(os, v.z);
+}
+
 }
 
 namespace hesp {
 
 //#################### LOADING METHODS ####################
+/**
+Loads the raw data for a mesh from the specified compiled mesh file.
+
+@param filename		The name of the file
+@return				The mesh data
+*/
+MeshData ModelFiles::load_compiled_mesh_data(const std::string& filename)
+{
+	std::stringstream is;
+	read_file(filename, is);
+
+	read_header(is, COMPILED_MESH_ID);
+
+	MeshData data;
+	const size_t minSubmeshSize = 6 * sizeof(int);	// the counts for the material name, the four arrays and the bone assignments
+	data.submeshes.resize(read_count(is, minSubmeshSize));
+	for(size_t i=0, submeshCount=data.submeshes.size(); i<submeshCount; ++i)
+	{
+		MeshData::SubmeshData& submesh = data.submeshes[i];
+		submesh.materialName = read_string(is);
+		read_array(is, submesh.vertIndices);
+		read_array(is, submesh.positions);
+		read_array(is, submesh.normals);
+		read_array(is, submesh.texCoords);
+
+		const size_t boneAssignmentSize = 2 * sizeof(int) + sizeof(double);	// the vertex index, bone index and weight
+		submesh.boneAssignments.resize(read_count(is, boneAssignmentSize));
+		for(size_t j=0, size=submesh.boneAssignments.size(); j<size; ++j)
+		{
+			MeshData::BoneAssignment& boneAssignment = submesh.boneAssignments[j];
+			boneAssignment.vertIndex = read_value<int>(is);
+			boneAssignment.boneIndex = read_value<int>(is);
+			boneAssignment.weight = read_value<double>(is);
+		}
+	}
+
+	return data;
+}
+
+/**
+Loads the raw data for a skeleton from the specified compiled skeleton file.
+
+@param filename		The name of the file
+@return				The skeleton data
+*/
+SkeletonData ModelFiles::load_compiled_skeleton_data(const std::string& filename)
+{
+	std::stringstream is;
+	read_file(filename, is);
+
+	read_header(is, COMPILED_SKELETON_ID);
+
+	SkeletonData data;
+	const size_t minBoneSize = 2 * sizeof(int) + 7 * sizeof(double);	// the name count, parent, position, rotation axis and angle
+	data.bones.resize(read_count(is, minBoneSize));
+	for(size_t i=0, boneCount=data.bones.size(); i<boneCount; ++i)
+	{
+		SkeletonData::BoneData& bone = data.bones[i];
+		bone.name = read_string(is);
+		bone.parent = read_value<int>(is);
+		bone.position = read_vector3d(is);
+		bone.rotationAxis = read_vector3d(is);
+		bone.rotationAngle = read_value<double>(is);
+	}
+
+	const size_t minAnimationSize = 2 * sizeof(int) + sizeof(double);	// the name count, length and track count
+	data.animations.resize(read_count(is, minAnimationSize));
+	for(size_t i=0, animationCount=data.animations.size(); i<animationCount; ++i)
+	{
+		SkeletonData::AnimationData& animation = data.animations[i];
+		animation.name = read_string(is);
+		animation.length = read_value<double>(is);
+
+		const size_t minTrackSize = 2 * sizeof(int);	// the bone name count and keyframe count
+		animation.tracks.resize(read_count(is, minTrackSize));
+		for(size_t j=0, trackCount=animation.tracks.size(); j<trackCount; ++j)
+		{
+			animation.tracks[j].boneName = read_string(is);
+			read_array(is, animation.tracks[j].keyframes);
+		}
+	}
+
+	return data;
+}
+
 /**
 Loads a set of materials from the specified Ogre materials file.
 
@@ -70,6 +277,17 @@ Loads a mesh from the specified Ogre mesh file.
 @return				The mesh
 */
 Mesh_Ptr ModelFiles::load_mesh(const std::string& filename, const std::map<std::string,Material_Ptr>& materials)
+{
+	return make_mesh(load_mesh_data(filename), materials);
+}
+
+/**
+Loads the raw data for a mesh from the specified Ogre mesh file.
+
+@param filename		The name of the file
+@return				The mesh data
+*/
+MeshData ModelFiles::load_mesh_data(const std::string& filename)
 try
 {
 	XMLLexer_Ptr lexer(new XMLLexer(filename));
@@ -82,32 +300,21 @@ try
 	std::vector<XMLElement_CPtr> submeshElts = submeshesElt->find_children("submesh");
 	int submeshCount = static_cast<int>(submeshElts.size());
 
-	std::vector<Submesh_Ptr> submeshes;
+	MeshData data;
+	data.submeshes.resize(submeshCount);
 	for(int i=0; i<submeshCount; ++i)
 	{
 		const XMLElement_CPtr& submeshElt = submeshElts[i];
+		MeshData::SubmeshData& submesh = data.submeshes[i];
 
-		std::string materialName = submeshElt->attribute("material");
-
-		// Lookup the material in the materials map. Use a default material and output an error if it's missing.
-		Material_Ptr material;
-		std::map<std::string,Material_Ptr>::const_iterator jt = materials.find(materialName);
-		if(jt != materials.end())
-		{
-			material = jt->second;
-		}
-		else
-		{
-			material.reset(new BasicMaterial(Colour3d(1,1,1), Colour3d(1,1,1), Colour3d(1,1,1), 1, Colour3d(1,1,1), true));
-			std::cerr << "Missing material: " << materialName << std::endl;
-		}
+		submesh.materialName = submeshElt->attribute("material");
 
 		// Read in the vertex indices for the triangles in the mesh.
 		XMLElement_CPtr facesElt = submeshElt->find_unique_child("faces");
 		std::vector<XMLElement_CPtr> faceElts = facesElt->find_children("face");
 		int faceCount = static_cast<int>(faceElts.size());
 
-		std::vector<unsigned int> vertIndices;
+		std::vector<unsigned int>& vertIndices = submesh.vertIndices;
 		vertIndices.reserve(faceCount * 3);
 
 		for(int j=0; j<faceCount; ++j)
@@ -133,8 +340,8 @@ try
 		std::vector<XMLElement_CPtr> vertexElts = vertexbufferElt->find_children("vertex");
 		int vertCount = static_cast<int>(vertexElts.size());
 
-		std::vector<ModelVertex> vertices;
-		vertices.reserve(vertCount);
+		submesh.positions.reserve(vertCount * 3);
+		submesh.normals.reserve(vertCount * 3);
 
 		for(int j=0; j<vertCount; ++j)
 		{
@@ -144,21 +351,27 @@ try
 			Vector3d position = extract_vector3d(positionElt) * SCALE;
 			Vector3d normal = extract_vector3d(normalElt);
 
-			vertices.push_back(ModelVertex(position, normal));
+			submesh.positions.push_back(position.x);
+			submesh.positions.push_back(position.y);
+			submesh.positions.push_back(position.z);
+			submesh.normals.push_back(normal.x);
+			submesh.normals.push_back(normal.y);
+			submesh.normals.push_back(normal.z);
 		}
 
 		// Read in the texture coordinates (if present).
 		bool useTexture = vertexbufferElt->has_attribute("texture_coords") && vertexbufferElt->attribute("texture_coords") == "1";
 
-		std::vector<TexCoords> texCoords;
 		if(useTexture)
 		{
-			texCoords.reserve(vertCount);
+			submesh.texCoords.reserve(vertCount * 2);
 			for(int j=0; j<vertCount; ++j)
 			{
 				const XMLElement_CPtr& vertexElt = vertexElts[j];
 				XMLElement_CPtr texcoordElt = vertexElt->find_unique_child("texcoord");
-				texCoords.push_back(extract_texcoords(texcoordElt));
+				TexCoords texCoords = extract_texcoords(texcoordElt);
+				submesh.texCoords.push_back(texCoords.u);
+				submesh.texCoords.push_back(texCoords.v);
 			}
 		}
 
@@ -167,24 +380,18 @@ try
 		std::vector<XMLElement_CPtr> vertexboneassignmentElts = boneassignmentsElt->find_children("vertexboneassignment");
 		int boneassignmentCount = static_cast<int>(vertexboneassignmentElts.size());
 
+		submesh.boneAssignments.resize(boneassignmentCount);
 		for(int j=0; j<boneassignmentCount; ++j)
 		{
 			const XMLElement_CPtr& vbaElt = vertexboneassignmentElts[j];
-
-			int vertIndex = lexical_cast<int>(vbaElt->attribute("vertexindex"));
-			if(vertIndex < 0 || vertIndex >= vertCount)
-				throw Exception("Invalid vertex index in bone assignment " + lexical_cast<std::string>(j));
-
-			int boneIndex = lexical_cast<int>(vbaElt->attribute("boneindex"));
-			double weight = lexical_cast<double>(vbaElt->attribute("weight"));
-
-			vertices[vertIndex].add_bone_weight(BoneWeight(boneIndex, weight));
+			MeshData::BoneAssignment& boneAssignment = submesh.boneAssignments[j];
+			boneAssignment.vertIndex = lexical_cast<int>(vbaElt->attribute("vertexindex"));
+			boneAssignment.boneIndex = lexical_cast<int>(vbaElt->attribute("boneindex"));
+			boneAssignment.weight = lexical_cast<double>(vbaElt->attribute("weight"));
 		}
-
-		submeshes.push_back(Submesh_Ptr(new Submesh(vertIndices, vertices, material, texCoords)));
 	}
 
-	return Mesh_Ptr(new Mesh(submeshes));
+	return data;
 }
 catch(bad_lexical_cast&)
 {
@@ -192,7 +399,8 @@ catch(bad_lexical_cast&)
 }
 
 /**
-Loads the model with the specified name.
+Loads the model with the specified name. The mesh and skeleton are loaded from compiled model
+files (see the hmodel tool) if they are at least as new as the corresponding Ogre XML files.
 
 @param name	The name of the model
 @return		The model
@@ -202,11 +410,40 @@ Model_Ptr ModelFiles::load_model(const std::string& name)
 	bf::path modelsDir = DirectoryFinder::instance().determine_models_directory();
 	bf::path materialsPath = modelsDir / (name + ".material");
 	bf::path meshPath = modelsDir / (name + ".mesh.xml");
+	bf::path compiledMeshPath = modelsDir / (name + ".mesh.bin");
 	bf::path skeletonPath = modelsDir / (name + ".skeleton.xml");
+	bf::path compiledSkeletonPath = modelsDir / (name + ".skeleton.bin");
 
 	std::map<std::string,Material_Ptr> materials = load_materials(materialsPath.file_string());
-	Mesh_Ptr mesh = load_mesh(meshPath.file_string(), materials);
-	Skeleton_Ptr skeleton = load_skeleton(skeletonPath.file_string());
+
+	MeshData meshData;
+	bool meshLoaded = false;
+	if(compiled_file_is_current(compiledMeshPath, meshPath))
+	{
+		try
+		{
+			meshData = load_compiled_mesh_data(compiledMeshPath.file_string());
+			meshLoaded = true;
+		}
+		catch(Exception& e) { std::cerr << "Ignoring compiled mesh " << compiledMeshPath.file_string() << ": " << e.cause() << std::endl; }
+	}
+	if(!meshLoaded) meshData = load_mesh_data(meshPath.file_string());
+
+	SkeletonData skeletonData;
+	bool skeletonLoaded = false;
+	if(compiled_file_is_current(compiledSkeletonPath, skeletonPath))
+	{
+		try
+		{
+			skeletonData = load_compiled_skeleton_data(compiledSkeletonPath.file_string());
+			skeletonLoaded = true;
+		}
+		catch(Exception& e) { std::cerr << "Ignoring compiled skeleton " << compiledSkeletonPath.file_string() << ": " << e.cause() << std::endl; }
+	}
+	if(!skeletonLoaded) skeletonData = load_skeleton_data(skeletonPath.file_string());
+
+	Mesh_Ptr mesh = make_mesh(meshData, materials);
+	Skeleton_Ptr skeleton = make_skeleton(skeletonData);
 
 	return Model_Ptr(new Model(mesh, skeleton));
 }
@@ -218,6 +455,17 @@ Loads a skeleton from the specified Ogre skeleton file.
 @return			The skeleton
 */
 Skeleton_Ptr ModelFiles::load_skeleton(const std::string& filename)
+{
+	return make_skeleton(load_skeleton_data(filename));
+}
+
+/**
+Loads the raw data for a skeleton from the specified Ogre skeleton file.
+
+@param filename	The name of the file
+@return			The skeleton data
+*/
+SkeletonData ModelFiles::load_skeleton_data(const std::string& filename)
 try
 {
 	XMLLexer_Ptr lexer(new XMLLexer(filename));
@@ -225,37 +473,41 @@ try
 	XMLElement_CPtr root = parser.parse();
 	XMLElement_CPtr skeletonElt = root->find_unique_child("skeleton");
 
+	SkeletonData data;
+
 	// Load in the bones.
 	XMLElement_CPtr bonesElt = skeletonElt->find_unique_child("bones");
 
 	std::vector<XMLElement_CPtr> boneElts = bonesElt->find_children("bone");
 	int boneCount = static_cast<int>(boneElts.size());
 
-	std::vector<Bone_Ptr> bones(boneCount);
+	data.bones.resize(boneCount);
+	std::map<std::string,int> boneLookup;
 	for(int i=0; i<boneCount; ++i)
 	{
-		// Extract all the necessary bits of information from the XML tree below each bone, then construct the bone itself.
 		const XMLElement_CPtr& boneElt = boneElts[i];
 
 		int id = lexical_cast<int>(boneElt->attribute("id"));
+		if(id < 0 || id >= boneCount) throw Exception("Invalid bone ID " + lexical_cast<std::string>(id));
 
-		std::string name = boneElt->attribute("name");
+		SkeletonData::BoneData& bone = data.bones[id];
+		bone.name = boneElt->attribute("name");
+		bone.parent = -1;
 
 		XMLElement_CPtr positionElt = boneElt->find_unique_child("position");
-		Vector3d position = extract_vector3d(positionElt) * SCALE;
+		bone.position = extract_vector3d(positionElt) * SCALE;
 
 		XMLElement_CPtr rotationElt = boneElt->find_unique_child("rotation");
-
-		double rotationAngle = lexical_cast<double>(rotationElt->attribute("angle"));
+		bone.rotationAngle = lexical_cast<double>(rotationElt->attribute("angle"));
 
 		XMLElement_CPtr axisElt = rotationElt->find_unique_child("axis");
-		Vector3d rotationAxis = extract_vector3d(axisElt);
-
-		bones[id].reset(new Bone(name, position, rotationAxis, rotationAngle));
+		bone.rotationAxis = extract_vector3d(axisElt);
 	}
 
-	// Construct the bone hierarchy.
-	BoneHierarchy_Ptr boneHierarchy(new BoneHierarchy(bones));
+	for(int i=0; i<boneCount; ++i)
+	{
+		boneLookup.insert(std::make_pair(data.bones[i].name, i));
+	}
 
 	// Load in the bone parents.
 	XMLElement_CPtr bonehierarchyElt = skeletonElt->find_unique_child("bonehierarchy");
@@ -266,45 +518,48 @@ try
 		const XMLElement_CPtr& boneparentElt = boneparentElts[i];
 		std::string childName = boneparentElt->attribute("bone");
 		std::string parentName = boneparentElt->attribute("parent");
-		Bone_Ptr child = boneHierarchy->bones(childName);
-		Bone_Ptr parent = boneHierarchy->bones(parentName);
-		child->set_parent(parent);
+
+		std::map<std::string,int>::const_iterator ct = boneLookup.find(childName), pt = boneLookup.find(parentName);
+		if(ct == boneLookup.end()) throw Exception("No such bone: " + childName);
+		if(pt == boneLookup.end()) throw Exception("No such bone: " + parentName);
+		data.bones[ct->second].parent = pt->second;
 	}
 
 	// Load in the animations (if any).
-	std::map<std::string,Animation_CPtr> animations;
-
 	if(skeletonElt->has_child("animations"))
 	{
 		XMLElement_CPtr animationsElt = skeletonElt->find_unique_child("animations");
 		std::vector<XMLElement_CPtr> animationElts = animationsElt->find_children("animation");
 		int animationCount = static_cast<int>(animationElts.size());
 
+		data.animations.resize(animationCount);
 		for(int i=0; i<animationCount; ++i)
 		{
 			const XMLElement_CPtr& animationElt = animationElts[i];
+			SkeletonData::AnimationData& animation = data.animations[i];
+
+			animation.name = animationElt->attribute("name");
+			animation.length = lexical_cast<double>(animationElt->attribute("length"));
 
 			// Load in the tracks for the bones.
 			XMLElement_CPtr tracksElt = animationElt->find_unique_child("tracks");
 			std::vector<XMLElement_CPtr> trackElts = tracksElt->find_children("track");
 			int trackCount = static_cast<int>(trackElts.size());
-			int keyframeCount = 0;
-
-			typedef std::vector<RBTMatrix_Ptr> Track;
-			std::map<std::string,Track> tracks;
 
+			animation.tracks.resize(trackCount);
 			for(int j=0; j<trackCount; ++j)
 			{
 				const XMLElement_CPtr& trackElt = trackElts[j];
+				SkeletonData::TrackData& track = animation.tracks[j];
 
-				std::string bone = trackElt->attribute("bone");
+				track.boneName = trackElt->attribute("bone");
 
 				// Read in the bone keyframes for this particular bone.
 				XMLElement_CPtr keyframesElt = trackElt->find_unique_child("keyframes");
 				std::vector<XMLElement_CPtr> keyframeElts = keyframesElt->find_children("keyframe");
-				keyframeCount = static_cast<int>(keyframeElts.size());
+				int keyframeCount = static_cast<int>(keyframeElts.size());
 
-				Track track(keyframeCount);
+				track.keyframes.reserve(keyframeCount * SkeletonData::KEYFRAME_SIZE);
 				for(int k=0; k<keyframeCount; ++k)
 				{
 					const XMLElement_CPtr& keyframeElt = keyframeElts[k];
@@ -319,58 +574,268 @@ try
 
 					// TODO: Make use of scale here as well if necessary.
 
-					track[k] = RBTMatrix::from_axis_angle_translation(rotateAxis, rotateAngle, translation);
+					double keyframe[SkeletonData::KEYFRAME_SIZE] = { translation.x, translation.y, translation.z, rotateAxis.x, rotateAxis.y, rotateAxis.z, rotateAngle };
+					track.keyframes.insert(track.keyframes.end(), keyframe, keyframe + SkeletonData::KEYFRAME_SIZE);
 				}
-				tracks.insert(std::make_pair(bone,track));
 			}
+		}
+	}
+
+	return data;
+}
+catch(bad_lexical_cast&)
+{
+	throw Exception("An element attribute was not of the correct type");
+}
+
+/**
+Makes a mesh from its raw data.
+
+@param data			The mesh data
+@param materials	The set of materials referenced by the mesh
+@return				The mesh
+*/
+Mesh_Ptr ModelFiles::make_mesh(const MeshData& data, const std::map<std::string,Material_Ptr>& materials)
+{
+	std::vector<Submesh_Ptr> submeshes;
+	for(size_t i=0, submeshCount=data.submeshes.size(); i<submeshCount; ++i)
+	{
+		const MeshData::SubmeshData& submesh = data.submeshes[i];
+
+		// Lookup the material in the materials map. Use a default material and output an error if it's missing.
+		Material_Ptr material;
+		std::map<std::string,Material_Ptr>::const_iterator jt = materials.find(submesh.materialName);
+		if(jt != materials.end())
+		{
+			material = jt->second;
+		}
+		else
+		{
+			material.reset(new BasicMaterial(Colour3d(1,1,1), Colour3d(1,1,1), Colour3d(1,1,1), 1, Colour3d(1,1,1), true));
+			std::cerr << "Missing material: " << submesh.materialName << std::endl;
+		}
+
+		int vertCount = static_cast<int>(submesh.positions.size() / 3);
+		if(submesh.normals.size() != submesh.positions.size()) throw Exception("Each vertex must have a normal");
+		if(!submesh.texCoords.empty() && static_cast<int>(submesh.texCoords.size()) != vertCount * 2) throw Exception("Each vertex must have texture coordinates");
+
+		std::vector<ModelVertex> vertices;
+		vertices.reserve(vertCount);
+		for(int j=0; j<vertCount; ++j)
+		{
+			const double *p = &submesh.positions[j*3], *n = &submesh.normals[j*3];
+			vertices.push_back(ModelVertex(Vector3d(p[0], p[1], p[2]), Vector3d(n[0], n[1], n[2])));
+		}
+
+		std::vector<TexCoords> texCoords;
+		texCoords.reserve(submesh.texCoords.size() / 2);
+		for(size_t j=0, size=submesh.texCoords.size(); j<size; j+=2)
+		{
+			texCoords.push_back(TexCoords(submesh.texCoords[j], submesh.texCoords[j+1]));
+		}
+
+		for(size_t j=0, size=submesh.boneAssignments.size(); j<size; ++j)
+		{
+			const MeshData::BoneAssignment& boneAssignment = submesh.boneAssignments[j];
+			if(boneAssignment.vertIndex < 0 || boneAssignment.vertIndex >= vertCount)
+				throw Exception("Invalid vertex index in bone assignment " + lexical_cast<std::string>(j));
+
+			vertices[boneAssignment.vertIndex].add_bone_weight(BoneWeight(boneAssignment.boneIndex, boneAssignment.weight));
+		}
+
+		submeshes.push_back(Submesh_Ptr(new Submesh(submesh.vertIndices, vertices, material, texCoords)));
+	}
+
+	return Mesh_Ptr(new Mesh(submeshes));
+}
+
+/**
+Makes a skeleton from its raw data.
+
+@param data	The skeleton data
+@return		The skeleton
+*/
+Skeleton_Ptr ModelFiles::make_skeleton(const SkeletonData& data)
+{
+	// Construct the bone hierarchy.
+	int boneCount = static_cast<int>(data.bones.size());
+	std::vector<Bone_Ptr> bones(boneCount);
+	for(int i=0; i<boneCount; ++i)
+	{
+		const SkeletonData::BoneData& bone = data.bones[i];
+		bones[i].reset(new Bone(bone.name, bone.position, bone.rotationAxis, bone.rotationAngle));
+	}
 
-			// Check that each track has the same number of bone keyframes.
-			for(std::map<std::string,Track>::const_iterator kt=tracks.begin(), kend=tracks.end(); kt!=kend; ++kt)
+	for(int i=0; i<boneCount; ++i)
+	{
+		int parent = data.bones[i].parent;
+		if(parent < -1 || parent >= boneCount) throw Exception("Invalid parent for bone " + data.bones[i].name);
+		if(parent != -1) bones[i]->set_parent(bones[parent]);
+	}
+
+	BoneHierarchy_Ptr boneHierarchy(new BoneHierarchy(bones));
+
+	// Construct the animations.
+	std::map<std::string,Animation_CPtr> animations;
+	for(size_t i=0, animationCount=data.animations.size(); i<animationCount; ++i)
+	{
+		const SkeletonData::AnimationData& animation = data.animations[i];
+
+		// Make the bone keyframe matrices for each track.
+		typedef std::vector<RBTMatrix_Ptr> Track;
+		std::map<std::string,Track> tracks;
+		int keyframeCount = 0;
+
+		for(size_t j=0, trackCount=animation.tracks.size(); j<trackCount; ++j)
+		{
+			const SkeletonData::TrackData& trackData = animation.tracks[j];
+			keyframeCount = static_cast<int>(trackData.keyframes.size() / SkeletonData::KEYFRAME_SIZE);
+
+			Track track(keyframeCount);
+			for(int k=0; k<keyframeCount; ++k)
 			{
-				const Track& track = kt->second;
-				if(track.size() != keyframeCount) throw Exception("Bad track length");
+				const double *keyframe = &trackData.keyframes[k * SkeletonData::KEYFRAME_SIZE];
+				Vector3d translation(keyframe[0], keyframe[1], keyframe[2]);
+				Vector3d rotateAxis(keyframe[3], keyframe[4], keyframe[5]);
+				double rotateAngle = keyframe[6];
+				track[k] = RBTMatrix::from_axis_angle_translation(rotateAxis, rotateAngle, translation);
 			}
+			tracks.insert(std::make_pair(trackData.boneName, track));
+		}
+
+		// Check that each track has the same number of bone keyframes.
+		for(std::map<std::string,Track>::const_iterator kt=tracks.begin(), kend=tracks.end(); kt!=kend; ++kt)
+		{
+			const Track& track = kt->second;
+			if(track.size() != keyframeCount) throw Exception("Bad track length");
+		}
 
-			// Use the tracks to create the *model* keyframes (note: these are distinct from the bone keyframes!).
-			std::vector<Pose_CPtr> keyframes(keyframeCount);
-			for(int j=0; j<keyframeCount; ++j)
+		// Use the tracks to create the *model* keyframes (note: these are distinct from the bone keyframes!).
+		std::vector<Pose_CPtr> keyframes(keyframeCount);
+		for(int j=0; j<keyframeCount; ++j)
+		{
+			std::vector<RBTMatrix_CPtr> boneMatrices(boneCount);
+			for(int k=0; k<boneCount; ++k)
 			{
-				std::vector<RBTMatrix_CPtr> boneMatrices(boneCount);
-				for(int k=0; k<boneCount; ++k)
+				Bone_CPtr bone = boneHierarchy->bones(k);
+				std::map<std::string,Track>::const_iterator kt = tracks.find(bone->name());
+				if(kt != tracks.end())
 				{
-					Bone_CPtr bone = boneHierarchy->bones(k);
-					std::map<std::string,Track>::const_iterator kt = tracks.find(bone->name());
-					if(kt != tracks.end())
-					{
-						// If there's an animation track for this bone, use the track matrix.
-						const Track& track = kt->second;
-						boneMatrices[k] = track[j];
-					}
-					else
-					{
-						// Otherwise, use the identity matrix.
-						boneMatrices[k] = RBTMatrix::identity();
-					}
+					// If there's an animation track for this bone, use the track matrix.
+					const Track& track = kt->second;
+					boneMatrices[k] = track[j];
+				}
+				else
+				{
+					// Otherwise, use the identity matrix.
+					boneMatrices[k] = RBTMatrix::identity();
 				}
-
-				keyframes[j].reset(new Pose(boneMatrices));
 			}
 
-			std::string name = animationElt->attribute("name");
-			double length = lexical_cast<double>(animationElt->attribute("length"));
-			Animation_CPtr animation(new Animation(length, keyframes));
-			animations.insert(std::make_pair(name, animation));
+			keyframes[j].reset(new Pose(boneMatrices));
 		}
+
+		Animation_CPtr anim(new Animation(animation.length, keyframes));
+		animations.insert(std::make_pair(animation.name, anim));
 	}
 
 	return Skeleton_Ptr(new Skeleton(boneHierarchy, animations));
 }
-catch(bad_lexical_cast&)
+
+//#################### SAVING METHODS ####################
+/**
+Saves the raw data for a mesh to a compiled mesh file.
+
+@param filename		The name of the file
+@param data			The mesh data
+*/
+void ModelFiles::save_compiled_mesh_data(const std::string& filename, const MeshData& data)
 {
-	throw Exception("An element attribute was not of the correct type");
+	std::ofstream os(filename.c_str(), std::ios_base::binary);
+	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+
+	write_header(os, COMPILED_MESH_ID);
+
+	write_value(os, static_cast<int>(data.submeshes.size()));
+	for(size_t i=0, submeshCount=data.submeshes.size(); i<submeshCount; ++i)
+	{
+		const MeshData::SubmeshData& submesh = data.submeshes[i];
+		write_string(os, submesh.materialName);
+		write_array(os, submesh.vertIndices);
+		write_array(os, submesh.positions);
+		write_array(os, submesh.normals);
+		write_array(os, submesh.texCoords);
+
+		write_value(os, static_cast<int>(submesh.boneAssignments.size()));
+		for(size_t j=0, size=submesh.boneAssignments.size(); j<size; ++j)
+		{
+			const MeshData::BoneAssignment& boneAssignment = submesh.boneAssignments[j];
+			write_value(os, boneAssignment.vertIndex);
+			write_value(os, boneAssignment.boneIndex);
+			write_value(os, boneAssignment.weight);
+		}
+	}
+
+	if(os.fail()) throw Exception("Could not write to " + filename);
+}
+
+/**
+Saves the raw data for a skeleton to a compiled skeleton file.
+
+@param filename		The name of the file
+@param data			The skeleton data
+*/
+void ModelFiles::save_compiled_skeleton_data(const std::string& filename, const SkeletonData& data)
+{
+	std::ofstream os(filename.c_str(), std::ios_base::binary);
+	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+
+	write_header(os, COMPILED_SKELETON_ID);
+
+	write_value(os, static_cast<int>(data.bones.size()));
+	for(size_t i=0, boneCount=data.bones.size(); i<boneCount; ++i)
+	{
+		const SkeletonData::BoneData& bone = data.bones[i];
+		write_string(os, bone.name);
+		write_value(os, bone.parent);
+		write_vector3d(os, bone.position);
+		write_vector3d(os, bone.rotationAxis);
+		write_value(os, bone.rotationAngle);
+	}
+
+	write_value(os, static_cast<int>(data.animations.size()));
+	for(size_t i=0, animationCount=data.animations.size(); i<animationCount; ++i)
+	{
+		const SkeletonData::AnimationData& animation = data.animations[i];
+		write_string(os, animation.name);
+		write_value(os, animation.length);
+
+		write_value(os, static_cast<int>(animation.tracks.size()));
+		for(size_t j=0, trackCount=animation.tracks.size(); j<trackCount; ++j)
+		{
+			write_string(os, animation.tracks[j].boneName);
+			write_array(os, animation.tracks[j].keyframes);
+		}
+	}
+
+	if(os.fail()) throw Exception("Could not write to " + filename);
 }
 
 //#################### LOADING SUPPORT METHODS ####################
+/**
+Determines whether or not a compiled model file exists and is at least as new as its source file.
+
+@param compiledPath	The path to the compiled file
+@param sourcePath	The path to the source file
+@return				true, if the compiled file should be used in preference to the source file, or false otherwise
+*/
+bool ModelFiles::compiled_file_is_current(const bf::path& compiledPath, const bf::path& sourcePath)
+{
+	if(!bf::exists(compiledPath)) return false;
+	if(!bf::exists(sourcePath)) return true;
+	return bf::last_write_time(compiledPath) >= bf::last_write_time(sourcePath);
+}
+
 /**
 Extracts (u,v) texture coordinates from the specified XML element.
 
@@ -9,11 +9,13 @@
 #include <map>
 #include <string>
 
+#include <boost/filesystem/path.hpp>
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
 
 #include <hesp/math/vectors/TexCoords.h>
 #include <hesp/math/vectors/Vector3.h>
+#include <hesp/models/ModelData.h>
 
 namespace hesp {
 
@@ -33,13 +35,25 @@ private:
 
 	//#################### LOADING METHODS ####################
 public:
+	static MeshData load_compiled_mesh_data(const std::string& filename);
+	static SkeletonData load_compiled_skeleton_data(const std::string& filename);
 	static std::map<std::string,Material_Ptr> load_materials(const std::string& filename);
 	static Mesh_Ptr load_mesh(const std::string& filename, const std::map<std::string,Material_Ptr>& materials);
+	static MeshData load_mesh_data(const std::string& filename);
 	static Model_Ptr load_model(const std::string& name);
 	static Skeleton_Ptr load_skeleton(const std::string& filename);
+	static SkeletonData load_skeleton_data(const std::string& filename);
+	static Mesh_Ptr make_mesh(const MeshData& data, const std::map<std::string,Material_Ptr>& materials);
+	static Skeleton_Ptr make_skeleton(const SkeletonData& data);
+
+	//#################### SAVING METHODS ####################
+public:
+	static void save_compiled_mesh_data(const std::string& filename, const MeshData& data);
+	static void save_compiled_skeleton_data(const std::string& filename, const SkeletonData& data);
 
 	//#################### LOADING SUPPORT METHODS ####################
 private:
+	static bool compiled_file_is_current(const boost::filesystem::path& compiledPath, const boost::filesystem::path& sourcePath);
 	static TexCoords extract_texcoords(const XMLElement_CPtr& elt);
 	static Vector3d extract_vector3d(const XMLElement_CPtr& elt);
 	static NamedMaterial_Ptr read_material(std::istream& is);
@@ -17,6 +17,11 @@ NavManager_Ptr NavFile::load(const std::string& filename)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	return load(is);
+}
+
+NavManager_Ptr NavFile::load(std::istream& is)
+{
 	return NavSection::load(is);
 }
 
@@ -25,6 +30,11 @@ void NavFile::save(const std::string& filename, const NavManager_CPtr& navManage
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, navManager);
+}
+
+void NavFile::save(std::ostream& os, const NavManager_CPtr& navManager)
+{
 	NavSection::save(os, navManager);
 }
 
@@ -6,6 +6,7 @@
 #ifndef H_HESP_NAVFILE
 #define H_HESP_NAVFILE
 
+#include <iosfwd>
 #include <string>
 
 #include <boost/shared_ptr.hpp>
@@ -21,9 +22,11 @@ struct NavFile
 {
 	//#################### LOADING METHODS ####################
 	static NavManager_Ptr load(const std::string& filename);
+	static NavManager_Ptr load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, const NavManager_CPtr& navManager);
+	static void save(std::ostream& os, const NavManager_CPtr& navManager);
 };
 
 }
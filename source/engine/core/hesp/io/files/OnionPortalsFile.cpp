@@ -22,7 +22,17 @@ std::vector<OnionPortal_Ptr> OnionPortalsFile::load(const std::string& filename)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	return load(is);
+}
+
+/**
+Loads an array of onion portals from the specified std::istream.
 
+@param is			The std::istream
+@return				The onion portals
+*/
+std::vector<OnionPortal_Ptr> OnionPortalsFile::load(std::istream& is)
+{
 	std::vector<OnionPortal_Ptr> portals;
 	PolygonsSection::load(is, "OnionPortals", portals);
 	return portals;
@@ -39,6 +49,17 @@ void OnionPortalsFile::save(const std::string& filename, const std::vector<Onion
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, portals);
+}
+
+/**
+Saves an array of onion portals to the specified std::ostream.
+
+@param os			The std::ostream
+@param portals		The onion portals
+*/
+void OnionPortalsFile::save(std::ostream& os, const std::vector<OnionPortal_Ptr>& portals)
+{
 	PolygonsSection::save(os, "OnionPortals", portals);
 }
 
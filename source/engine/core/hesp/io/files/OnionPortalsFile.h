@@ -6,6 +6,7 @@
 #ifndef H_HESP_ONIONPORTALSFILE
 #define H_HESP_ONIONPORTALSFILE
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -17,9 +18,11 @@ struct OnionPortalsFile
 {
 	//#################### LOADING METHODS ####################
 	static std::vector<OnionPortal_Ptr> load(const std::string& filename);
+	static std::vector<OnionPortal_Ptr> load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, const std::vector<OnionPortal_Ptr>& portals);
+	static void save(std::ostream& os, const std::vector<OnionPortal_Ptr>& portals);
 };
 
 }
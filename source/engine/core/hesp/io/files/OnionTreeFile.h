@@ -6,6 +6,8 @@
 #ifndef H_HESP_ONIONTREEFILE
 #define H_HESP_ONIONTREEFILE
 
+#include <iosfwd>
+
 #include <hesp/trees/OnionTree.h>
 
 namespace hesp {
@@ -14,9 +16,11 @@ struct OnionTreeFile
 {
 	//#################### LOADING METHODS ####################
 	template <typename Poly> static void load(const std::string& filename, std::vector<shared_ptr<Poly> >& polygons, OnionTree_Ptr& tree);
+	template <typename Poly> static void load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons, OnionTree_Ptr& tree);
 
 	//#################### SAVING METHODS ####################
 	template <typename Poly> static void save(const std::string& filename, const std::vector<shared_ptr<Poly> >& polygons, const OnionTree_CPtr& tree);
+	template <typename Poly> static void save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons, const OnionTree_CPtr& tree);
 };
 
 }
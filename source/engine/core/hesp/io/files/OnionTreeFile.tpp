@@ -24,7 +24,19 @@ void OnionTreeFile::load(const std::string& filename, std::vector<shared_ptr<Pol
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	load(is, polygons, tree);
+}
+
+/**
+Loads the polygons and onion tree from the specified std::istream.
 
+@param is			The std::istream
+@param polygons		Used to return the polygons to the caller
+@param tree			Used to return the onion tree to the caller
+*/
+template <typename Poly>
+void OnionTreeFile::load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons, OnionTree_Ptr& tree)
+{
 	PolygonsSection::load(is, "Polygons", polygons);
 	tree = OnionTreeSection::load(is);
 }
@@ -42,7 +54,19 @@ void OnionTreeFile::save(const std::string& filename, const std::vector<shared_p
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, polygons, tree);
+}
+
+/**
+Saves the polygons and onion tree to the specified std::ostream.
 
+@param os			The std::ostream
+@param polygons		The polygons
+@param tree			The onion tree
+*/
+template <typename Poly>
+void OnionTreeFile::save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons, const OnionTree_CPtr& tree)
+{
 	PolygonsSection::save(os, "Polygons", polygons);
 	OnionTreeSection::save(os, tree);
 }
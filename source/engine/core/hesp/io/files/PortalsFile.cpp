@@ -28,7 +28,18 @@ void PortalsFile::load(const std::string& filename, int& emptyLeafCount, std::ve
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	load(is, emptyLeafCount, portals);
+}
+
+/**
+Loads an empty leaf count and an array of portals from the specified std::istream.
 
+@param is				The std::istream
+@param emptyLeafCount	Used to return the empty leaf count to the caller
+@param portals			Used to return the portals to the caller
+*/
+void PortalsFile::load(std::istream& is, int& emptyLeafCount, std::vector<Portal_Ptr>& portals)
+{
 	std::string line;
 	if(!LineIO::portable_getline(is, line)) throw Exception("The empty leaf count could not be read");
 	try							{ emptyLeafCount = lexical_cast<int>(line); }
@@ -49,7 +60,18 @@ void PortalsFile::save(const std::string& filename, int emptyLeafCount, const st
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, emptyLeafCount, portals);
+}
+
+/**
+Saves an empty leaf count and an array of portals to the specified std::ostream.
 
+@param os				The std::ostream
+@param emptyLeafCount	The empty leaf count
+@param portals			The portals
+*/
+void PortalsFile::save(std::ostream& os, int emptyLeafCount, const std::vector<Portal_Ptr>& portals)
+{
 	os << emptyLeafCount << '\n';
 	PolygonsSection::save(os, "Portals", portals);
 }
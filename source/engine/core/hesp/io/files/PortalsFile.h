@@ -6,6 +6,7 @@
 #ifndef H_HESP_PORTALSFILE
 #define H_HESP_PORTALSFILE
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -17,9 +18,11 @@ struct PortalsFile
 {
 	//#################### LOADING METHODS ####################
 	static void load(const std::string& filename, int& emptyLeafCount, std::vector<Portal_Ptr>& portals);
+	static void load(std::istream& is, int& emptyLeafCount, std::vector<Portal_Ptr>& portals);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, int emptyLeafCount, const std::vector<Portal_Ptr>& portals);
+	static void save(std::ostream& os, int emptyLeafCount, const std::vector<Portal_Ptr>& portals);
 };
 
 }
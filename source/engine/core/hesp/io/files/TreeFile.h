@@ -6,6 +6,8 @@
 #ifndef H_HESP_TREEFILE
 #define H_HESP_TREEFILE
 
+#include <iosfwd>
+
 #include <hesp/trees/BSPTree.h>
 
 namespace hesp {
@@ -14,9 +16,11 @@ struct TreeFile
 {
 	//#################### LOADING METHODS ####################
 	template <typename Poly> static void load(const std::string& filename, std::vector<shared_ptr<Poly> >& polygons, BSPTree_Ptr& tree);
+	template <typename Poly> static void load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons, BSPTree_Ptr& tree);
 
 	//#################### SAVING METHODS ####################
 	template <typename Poly> static void save(const std::string& filename, const std::vector<shared_ptr<Poly> >& polygons, const BSPTree_CPtr& tree);
+	template <typename Poly> static void save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons, const BSPTree_CPtr& tree);
 };
 
 }
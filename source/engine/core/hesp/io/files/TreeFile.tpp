@@ -22,7 +22,19 @@ void TreeFile::load(const std::string& filename, std::vector<shared_ptr<Poly> >&
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("Could not open " + filename + " for reading");
+	load(is, polygons, tree);
+}
+
+/**
+Loads the polygons and BSP tree from the specified std::istream.
 
+@param is			The std::istream
+@param polygons		Used to return the polygons to the caller
+@param tree			Used to return the tree to the caller
+*/
+template <typename Poly>
+void TreeFile::load(std::istream& is, std::vector<shared_ptr<Poly> >& polygons, BSPTree_Ptr& tree)
+{
 	PolygonsSection::load(is, "Polygons", polygons);
 	tree = TreeSection::load(is);
 }
@@ -40,7 +52,19 @@ void TreeFile::save(const std::string& filename, const std::vector<shared_ptr<Po
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, polygons, tree);
+}
+
+/**
+Saves the polygons and BSP tree to the specified std::ostream.
 
+@param os			The std::ostream
+@param polygons		The polygons
+@param tree			The tree
+*/
+template <typename Poly>
+void TreeFile::save(std::ostream& os, const std::vector<shared_ptr<Poly> >& polygons, const BSPTree_CPtr& tree)
+{
 	PolygonsSection::save(os, "Polygons", polygons);
 	TreeSection::save(os, tree);
 }
@@ -23,6 +23,17 @@ LeafVisTable_Ptr VisFile::load(const std::string& filename)
 {
 	std::ifstream is(filename.c_str(), std::ios_base::binary);
 	if(is.fail()) throw Exception("The vis file could not be read");
+	return load(is);
+}
+
+/**
+Loads a leaf visibility table from the specified std::istream.
+
+@param is		The std::istream
+@return			The visibility table
+*/
+LeafVisTable_Ptr VisFile::load(std::istream& is)
+{
 	return VisSection::load(is);
 }
 
@@ -37,6 +48,17 @@ void VisFile::save(const std::string& filename, const LeafVisTable_CPtr& leafVis
 {
 	std::ofstream os(filename.c_str(), std::ios_base::binary);
 	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	save(os, leafVis);
+}
+
+/**
+Saves a leaf visibility table to the specified std::ostream.
+
+@param os		The std::ostream
+@param leafVis	The visibility table
+*/
+void VisFile::save(std::ostream& os, const LeafVisTable_CPtr& leafVis)
+{
 	VisSection::save(os, leafVis);
 }
 
@@ -17,9 +17,11 @@ struct VisFile
 {
 	//#################### LOADING METHODS ####################
 	static LeafVisTable_Ptr load(const std::string& filename);
+	static LeafVisTable_Ptr load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
 	static void save(const std::string& filename, const LeafVisTable_CPtr& leafVis);
+	static void save(std::ostream& os, const LeafVisTable_CPtr& leafVis);
 };
 
 }
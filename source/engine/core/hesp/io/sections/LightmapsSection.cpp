@@ -5,72 +5,274 @@
 
 #include "LightmapsSection.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include <boost/lexical_cast.hpp>
 using boost::bad_lexical_cast;
 using boost::lexical_cast;
 
 #include <hesp/exceptions/Exception.h>
+#include <hesp/images/PixelTypes.h>
 #include <hesp/images/PNGLoader.h>
-#include <hesp/images/PNGSaver.h>
+#include <hesp/images/SimpleImage.h>
 #include <hesp/io/util/LineIO.h>
 
 namespace hesp {
 
 //#################### LOADING METHODS ####################
 /**
-Loads an array of lightmaps from the specified std::istream.
+Loads a lightmap atlas from the specified std::istream. Both the atlas format written by
+save() and the older format (one PNG per polygon) are accepted: in the latter case, each
+lightmap is loaded as a page of its own.
 
 @param is			The std::istream
-@return				The lightmaps
+@return				The lightmap atlas
 @throws Exception	If EOF is encountered whilst trying to read the lightmaps
 */
-std::vector<Image24_Ptr> LightmapsSection::load(std::istream& is)
+LightmapAtlas_Ptr LightmapsSection::load(std::istream& is)
 {
-	std::vector<Image24_Ptr> lightmaps;
+	LightmapAtlas_Ptr atlas;
 
 	LineIO::read_checked_line(is, "Lightmaps");
 	LineIO::read_checked_line(is, "{");
 
+	// The atlas format starts with a format line; the PNG format starts with the lightmap count.
 	std::string line;
-	LineIO::read_line(is, line, "lightmap count");
-	int lightmapCount;
-	try							{ lightmapCount = lexical_cast<int>(line); }
-	catch(bad_lexical_cast&)	{ throw Exception("The lightmap count was not an integer"); }
-
-	lightmaps.resize(lightmapCount);
-	for(int i=0; i<lightmapCount; ++i)
+	LineIO::read_line(is, line, "lightmap format or count");
+	if(line.substr(0,6) == "Atlas ")
 	{
-		lightmaps[i] = PNGLoader::load_streamed_image24(is);
-	}
+		int version;
+		try							{ version = lexical_cast<int>(line.substr(6)); }
+		catch(bad_lexical_cast&)	{ throw Exception("The lightmap format version was not an integer"); }
+		if(version != 1) throw Exception("Unsupported lightmap format version " + lexical_cast<std::string>(version));
 
-	if(is.get() != '\n') throw Exception("Expected newline after lightmaps");
+		atlas = load_atlas(is);
+	}
+	else atlas = load_png(is, line);
 
 	LineIO::read_checked_line(is, "}");
 
-	return lightmaps;
+	return atlas;
 }
 
 //#################### SAVING METHODS ####################
 /**
-Saves an array of lightmaps to the specified std::ostream.
+Saves a lightmap atlas to the specified std::ostream. Each page is written as its
+dimensions and the length of its encoded pixels, followed by the encoded pixels
+themselves (see encode_page); the pages are followed by the index of the page
+containing each polygon's lightmap.
 
-@param os			The std::ostream
-@param lightmaps	The lightmaps
+@param os		The std::ostream
+@param atlas	The lightmap atlas
 */
-void LightmapsSection::save(std::ostream& os, const std::vector<Image24_Ptr>& lightmaps)
+void LightmapsSection::save(std::ostream& os, const LightmapAtlas_CPtr& atlas)
 {
 	os << "Lightmaps\n";
 	os << "{\n";
+	os << "Atlas 1\n";
 
-	int lightmapCount = static_cast<int>(lightmaps.size());
-	os << lightmapCount << '\n';
+	const std::vector<Image24_Ptr>& pages = atlas->pages();
+	int pageCount = static_cast<int>(pages.size());
+	os << pageCount << '\n';
 
-	for(int i=0; i<lightmapCount; ++i)
+	std::vector<unsigned char> data;
+	for(int i=0; i<pageCount; ++i)
 	{
-		PNGSaver::save_streamed_image24(os, lightmaps[i]);
+		const Image24& page = *pages[i];
+		encode_page(page, data);
+
+		os << page.width() << ' ' << page.height() << ' ' << data.size() << '\n';
+		os.write(reinterpret_cast<const char*>(&data[0]), static_cast<std::streamsize>(data.size()));
+		os << '\n';
 	}
 
+	const std::vector<int>& polygonPages = atlas->polygon_pages();
+	int polyCount = static_cast<int>(polygonPages.size());
+	os << polyCount << '\n';
+	for(int i=0; i<polyCount; ++i)
+	{
+		if(i != 0) os << ' ';
+		os << polygonPages[i];
+	}
 	os << "\n}\n";
 }
 
+//#################### LOADING SUPPORT METHODS ####################
+/**
+Loads a lightmap atlas in the atlas format from the specified std::istream.
+
+@param is	The std::istream
+@return		The lightmap atlas
+*/
+LightmapAtlas_Ptr LightmapsSection::load_atlas(std::istream& is)
+{
+	std::string line;
+
+	LineIO::read_line(is, line, "lightmap page count");
+	int pageCount;
+	try							{ pageCount = lexical_cast<int>(line); }
+	catch(bad_lexical_cast&)	{ throw Exception("The lightmap page count was not an integer"); }
+
+	std::vector<Image24_Ptr> pages(pageCount);
+	std::vector<unsigned char> data;
+	for(int i=0; i<pageCount; ++i)
+	{
+		LineIO::read_line(is, line, "lightmap page header");
+		std::istringstream ss(line);
+		int width, height, length;
+		if(!(ss >> width >> height >> length) || width <= 0 || height <= 0 || length <= 0)
+		{
+			throw Exception("Bad lightmap page header: " + line);
+		}
+
+		data.resize(length);
+		if(!is.read(reinterpret_cast<char*>(&data[0]), length)) throw Exception("Unexpected EOF whilst trying to read a lightmap page");
+		if(is.get() != '\n') throw Exception("Expected newline after lightmap page");
+
+		pages[i] = decode_page(data, width, height);
+	}
+
+	LineIO::read_line(is, line, "lightmap polygon count");
+	int polyCount;
+	try							{ polyCount = lexical_cast<int>(line); }
+	catch(bad_lexical_cast&)	{ throw Exception("The lightmap polygon count was not an integer"); }
+
+	std::vector<int> polygonPages(polyCount);
+	for(int i=0; i<polyCount; ++i)
+	{
+		if(!(is >> polygonPages[i])) throw Exception("Unexpected EOF whilst trying to read the lightmap page indices");
+		if(polygonPages[i] < 0 || polygonPages[i] >= pageCount) throw Exception("Bad lightmap page index");
+	}
+	if(is.get() != '\n') throw Exception("Expected newline after lightmap page indices");
+
+	return LightmapAtlas_Ptr(new LightmapAtlas(pages, polygonPages));
+}
+
+/**
+Decodes the pixels of a lightmap page (see encode_page).
+
+@param data			The encoded pixels
+@param width		The width of the page
+@param height		The height of the page
+@return				The page
+@throws Exception	If the encoded pixels are malformed
+*/
+Image24_Ptr LightmapsSection::decode_page(const std::vector<unsigned char>& data, int width, int height)
+{
+	Image24_Ptr page(new SimpleImage24(width, height));
+
+	int pixelCount = width * height;
+	int n = 0;
+	size_t i = 0, size = data.size();
+	while(i < size)
+	{
+		int header = data[i++];
+		bool repeat = header >= 128;
+		int count = repeat ? header - 126 : header + 1;
+		int byteCount = repeat ? 3 : count * 3;
+		if(n + count > pixelCount || i + byteCount > size) throw Exception("The encoded lightmap page was malformed");
+
+		for(int k=0; k<count; ++k)
+		{
+			size_t offset = repeat ? i : i + k * 3;
+			page->set(n++, Pixel24(data[offset], data[offset+1], data[offset+2]));
+		}
+		i += byteCount;
+	}
+
+	if(n != pixelCount) throw Exception("The encoded lightmap page was too short");
+	return page;
+}
+
+/**
+Loads lightmaps in the older format (one PNG per polygon) from the specified std::istream.
+
+@param is			The std::istream
+@param countLine	The line containing the number of lightmaps
+@return				A lightmap atlas with one page per lightmap
+*/
+LightmapAtlas_Ptr LightmapsSection::load_png(std::istream& is, const std::string& countLine)
+{
+	int lightmapCount;
+	try							{ lightmapCount = lexical_cast<int>(countLine); }
+	catch(bad_lexical_cast&)	{ throw Exception("The lightmap count was not an integer"); }
+
+	std::vector<Image24_Ptr> pages(lightmapCount);
+	std::vector<int> polygonPages(lightmapCount);
+	for(int i=0; i<lightmapCount; ++i)
+	{
+		pages[i] = PNGLoader::load_streamed_image24(is);
+		polygonPages[i] = i;
+	}
+
+	if(is.get() != '\n') throw Exception("Expected newline after lightmaps");
+
+	return LightmapAtlas_Ptr(new LightmapAtlas(pages, polygonPages));
+}
+
+//#################### SAVING SUPPORT METHODS ####################
+/**
+Encodes the pixels of a lightmap page (in row order) using a simple run-length encoding,
+which is cheap to decode and works well for the large areas of uniform colour (including
+the unused parts of the page) found in lightmaps. The pixels are written as a sequence of
+packets, each of which starts with a header byte h: if h < 128, it's followed by h+1 pixels
+(as RGB triples) which should be copied as they are; otherwise, it's followed by a single
+pixel which should be repeated h-126 times.
+
+@param page	The page
+@param data	Used to return the encoded pixels
+*/
+void LightmapsSection::encode_page(const Image24& page, std::vector<unsigned char>& data)
+{
+	const int MAX_LITERALS = 128, MAX_REPEATS = 129;
+
+	data.clear();
+	int pixelCount = page.width() * page.height();
+	int literalStart = 0;
+	for(int n=0; n<=pixelCount;)
+	{
+		// Find the length of the run of identical pixels starting here.
+		int runLength = 0;
+		if(n < pixelCount)
+		{
+			Pixel24 pixel = page(n);
+			runLength = 1;
+			while(runLength < MAX_REPEATS && n + runLength < pixelCount && page(n + runLength) == pixel) ++runLength;
+		}
+
+		// Flush any pending literals if a run (or the end of the page) has been reached, or there are too many of them.
+		if(runLength != 1 || n - literalStart == MAX_LITERALS)
+		{
+			while(literalStart < n)
+			{
+				int count = std::min(n - literalStart, MAX_LITERALS);
+				data.push_back(static_cast<unsigned char>(count - 1));
+				for(int k=literalStart; k<literalStart+count; ++k)
+				{
+					Pixel24 pixel = page(k);
+					data.push_back(pixel.r());
+					data.push_back(pixel.g());
+					data.push_back(pixel.b());
+				}
+				literalStart += count;
+			}
+		}
+
+		if(n == pixelCount) break;
+
+		if(runLength >= 2)
+		{
+			Pixel24 pixel = page(n);
+			data.push_back(static_cast<unsigned char>(runLength + 126));
+			data.push_back(pixel.r());
+			data.push_back(pixel.g());
+			data.push_back(pixel.b());
+			n += runLength;
+			literalStart = n;
+		}
+		else ++n;
+	}
+}
+
 }
@@ -7,19 +7,30 @@
 #define H_HESP_LIGHTMAPSSECTION
 
 #include <iosfwd>
+#include <string>
 #include <vector>
 
-#include <hesp/images/Image.h>
+#include <hesp/lighting/LightmapAtlas.h>
 
 namespace hesp {
 
 struct LightmapsSection
 {
 	//#################### LOADING METHODS ####################
-	static std::vector<Image24_Ptr> load(std::istream& is);
+	static LightmapAtlas_Ptr load(std::istream& is);
 
 	//#################### SAVING METHODS ####################
-	static void save(std::ostream& os, const std::vector<Image24_Ptr>& lightmaps);
+	static void save(std::ostream& os, const LightmapAtlas_CPtr& atlas);
+
+	//#################### LOADING SUPPORT METHODS ####################
+private:
+	static LightmapAtlas_Ptr load_atlas(std::istream& is);
+	static Image24_Ptr decode_page(const std::vector<unsigned char>& data, int width, int height);
+	static LightmapAtlas_Ptr load_png(std::istream& is, const std::string& countLine);
+
+	//#################### SAVING SUPPORT METHODS ####################
+private:
+	static void encode_page(const Image24& page, std::vector<unsigned char>& data);
 };
 
 }
@@ -16,7 +16,9 @@ namespace hesp {
 
 //#################### LOADING METHODS ####################
 /**
-Loads a leaf visibility table from the specified std::istream.
+Loads a leaf visibility table from the specified std::istream. Both the compressed
+format written by save() and the older text format (one '0' or '1' per cell) are
+accepted.
 
 @param is	The std::istream
 @return		The visibility table
@@ -30,28 +32,18 @@ LeafVisTable_Ptr VisSection::load(std::istream& is)
 	LineIO::read_checked_line(is, "VisTable");
 	LineIO::read_checked_line(is, "{");
 
-	// Read in the size of the vis table.
-	LineIO::read_line(is, line, "vis table size");
-	int size;
-	try							{ size = lexical_cast<int>(line); }
-	catch(bad_lexical_cast&)	{ throw Exception("The vis table size was not an integer"); }
-
-	// Construct an empty vis table of the right size.
-	leafVis.reset(new LeafVisTable(size));
-
-	// Read in the vis table itself.
-	for(int i=0; i<size; ++i)
+	// The compressed format starts with a format line; the text format starts with the size of the vis table.
+	LineIO::read_line(is, line, "vis table format or size");
+	if(line.substr(0,4) == "RLE ")
 	{
-		LineIO::read_line(is, line, "vis table row " + lexical_cast<std::string>(i));
-		if(line.length() != size) throw Exception("Bad vis table row " + lexical_cast<std::string>(i));
+		int version;
+		try							{ version = lexical_cast<int>(line.substr(4)); }
+		catch(bad_lexical_cast&)	{ throw Exception("The vis table format version was not an integer"); }
+		if(version != 1) throw Exception("Unsupported vis table format version " + lexical_cast<std::string>(version));
 
-		for(int j=0; j<size; ++j)
-		{
-			if(line[j] == '0') (*leafVis)(i,j) = LEAFVIS_NO;
-			else if(line[j] == '1') (*leafVis)(i,j) = LEAFVIS_YES;
-			else throw Exception("Bad vis table value in row " + lexical_cast<std::string>(i));
-		}
+		leafVis = load_compressed(is);
 	}
+	else leafVis = load_text(is, line);
 
 	LineIO::read_checked_line(is, "}");
 
@@ -60,7 +52,9 @@ LeafVisTable_Ptr VisSection::load(std::istream& is)
 
 //#################### SAVING METHODS ####################
 /**
-Saves a leaf visibility table to a std::ostream.
+Saves a leaf visibility table to a std::ostream. The table is written in a compressed
+binary format: each row is run-length encoded (see VisTable<bool>::compress_row) and
+the rows are written one after the other, preceded by their total length in bytes.
 
 @param os		The std::ostream
 @param leafVis	The leaf visibility table
@@ -71,31 +65,111 @@ void VisSection::save(std::ostream& os, const LeafVisTable_CPtr& leafVis)
 
 	os << "VisTable\n";
 	os << "{\n";
+	os << "RLE 1\n";
 
 	int size = table.size();
 	os << size << '\n';
+
+	std::vector<unsigned char> compressedRows;
+	for(int i=0; i<size; ++i)
+	{
+		table.compress_row(i, compressedRows);
+	}
+
+	os << compressedRows.size() << '\n';
+	if(!compressedRows.empty())
+	{
+		os.write(reinterpret_cast<const char*>(&compressedRows[0]), static_cast<std::streamsize>(compressedRows.size()));
+	}
+
+	os << "\n}\n";
+}
+
+//#################### LOADING SUPPORT METHODS ####################
+/**
+Loads a leaf visibility table in the compressed format from the specified std::istream.
+The rows are only decompressed as and when they're first accessed.
+
+@param is	The std::istream
+@return		The visibility table
+*/
+LeafVisTable_Ptr VisSection::load_compressed(std::istream& is)
+{
+	std::string line;
+
+	LineIO::read_line(is, line, "vis table size");
+	int size = parse_table_size(line);
+
+	LineIO::read_line(is, line, "compressed vis table length");
+	int length;
+	try							{ length = lexical_cast<int>(line); }
+	catch(bad_lexical_cast&)	{ throw Exception("The compressed vis table length was not an integer"); }
+
+	// Each compressed byte either is, or is half of a run representing, at least one byte of the decompressed table,
+	// so well-formed compressed data can never be more than twice the size of the table itself.
+	double maxLength = 2.0 * size * ((size + 7) / 8);
+	if(length < 0 || length > maxLength) throw Exception("The compressed vis table length was out of range");
+
+	std::vector<unsigned char> compressedRows(length);
+	if(length > 0 && !is.read(reinterpret_cast<char*>(&compressedRows[0]), length))
+	{
+		throw Exception("Unexpected EOF whilst trying to read the compressed vis table");
+	}
+
+	if(is.get() != '\n') throw Exception("Expected newline after compressed vis table");
+
+	return LeafVisTable_Ptr(new LeafVisTable(size, compressedRows));
+}
+
+/**
+Loads a leaf visibility table in the old text format from the specified std::istream.
+
+@param is			The std::istream
+@param sizeLine		The line containing the size of the vis table (which has already been read)
+@return				The visibility table
+*/
+LeafVisTable_Ptr VisSection::load_text(std::istream& is, const std::string& sizeLine)
+{
+	int size = parse_table_size(sizeLine);
+
+	// Construct an empty vis table of the right size.
+	LeafVisTable_Ptr leafVis(new LeafVisTable(size));
+
+	// Read in the vis table itself.
+	std::string line;
 	for(int i=0; i<size; ++i)
 	{
+		LineIO::read_line(is, line, "vis table row " + lexical_cast<std::string>(i));
+		if(line.length() != size) throw Exception("Bad vis table row " + lexical_cast<std::string>(i));
+
 		for(int j=0; j<size; ++j)
 		{
-			switch(table(i,j))
-			{
-				case LEAFVIS_NO:
-				{
-					os << '0';
-					break;
-				}
-				case LEAFVIS_YES:
-				{
-					os << '1';
-					break;
-				}
-			}
+			if(line[j] == '1') leafVis->set(i,j);
+			else if(line[j] != '0') throw Exception("Bad vis table value in row " + lexical_cast<std::string>(i));
 		}
-		os << '\n';
 	}
 
-	os << "}\n";
+	return leafVis;
+}
+
+/**
+Parses the size of a vis table, checking that it's small enough for the table (which has
+size * size cells) to be indexed.
+
+@param sizeLine		The line containing the size of the vis table
+@return				The size of the vis table
+@throws Exception	If the size isn't an integer, or is out of range
+*/
+int VisSection::parse_table_size(const std::string& sizeLine)
+{
+	int size;
+	try							{ size = lexical_cast<int>(sizeLine); }
+	catch(bad_lexical_cast&)	{ throw Exception("The vis table size was not an integer"); }
+
+	const int MAX_SIZE = 46340;		// floor(sqrt(INT_MAX))
+	if(size < 0 || size > MAX_SIZE) throw Exception("The vis table size was out of range");
+
+	return size;
 }
 
 }
@@ -6,6 +6,9 @@
 #ifndef H_HESP_VISSECTION
 #define H_HESP_VISSECTION
 
+#include <iosfwd>
+#include <string>
+
 #include <hesp/vis/VisTable.h>
 
 namespace hesp {
@@ -17,6 +20,12 @@ struct VisSection
 
 	//#################### SAVING METHODS ####################
 	static void save(std::ostream& os, const LeafVisTable_CPtr& leafVis);
+
+	//#################### LOADING SUPPORT METHODS ####################
+private:
+	static LeafVisTable_Ptr load_compressed(std::istream& is);
+	static LeafVisTable_Ptr load_text(std::istream& is, const std::string& sizeLine);
+	static int parse_table_size(const std::string& sizeLine);
 };
 
 }
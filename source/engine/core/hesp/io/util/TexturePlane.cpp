@@ -1,5 +1,5 @@
 /***
- * mef2input: TexturePlane.cpp
+ * hesperus: TexturePlane.cpp
  * Copyright Stuart Golodetz, 2009. All rights reserved.
  ***/
 
@@ -1,10 +1,10 @@
 /***
- * mef2input: TexturePlane.h
+ * hesperus: TexturePlane.h
  * Copyright Stuart Golodetz, 2009. All rights reserved.
  ***/
 
-#ifndef H_MEF2INPUT_TEXTUREPLANE
-#define H_MEF2INPUT_TEXTUREPLANE
+#ifndef H_HESP_TEXTUREPLANE
+#define H_HESP_TEXTUREPLANE
 
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
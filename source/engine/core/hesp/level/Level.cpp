@@ -5,12 +5,18 @@
 
 #include "Level.h"
 
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 #include <hesp/axes/NUVAxes.h>
 #include <hesp/bounds/Bounds.h>
 #include <hesp/bounds/BoundsManager.h>
+#include <hesp/database/Database.h>
 #include <hesp/input/InputState.h>
+#include <hesp/nav/GlobalPathfinder.h>
 #include <hesp/nav/NavDataset.h>
+#include <hesp/nav/NavManager.h>
 #include <hesp/nav/NavMesh.h>
+#include <hesp/nav/PathQueryService.h>
 #include <hesp/objects/base/ObjectCommand.h>
 #include <hesp/objects/base/ObjectManager.h>
 #include <hesp/objects/components/ICmpActivatable.h>
@@ -26,6 +32,25 @@
 
 namespace hesp {
 
+//#################### LOCAL METHODS ####################
+namespace {
+
+/**
+Returns the time elapsed since the specified time, and resets it to now.
+
+@param since	The time
+@return			The elapsed time (in microseconds)
+*/
+int elapsed_microseconds(boost::posix_time::ptime& since)
+{
+	boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+	int elapsed = static_cast<int>((now - since).total_microseconds());
+	since = now;
+	return elapsed;
+}
+
+}
+
 //#################### CONSTRUCTORS ####################
 Level::Level(const GeometryRenderer_Ptr& geomRenderer, const BSPTree_Ptr& tree,
 			 const PortalVector& portals, const LeafVisTable_Ptr& leafVis,
@@ -34,8 +59,10 @@ Level::Level(const GeometryRenderer_Ptr& geomRenderer, const BSPTree_Ptr& tree,
 			 const ObjectManager_Ptr& objectManager)
 :	m_geomRenderer(geomRenderer), m_tree(tree), m_portals(portals), m_leafVis(leafVis),
 	m_onionPolygons(onionPolygons), m_onionTree(onionTree), m_onionPortals(onionPortals),
-	m_navManager(navManager), m_objectManager(objectManager)
-{}
+	m_navManager(navManager), m_objectManager(objectManager), m_pathQueryBudget(DEFAULT_PATH_QUERY_BUDGET)
+{
+	m_pathQueryService = objectManager->database()->get("db://PathQueryService", m_pathQueryService);
+}
 
 //#################### PUBLIC METHODS ####################
 BSPTree_CPtr Level::bsp_tree() const
@@ -91,31 +118,71 @@ OnionTree_CPtr Level::onion_tree() const
 	return m_onionTree;
 }
 
+int Level::path_query_budget() const
+{
+	return m_pathQueryBudget;
+}
+
 const std::vector<Portal_Ptr>& Level::portals() const
 {
 	return m_portals;
 }
 
-void Level::update(int milliseconds, InputState& input)
+/**
+Sets the amount of time which may be spent processing the AI agents' path queries on each update.
+
+@param budgetMicroseconds	The time budget (in microseconds), or a negative number to process all pending
+							queries on each update (which makes the simulation independent of how fast
+							the machine is)
+*/
+void Level::set_path_query_budget(int budgetMicroseconds)
+{
+	m_pathQueryBudget = budgetMicroseconds;
+}
+
+/**
+Updates the level by the specified amount of time.
+
+@param milliseconds	The length of the time step (in milliseconds)
+@param input		The current input state
+@param timings		If non-null, used to return the time spent in each phase of the update
+*/
+void Level::update(int milliseconds, InputState& input, UpdateTimings *timings)
 {
+	boost::posix_time::ptime start;
+	if(timings) start = boost::posix_time::microsec_clock::universal_time();
+
 	do_yokes(milliseconds, input);
+	if(timings) timings->yokes = elapsed_microseconds(start);
+
+	do_nav_obstacles();
+	do_path_queries();
+	if(timings) timings->pathQueries = elapsed_microseconds(start);
+
 	do_physics(milliseconds);
+	if(timings) timings->physics = elapsed_microseconds(start);
+
 	do_animations(milliseconds);
+	if(timings) timings->animations = elapsed_microseconds(start);
+
 	do_activatables(input);
+	if(timings) timings->activatables = elapsed_microseconds(start);
 
 	// Safely create any new objects which were spawned during this update,
 	// and destroy any objects which were queued up for destruction.
 	m_objectManager->flush_queues();
+	if(timings) timings->queueFlushes = elapsed_microseconds(start);
 
 	// Broadcast an elapsed time message so that time-sensitive components can update themselves.
 	m_objectManager->broadcast_message(Message_CPtr(new MsgTimeElapsed(milliseconds)));
+	if(timings) timings->messageBroadcast = elapsed_microseconds(start);
 }
 
 //#################### PRIVATE METHODS ####################
 void Level::do_activatables(InputState& input)
 {
 	// Step 1:	Set all activatable objects to be unhighlighted when rendered.
-	std::vector<ObjectID> activatables = m_objectManager->group("Activatables");
+	const std::vector<ObjectID>& activatables = m_objectManager->group("Activatables");
 	for(size_t i=0, size=activatables.size(); i<size; ++i)
 	{
 		ICmpModelRender_Ptr cmpRender = m_objectManager->get_component(activatables[i], cmpRender);
@@ -176,7 +243,7 @@ void Level::do_activatables(InputState& input)
 void Level::do_animations(int milliseconds)
 {
 	// Update the model animations.
-	std::vector<ObjectID> animatables = m_objectManager->group("Animatables");
+	const std::vector<ObjectID>& animatables = m_objectManager->group("Animatables");
 	for(size_t i=0, size=animatables.size(); i<size; ++i)
 	{
 		ICmpModelRender_Ptr cmpRender = m_objectManager->get_component(animatables[i], cmpRender);
@@ -191,7 +258,7 @@ void Level::do_gravity(int milliseconds)
 	// FIXME: Gravity strength should eventually be a level property.
 	const double GRAVITY_STRENGTH = 9.81;	// strength of gravity in Newtons
 
-	std::vector<ObjectID> moveables = m_objectManager->group("Moveables");
+	const std::vector<ObjectID>& moveables = m_objectManager->group("Moveables");
 	for(size_t i=0, size=moveables.size(); i<size; ++i)
 	{
 		ICmpMovement_Ptr cmpMovement = m_objectManager->get_component(moveables[i], cmpMovement);
@@ -206,6 +273,51 @@ void Level::do_gravity(int milliseconds)
 	}
 }
 
+void Level::do_nav_obstacles()
+{
+	// Block the nav polygons which are currently occupied by dynamic obstacles (i.e. moveable objects other
+	// than the player), so that the AI agents' paths are routed around them. Each object only blocks its
+	// polygon in the nav mesh for its own AABB map (the nav polygons of the different maps don't correspond
+	// to each other). Note that the pathfinder never treats a query's source polygon as blocked, so an agent
+	// isn't prevented from pathing away from its own position by itself (or by anything else there).
+	std::map<int,std::vector<int> > occupiedPolys;
+
+	// Make sure every dataset is updated (even if it has no occupied polygons), so that the polygons blocked on the previous frame are unblocked.
+	const std::map<int,NavDataset_CPtr>& datasets = m_navManager->datasets();
+	for(std::map<int,NavDataset_CPtr>::const_iterator it=datasets.begin(), iend=datasets.end(); it!=iend; ++it)
+	{
+		occupiedPolys[it->first];
+	}
+
+	const ObjectID player = m_objectManager->player();
+	const std::vector<ObjectID>& moveables = m_objectManager->group("Moveables");
+	for(size_t i=0, size=moveables.size(); i<size; ++i)
+	{
+		if(moveables[i] == player) continue;
+
+		ICmpMovement_Ptr cmpMovement = m_objectManager->get_component(moveables[i], cmpMovement);
+		int curNavPolyIndex = cmpMovement->cur_nav_poly_index();
+		if(curNavPolyIndex == -1) continue;
+
+		ICmpSimulation_Ptr cmpSimulation = m_objectManager->get_component(moveables[i], cmpSimulation);
+		int mapIndex = m_objectManager->bounds_manager()->lookup_bounds_index(cmpSimulation->bounds_group(), cmpSimulation->posture());
+
+		std::map<int,std::vector<int> >::iterator jt = occupiedPolys.find(mapIndex);
+		if(jt != occupiedPolys.end()) jt->second.push_back(curNavPolyIndex);
+	}
+
+	for(std::map<int,std::vector<int> >::const_iterator it=occupiedPolys.begin(), iend=occupiedPolys.end(); it!=iend; ++it)
+	{
+		m_navManager->dataset(it->first)->pathfinder()->set_blocked_polygons(it->second);
+	}
+}
+
+void Level::do_path_queries()
+{
+	// Process the path queries submitted by the AI agents, spending no more than the level's time budget on them per frame.
+	m_pathQueryService->process_queries(m_pathQueryBudget);
+}
+
 void Level::do_physics(int milliseconds)
 {
 	// Treat gravity as a special case.
@@ -217,7 +329,7 @@ void Level::do_physics(int milliseconds)
 void Level::do_yokes(int milliseconds, InputState& input)
 {
 	// Step 1:	Generate the desired object commands for the yokeable objects and add them to the queue.
-	std::vector<ObjectID> yokeables = m_objectManager->group("Yokeables");
+	const std::vector<ObjectID>& yokeables = m_objectManager->group("Yokeables");
 
 	std::list<ObjectCommand_Ptr> cmdQueue;	// implement the queue as a list so that we can use back_inserter below
 
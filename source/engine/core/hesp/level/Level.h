@@ -28,6 +28,7 @@ typedef shared_ptr<const class NavManager> NavManager_CPtr;
 typedef shared_ptr<class ObjectManager> ObjectManager_Ptr;
 typedef shared_ptr<class OnionTree> OnionTree_Ptr;
 typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
+typedef shared_ptr<class PathQueryService> PathQueryService_Ptr;
 
 class Level
 {
@@ -38,6 +39,26 @@ private:
 	typedef std::vector<OnionPortal_Ptr> OnionPortalVector;
 	typedef std::vector<Portal_Ptr> PortalVector;
 
+	//#################### NESTED CLASSES ####################
+public:
+	/**
+	The time spent in each phase of an update (in microseconds).
+	*/
+	struct UpdateTimings
+	{
+		int yokes;
+		int pathQueries;
+		int physics;
+		int animations;
+		int activatables;
+		int queueFlushes;
+		int messageBroadcast;
+	};
+
+	//#################### CONSTANTS ####################
+public:
+	enum { DEFAULT_PATH_QUERY_BUDGET = 2000 };	// in microseconds
+
 	//#################### PRIVATE VARIABLES ####################
 private:
 	GeometryRenderer_Ptr m_geomRenderer;
@@ -49,6 +70,8 @@ private:
 	OnionPortalVector m_onionPortals;
 	NavManager_Ptr m_navManager;
 	ObjectManager_Ptr m_objectManager;
+	PathQueryService_Ptr m_pathQueryService;
+	int m_pathQueryBudget;
 
 	//#################### CONSTRUCTORS ####################
 public:
@@ -67,14 +90,18 @@ public:
 	const ObjectManager_Ptr& object_manager();
 	const ColPolyVector& onion_polygons() const;
 	OnionTree_CPtr onion_tree() const;
+	int path_query_budget() const;
 	const PortalVector& portals() const;
-	void update(int milliseconds, InputState& input);
+	void set_path_query_budget(int budgetMicroseconds);
+	void update(int milliseconds, InputState& input, UpdateTimings *timings = NULL);
 
 	//#################### PRIVATE METHODS ####################
 private:
 	void do_activatables(InputState& input);
 	void do_animations(int milliseconds);
 	void do_gravity(int milliseconds);
+	void do_nav_obstacles();
+	void do_path_queries();
 	void do_physics(int milliseconds);
 	void do_yokes(int milliseconds, InputState& input);
 };
@@ -162,7 +162,7 @@ void LevelViewer::render_objects() const
 	ObjectManager_Ptr objectManager = m_level->object_manager();
 	objectManager->sprite_manager()->set_camera_position(m_camera->eye());
 
-	std::vector<ObjectID> renderables = objectManager->group("Renderables");
+	const std::vector<ObjectID>& renderables = objectManager->group("Renderables");
 	ICmpModelRender_Ptr cmpFirstPersonRender;
 	for(size_t i=0, size=renderables.size(); i<size; ++i)
 	{
@@ -13,10 +13,10 @@
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
-LitGeometryRenderer::LitGeometryRenderer(const TexLitPolyVector& polygons, const std::vector<Image24_Ptr>& lightmaps)
-:	m_polygons(polygons)
+LitGeometryRenderer::LitGeometryRenderer(const TexLitPolyVector& polygons, const LightmapAtlas_CPtr& lightmaps)
+:	m_polygons(polygons), m_polygonPages(lightmaps->polygon_pages())
 {
-	assert(polygons.size() == lightmaps.size());
+	assert(polygons.size() == m_polygonPages.size());
 
 	// Determine the set of unique texture names.
 	std::set<std::string> textureNames;
@@ -28,12 +28,13 @@ LitGeometryRenderer::LitGeometryRenderer(const TexLitPolyVector& polygons, const
 
 	load_textures(textureNames);
 
-	// Create the lightmaps.
-	int lightmapCount = static_cast<int>(lightmaps.size());
-	m_lightmaps.resize(lightmapCount);
-	for(int i=0; i<lightmapCount; ++i)
+	// Create the lightmap pages.
+	const std::vector<Image24_Ptr>& pages = lightmaps->pages();
+	int pageCount = static_cast<int>(pages.size());
+	m_lightmapPages.resize(pageCount);
+	for(int i=0; i<pageCount; ++i)
 	{
-		m_lightmaps[i] = TextureFactory::create_texture24(lightmaps[i], true);
+		m_lightmapPages[i] = TextureFactory::create_texture24(pages[i], true);
 	}
 }
 
@@ -60,6 +61,10 @@ void LitGeometryRenderer::render_simple(const std::vector<int>& polyIndices) con
 
 	glColor3d(1,1,1);
 
+	// Many polygons share each texture and lightmap page, so only rebind them when they change.
+	const Texture *boundTexture = NULL;
+	int boundPage = -1;
+
 	int indexCount = static_cast<int>(polyIndices.size());
 	for(int i=0; i<indexCount; ++i)
 	{
@@ -68,11 +73,20 @@ void LitGeometryRenderer::render_simple(const std::vector<int>& polyIndices) con
 		// Note:	If we got to this point, all textures were loaded successfully,
 		//			so the texture's definitely in the map.
 		std::map<std::string,Texture_Ptr>::const_iterator jt = m_textures.find(poly->auxiliary_data());
-		glActiveTextureARB(GL_TEXTURE0_ARB);
-		jt->second->bind();
-
-		glActiveTextureARB(GL_TEXTURE1_ARB);
-		m_lightmaps[polyIndices[i]]->bind();
+		if(jt->second.get() != boundTexture)
+		{
+			glActiveTextureARB(GL_TEXTURE0_ARB);
+			jt->second->bind();
+			boundTexture = jt->second.get();
+		}
+
+		int page = m_polygonPages[polyIndices[i]];
+		if(page != boundPage)
+		{
+			glActiveTextureARB(GL_TEXTURE1_ARB);
+			m_lightmapPages[page]->bind();
+			boundPage = page;
+		}
 
 		int vertCount = poly->vertex_count();
 		glBegin(GL_POLYGON);
@@ -6,7 +6,7 @@
 #ifndef H_HESP_LITGEOMETRYRENDERER
 #define H_HESP_LITGEOMETRYRENDERER
 
-#include <hesp/images/Image.h>
+#include <hesp/lighting/LightmapAtlas.h>
 #include <hesp/util/PolygonTypes.h>
 #include "GeometryRenderer.h"
 
@@ -21,11 +21,12 @@ private:
 	//#################### PRIVATE VARIABLES ####################
 private:
 	TexLitPolyVector m_polygons;
-	std::vector<Texture_Ptr> m_lightmaps;
+	std::vector<int> m_polygonPages;		// the lightmap page for each polygon
+	std::vector<Texture_Ptr> m_lightmapPages;
 
 	//#################### CONSTRUCTORS ####################
 public:
-	LitGeometryRenderer(const TexLitPolyVector& polygons, const std::vector<Image24_Ptr>& lightmaps);
+	LitGeometryRenderer(const TexLitPolyVector& polygons, const LightmapAtlas_CPtr& lightmaps);
 
 	//#################### PUBLIC METHODS ####################
 public:
@@ -0,0 +1,171 @@
+/***
+ * hesperus: LightmapAtlas.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "LightmapAtlas.h"
+
+#include <algorithm>
+
+#include <hesp/exceptions/InvalidParameterException.h>
+#include <hesp/images/PixelTypes.h>
+#include <hesp/images/SimpleImage.h>
+#include "Lightmap.h"
+#include "SkylinePacker.h"
+
+namespace hesp {
+
+namespace {
+
+//#################### LOCAL CLASSES ####################
+struct Placement
+{
+	int page, x, y;
+};
+
+/**
+Orders lightmap images by decreasing height, then by decreasing width (ties are
+broken by index, so that the packing is deterministic).
+*/
+struct LargerImage
+{
+	const std::vector<Image24_Ptr>& images;
+
+	explicit LargerImage(const std::vector<Image24_Ptr>& images_) : images(images_) {}
+
+	bool operator()(int lhs, int rhs) const
+	{
+		const Image24& l = *images[lhs], & r = *images[rhs];
+		if(l.height() != r.height()) return l.height() > r.height();
+		if(l.width() != r.width()) return l.width() > r.width();
+		return lhs < rhs;
+	}
+};
+
+//#################### LOCAL METHODS ####################
+int clamp(int value, int lo, int hi)
+{
+	return value < lo ? lo : value > hi ? hi : value;
+}
+
+int round_up_to_power_of_two(int n)
+{
+	int ret = 2;
+	while(ret < n) ret *= 2;
+	return ret;
+}
+
+}
+
+//#################### CONSTRUCTORS ####################
+LightmapAtlas::LightmapAtlas(const std::vector<Image24_Ptr>& pages, const std::vector<int>& polygonPages)
+:	m_pages(pages), m_polygonPages(polygonPages)
+{}
+
+//#################### PUBLIC METHODS ####################
+/**
+Packs the lightmaps for a set of polygons into atlas pages, and rewrites the lightmap
+coordinates of the polygons to refer to their lightmaps' places in the atlas.
+
+The pages are all pageSize texels wide, and all but the last are pageSize texels high;
+the last page is only made as high as it needs to be (rounded up to a power of two).
+
+@param lightmaps					The lightmaps (one per polygon)
+@param polygons						The polygons (these are replaced with copies whose lightmap coordinates refer to the atlas)
+@param pageSize						The size of each page (a power of two, no bigger than 1024)
+@param padding						The width of the border to put around each lightmap
+@return								The atlas
+@throws InvalidParameterException	If the numbers of lightmaps and polygons differ, or a lightmap is too big for a page
+*/
+LightmapAtlas_Ptr LightmapAtlas::pack(const LightmapVector& lightmaps, TexLitPolyVector& polygons, int pageSize, int padding)
+{
+	if(lightmaps.size() != polygons.size()) throw InvalidParameterException("There must be exactly one lightmap per polygon");
+
+	int lightmapCount = static_cast<int>(lightmaps.size());
+	std::vector<Image24_Ptr> images(lightmapCount);
+	for(int i=0; i<lightmapCount; ++i)
+	{
+		images[i] = lightmaps[i]->to_image();
+	}
+
+	// Pack the lightmaps, largest first, onto the first page with room for each of them.
+	std::vector<int> order(lightmapCount);
+	for(int i=0; i<lightmapCount; ++i) order[i] = i;
+	std::sort(order.begin(), order.end(), LargerImage(images));
+
+	std::vector<SkylinePacker> packers;
+	std::vector<Placement> placements(lightmapCount);
+	for(std::vector<int>::const_iterator it=order.begin(), iend=order.end(); it!=iend; ++it)
+	{
+		int i = *it;
+		int paddedWidth = images[i]->width() + 2 * padding, paddedHeight = images[i]->height() + 2 * padding;
+		if(paddedWidth > pageSize || paddedHeight > pageSize) throw InvalidParameterException("A lightmap is too big to fit on an atlas page");
+
+		Placement& placement = placements[i];
+		int pageCount = static_cast<int>(packers.size());
+		for(placement.page=0; placement.page<pageCount; ++placement.page)
+		{
+			if(packers[placement.page].insert(paddedWidth, paddedHeight, placement.x, placement.y)) break;
+		}
+		if(placement.page == pageCount)
+		{
+			packers.push_back(SkylinePacker(pageSize, pageSize));
+			packers.back().insert(paddedWidth, paddedHeight, placement.x, placement.y);
+		}
+	}
+
+	// Make the page images.
+	int pageCount = static_cast<int>(packers.size());
+	std::vector<Image24_Ptr> pages(pageCount);
+	for(int p=0; p<pageCount; ++p)
+	{
+		int pageHeight = p == pageCount - 1 ? round_up_to_power_of_two(packers[p].height_used()) : pageSize;
+		pages[p].reset(new SimpleImage24(pageSize, pageHeight));
+	}
+
+	// Copy each lightmap (and its border) onto its page, and rewrite the lightmap coordinates of its polygon.
+	std::vector<int> polygonPages(lightmapCount);
+	for(int i=0; i<lightmapCount; ++i)
+	{
+		const Image24& image = *images[i];
+		const Placement& placement = placements[i];
+		Image24& page = *pages[placement.page];
+		int width = image.width(), height = image.height();
+
+		for(int y=-padding; y<height+padding; ++y)
+			for(int x=-padding; x<width+padding; ++x)
+			{
+				page.set(placement.x + padding + x, placement.y + padding + y, image(clamp(x, 0, width-1), clamp(y, 0, height-1)));
+			}
+
+		double left = placement.x + padding, top = placement.y + padding;
+		const TexturedLitPolygon& poly = *polygons[i];
+		int vertCount = poly.vertex_count();
+		std::vector<TexturedLitVector3d> vertices;
+		vertices.reserve(vertCount);
+		for(int j=0; j<vertCount; ++j)
+		{
+			const TexturedLitVector3d& v = poly.vertex(j);
+			double lu = (left + v.lu * width) / page.width();
+			double lv = (top + v.lv * height) / page.height();
+			vertices.push_back(TexturedLitVector3d(v.x, v.y, v.z, v.u, v.v, lu, lv));
+		}
+		polygons[i].reset(new TexturedLitPolygon(vertices, poly.auxiliary_data()));
+
+		polygonPages[i] = placement.page;
+	}
+
+	return LightmapAtlas_Ptr(new LightmapAtlas(pages, polygonPages));
+}
+
+const std::vector<Image24_Ptr>& LightmapAtlas::pages() const
+{
+	return m_pages;
+}
+
+const std::vector<int>& LightmapAtlas::polygon_pages() const
+{
+	return m_polygonPages;
+}
+
+}
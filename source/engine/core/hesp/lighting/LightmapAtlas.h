@@ -0,0 +1,67 @@
+/***
+ * hesperus: LightmapAtlas.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_LIGHTMAPATLAS
+#define H_HESP_LIGHTMAPATLAS
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <hesp/images/Image.h>
+#include <hesp/util/PolygonTypes.h>
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<class LightmapAtlas> LightmapAtlas_Ptr;
+typedef shared_ptr<class Lightmap> Lightmap_Ptr;
+
+/**
+This class represents the lightmaps for a level, packed into a small number of atlas pages
+(rather than stored as one image per polygon). Each polygon's lightmap coordinates refer to
+its region of the page on which its lightmap has been placed.
+
+Each lightmap is surrounded by a border of copies of its edge lumels when it's packed, so that
+filtering near the edge of a lightmap doesn't pick up any of its neighbours on the page.
+*/
+class LightmapAtlas
+{
+	//#################### TYPEDEFS ####################
+private:
+	typedef std::vector<Lightmap_Ptr> LightmapVector;
+	typedef std::vector<TexturedLitPolygon_Ptr> TexLitPolyVector;
+
+	//#################### CONSTANTS ####################
+public:
+	enum
+	{
+		DEFAULT_PADDING = 2,
+		DEFAULT_PAGE_SIZE = 512
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<Image24_Ptr> m_pages;
+	std::vector<int> m_polygonPages;	// the page containing the lightmap for each polygon
+
+	//#################### CONSTRUCTORS ####################
+public:
+	LightmapAtlas(const std::vector<Image24_Ptr>& pages, const std::vector<int>& polygonPages);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	static LightmapAtlas_Ptr pack(const LightmapVector& lightmaps, TexLitPolyVector& polygons, int pageSize = DEFAULT_PAGE_SIZE, int padding = DEFAULT_PADDING);
+	const std::vector<Image24_Ptr>& pages() const;
+	const std::vector<int>& polygon_pages() const;
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<const LightmapAtlas> LightmapAtlas_CPtr;
+
+}
+
+#endif
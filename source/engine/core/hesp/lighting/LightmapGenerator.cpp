@@ -5,6 +5,11 @@
 
 #include "LightmapGenerator.h"
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <hesp/trees/BSPTree.h>
 #include <hesp/trees/TreeUtil.h>
 #include "Lightmap.h"
@@ -13,8 +18,9 @@
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
-LightmapGenerator::LightmapGenerator(const TexPolyVector& inputPolygons, const std::vector<Light>& lights, const BSPTree_Ptr& tree, const LeafVisTable_Ptr& leafVis)
-:	m_inputPolygons(inputPolygons), m_lights(lights), m_tree(tree), m_leafVis(leafVis)
+LightmapGenerator::LightmapGenerator(const TexPolyVector& inputPolygons, const std::vector<Light>& lights, const BSPTree_Ptr& tree, const LeafVisTable_Ptr& leafVis,
+									 int threadCount)
+:	m_inputPolygons(inputPolygons), m_lights(lights), m_tree(tree), m_leafVis(leafVis), m_threadCount(std::max(threadCount, 1)), m_nextPolygon(0)
 {}
 
 //#################### PUBLIC METHODS ####################
@@ -59,6 +65,8 @@ Cleans up the intermediate data structures used during lightmap generation.
 void LightmapGenerator::clean_intermediate()
 {
 	LightmapGridVector().swap(m_grids);
+	std::vector<int>().swap(m_lightLeaves);
+	std::vector<std::vector<int> >().swap(m_polygonLeaves);
 }
 
 /**
@@ -124,57 +132,125 @@ void LightmapGenerator::construct_grids()
 }
 
 /**
-Processes light n: this involves updating the lightmaps for all the polygons that
-the light can see.
-
-@param n	The index of the light to be processed
+Determines the leaf in which each light resides, and the empty leaves which contain each polygon.
+These are used to work out which lights can potentially see each polygon.
 */
-void LightmapGenerator::process_light(int n)
+void LightmapGenerator::find_light_and_polygon_leaves()
 {
 	assert(m_tree->empty_leaf_count() == m_leafVis->size());
+	int emptyLeafCount = m_leafVis->size();
 
-	// Determine the BSP leaf in which the light resides.
-	const Light& light = m_lights[n];
-	int lightLeaf = TreeUtil::find_leaf_index(light.position, m_tree);
-
-	// If the light is in a wall, we can simply ignore it.
-	if(lightLeaf >= m_tree->empty_leaf_count()) return;
+	int lightCount = static_cast<int>(m_lights.size());
+	m_lightLeaves.resize(lightCount);
+	for(int i=0; i<lightCount; ++i)
+	{
+		// If the light is in a wall, we can simply ignore it.
+		int lightLeaf = TreeUtil::find_leaf_index(m_lights[i].position, m_tree);
+		m_lightLeaves[i] = lightLeaf < emptyLeafCount ? lightLeaf : -1;
+	}
 
-	int emptyLeafCount = m_leafVis->size();
+	m_polygonLeaves.resize(m_inputPolygons.size());
 	for(int i=0; i<emptyLeafCount; ++i)
 	{
-		// If the light can potentially see this leaf, we need to process the polygons in it.
-		if((*m_leafVis)(lightLeaf, i))
+		const std::vector<int>& polyIndices = m_tree->leaf(i)->polygon_indices();
+		for(std::vector<int>::const_iterator jt=polyIndices.begin(), jend=polyIndices.end(); jt!=jend; ++jt)
 		{
-			const BSPLeaf *leaf = m_tree->leaf(i);
-			const std::vector<int>& polyIndices = leaf->polygon_indices();
-			for(std::vector<int>::const_iterator jt=polyIndices.begin(), jend=polyIndices.end(); jt!=jend; ++jt)
-			{
-				int j = *jt;
-
-				// Calculate the individual lightmap between this light and the polygon.
-				Lightmap_Ptr newLightmap = m_grids[j]->lightmap_from_light(light, m_tree);
-
-				if(newLightmap)
-				{
-					// Combine it with the existing lightmap for the polygon (from previously processed lights in the scene).
-					Lightmap_Ptr& curLightmap = (*m_lightmaps)[j];
-					*curLightmap += *newLightmap;
-				}
-			}
+			m_polygonLeaves[*jt].push_back(i);
 		}
 	}
 }
 
 /**
-Processes all the lights in the level.
+Takes the next polygon to process off the work queue.
+
+@return	The index of the next polygon to process, or -1 if there are none left
+*/
+int LightmapGenerator::next_polygon_to_process()
+{
+	boost::mutex::scoped_lock lock(m_nextPolygonMutex);
+	if(m_nextPolygon == static_cast<int>(m_inputPolygons.size())) return -1;
+	return m_nextPolygon++;
+}
+
+/**
+Processes all the lights in the level. Rather than processing each light in turn, we
+process each polygon in turn, accumulating the lightmaps from all the lights that can
+potentially see it: since each polygon's lightmap is then only written by whichever
+thread is processing that polygon, the polygons can be processed in parallel without
+any locking.
 */
 void LightmapGenerator::process_lights()
 {
+	find_light_and_polygon_leaves();
+
+	// Make sure the leaf vis table is fully decompressed before we start reading it from several threads.
+	m_leafVis->decompress_all_rows();
+
+	m_nextPolygon = 0;
+	if(m_threadCount == 1)
+	{
+		process_polygons_worker();
+	}
+	else
+	{
+		boost::thread_group workers;
+		for(int i=0; i<m_threadCount; ++i)
+		{
+			workers.create_thread(boost::bind(&LightmapGenerator::process_polygons_worker, this));
+		}
+		workers.join_all();
+	}
+}
+
+/**
+Processes polygon n: this involves updating its lightmap with the light from all the
+lights that can potentially see it.
+
+Note:	The lights are combined in light order (and for each light, once per visible
+		leaf containing the polygon), so the result is exactly the same as it would be
+		if we processed the lights one at a time.
+
+@param n	The index of the polygon to be processed
+*/
+void LightmapGenerator::process_polygon(int n)
+{
+	const std::vector<int>& polygonLeaves = m_polygonLeaves[n];
+	if(polygonLeaves.empty()) return;
+
+	Lightmap_Ptr& curLightmap = (*m_lightmaps)[n];
+
 	int lightCount = static_cast<int>(m_lights.size());
 	for(int i=0; i<lightCount; ++i)
 	{
-		process_light(i);
+		int lightLeaf = m_lightLeaves[i];
+		if(lightLeaf == -1) continue;
+
+		for(std::vector<int>::const_iterator jt=polygonLeaves.begin(), jend=polygonLeaves.end(); jt!=jend; ++jt)
+		{
+			// If the light can potentially see this leaf, we need to process the polygon.
+			if((*m_leafVis)(lightLeaf, *jt))
+			{
+				// Calculate the individual lightmap between this light and the polygon.
+				Lightmap_Ptr newLightmap = m_grids[n]->lightmap_from_light(m_lights[i], m_tree);
+
+				// Combine it with the existing lightmap for the polygon (from previously processed lights in the scene).
+				if(newLightmap) *curLightmap += *newLightmap;
+			}
+		}
+	}
+}
+
+/**
+Repeatedly takes the next unprocessed polygon from the work queue and processes it,
+until there are no polygons left. This is run by each worker thread (or directly, if
+only one thread is being used).
+*/
+void LightmapGenerator::process_polygons_worker()
+{
+	int polygon;
+	while((polygon = next_polygon_to_process()) != -1)
+	{
+		process_polygon(polygon);
 	}
 }
 
@@ -8,6 +8,8 @@
 
 #include <vector>
 
+#include <boost/thread/mutex.hpp>
+
 #include <hesp/util/PolygonTypes.h>
 #include <hesp/vis/VisTable.h>
 #include "Light.h"
@@ -39,9 +41,16 @@ private:
 	std::vector<Light> m_lights;
 	BSPTree_Ptr m_tree;
 	LeafVisTable_Ptr m_leafVis;
+	int m_threadCount;
 
 	// Intermediate data
 	LightmapGridVector m_grids;
+	std::vector<int> m_lightLeaves;					// the leaf containing each light (or -1 if it's in a wall)
+	std::vector<std::vector<int> > m_polygonLeaves;	// the empty leaves containing each polygon
+
+	// Work queue for processing the polygons
+	int m_nextPolygon;
+	boost::mutex m_nextPolygonMutex;
 
 	// Output data
 	TexLitPolyVector_Ptr m_outputPolygons;
@@ -49,7 +58,7 @@ private:
 
 	//#################### CONSTRUCTORS ####################
 public:
-	LightmapGenerator(const TexPolyVector& inputPolygons, const std::vector<Light>& lights, const BSPTree_Ptr& tree, const LeafVisTable_Ptr& leafVis);
+	LightmapGenerator(const TexPolyVector& inputPolygons, const std::vector<Light>& lights, const BSPTree_Ptr& tree, const LeafVisTable_Ptr& leafVis, int threadCount = 1);
 
 	//#################### PUBLIC METHODS ####################
 public:
@@ -63,8 +72,11 @@ private:
 	void construct_ambient_lightmaps();
 	void construct_grid(int n);
 	void construct_grids();
-	void process_light(int n);
+	void find_light_and_polygon_leaves();
+	int next_polygon_to_process();
 	void process_lights();
+	void process_polygon(int n);
+	void process_polygons_worker();
 };
 
 }
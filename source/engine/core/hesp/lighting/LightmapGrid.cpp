@@ -30,14 +30,25 @@ Lightmap_Ptr LightmapGrid::lightmap_from_light(const Light& light, const BSPTree
 	int gridRows = static_cast<int>(m_grid.size());
 	int gridCols = static_cast<int>(m_grid[0].size());
 
+	// Trace the shadow rays to all the grid points within the polygon in one go.
+	std::vector<LineSegment3d> shadowRays;
+	shadowRays.reserve(gridRows * gridCols);
+	for(int r=0; r<gridRows; ++r)
+		for(int c=0; c<gridCols; ++c)
+		{
+			if(m_grid[r][c].withinPolygon) shadowRays.push_back(LineSegment3d(light.position, m_grid[r][c].position));
+		}
+	boost::dynamic_bitset<> lit = BSPUtil::lines_of_sight(shadowRays, tree);
+
 	Lightmap_Ptr gridLightmap(new Lightmap(gridRows, gridCols));
+	int rayIndex = 0;
 	for(int r=0; r<gridRows; ++r)
 		for(int c=0; c<gridCols; ++c)
 		{
 			if(m_grid[r][c].withinPolygon)
 			{
 				const Vector3d& p = m_grid[r][c].position;
-				if(BSPUtil::line_of_sight(light.position, p, tree))
+				if(lit[rayIndex++])
 				{
 					// Use the light equation I = I_p . k_d . (N . L) . fAtt (see OUCL Computer Graphics notes - Set 8).
 					// In this, fAtt (the atmospheric attenuation coefficient) = min(1/(c1+c2.dL+c3.dL^2), 1), where
@@ -0,0 +1,143 @@
+/***
+ * hesperus: SkylinePacker.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "SkylinePacker.h"
+
+#include <algorithm>
+
+#include <hesp/exceptions/InvalidParameterException.h>
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+SkylinePacker::SkylinePacker(int width, int height)
+:	m_width(width), m_height(height), m_usedArea(0)
+{
+	if(width <= 0 || height <= 0) throw InvalidParameterException("Packing pages must have a positive width and height");
+	m_skyline.push_back(Segment(0, 0, width));
+}
+
+//#################### PUBLIC METHODS ####################
+int SkylinePacker::height() const
+{
+	return m_height;
+}
+
+/**
+Returns the height of the part of the page which has been used so far.
+*/
+int SkylinePacker::height_used() const
+{
+	int ret = 0;
+	for(std::vector<Segment>::const_iterator it=m_skyline.begin(), iend=m_skyline.end(); it!=iend; ++it)
+	{
+		ret = std::max(ret, it->y);
+	}
+	return ret;
+}
+
+/**
+Attempts to place a rectangle on the page.
+
+@param width	The width of the rectangle
+@param height	The height of the rectangle
+@param x		Used to return the x coordinate of the corner of the rectangle nearest the page origin
+@param y		Used to return the y coordinate of the corner of the rectangle nearest the page origin
+@return			true, if the rectangle was placed, or false if there's no room for it on the page
+*/
+bool SkylinePacker::insert(int width, int height, int& x, int& y)
+{
+	if(width <= 0 || height <= 0) throw InvalidParameterException("Packed rectangles must have a positive width and height");
+
+	// Find the position on the skyline which keeps the top of the rectangle lowest.
+	int bestSegment = -1, bestTop = m_height + 1;
+	for(int i=0, segmentCount=static_cast<int>(m_skyline.size()); i<segmentCount; ++i)
+	{
+		int base = fit(i, width, height);
+		if(base != -1 && base + height < bestTop)
+		{
+			bestSegment = i;
+			bestTop = base + height;
+		}
+	}
+	if(bestSegment == -1) return false;
+
+	x = m_skyline[bestSegment].x;
+	y = bestTop - height;
+
+	// Raise the skyline over the rectangle, shortening (or removing) any segments it covers.
+	m_skyline.insert(m_skyline.begin() + bestSegment, Segment(x, bestTop, width));
+	for(size_t i=bestSegment+1; i<m_skyline.size();)
+	{
+		Segment& cur = m_skyline[i];
+		int overlap = x + width - cur.x;
+		if(overlap <= 0) break;
+		if(overlap < cur.width)
+		{
+			cur.x += overlap;
+			cur.width -= overlap;
+			break;
+		}
+		m_skyline.erase(m_skyline.begin() + i);
+	}
+
+	// Merge neighbouring segments of the same height.
+	for(size_t i=0; i+1<m_skyline.size();)
+	{
+		if(m_skyline[i].y == m_skyline[i+1].y)
+		{
+			m_skyline[i].width += m_skyline[i+1].width;
+			m_skyline.erase(m_skyline.begin() + i + 1);
+		}
+		else ++i;
+	}
+
+	m_usedArea += width * height;
+	return true;
+}
+
+int SkylinePacker::used_area() const
+{
+	return m_usedArea;
+}
+
+/**
+Returns the fraction of the page's area which is covered by the rectangles packed so far.
+*/
+double SkylinePacker::utilisation() const
+{
+	return static_cast<double>(m_usedArea) / (static_cast<double>(m_width) * m_height);
+}
+
+int SkylinePacker::width() const
+{
+	return m_width;
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Determines how low a rectangle can be placed if its left edge is at the start of the specified skyline segment.
+
+@param segment	The index of the segment
+@param width	The width of the rectangle
+@param height	The height of the rectangle
+@return			The y coordinate of the top of the rectangle, or -1 if it doesn't fit there
+*/
+int SkylinePacker::fit(int segment, int width, int height) const
+{
+	if(m_skyline[segment].x + width > m_width) return -1;
+
+	int y = 0;
+	int widthLeft = width;
+	for(int i=segment; widthLeft > 0; ++i)
+	{
+		y = std::max(y, m_skyline[i].y);
+		if(y + height > m_height) return -1;
+		widthLeft -= m_skyline[i].width;
+	}
+	return y;
+}
+
+}
@@ -0,0 +1,56 @@
+/***
+ * hesperus: SkylinePacker.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_SKYLINEPACKER
+#define H_HESP_SKYLINEPACKER
+
+#include <vector>
+
+namespace hesp {
+
+/**
+This class packs rectangles into a fixed-size page using the skyline bottom-left heuristic.
+The top edge of the packed area is stored as a 'skyline' of horizontal segments, and each new
+rectangle is placed on the skyline at the position which keeps its top edge lowest (ties are
+broken by choosing the leftmost such position).
+*/
+class SkylinePacker
+{
+	//#################### NESTED CLASSES ####################
+private:
+	struct Segment
+	{
+		int x, y, width;
+
+		Segment(int x_, int y_, int width_) : x(x_), y(y_), width(width_) {}
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	int m_width, m_height;
+	std::vector<Segment> m_skyline;		// in left-to-right order, covering the whole width of the page
+	int m_usedArea;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	SkylinePacker(int width, int height);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	int height() const;
+	int height_used() const;
+	bool insert(int width, int height, int& x, int& y);
+	int used_area() const;
+	double utilisation() const;
+	int width() const;
+
+	//#################### PRIVATE METHODS ####################
+private:
+	int fit(int segment, int width, int height) const;
+};
+
+}
+
+#endif
@@ -42,6 +42,9 @@ PlaneClassifier classify_point_against_plane(const Vector3d& p, const Plane& pla
 template <typename Vert, typename AuxData>
 PlaneClassifier classify_polygon_against_plane(const Polygon<Vert,AuxData>& poly, const Plane& plane);
 
+template <typename Vert, typename AuxData>
+PlaneClassifier clip_polygon_to_plane(const Polygon<Vert,AuxData>& poly, const Plane& plane, typename Polygon<Vert,AuxData>::VertexList& frontVerts);
+
 template <typename Vert, typename AuxData>
 AABB3d construct_bounding_box(const std::vector<shared_ptr<Polygon<Vert,AuxData> > >& polys);
 
@@ -88,6 +91,10 @@ Vector3d project_vector_onto_plane(const Vector3d& v, const Plane& plane);
 template <typename Vert, typename AuxData>
 SplitResults<Vert,AuxData> split_polygon(const Polygon<Vert,AuxData>& poly, const Plane& plane);
 
+template <typename Vert, typename AuxData>
+void split_polygon(const Polygon<Vert,AuxData>& poly, const Plane& plane, typename Polygon<Vert,AuxData>::VertexList& backVerts,
+				   typename Polygon<Vert,AuxData>::VertexList& frontVerts);
+
 //################## HELPER METHODS FOR THE split_polygon FUNCTION ##################
 int next_vert(int index, int vertCount);
 
@@ -62,6 +62,32 @@ PlaneClassifier classify_polygon_against_plane(const Polygon<Vert,AuxData>& poly
 	else return CP_COPLANAR;
 }
 
+/**
+Clips the polygon to the half-space in front of the specified plane. If the polygon straddles the
+plane, the vertices of the part of it which is in front of the plane are written into the specified
+vertex list (they're the same as the front half from split_polygon). Otherwise, the classification
+says it all: the clipped polygon is either the polygon itself (CP_FRONT) or nothing.
+
+@param poly			The polygon to clip
+@param plane		The plane to which to clip it
+@param frontVerts	Used to return the vertices of the clipped polygon when the polygon straddles
+					the plane (it's empty otherwise, so that a polygon entirely in front of the
+					plane needn't be copied)
+@return				The classification of the polygon against the plane
+*/
+template <typename Vert, typename AuxData>
+PlaneClassifier clip_polygon_to_plane(const Polygon<Vert,AuxData>& poly, const Plane& plane, typename Polygon<Vert,AuxData>::VertexList& frontVerts)
+{
+	PlaneClassifier cp = classify_polygon_against_plane(poly, plane);
+	if(cp == CP_STRADDLE)
+	{
+		typename Polygon<Vert,AuxData>::VertexList backVerts;
+		split_polygon(poly, plane, backVerts, frontVerts);
+	}
+	else frontVerts.clear();
+	return cp;
+}
+
 /**
 Constructs a bounding box around an array of polygons.
 
@@ -297,7 +323,9 @@ bool point_in_polygon(const Vector3d& p, const Polygon<Vert,AuxData>& poly)
 }
 
 /**
-Splits the polygon across the specified plane.
+Splits the polygon across the specified plane, returning the halves as new shared polygons. This is
+an adapter for code which shares polygons via shared_ptr: code which doesn't need to should use the
+version of split_polygon which writes the halves into caller-provided vertex lists instead.
 
 @param poly							The polygon to split across the plane
 @param plane						The plane across which to split the polygon
@@ -306,10 +334,41 @@ Splits the polygon across the specified plane.
 */
 template <typename Vert, typename AuxData>
 SplitResults<Vert,AuxData> split_polygon(const Polygon<Vert,AuxData>& poly, const Plane& plane)
+{
+	typedef Polygon<Vert,AuxData> Poly;
+	typedef shared_ptr<Poly> Poly_Ptr;
+
+	typename Poly::VertexList backHalf, frontHalf;
+	split_polygon(poly, plane, backHalf, frontHalf);
+
+	// Note that the auxiliary data is simply inherited from the parent polygon: it may or
+	// may not be necessary to allow this behaviour to be customised in the future.
+	Poly_Ptr backPoly(new Poly(backHalf, poly.auxiliary_data()));
+	Poly_Ptr frontPoly(new Poly(frontHalf, poly.auxiliary_data()));
+
+	return SplitResults<Vert,AuxData>(backPoly, frontPoly);
+}
+
+/**
+Splits the polygon across the specified plane, writing the vertices of its two halves into the
+specified vertex lists (any existing contents of which are discarded). The lists can be reused
+from one split to the next, and the halves are built without any heap allocation unless they
+have more vertices than a polygon stores inline.
+
+@param poly							The polygon to split across the plane
+@param plane						The plane across which to split the polygon
+@param backHalf						Used to return the vertices of the half behind the plane
+@param frontHalf					Used to return the vertices of the half in front of the plane
+@throws InvalidParameterException	If the polygon doesn't straddle the plane
+*/
+template <typename Vert, typename AuxData>
+void split_polygon(const Polygon<Vert,AuxData>& poly, const Plane& plane, typename Polygon<Vert,AuxData>::VertexList& backHalf,
+				   typename Polygon<Vert,AuxData>::VertexList& frontHalf)
 {
 	if(classify_polygon_against_plane(poly, plane) != CP_STRADDLE) throw InvalidParameterException("Polygon doesn't straddle plane");
 
-	std::vector<Vert> backHalf, frontHalf;
+	backHalf.clear();
+	frontHalf.clear();
 
 	// Find a start vertex which isn't on the plane. If there isn't one, the polygon doesn't
 	// straddle the plane, so we've violated a precondition (but we just checked this above,
@@ -348,17 +407,6 @@ SplitResults<Vert,AuxData> split_polygon(const Polygon<Vert,AuxData>& poly, cons
 			break;
 		}
 	}
-
-	// Construct the polygons from the lists of vertices and the auxiliary data.
-	// Note that the auxiliary data is simply inherited from the parent polygon:
-	// it may or may not be necessary to allow this behaviour to be customised
-	// in the future.
-	typedef Polygon<Vert,AuxData> Poly;
-	typedef shared_ptr<Poly> Poly_Ptr;
-	Poly_Ptr backPoly(new Poly(backHalf, poly.auxiliary_data()));
-	Poly_Ptr frontPoly(new Poly(frontHalf, poly.auxiliary_data()));
-
-	return SplitResults<Vert,AuxData>(backPoly, frontPoly);
 }
 
 //################## HELPER METHODS FOR THE split_polygon FUNCTION ##################
@@ -372,7 +420,7 @@ split_polygon function.)
 @param startVert	The first vertex we processed
 */
 template <typename Vert, typename AuxData>
-void complete_original_half(std::vector<Vert>& originalHalf, const Polygon<Vert,AuxData>& poly, int i, int startVert)
+void complete_original_half(typename Polygon<Vert,AuxData>::VertexList& originalHalf, const Polygon<Vert,AuxData>& poly, int i, int startVert)
 {
 	const int vertCount = poly.vertex_count();
 
@@ -402,8 +450,8 @@ Constructs one of the two halves of the split polygon. (It's used, obviously, in
 @return				A pair, the first component of which is the new value of i and the second of which is the new value of cp
 */
 template <typename Vert, typename AuxData>
-std::pair<int,PlaneClassifier> construct_half_polygon(std::vector<Vert>& currentHalf, std::vector<Vert>& otherHalf, const Polygon<Vert,AuxData>& poly,
-													  const Plane& plane, int i, PlaneClassifier cp)
+std::pair<int,PlaneClassifier> construct_half_polygon(typename Polygon<Vert,AuxData>::VertexList& currentHalf, typename Polygon<Vert,AuxData>::VertexList& otherHalf,
+													  const Polygon<Vert,AuxData>& poly, const Plane& plane, int i, PlaneClassifier cp)
 {
 	const int vertCount = poly.vertex_count();
 
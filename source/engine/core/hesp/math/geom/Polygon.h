@@ -12,6 +12,7 @@
 using boost::shared_ptr;
 
 #include <hesp/math/vectors/Vector3.h>
+#include <hesp/util/SmallVector.h>
 
 namespace hesp {
 
@@ -20,6 +21,10 @@ This class template allows users to create convex, planar polygons with a vertex
 auxiliary data type of their choosing. For instance, they can create textured polygons by
 specifying a vertex type with (u,v) texture coordinates and an auxiliary data type referencing
 the texture itself.
+
+Polygons are values: their vertices are stored inline (unless there are more than 8 of them), so
+they can be created, copied and split without touching the heap. Code which shares polygons via
+shared_ptr still works, but new code should prefer to pass them around by value or reference.
 */
 template <typename Vertex, typename AuxiliaryData>
 class Polygon
@@ -31,16 +36,18 @@ public:
 	typedef AuxiliaryData AuxData;
 
 	typedef shared_ptr<Polygon> Polygon_Ptr;
+	typedef SmallVector<Vert,8> VertexList;
 
 	//#################### PRIVATE VARIABLES ####################
 private:
-	std::vector<Vert> m_vertices;
+	VertexList m_vertices;
 	Vector3d m_normal;
 	AuxData m_auxData;
 
 	//#################### CONSTRUCTORS ####################
 public:
 	Polygon(const std::vector<Vert>& vertices, const AuxData& auxData);
+	Polygon(const VertexList& vertices, const AuxData& auxData);
 	template <typename OtherAuxData> Polygon(const Polygon<Vert,OtherAuxData>& otherPoly, const AuxData& auxData);
 
 	//#################### PUBLIC METHODS ####################
@@ -51,6 +58,7 @@ public:
 	const Vector3d& normal() const;
 	const Vert& vertex(int i) const;
 	int vertex_count() const;
+	const VertexList& vertices() const;
 
 	//#################### PRIVATE METHODS ####################
 private:
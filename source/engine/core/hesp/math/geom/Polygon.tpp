@@ -22,6 +22,23 @@ Constructs a polygon from the specified vertices and auxiliary data.
 */
 Polygon_HEADER
 Polygon_THIS::Polygon(const std::vector<Vert>& vertices, const AuxData& auxData)
+:	m_vertices(vertices.begin(), vertices.end()), m_auxData(auxData)
+{
+	if(vertices.size() < 3) throw InvalidParameterException("A polygon must have at least 3 vertices");
+	calculate_normal();
+}
+
+/**
+Constructs a polygon from the specified vertices and auxiliary data.
+
+- |vertices| >= 3
+
+@param vertices						The vertices
+@param auxData						The auxiliary data
+@throws InvalidParameterException	If the precondition is violated
+*/
+Polygon_HEADER
+Polygon_THIS::Polygon(const VertexList& vertices, const AuxData& auxData)
 :	m_vertices(vertices), m_auxData(auxData)
 {
 	if(vertices.size() < 3) throw InvalidParameterException("A polygon must have at least 3 vertices");
@@ -37,7 +54,7 @@ Constructs a polygon from another polygon with the same vertex type.
 Polygon_HEADER
 template <typename OtherAuxData>
 Polygon_THIS::Polygon(const Polygon<Vert,OtherAuxData>& otherPoly, const AuxData& auxData)
-:	m_vertices(otherPoly.m_vertices), m_normal(otherPoly.m_normal), m_auxData(auxData)
+:	m_vertices(otherPoly.vertices()), m_normal(otherPoly.normal()), m_auxData(auxData)
 {}
 
 //#################### PUBLIC METHODS ####################
@@ -71,9 +88,9 @@ Returns a copy of this polygon with flipped winding order.
 Polygon_HEADER
 typename Polygon_THIS::Polygon_Ptr Polygon_THIS::flipped_winding() const
 {
-	std::vector<Vert> flippedVertices;
+	VertexList flippedVertices;
 	flippedVertices.reserve(m_vertices.size());
-	std::copy(m_vertices.rbegin(), m_vertices.rend(), std::back_inserter(flippedVertices));
+	for(int i=m_vertices.size()-1; i>=0; --i) flippedVertices.push_back(m_vertices[i]);
 	return Polygon_Ptr(new Polygon(flippedVertices, m_auxData));
 }
 
@@ -107,7 +124,18 @@ Returns the number of vertices in the polygon.
 Polygon_HEADER
 int Polygon_THIS::vertex_count() const
 {
-	return static_cast<int>(m_vertices.size());
+	return m_vertices.size();
+}
+
+/**
+Returns the vertices of the polygon.
+
+@return	As stated
+*/
+Polygon_HEADER
+const typename Polygon_THIS::VertexList& Polygon_THIS::vertices() const
+{
+	return m_vertices;
 }
 
 //#################### PRIVATE METHODS ####################
@@ -25,9 +25,10 @@ void Mesh::render() const
 
 void Mesh::skin(const Skeleton_CPtr& skeleton)
 {
+	m_palette.update(skeleton);
 	for(size_t i=0, size=m_submeshes.size(); i<size; ++i)
 	{
-		m_submeshes[i]->skin(skeleton);
+		m_submeshes[i]->skin(m_palette);
 	}
 }
 
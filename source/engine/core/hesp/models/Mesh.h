@@ -11,6 +11,8 @@
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
 
+#include "SkinningPalette.h"
+
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
@@ -22,6 +24,7 @@ class Mesh
 	//#################### PRIVATE VARIABLES ####################
 private:
 	std::vector<Submesh_Ptr> m_submeshes;
+	SkinningPalette m_palette;				// the skinning matrices are calculated once per pose and shared by the submeshes
 
 	//#################### CONSTRUCTORS ####################
 public:
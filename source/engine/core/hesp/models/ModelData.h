@@ -0,0 +1,81 @@
+/***
+ * hesperus: ModelData.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_MODELDATA
+#define H_HESP_MODELDATA
+
+#include <string>
+#include <vector>
+
+#include <hesp/math/vectors/Vector3.h>
+
+namespace hesp {
+
+/**
+The raw data for a mesh, as read in from an Ogre mesh file or a compiled mesh file.
+*/
+struct MeshData
+{
+	//#################### NESTED CLASSES ####################
+	struct BoneAssignment
+	{
+		int vertIndex;
+		int boneIndex;
+		double weight;
+	};
+
+	struct SubmeshData
+	{
+		std::string materialName;
+		std::vector<unsigned int> vertIndices;
+		std::vector<double> positions;				// x,y,z for each vertex (in game units)
+		std::vector<double> normals;				// x,y,z for each vertex
+		std::vector<double> texCoords;				// u,v for each vertex (empty if the submesh isn't textured)
+		std::vector<BoneAssignment> boneAssignments;
+	};
+
+	//#################### PUBLIC VARIABLES ####################
+	std::vector<SubmeshData> submeshes;
+};
+
+/**
+The raw data for a skeleton, as read in from an Ogre skeleton file or a compiled skeleton file.
+*/
+struct SkeletonData
+{
+	//#################### NESTED CLASSES ####################
+	struct BoneData
+	{
+		std::string name;
+		int parent;									// the index of the bone's parent, or -1 if it doesn't have one
+		Vector3d position;							// in game units
+		Vector3d rotationAxis;
+		double rotationAngle;
+	};
+
+	struct TrackData
+	{
+		std::string boneName;
+		std::vector<double> keyframes;				// translation x,y,z (in game units), rotation axis x,y,z and rotation angle for each keyframe
+	};
+
+	struct AnimationData
+	{
+		std::string name;
+		double length;
+		std::vector<TrackData> tracks;
+	};
+
+	//#################### CONSTANTS ####################
+	enum { KEYFRAME_SIZE = 7 };
+
+	//#################### PUBLIC VARIABLES ####################
+	std::vector<BoneData> bones;					// indexed by bone ID
+	std::vector<AnimationData> animations;
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+/***
+ * hesperus: SkinningPalette.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "SkinningPalette.h"
+
+#include <hesp/math/matrices/RBTMatrix.h>
+#include "BoneHierarchy.h"
+#include "ConfiguredBone.h"
+#include "ConfiguredPose.h"
+#include "Skeleton.h"
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+SkinningPalette::SkinningPalette()
+:	m_matrices(MATRIX_SIZE, 0.0f)
+{
+	m_matrices[0] = m_matrices[5] = m_matrices[10] = m_matrices[15] = 1.0f;
+}
+
+//#################### PUBLIC METHODS ####################
+const float *SkinningPalette::matrices() const
+{
+	return &m_matrices[0];
+}
+
+int SkinningPalette::slot_count() const
+{
+	return static_cast<int>(m_matrices.size()) / MATRIX_SIZE;
+}
+
+/**
+Recalculates the skinning matrices for the skeleton's current pose.
+
+@param skeleton	The skeleton
+*/
+void SkinningPalette::update(const Skeleton_CPtr& skeleton)
+{
+	BoneHierarchy_CPtr boneHierarchy = skeleton->bone_hierarchy();
+	ConfiguredPose_CPtr pose = skeleton->get_pose();
+	int boneCount = boneHierarchy->bone_count();
+
+	// Note: Resizing never touches the identity matrix in slot 0.
+	m_matrices.resize((boneCount + 1) * MATRIX_SIZE);
+
+	for(int i=0; i<boneCount; ++i)
+	{
+		RBTMatrix_CPtr skinningMatrix = pose->bones(i)->absolute_matrix() * skeleton->to_bone_matrix(i);
+
+		float *dest = &m_matrices[(i + 1) * MATRIX_SIZE];
+		for(int c=0; c<4; ++c)
+		{
+			for(int r=0; r<3; ++r)
+			{
+				dest[c*4 + r] = static_cast<float>((*skinningMatrix)(r,c));
+			}
+			dest[c*4 + 3] = c == 3 ? 1.0f : 0.0f;
+		}
+	}
+}
+
+}
@@ -0,0 +1,52 @@
+/***
+ * hesperus: SkinningPalette.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_SKINNINGPALETTE
+#define H_HESP_SKINNINGPALETTE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<const class Skeleton> Skeleton_CPtr;
+
+/**
+This class holds the skinning matrices for the current pose of a skeleton, i.e. the matrices
+M_n * M_{0,n}^{-1} which take a rest vertex into bone n's coordinate frame and then out again
+into the posed model's frame. They're stored as a flat array of single-precision matrices so
+that submeshes can blend them directly when they're skinned.
+
+Each matrix is stored as its four columns, each padded to four floats, so that a matrix
+occupies 16 consecutive floats. Slot 0 always holds the identity matrix (it's used for
+vertices which aren't affected by any bones); the matrix for bone n is in slot n+1.
+*/
+class SkinningPalette
+{
+	//#################### CONSTANTS ####################
+public:
+	enum { MATRIX_SIZE = 16 };
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<float> m_matrices;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	SkinningPalette();
+
+	//#################### PUBLIC METHODS ####################
+public:
+	const float *matrices() const;
+	int slot_count() const;
+	void update(const Skeleton_CPtr& skeleton);
+};
+
+}
+
+#endif
@@ -5,20 +5,68 @@
 
 #include "Submesh.h"
 
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define HESP_SSE_SKINNING
+	#include <xmmintrin.h>
+#endif
+
+#include <hesp/exceptions/Exception.h>
 #include <hesp/materials/Material.h>
-#include <hesp/math/matrices/RBTMatrix.h>
-#include "BoneHierarchy.h"
-#include "ConfiguredBone.h"
-#include "ConfiguredPose.h"
-#include "Skeleton.h"
+#include "SkinningPalette.h"
 
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
 Submesh::Submesh(const std::vector<unsigned int>& vertIndices, const std::vector<ModelVertex>& vertices,
 				 const Material_Ptr& material, const std::vector<TexCoords>& texCoords)
-:	m_vertIndices(vertIndices), m_vertices(vertices), m_vertArray(vertices.size() * 3), m_material(material)
+:	m_vertIndices(vertIndices), m_vertCount(static_cast<int>(vertices.size())), m_influenceCount(1), m_maxSlot(0),
+	m_material(material), m_vertArray(vertices.size() * 3)
 {
+	// Construct the rest position arrays.
+	m_restXs.resize(m_vertCount);
+	m_restYs.resize(m_vertCount);
+	m_restZs.resize(m_vertCount);
+	for(int i=0; i<m_vertCount; ++i)
+	{
+		const Vector3d& p0 = vertices[i].position();
+		m_restXs[i] = static_cast<float>(p0.x);
+		m_restYs[i] = static_cast<float>(p0.y);
+		m_restZs[i] = static_cast<float>(p0.z);
+	}
+
+	// Construct the influence arrays. The weights are normalized here, rather than dividing by their sum
+	// after blending. Vertices which aren't affected by the armature (i.e. no bone weights have been
+	// assigned to them) are given a single influence on the identity matrix in palette slot 0, so that
+	// their real positions are their rest positions (it's the best we can do).
+	for(int i=0; i<m_vertCount; ++i)
+	{
+		m_influenceCount = std::max(m_influenceCount, static_cast<int>(vertices[i].bone_weights().size()));
+	}
+
+	m_influenceSlots.resize(m_vertCount * m_influenceCount, 0);
+	m_influenceWeights.resize(m_vertCount * m_influenceCount, 0.0f);
+	for(int i=0, offset=0; i<m_vertCount; ++i, offset+=m_influenceCount)
+	{
+		const std::vector<BoneWeight>& boneWeights = vertices[i].bone_weights();
+		int boneWeightCount = static_cast<int>(boneWeights.size());
+
+		double boneWeightSum = 0;
+		for(int j=0; j<boneWeightCount; ++j) boneWeightSum += boneWeights[j].weight();
+
+		if(boneWeightSum > 0)
+		{
+			for(int j=0; j<boneWeightCount; ++j)
+			{
+				m_influenceSlots[offset+j] = boneWeights[j].bone_index() + 1;
+				m_influenceWeights[offset+j] = static_cast<float>(boneWeights[j].weight() / boneWeightSum);
+				m_maxSlot = std::max(m_maxSlot, m_influenceSlots[offset+j]);
+			}
+		}
+		else m_influenceWeights[offset] = 1.0f;
+	}
+
 	if(m_material->uses_texcoords())
 	{
 		// Construct the tex coord array.
@@ -40,7 +88,7 @@ void Submesh::render() const
 	glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT);
 
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_DOUBLE, 0, &m_vertArray[0]);
+	glVertexPointer(3, GL_FLOAT, 0, &m_vertArray[0]);
 
 	if(m_material->uses_texcoords())
 	{
@@ -56,7 +104,14 @@ void Submesh::render() const
 	glPopClientAttrib();
 }
 
-void Submesh::skin(const Skeleton_CPtr& skeleton)
+/**
+Skins the submesh, i.e. calculates the real positions of its vertices for the pose whose
+skinning matrices are in the specified palette.
+
+@param palette		The skinning palette
+@throws Exception	If the submesh refers to bones which aren't in the palette
+*/
+void Submesh::skin(const SkinningPalette& palette)
 {
 	/*
 	Linear Blend Skinning Algorithm:
@@ -64,62 +119,71 @@ void Submesh::skin(const Skeleton_CPtr& skeleton)
 	P = (\sum_i w_i * M_i * M_{0,i}^{-1}) * P_0 / (sum i w_i)
 
 	Each M_{0,i}^{-1} matrix gets P_0 (the rest vertex) into its corresponding bone's coordinate frame.
-	We construct matrices M_n * M_{0,n}^-1 for each n in advance to avoid repeating calculations.
-	I refer to these in the code as the 'skinning matrices'.
+	The palette contains the matrices M_n * M_{0,n}^-1 for each n (the 'skinning matrices'), and the
+	weights have already been normalized, so for each vertex we just blend the relevant skinning
+	matrices and apply the result to P_0.
 	*/
 
-	BoneHierarchy_CPtr boneHierarchy = skeleton->bone_hierarchy();
-	ConfiguredPose_CPtr pose = skeleton->get_pose();
-	int boneCount = boneHierarchy->bone_count();
-
-	// Construct the skinning matrices.
-	std::vector<RBTMatrix_CPtr> skinningMatrices(boneCount);
-	for(int i=0; i<boneCount; ++i)
-	{
-		skinningMatrices[i] = pose->bones(i)->absolute_matrix() * skeleton->to_bone_matrix(i);
-	}
+	if(m_maxSlot >= palette.slot_count()) throw Exception("The submesh refers to bones which are not in the skeleton");
 
-	// Build the vertex array.
-	RBTMatrix_Ptr m = RBTMatrix::zeros();		// used as an accumulator for \sum_i w_i * M_i * M_{0,i}^{-1}
+	const float *matrices = palette.matrices();
+	const int *slots = m_influenceSlots.empty() ? NULL : &m_influenceSlots[0];
+	const float *weights = m_influenceWeights.empty() ? NULL : &m_influenceWeights[0];
+	const float *xs = m_restXs.empty() ? NULL : &m_restXs[0];
+	const float *ys = m_restYs.empty() ? NULL : &m_restYs[0];
+	const float *zs = m_restZs.empty() ? NULL : &m_restZs[0];
+	GLfloat *out = m_vertArray.empty() ? NULL : &m_vertArray[0];
+	const int n = m_influenceCount;
+	const int M = SkinningPalette::MATRIX_SIZE;
 
-	int vertCount = static_cast<int>(m_vertices.size());
-	for(int i=0, offset=0; i<vertCount; ++i, offset+=3)
+	for(int i=0; i<m_vertCount; ++i, out+=3, slots+=n, weights+=n)
 	{
-		const Vector3d& p0 = m_vertices[i].position();
-		const std::vector<BoneWeight>& boneWeights = m_vertices[i].bone_weights();
-		int boneWeightCount = static_cast<int>(boneWeights.size());
-
-		Vector3d p;
-		if(boneWeightCount != 0)
+#ifdef HESP_SSE_SKINNING
+		// Blend the columns of the skinning matrices.
+		const float *m = matrices + slots[0] * M;
+		__m128 w = _mm_set1_ps(weights[0]);
+		__m128 c0 = _mm_mul_ps(w, _mm_loadu_ps(m));
+		__m128 c1 = _mm_mul_ps(w, _mm_loadu_ps(m + 4));
+		__m128 c2 = _mm_mul_ps(w, _mm_loadu_ps(m + 8));
+		__m128 c3 = _mm_mul_ps(w, _mm_loadu_ps(m + 12));
+		for(int j=1; j<n; ++j)
 		{
-			double boneWeightSum = 0;
-
-			for(int j=0; j<boneWeightCount; ++j)
-			{
-				int boneIndex = boneWeights[j].bone_index();
-				double boneWeight = boneWeights[j].weight();
-				boneWeightSum += boneWeight;
-				m->add_scaled(skinningMatrices[boneIndex], boneWeight);
-			}
-
-			// Note: This is effectively p = m*p0 (if we think of p0 as (p0.x, p0.y, p0.z, 1)).
-			p = m->apply_to_point(p0);
-			p /= boneWeightSum;
-
-			// Reset the accumulator matrix ready for the next vertex.
-			m->reset_to_zeros();
+			m = matrices + slots[j] * M;
+			w = _mm_set1_ps(weights[j]);
+			c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
 		}
-		else
+
+		// Note: This is effectively p = m*p0 (if we think of p0 as (p0.x, p0.y, p0.z, 1)).
+		__m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(xs[i])), _mm_mul_ps(c1, _mm_set1_ps(ys[i]))),
+							  _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(zs[i])), c3));
+
+		float result[4];
+		_mm_storeu_ps(result, p);
+		out[0] = result[0];
+		out[1] = result[1];
+		out[2] = result[2];
+#else
+		// Blend the columns of the skinning matrices.
+		float c[16] = {0};
+		for(int j=0; j<n; ++j)
 		{
-			// If this vertex is unaffected by the armature (i.e. no bone weights have been assigned to it),
-			// use its rest position as its real position (it's the best we can do).
-			p = p0;
+			const float *m = matrices + slots[j] * M;
+			const float w = weights[j];
+			for(int k=0; k<16; ++k) c[k] += w * m[k];
 		}
 
-		m_vertArray[offset] = p.x;
-		m_vertArray[offset+1] = p.y;
-		m_vertArray[offset+2] = p.z;
+		const float x = xs[i], y = ys[i], z = zs[i];
+		for(int k=0; k<3; ++k) out[k] = c[k]*x + c[k+4]*y + c[k+8]*z + c[k+12];
+#endif
 	}
 }
 
+const std::vector<GLfloat>& Submesh::vertex_array() const
+{
+	return m_vertArray;
+}
+
 }
@@ -17,20 +17,37 @@ namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
 typedef shared_ptr<class Material> Material_Ptr;
-typedef shared_ptr<const class Skeleton> Skeleton_CPtr;
+class SkinningPalette;
 
+/**
+This class represents a submesh of a skinned mesh. The rest positions of its vertices are
+stored in single-precision structure-of-arrays form, together with a fixed number of bone
+influences per vertex, so that skinning can blend the palette matrices for each vertex
+without any allocation (using SSE where it's available).
+*/
 class Submesh
 {
 	//#################### PRIVATE VARIABLES ####################
 private:
 	std::vector<unsigned int> m_vertIndices;
-	std::vector<ModelVertex> m_vertices;
+	int m_vertCount;
+
+	// The rest positions of the vertices.
+	std::vector<float> m_restXs, m_restYs, m_restZs;
+
+	// The bone influences for each vertex: these are stored as the palette slots and normalized
+	// weights of vertex 0's influences, followed by those of vertex 1, etc. Vertices with fewer than
+	// the maximum number of influences are padded with zero-weight influences.
+	int m_influenceCount;
+	int m_maxSlot;									// the highest palette slot used by any of the influences
+	std::vector<int> m_influenceSlots;
+	std::vector<float> m_influenceWeights;
 
 	Material_Ptr m_material;
 	std::vector<GLdouble> m_texCoordArray;	// the tex coord array is empty if we're using a basic material
 
 	// Note: The vertex array is created as necessary using the skin() method.
-	std::vector<GLdouble> m_vertArray;
+	std::vector<GLfloat> m_vertArray;
 
 	//#################### CONSTRUCTORS ####################
 public:
@@ -39,7 +56,8 @@ public:
 	//#################### PUBLIC METHODS ####################
 public:
 	void render() const;
-	void skin(const Skeleton_CPtr& skeleton);
+	void skin(const SkinningPalette& palette);
+	const std::vector<GLfloat>& vertex_array() const;
 };
 
 //#################### TYPEDEFS ####################
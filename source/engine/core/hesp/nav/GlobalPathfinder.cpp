@@ -5,8 +5,15 @@
 
 #include "GlobalPathfinder.h"
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <queue>
 
+#include <hesp/exceptions/Exception.h>
+
+#include "AdjacencyList.h"
+#include "LinkPathCache.h"
 #include "NavLink.h"
 #include "NavMesh.h"
 #include "NavPolygon.h"
@@ -17,28 +24,156 @@ namespace hesp {
 //#################### CONSTRUCTORS ####################
 GlobalPathfinder::GlobalPathfinder(const NavMesh_CPtr& navMesh, const AdjacencyList_CPtr& adjList,
 								   const PathTable_CPtr& pathTable)
-:	m_navMesh(navMesh), m_adjList(adjList), m_pathTable(pathTable)
+:	m_navMesh(navMesh), m_adjList(adjList), m_pathTable(pathTable),
+	m_blockedPolygons(navMesh->polygons().size()), m_searchGeneration(0)
 {}
 
 //#################### PUBLIC METHODS ####################
 /**
 Tries to find a (high-level) path from sourcePos in sourcePoly to destPos in destPoly.
 
+@param sourcePos		The source position
+@param sourcePoly		The source nav polygon
+@param destPos			The destination position
+@param destPoly			The destination nav polygon
+@param path				Used to return the path (if found) to the caller
+@param pathCache		An optional cache of path-table paths (for this pathfinder's path table)
+@param maxExpansions	The maximum number of nodes to expand if an A* search is needed
+@return					true, if a path was found, or false otherwise
+*/
+bool GlobalPathfinder::find_path(const Vector3d& sourcePos, int sourcePoly,
+								 const Vector3d& destPos, int destPoly,
+								 std::list<int>& path, LinkPathCache *pathCache, int maxExpansions) const
+{
+	// Steps 1 and 2:	Look for an acceptable path-table path.
+	if(find_table_path(sourcePos, sourcePoly, destPos, destPoly, path, pathCache)) return true;
+
+	// Step 3:	If a reasonable unblocked path-table path does not exist, do an A* search on
+	//			the adjacency list representation of the navigation graph. Use a temporary node
+	//			in both the source and destination polygons to represent the actual position of
+	//			the player.
+	// Step 4:	If an A* path was found, use it. Otherwise, no valid path exists.
+	return find_astar_path(sourcePos, sourcePoly, destPos, destPoly, path, maxExpansions);
+}
+
+/**
+Does an A* search on the adjacency list representation of the navigation graph (whose nodes are the navlinks).
+A temporary source node is connected to the out links of the source polygon, and the in links of the destination
+polygon are connected to a temporary destination node. The straight-line distance from the end of a link to the
+destination position is used as the heuristic. Since the graph's edge costs don't include the distances spanned
+by the links themselves (e.g. step links), this can very slightly overestimate, so closed nodes are reopened if a
+cheaper path to them is found.
+
+The search gives up (and fails) once it has expanded maxExpansions nodes without reaching the destination,
+so that the time taken by a single query is bounded even if the destination can't be reached.
+
+@param sourcePos		The source position
+@param sourcePoly		The source nav polygon
+@param destPos			The destination position
+@param destPoly			The destination nav polygon
+@param path				Used to return the path (if found) to the caller
+@param maxExpansions	The maximum number of nodes to expand
+@return					true, if a path was found, or false otherwise
+*/
+bool GlobalPathfinder::find_astar_path(const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly,
+									   std::list<int>& path, int maxExpansions) const
+{
+	const std::vector<NavLink_Ptr>& links = m_navMesh->links();
+	const std::vector<NavPolygon_Ptr>& polygons = m_navMesh->polygons();
+	const int linkCount = static_cast<int>(links.size());
+	const int sourceNode = linkCount, destNode = linkCount + 1;
+
+	// Start a new search generation (this implicitly resets every node). The node array is only
+	// reset for real if the navmesh has grown or the generation counter is about to wrap round.
+	if(static_cast<int>(m_searchNodes.size()) != linkCount + 2 || m_searchGeneration == std::numeric_limits<int>::max())
+	{
+		SearchNode initialNode = { 0, 0.0f, -1, false };
+		m_searchNodes.assign(linkCount + 2, initialNode);
+		m_searchGeneration = 0;
+	}
+	++m_searchGeneration;
+	m_openList.clear();
+
+	open_node(sourceNode, 0.0f, static_cast<float>(sourcePos.distance(destPos)), -1);
+
+	int expansions = 0;
+	while(!m_openList.empty())
+	{
+		std::pop_heap(m_openList.begin(), m_openList.end(), std::greater<OpenEntry>());
+		OpenEntry entry = m_openList.back();
+		m_openList.pop_back();
+
+		// Skip the entry if a cheaper path to its node has been found since it was added.
+		SearchNode& cur = m_searchNodes[entry.node];
+		if(cur.closed || entry.g > cur.g) continue;
+		cur.closed = true;
+
+		if(entry.node == destNode)
+		{
+			path.clear();
+			for(int n=cur.parent; n!=sourceNode; n=m_searchNodes[n].parent)
+			{
+				path.push_front(n);
+			}
+			return true;
+		}
+
+		if(++expansions > maxExpansions) return false;
+
+		if(entry.node == sourceNode)
+		{
+			const std::vector<int>& outLinks = polygons[sourcePoly]->out_links();
+			for(size_t i=0, size=outLinks.size(); i<size; ++i)
+			{
+				int link = outLinks[i];
+				if(is_link_blocked(link, sourcePoly, destPoly)) continue;
+				float g = static_cast<float>(sourcePos.distance(links[link]->source_position()));
+				open_node(link, g, static_cast<float>(links[link]->dest_position().distance(destPos)), sourceNode);
+			}
+		}
+		else
+		{
+			const NavLink& link = *links[entry.node];
+			if(link.dest_poly() == destPoly)
+			{
+				float g = entry.g + static_cast<float>(link.dest_position().distance(destPos));
+				open_node(destNode, g, 0.0f, entry.node);
+			}
+
+			const std::list<AdjacencyList::Edge>& edges = m_adjList->adjacent_edges(entry.node);
+			for(std::list<AdjacencyList::Edge>::const_iterator it=edges.begin(), iend=edges.end(); it!=iend; ++it)
+			{
+				int toNode = it->to_node();
+				if(is_link_blocked(toNode, sourcePoly, destPoly)) continue;
+				open_node(toNode, entry.g + it->length(), static_cast<float>(links[toNode]->dest_position().distance(destPos)), entry.node);
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+Tries to find a (high-level) path from sourcePos in sourcePoly to destPos in destPoly using
+only the path table (this is cheap, but fails if all the reasonable path-table paths are blocked).
+
 @param sourcePos	The source position
 @param sourcePoly	The source nav polygon
 @param destPos		The destination position
 @param destPoly		The destination nav polygon
 @param path			Used to return the path (if found) to the caller
+@param pathCache	An optional cache of path-table paths (for this pathfinder's path table)
 @return				true, if a path was found, or false otherwise
 */
-bool GlobalPathfinder::find_path(const Vector3d& sourcePos, int sourcePoly,
-								 const Vector3d& destPos, int destPoly,
-								 std::list<int>& path) const
+bool GlobalPathfinder::find_table_path(const Vector3d& sourcePos, int sourcePoly,
+									   const Vector3d& destPos, int destPoly,
+									   std::list<int>& path, LinkPathCache *pathCache) const
 {
 	// Step 1:	If the source position and dest position are both in the same nav polygon,
 	//			the high-level path is empty (the entity just needs to go in a straight line).
 	if(sourcePoly == destPoly)
 	{
+		path.clear();
 		return true;
 	}
 
@@ -88,31 +223,126 @@ bool GlobalPathfinder::find_path(const Vector3d& sourcePos, int sourcePoly,
 			if(desc.cost > WORST_ACCEPTABLE_COST) break;
 			pq.pop();
 
-			path = m_pathTable->construct_path(desc.sourceLink, desc.destLink);
+			if(pathCache)
+			{
+				LinkPathCache::LinkPath_CPtr cachedPath = pathCache->construct_path(desc.sourceLink, desc.destLink);
+				if(!is_blocked(*cachedPath, sourcePoly, destPoly))
+				{
+					path = *cachedPath;
+					return true;
+				}
+			}
+			else
+			{
+				path = m_pathTable->construct_path(desc.sourceLink, desc.destLink);
 
-			if(!is_blocked(sourcePos, path, destPos))
-				return true;	// note that the path to be returned has already been stored in the out parameter
+				if(!is_blocked(path, sourcePoly, destPoly))
+					return true;	// note that the path to be returned has already been stored in the out parameter
+			}
 		}
 	}
 
-	// Step 3:	If a reasonable unblocked path-table path does not exist, do an A* search on
-	//			the adjacency list representation of the navigation graph. Use a temporary node
-	//			in both the source and destination polygons to represent the actual position of
-	//			the player.
-	// TODO
+	return false;
+}
 
-	// Step 4:	If an A* path was found, use it. Otherwise, no valid path exists.
-	// TODO
+/**
+Returns whether or not the specified nav polygon is currently blocked.
 
-	// NYI
-	return false;
+@param poly	The index of the nav polygon
+@return		true, if the polygon is blocked, or false otherwise
+*/
+bool GlobalPathfinder::is_polygon_blocked(int poly) const
+{
+	return m_blockedPolygons.test(poly);
+}
+
+/**
+Marks the specified nav polygon as blocked or unblocked (e.g. when a dynamic obstacle
+moves into or out of it). Paths are not allowed to pass through blocked polygons, but
+they can still start or end in them (so an agent is never blocked by its own polygon).
+
+@param poly			The index of the nav polygon
+@param blocked		Whether or not the polygon should be blocked
+@throws Exception	If the polygon index is out of range
+*/
+void GlobalPathfinder::set_polygon_blocked(int poly, bool blocked)
+{
+	if(poly < 0 || poly >= static_cast<int>(m_blockedPolygons.size())) throw Exception("set_polygon_blocked: Nav polygon index out of range");
+	m_blockedPolygons.set(poly, blocked);
+}
+
+/**
+Replaces the current set of blocked nav polygons with the specified set (e.g. the polygons
+occupied by the dynamic obstacles in the level at the start of a frame).
+
+@param polys		The indices of the nav polygons which should be blocked (duplicates are allowed)
+@throws Exception	If any of the polygon indices is out of range
+*/
+void GlobalPathfinder::set_blocked_polygons(const std::vector<int>& polys)
+{
+	m_blockedPolygons.reset();
+	for(size_t i=0, size=polys.size(); i<size; ++i)
+	{
+		set_polygon_blocked(polys[i], true);
+	}
 }
 
 //#################### PRIVATE METHODS ####################
-bool GlobalPathfinder::is_blocked(const Vector3d& sourcePos, const std::list<int>& potentialPath, const Vector3d& destPos) const
+/**
+Checks whether the specified path passes through any blocked nav polygons.
+
+@param potentialPath	The path (a sequence of navlink indices)
+@param sourcePoly		The source nav polygon (which the path may re-enter even if it's blocked)
+@param destPoly			The destination nav polygon (which the path may enter even if it's blocked)
+@return					true, if the path is blocked, or false otherwise
+*/
+bool GlobalPathfinder::is_blocked(const std::list<int>& potentialPath, int sourcePoly, int destPoly) const
 {
-	// NYI
+	if(m_blockedPolygons.none()) return false;
+
+	for(std::list<int>::const_iterator it=potentialPath.begin(), iend=potentialPath.end(); it!=iend; ++it)
+	{
+		if(is_link_blocked(*it, sourcePoly, destPoly)) return true;
+	}
 	return false;
 }
 
+/**
+Checks whether the specified navlink leads into a blocked nav polygon. The source polygon is
+never treated as blocked, since the querying agent is already there (and is usually the reason
+it's blocked in the first place), and nor is the destination polygon.
+
+@param link			The index of the navlink
+@param sourcePoly	The source nav polygon
+@param destPoly		The destination nav polygon
+@return				true, if the link is blocked, or false otherwise
+*/
+bool GlobalPathfinder::is_link_blocked(int link, int sourcePoly, int destPoly) const
+{
+	int linkDestPoly = m_navMesh->links()[link]->dest_poly();
+	return linkDestPoly != sourcePoly && linkDestPoly != destPoly && m_blockedPolygons.test(linkDestPoly);
+}
+
+/**
+Adds a node to the open list, unless the best known path to it is already at least as cheap.
+
+@param node		The node
+@param g		The cost of the new path to the node
+@param h		The estimated cost from the node to the destination
+@param parent	The node's predecessor on the new path
+*/
+void GlobalPathfinder::open_node(int node, float g, float h, int parent) const
+{
+	SearchNode& n = m_searchNodes[node];
+	if(n.stamp == m_searchGeneration && g >= n.g) return;
+
+	n.stamp = m_searchGeneration;
+	n.g = g;
+	n.parent = parent;
+	n.closed = false;
+
+	m_openList.push_back(OpenEntry(g + h, g, node));
+	std::push_heap(m_openList.begin(), m_openList.end(), std::greater<OpenEntry>());
+}
+
 }
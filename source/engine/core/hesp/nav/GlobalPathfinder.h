@@ -7,6 +7,11 @@
 #define H_HESP_GLOBALPATHFINDER
 
 #include <list>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
 
 #include <hesp/math/vectors/Vector3.h>
 
@@ -14,6 +19,7 @@ namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
 typedef shared_ptr<const class AdjacencyList> AdjacencyList_CPtr;
+class LinkPathCache;
 typedef shared_ptr<const class NavMesh> NavMesh_CPtr;
 typedef shared_ptr<const class PathTable> PathTable_CPtr;
 
@@ -22,6 +28,14 @@ This class provides global (high-level) pathfinding, i.e.
 it allows us to find a path from one side of the level to
 the other. There should be one of these for each navmesh,
 i.e. one for each AABB map.
+
+Nav polygons can be marked as blocked (e.g. by dynamic obstacles),
+in which case paths through them are rejected and A* is used to find
+a way round them. The A* search works in storage that is kept between
+queries, so a pathfinder must not be used by several threads at once.
+It gives up after expanding a maximum number of nodes, so that a query
+which can't succeed (e.g. because the destination has been cut off)
+doesn't end up searching the whole navigation graph.
 */
 class GlobalPathfinder
 {
@@ -43,23 +57,72 @@ private:
 		}
 	};
 
+	/**
+	The A* state of a node in the search graph. The state is only valid if stamp matches the
+	generation of the current search: this means that starting a new search doesn't involve
+	resetting every node.
+	*/
+	struct SearchNode
+	{
+		int stamp;
+		float g;		// the cost of the best known path from the source to this node
+		int parent;
+		bool closed;
+	};
+
+	struct OpenEntry
+	{
+		float f;
+		float g;
+		int node;
+
+		OpenEntry(float f_, float g_, int node_)
+		:	f(f_), g(g_), node(node_)
+		{}
+
+		bool operator>(const OpenEntry& rhs) const
+		{
+			return f > rhs.f;
+		}
+	};
+
+	//#################### CONSTANTS ####################
+public:
+	enum { DEFAULT_MAX_EXPANSIONS = 10000 };
+
 	//#################### PRIVATE VARIABLES ####################
 private:
 	NavMesh_CPtr m_navMesh;
 	AdjacencyList_CPtr m_adjList;
 	PathTable_CPtr m_pathTable;
 
+	boost::dynamic_bitset<> m_blockedPolygons;
+
+	// The working storage for the A* search (one node per navlink, plus the temporary source and destination nodes)
+	mutable std::vector<SearchNode> m_searchNodes;
+	mutable std::vector<OpenEntry> m_openList;		// a binary heap ordered by f
+	mutable int m_searchGeneration;
+
 	//#################### CONSTRUCTORS ####################
 public:
 	GlobalPathfinder(const NavMesh_CPtr& navMesh, const AdjacencyList_CPtr& adjList, const PathTable_CPtr& pathTable);
 
 	//#################### PUBLIC METHODS ####################
 public:
-	bool find_path(const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly, std::list<int>& path) const;
+	bool find_astar_path(const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly, std::list<int>& path,
+						 int maxExpansions = DEFAULT_MAX_EXPANSIONS) const;
+	bool find_path(const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly, std::list<int>& path,
+				   LinkPathCache *pathCache = NULL, int maxExpansions = DEFAULT_MAX_EXPANSIONS) const;
+	bool find_table_path(const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly, std::list<int>& path, LinkPathCache *pathCache = NULL) const;
+	bool is_polygon_blocked(int poly) const;
+	void set_blocked_polygons(const std::vector<int>& polys);
+	void set_polygon_blocked(int poly, bool blocked);
 
 	//#################### PRIVATE METHODS ####################
 private:
-	bool is_blocked(const Vector3d& sourcePos, const std::list<int>& potentialPath, const Vector3d& destPos) const;
+	bool is_blocked(const std::list<int>& potentialPath, int sourcePoly, int destPoly) const;
+	bool is_link_blocked(int link, int sourcePoly, int destPoly) const;
+	void open_node(int node, float g, float h, int parent) const;
 };
 
 //#################### TYPEDEFS ####################
@@ -0,0 +1,88 @@
+/***
+ * hesperus: LinkPathCache.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "LinkPathCache.h"
+
+#include <hesp/exceptions/Exception.h>
+#include "PathTable.h"
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs an empty cache.
+
+@param pathTable	The path table from which to construct paths
+@param capacity		The maximum number of paths to cache
+@throws Exception	If the capacity is less than 1
+*/
+LinkPathCache::LinkPathCache(const PathTable_CPtr& pathTable, int capacity)
+:	m_pathTable(pathTable), m_capacity(capacity), m_hits(0), m_misses(0)
+{
+	if(capacity < 1) throw Exception("The capacity of a link path cache must be at least 1");
+}
+
+//#################### PUBLIC METHODS ####################
+int LinkPathCache::capacity() const
+{
+	return m_capacity;
+}
+
+void LinkPathCache::clear()
+{
+	m_usageList.clear();
+	m_lookup.clear();
+}
+
+/**
+Returns the path-table path between the specified links, constructing it
+from the path table only if it isn't already in the cache.
+
+@param sourceLink	The index of the source link
+@param destLink		The index of the dest link
+@return				The path, as a sequence of link indices
+*/
+LinkPathCache::LinkPath_CPtr LinkPathCache::construct_path(int sourceLink, int destLink)
+{
+	Key key(sourceLink, destLink);
+	std::map<Key,UsageList::iterator>::iterator it = m_lookup.find(key);
+	if(it != m_lookup.end())
+	{
+		// Move the path to the front of the usage list to mark it as the most recently used.
+		m_usageList.splice(m_usageList.begin(), m_usageList, it->second);
+		++m_hits;
+		return it->second->second;
+	}
+
+	++m_misses;
+	LinkPath_CPtr path(new std::list<int>(m_pathTable->construct_path(sourceLink, destLink)));
+
+	if(static_cast<int>(m_usageList.size()) == m_capacity)
+	{
+		m_lookup.erase(m_usageList.back().first);
+		m_usageList.pop_back();
+	}
+
+	m_usageList.push_front(std::make_pair(key, path));
+	m_lookup.insert(std::make_pair(key, m_usageList.begin()));
+	return path;
+}
+
+int LinkPathCache::hits() const
+{
+	return m_hits;
+}
+
+int LinkPathCache::misses() const
+{
+	return m_misses;
+}
+
+int LinkPathCache::size() const
+{
+	return static_cast<int>(m_lookup.size());
+}
+
+}
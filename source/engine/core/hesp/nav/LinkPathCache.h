@@ -0,0 +1,65 @@
+/***
+ * hesperus: LinkPathCache.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_LINKPATHCACHE
+#define H_HESP_LINKPATHCACHE
+
+#include <list>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<const class PathTable> PathTable_CPtr;
+
+/**
+This class caches the link paths constructed from a path table, keyed by their
+(source link, dest link) pairs. It holds at most a fixed number of paths: when
+it's full, the least recently used path is discarded to make room for a new one.
+*/
+class LinkPathCache
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef shared_ptr<const std::list<int> > LinkPath_CPtr;
+
+private:
+	typedef std::pair<int,int> Key;
+	typedef std::list<std::pair<Key,LinkPath_CPtr> > UsageList;
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	PathTable_CPtr m_pathTable;
+	int m_capacity;
+
+	UsageList m_usageList;						// the cached paths, from most to least recently used
+	std::map<Key,UsageList::iterator> m_lookup;
+
+	int m_hits, m_misses;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	LinkPathCache(const PathTable_CPtr& pathTable, int capacity);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	int capacity() const;
+	void clear();
+	LinkPath_CPtr construct_path(int sourceLink, int destLink);
+	int hits() const;
+	int misses() const;
+	int size() const;
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<LinkPathCache> LinkPathCache_Ptr;
+typedef shared_ptr<const LinkPathCache> LinkPathCache_CPtr;
+
+}
+
+#endif
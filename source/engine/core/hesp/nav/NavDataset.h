@@ -9,15 +9,14 @@
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
 
+#include "GlobalPathfinder.h"
+
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
 typedef shared_ptr<class AdjacencyList> AdjacencyList_Ptr;
-typedef shared_ptr<const class AdjacencyList> AdjacencyList_CPtr;
 typedef shared_ptr<class NavMesh> NavMesh_Ptr;
-typedef shared_ptr<const class NavMesh> NavMesh_CPtr;
 typedef shared_ptr<class PathTable> PathTable_Ptr;
-typedef shared_ptr<const class PathTable> PathTable_CPtr;
 
 /**
 An instance of this class stores all the necessary nav data for a particular AABB map.
@@ -29,11 +28,12 @@ private:
 	AdjacencyList_Ptr m_adjList;
 	NavMesh_Ptr m_navMesh;
 	PathTable_Ptr m_pathTable;
+	GlobalPathfinder_Ptr m_pathfinder;
 
 	//#################### CONSTRUCTORS ####################
 public:
 	NavDataset(const AdjacencyList_Ptr& adjList, const NavMesh_Ptr& navMesh, const PathTable_Ptr& pathTable)
-	:	m_adjList(adjList), m_navMesh(navMesh), m_pathTable(pathTable)
+	:	m_adjList(adjList), m_navMesh(navMesh), m_pathTable(pathTable), m_pathfinder(new GlobalPathfinder(navMesh, adjList, pathTable))
 	{}
 
 	//#################### PUBLIC METHODS ####################
@@ -44,6 +44,8 @@ public:
 	NavMesh_CPtr nav_mesh() const				{ return m_navMesh; }
 	const PathTable_Ptr& path_table()			{ return m_pathTable; }
 	PathTable_CPtr path_table() const			{ return m_pathTable; }
+	const GlobalPathfinder_Ptr& pathfinder()	{ return m_pathfinder; }
+	GlobalPathfinder_CPtr pathfinder() const	{ return m_pathfinder; }
 };
 
 //#################### TYPEDEFS ####################
@@ -27,14 +27,18 @@ NavDataset_CPtr NavManager::dataset(int index) const
 	else throw Exception("No nav dataset available for index: " + lexical_cast<std::string>(index));
 }
 
-std::map<int,NavDataset_CPtr> NavManager::datasets() const
+const std::map<int,NavDataset_CPtr>& NavManager::datasets() const
 {
-	return std::map<int,NavDataset_CPtr>(m_datasets.begin(), m_datasets.end());
+	return m_constDatasets;
 }
 
 void NavManager::set_dataset(int index, const NavDataset_Ptr& dataset)
 {
-	if(dataset != NULL) m_datasets[index] = dataset;
+	if(dataset != NULL)
+	{
+		m_datasets[index] = dataset;
+		m_constDatasets[index] = dataset;
+	}
 	else throw Exception("Must provide a valid nav dataset for index: " + lexical_cast<std::string>(index));
 }
 
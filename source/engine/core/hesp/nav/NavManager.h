@@ -22,12 +22,13 @@ class NavManager
 	//#################### PRIVATE VARIABLES ####################
 private:
 	std::map<int,NavDataset_Ptr> m_datasets;
+	std::map<int,NavDataset_CPtr> m_constDatasets;	// a read-only copy of m_datasets, so that datasets() can return it without copying it
 
 	//#################### PUBLIC METHODS ####################
 public:
 	const NavDataset_Ptr& dataset(int index);
 	NavDataset_CPtr dataset(int index) const;
-	std::map<int,NavDataset_CPtr> datasets() const;
+	const std::map<int,NavDataset_CPtr>& datasets() const;
 	void set_dataset(int index, const NavDataset_Ptr& dataset);
 };
 
@@ -0,0 +1,195 @@
+/***
+ * hesperus: PathQueryService.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "PathQueryService.h"
+
+#include <algorithm>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+using boost::lexical_cast;
+
+#include <hesp/exceptions/Exception.h>
+#include "GlobalPathfinder.h"
+#include "LinkPathCache.h"
+#include "NavDataset.h"
+#include "NavManager.h"
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs a path query service for the nav datasets of the specified nav manager.
+
+@param navManager		The nav manager
+@param cacheCapacity	The maximum number of link paths to cache for each nav dataset
+*/
+PathQueryService::PathQueryService(const NavManager_CPtr& navManager, int cacheCapacity)
+:	m_navManager(navManager), m_cacheCapacity(cacheCapacity), m_nextQueryID(0)
+{}
+
+//#################### PUBLIC METHODS ####################
+/**
+Cancels the specified query (if it's still pending) or discards its result (if not).
+
+@param id	The ID of the query
+*/
+void PathQueryService::cancel_query(int id)
+{
+	// Note that any queue entries for the query are skipped when they're reached.
+	m_results.erase(id);
+}
+
+/**
+Returns the number of queries which have been submitted but not yet processed.
+
+@return	As stated
+*/
+int PathQueryService::pending_query_count() const
+{
+	int count = 0;
+	for(std::map<int,Result>::const_iterator it=m_results.begin(), iend=m_results.end(); it!=iend; ++it)
+	{
+		if(it->second.status == QUERY_PENDING) ++count;
+	}
+	return count;
+}
+
+/**
+Processes pending queries until either there are none left or the time budget runs out.
+The cheap path-table queries are processed before any of the A* searches. At least one
+query is processed on each call (if there are any), so every query is answered in the end,
+however small the budget. A negative budget means that all the pending queries should be
+processed, which makes the results independent of how fast the machine is.
+
+@param budgetMicroseconds	The amount of time which may be spent processing queries (or a negative number, for no limit)
+*/
+void PathQueryService::process_queries(int budgetMicroseconds)
+{
+	using namespace boost::posix_time;
+	const bool limited = budgetMicroseconds >= 0;
+	const ptime deadline = microsec_clock::universal_time() + microseconds(std::max(budgetMicroseconds, 0));
+	bool processedAny = false;
+
+	while(!m_tableQueue.empty())
+	{
+		if(limited && processedAny && microsec_clock::universal_time() >= deadline) return;
+
+		Query query = m_tableQueue.front();
+		m_tableQueue.pop_front();
+
+		std::map<int,Result>::iterator it = m_results.find(query.id);
+		if(it == m_results.end()) continue;		// the query was cancelled
+
+		process_table_query(query, it->second);
+		processedAny = true;
+	}
+
+	while(!m_searchQueue.empty())
+	{
+		if(limited && processedAny && microsec_clock::universal_time() >= deadline) return;
+
+		Query query = m_searchQueue.front();
+		m_searchQueue.pop_front();
+
+		std::map<int,Result>::iterator it = m_results.find(query.id);
+		if(it == m_results.end()) continue;		// the query was cancelled
+
+		Result& result = it->second;
+		process_search_query(query, result);
+		processedAny = true;
+
+		// Any other queued searches for exactly the same path can use the result.
+		for(std::list<Query>::iterator jt=m_searchQueue.begin(), jend=m_searchQueue.end(); jt!=jend;)
+		{
+			if(jt->same_search_as(query))
+			{
+				std::map<int,Result>::iterator kt = m_results.find(jt->id);
+				if(kt != m_results.end()) kt->second = result;
+				m_searchQueue.erase(jt++);
+			}
+			else ++jt;
+		}
+	}
+}
+
+/**
+Submits a query for a path from sourcePos in sourcePoly to destPos in destPoly in the
+specified nav dataset. The query will be processed on a subsequent call to process_queries().
+
+@param mapIndex		The index of the nav dataset (i.e. of the AABB map)
+@param sourcePos	The source position
+@param sourcePoly	The source nav polygon
+@param destPos		The destination position
+@param destPoly		The destination nav polygon
+@return				The ID of the query (to be passed to take_result() or cancel_query())
+@throws Exception	If there's no nav dataset with the specified index
+*/
+int PathQueryService::submit_query(int mapIndex, const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly)
+{
+	m_navManager->dataset(mapIndex);	// check that the dataset exists (this throws if not)
+
+	Query query;
+	query.id = m_nextQueryID++;
+	query.mapIndex = mapIndex;
+	query.sourcePos = sourcePos;
+	query.sourcePoly = sourcePoly;
+	query.destPos = destPos;
+	query.destPoly = destPoly;
+	m_tableQueue.push_back(query);
+
+	m_results[query.id].status = QUERY_PENDING;
+	return query.id;
+}
+
+/**
+Checks whether the specified query has been processed. If it has, its result is returned
+(and then discarded by the service).
+
+@param id			The ID of the query
+@param path			Used to return the path to the caller (if the query succeeded)
+@return				The status of the query
+@throws Exception	If the query is unknown (e.g. because its result has already been taken)
+*/
+PathQueryService::QueryStatus PathQueryService::take_result(int id, std::list<int>& path)
+{
+	std::map<int,Result>::iterator it = m_results.find(id);
+	if(it == m_results.end()) throw Exception("Unknown path query: " + lexical_cast<std::string>(id));
+
+	QueryStatus status = it->second.status;
+	if(status != QUERY_PENDING)
+	{
+		path.swap(it->second.path);
+		m_results.erase(it);
+	}
+	return status;
+}
+
+//#################### PRIVATE METHODS ####################
+const LinkPathCache_Ptr& PathQueryService::path_cache(int mapIndex)
+{
+	LinkPathCache_Ptr& pathCache = m_pathCaches[mapIndex];
+	if(!pathCache) pathCache.reset(new LinkPathCache(m_navManager->dataset(mapIndex)->path_table(), m_cacheCapacity));
+	return pathCache;
+}
+
+void PathQueryService::process_search_query(const Query& query, Result& result)
+{
+	GlobalPathfinder_CPtr pathfinder = m_navManager->dataset(query.mapIndex)->pathfinder();
+	bool pathFound = pathfinder->find_astar_path(query.sourcePos, query.sourcePoly, query.destPos, query.destPoly, result.path);
+	result.status = pathFound ? QUERY_SUCCEEDED : QUERY_FAILED;
+}
+
+void PathQueryService::process_table_query(const Query& query, Result& result)
+{
+	GlobalPathfinder_CPtr pathfinder = m_navManager->dataset(query.mapIndex)->pathfinder();
+	if(pathfinder->find_table_path(query.sourcePos, query.sourcePoly, query.destPos, query.destPoly, result.path, path_cache(query.mapIndex).get()))
+	{
+		result.status = QUERY_SUCCEEDED;
+	}
+	else m_searchQueue.push_back(query);
+}
+
+}
@@ -0,0 +1,114 @@
+/***
+ * hesperus: PathQueryService.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_PATHQUERYSERVICE
+#define H_HESP_PATHQUERYSERVICE
+
+#include <deque>
+#include <list>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <hesp/math/vectors/Vector3.h>
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<class LinkPathCache> LinkPathCache_Ptr;
+typedef shared_ptr<const class NavManager> NavManager_CPtr;
+
+/**
+This class answers (high-level) path queries for all the AI agents in a level. Rather
+than each agent calling GlobalPathfinder::find_path() directly, agents submit queries,
+which are processed in batches (typically once per frame) and whose results can be
+collected later on.
+
+Queries are first tried against the path table, with the constructed link paths being
+cached (per nav dataset) in a bounded LRU cache keyed by (source link, dest link), so
+that agents heading the same way share the same path. Queries which need an A* search
+are queued and processed in order for as long as the per-batch time budget allows, so
+the cost per frame stays roughly flat however many agents there are. Identical queued
+searches are only done once. Note that searches which merely share a pair of nav polygons
+are not merged, since the positions within the polygons affect the path found by A*.
+*/
+class PathQueryService
+{
+	//#################### ENUMERATIONS ####################
+public:
+	enum QueryStatus
+	{
+		QUERY_FAILED,		// no path could be found
+		QUERY_PENDING,		// the query has yet to be processed
+		QUERY_SUCCEEDED		// a path was found
+	};
+
+	//#################### CONSTANTS ####################
+public:
+	enum { DEFAULT_CACHE_CAPACITY = 512 };
+
+	//#################### NESTED CLASSES ####################
+private:
+	struct Query
+	{
+		int id;
+		int mapIndex;
+		Vector3d sourcePos;
+		int sourcePoly;
+		Vector3d destPos;
+		int destPoly;
+
+		bool same_search_as(const Query& rhs) const
+		{
+			return mapIndex == rhs.mapIndex && sourcePoly == rhs.sourcePoly && destPoly == rhs.destPoly &&
+				   sourcePos.x == rhs.sourcePos.x && sourcePos.y == rhs.sourcePos.y && sourcePos.z == rhs.sourcePos.z &&
+				   destPos.x == rhs.destPos.x && destPos.y == rhs.destPos.y && destPos.z == rhs.destPos.z;
+		}
+	};
+
+	struct Result
+	{
+		QueryStatus status;
+		std::list<int> path;
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	NavManager_CPtr m_navManager;
+	int m_cacheCapacity;
+	std::map<int,LinkPathCache_Ptr> m_pathCaches;	// the link path caches for the nav datasets (created on demand)
+
+	int m_nextQueryID;
+	std::deque<Query> m_tableQueue;					// queries which have yet to be tried against the path table
+	std::list<Query> m_searchQueue;					// queries which need an A* search
+	std::map<int,Result> m_results;					// the results of the queries which have not yet been collected or cancelled
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit PathQueryService(const NavManager_CPtr& navManager, int cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void cancel_query(int id);
+	int pending_query_count() const;
+	void process_queries(int budgetMicroseconds);
+	int submit_query(int mapIndex, const Vector3d& sourcePos, int sourcePoly, const Vector3d& destPos, int destPoly);
+	QueryStatus take_result(int id, std::list<int>& path);
+
+	//#################### PRIVATE METHODS ####################
+private:
+	const LinkPathCache_Ptr& path_cache(int mapIndex);
+	void process_search_query(const Query& query, Result& result);
+	void process_table_query(const Query& query, Result& result);
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<PathQueryService> PathQueryService_Ptr;
+typedef shared_ptr<const PathQueryService> PathQueryService_CPtr;
+
+}
+
+#endif
@@ -6,13 +6,57 @@
 #include "PathTableGenerator.h"
 
 #include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "AdjacencyList.h"
 #include "AdjacencyTable.h"
 #include "PathTable.h"
 
 namespace hesp {
 
 //#################### PUBLIC METHODS ####################
+/**
+Generates the path table for a graph by running Dijkstra's algorithm from each of its nodes
+in turn. This takes O(n (n + e) log n) time for a graph with n nodes and e edges, which for
+the sparse graphs we get from navigation meshes is much better than the O(n^3) taken by the
+Floyd-Warshall algorithm, and it works directly on the adjacency list (so there's no need
+to build an adjacency table). Each run only writes to its own row of the path table, so the
+runs can be shared out between several threads, and the result doesn't depend on how many
+threads are used.
+
+@param adjList		The adjacency list for the graph
+@param threadCount	The number of threads to use
+@return				The path table
+*/
+PathTable_Ptr PathTableGenerator::dijkstra(const AdjacencyList& adjList, int threadCount)
+{
+	PathTable_Ptr pathTable(new PathTable(adjList.size()));
+
+	int nextSource = 0;
+	boost::mutex nextSourceMutex;
+
+	if(threadCount <= 1)
+	{
+		dijkstra_worker(adjList, *pathTable, nextSource, nextSourceMutex);
+	}
+	else
+	{
+		boost::thread_group workers;
+		for(int i=0; i<threadCount; ++i)
+		{
+			workers.create_thread(boost::bind(&PathTableGenerator::dijkstra_worker, boost::cref(adjList), boost::ref(*pathTable), boost::ref(nextSource), boost::ref(nextSourceMutex)));
+		}
+		workers.join_all();
+	}
+
+	return pathTable;
+}
+
 PathTable_Ptr PathTableGenerator::floyd_warshall(const AdjacencyTable& adjTable)
 {
 	// Reference: See p.558-62 of Introduction to Algorithms (Cormen, Leiserson and Rivest) 1st Ed.
@@ -39,32 +83,116 @@ PathTable_Ptr PathTableGenerator::floyd_warshall(const AdjacencyTable& adjTable)
 		}
 
 	/*
-	Run the actual Floyd-Warshall algorithm. Unfortunately it's cubic in the
-	number of nodes, so we might need to change it for a different algorithm
-	in the future (e.g. running Dijkstra's from each node using a Fib heap).
-	This would be an improvement since the graph is generally quite sparse.
+	Run the actual Floyd-Warshall algorithm. This is cubic in the number of nodes, so
+	for anything but small graphs, dijkstra() (above) should be used instead.
 
 	Note that the inductive formula for the next nodes is given by:
 
 	sigma_{ij}^k =	{ sigma_{ij}^{k-1}		if d_{ij}^{k-1} <= d_{ik}^{k-1} + d_{kj}^{k-1}
 					{ sigma_{ik}^{k-1}		otherwise
+
+	The table can be updated in place, since row k and column k don't change during
+	iteration k (d_{kk} is 0).
 	*/
 	for(int k=0; k<size; ++k)
-	{
-		PathTable_Ptr oldPathTable = pathTable;
-		pathTable.reset(new PathTable(size));
 		for(int i=0; i<size; ++i)
+		{
+			float costIK = pathTable->cost(i,k);
+			int nextIK = pathTable->next_node(i,k);
 			for(int j=0; j<size; ++j)
 			{
-				pathTable->cost(i,j) = std::min(oldPathTable->cost(i,j), oldPathTable->cost(i,k) + oldPathTable->cost(k,j));
-				if(oldPathTable->cost(i,j) <= oldPathTable->cost(i,k) + oldPathTable->cost(k,j))
-					pathTable->next_node(i,j) = oldPathTable->next_node(i,j);
-				else
-					pathTable->next_node(i,j) = oldPathTable->next_node(i,k);
+				float viaK = costIK + pathTable->cost(k,j);
+				if(viaK < pathTable->cost(i,j))
+				{
+					pathTable->cost(i,j) = viaK;
+					pathTable->next_node(i,j) = nextIK;
+				}
 			}
-	}
+		}
 
 	return pathTable;
 }
 
+//#################### PRIVATE METHODS ####################
+/**
+Runs Dijkstra's algorithm (using a binary heap) from the specified source node, and
+fills in the source's row of the path table.
+
+@param source		The source node
+@param adjList		The adjacency list for the graph
+@param pathTable	The path table
+@param costs		Working storage for the path costs (one per node)
+@param firstHops	Working storage for the first node after the source on each path (one per node)
+*/
+void PathTableGenerator::dijkstra_from(int source, const AdjacencyList& adjList, PathTable& pathTable, std::vector<float>& costs, std::vector<int>& firstHops)
+{
+	typedef std::pair<float,int> Candidate;	// (cost, node)
+
+	int size = adjList.size();
+	std::fill(costs.begin(), costs.end(), (float)INT_MAX);
+	std::fill(firstHops.begin(), firstHops.end(), -1);
+
+	// Note: Nodes can appear in the heap more than once - any entry whose cost is out-of-date is simply skipped.
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > pq;
+	costs[source] = 0.0f;
+	pq.push(Candidate(0.0f, source));
+
+	while(!pq.empty())
+	{
+		Candidate c = pq.top();
+		pq.pop();
+
+		int u = c.second;
+		if(c.first > costs[u]) continue;
+
+		const std::list<AdjacencyList::Edge>& edges = adjList.adjacent_edges(u);
+		for(std::list<AdjacencyList::Edge>::const_iterator it=edges.begin(), iend=edges.end(); it!=iend; ++it)
+		{
+			int v = it->to_node();
+			float cost = costs[u] + it->length();
+			if(cost < costs[v])
+			{
+				costs[v] = cost;
+				firstHops[v] = u == source ? v : firstHops[u];
+				pq.push(Candidate(cost, v));
+			}
+		}
+	}
+
+	for(int j=0; j<size; ++j)
+	{
+		if(j == source) continue;
+		pathTable.cost(source,j) = costs[j];
+		pathTable.next_node(source,j) = firstHops[j];
+	}
+}
+
+/**
+Repeatedly takes the next source node and runs Dijkstra's algorithm from it, until
+there are no source nodes left.
+
+@param adjList			The adjacency list for the graph
+@param pathTable		The path table
+@param nextSource		The next source node to process (shared between the workers)
+@param nextSourceMutex	The mutex protecting nextSource
+*/
+void PathTableGenerator::dijkstra_worker(const AdjacencyList& adjList, PathTable& pathTable, int& nextSource, boost::mutex& nextSourceMutex)
+{
+	int size = adjList.size();
+	std::vector<float> costs(size);
+	std::vector<int> firstHops(size);
+
+	for(;;)
+	{
+		int source;
+		{
+			boost::mutex::scoped_lock lock(nextSourceMutex);
+			if(nextSource == size) return;
+			source = nextSource++;
+		}
+
+		dijkstra_from(source, adjList, pathTable, costs, firstHops);
+	}
+}
+
 }
@@ -6,19 +6,29 @@
 #ifndef H_HESP_PATHTABLEGENERATOR
 #define H_HESP_PATHTABLEGENERATOR
 
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 using boost::shared_ptr;
 
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
+class AdjacencyList;
 class AdjacencyTable;
 typedef shared_ptr<class PathTable> PathTable_Ptr;
 
 struct PathTableGenerator
 {
 	//#################### PUBLIC METHODS ####################
+	static PathTable_Ptr dijkstra(const AdjacencyList& adjList, int threadCount = 1);
 	static PathTable_Ptr floyd_warshall(const AdjacencyTable& adjTable);
+
+	//#################### PRIVATE METHODS ####################
+private:
+	static void dijkstra_from(int source, const AdjacencyList& adjList, PathTable& pathTable, std::vector<float>& costs, std::vector<int>& firstHops);
+	static void dijkstra_worker(const AdjacencyList& adjList, PathTable& pathTable, int& nextSource, boost::mutex& nextSourceMutex);
 };
 
 }
@@ -0,0 +1,136 @@
+/***
+ * hesperus: ScriptModuleCache.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "ScriptModuleCache.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <boost/functional/hash.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/util/DirectoryFinder.h>
+namespace bf = boost::filesystem;
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+ScriptModuleCache::ScriptModuleCache(const ASXEngine_Ptr& engine)
+:	m_buildCount(0), m_engine(engine), m_instanceCount(0)
+{}
+
+//#################### PUBLIC METHODS ####################
+/**
+Returns the number of times a script has been built (as opposed to loaded from the cache).
+*/
+int ScriptModuleCache::build_count() const
+{
+	return m_buildCount;
+}
+
+const ASXEngine_Ptr& ScriptModuleCache::engine() const
+{
+	return m_engine;
+}
+
+/**
+Creates a new module for the specified script, building the script first if its bytecode isn't
+already in the cache. The caller should release the module when it's no longer needed.
+
+@param scriptName	The name of the script (e.g. "guard-ai" for scripts/guard-ai.as)
+@return				The name of the new module
+@throws Exception	If the script can't be read or built, or its bytecode can't be loaded
+*/
+std::string ScriptModuleCache::instantiate_module(const std::string& scriptName)
+{
+	const CompiledScript& compiledScript = compiled_script(scriptName);
+
+	std::string moduleName = scriptName + "#" + boost::lexical_cast<std::string>(m_instanceCount++);
+	if(!m_engine->load_bytecode(compiledScript.bytecode, moduleName))
+	{
+		throw Exception("Could not load the bytecode for script module " + scriptName);
+	}
+
+	return moduleName;
+}
+
+/**
+Discards a module created by instantiate_module().
+
+@param moduleName	The name of the module
+*/
+void ScriptModuleCache::release_module(const std::string& moduleName)
+{
+	m_engine->discard_module(moduleName);
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Looks up the compiled bytecode for the specified script, (re)building the script if it isn't in the
+cache or if its source has changed since it was built. The script file is only read (and hashed) if
+its last write time has changed, so a cache hit costs a single query of the file's timestamp. Note
+that only the script's own source is checked for changes, not that of any files it includes.
+
+@param scriptName	The name of the script
+@return				The compiled script
+@throws Exception	If the script can't be read or built
+*/
+const ScriptModuleCache::CompiledScript& ScriptModuleCache::compiled_script(const std::string& scriptName)
+{
+	bf::path scriptsDir = DirectoryFinder::instance().determine_scripts_directory();
+	std::string scriptFilename = (scriptsDir / (scriptName + ".as")).file_string();
+
+	std::time_t lastWriteTime;
+	try
+	{
+		lastWriteTime = bf::last_write_time(scriptFilename);
+	}
+	catch(bf::filesystem_error&)
+	{
+		throw Exception("Could not find script " + scriptFilename);
+	}
+
+	std::map<std::string,CompiledScript>::iterator it = m_compiledScripts.find(scriptFilename);
+	if(it != m_compiledScripts.end() && it->second.lastWriteTime == lastWriteTime) return it->second;
+
+	std::ifstream fs(scriptFilename.c_str(), std::ios_base::binary);
+	if(!fs) throw Exception("Could not open script " + scriptFilename + " for reading");
+	std::string source((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+	std::size_t sourceHash = boost::hash<std::string>()(source);
+
+	// If the file has been written to without its source actually changing, there's no need to rebuild it.
+	if(it != m_compiledScripts.end() && it->second.sourceHash == sourceHash)
+	{
+		it->second.lastWriteTime = lastWriteTime;
+		return it->second;
+	}
+
+	// Build the script in a temporary module, save its bytecode and then discard the module.
+	m_engine->clear_messages();
+	if(!m_engine->load_and_build_script(scriptFilename, scriptName))
+	{
+		m_engine->output_messages(std::cout);
+		throw Exception("Could not build script module " + scriptName);
+	}
+	++m_buildCount;
+
+	CompiledScript& compiledScript = m_compiledScripts[scriptFilename];
+	compiledScript.lastWriteTime = lastWriteTime;
+	compiledScript.sourceHash = sourceHash;
+	bool saved = m_engine->save_bytecode(scriptName, compiledScript.bytecode);
+	m_engine->discard_module(scriptName);
+
+	if(!saved)
+	{
+		m_compiledScripts.erase(scriptFilename);
+		throw Exception("Could not save the bytecode for script module " + scriptName);
+	}
+
+	return compiledScript;
+}
+
+}
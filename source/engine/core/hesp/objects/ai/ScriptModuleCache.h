@@ -0,0 +1,68 @@
+/***
+ * hesperus: ScriptModuleCache.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_SCRIPTMODULECACHE
+#define H_HESP_SCRIPTMODULECACHE
+
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <ASXEngine.h>
+
+namespace hesp {
+
+/**
+This class caches the compiled bytecode of the AI scripts used with a particular scripting engine.
+Each script is only built the first time it's used (or when its source changes): every object that
+uses the script then gets its own module, loaded from the cached bytecode, so that the objects don't
+share the script's global variables.
+*/
+class ScriptModuleCache
+{
+	//#################### NESTED CLASSES ####################
+private:
+	struct CompiledScript
+	{
+		std::time_t lastWriteTime;
+		std::size_t sourceHash;
+		std::vector<unsigned char> bytecode;
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	int m_buildCount;
+	std::map<std::string,CompiledScript> m_compiledScripts;		// keyed by script filename
+	ASXEngine_Ptr m_engine;
+	int m_instanceCount;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit ScriptModuleCache(const ASXEngine_Ptr& engine);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	int build_count() const;
+	const ASXEngine_Ptr& engine() const;
+	std::string instantiate_module(const std::string& scriptName);
+	void release_module(const std::string& moduleName);
+
+	//#################### PRIVATE METHODS ####################
+private:
+	const CompiledScript& compiled_script(const std::string& scriptName);
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<ScriptModuleCache> ScriptModuleCache_Ptr;
+typedef shared_ptr<const ScriptModuleCache> ScriptModuleCache_CPtr;
+
+}
+
+#endif
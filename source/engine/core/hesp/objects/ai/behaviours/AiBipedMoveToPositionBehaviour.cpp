@@ -67,7 +67,7 @@ void AiBipedMoveToPositionBehaviour::make_plan()
 		int mapIndex = m_objectManager->bounds_manager()->lookup_bounds_index(cmpSimulation->bounds_group(), cmpSimulation->posture());
 		NavDataset_CPtr navDataset = navManager->dataset(mapIndex);
 		NavMesh_CPtr navMesh = navDataset->nav_mesh();
-		GlobalPathfinder pathfinder(navMesh, navDataset->adjacency_list(), navDataset->path_table());
+		GlobalPathfinder_CPtr pathfinder = navDataset->pathfinder();
 
 		int suggestedSourcePoly = cmpMovement->cur_nav_poly_index();
 		int sourcePoly = NavMeshUtil::find_nav_polygon(source, suggestedSourcePoly, *polygons, tree, navMesh);
@@ -76,7 +76,7 @@ void AiBipedMoveToPositionBehaviour::make_plan()
 		if(destPoly == -1)		{ m_status = FAILED; return; }
 
 		std::list<int> path;
-		bool pathFound = pathfinder.find_path(source, sourcePoly, m_dest, destPoly, path);
+		bool pathFound = pathfinder->find_path(source, sourcePoly, m_dest, destPoly, path);
 		if(!pathFound)			{ m_status = FAILED; return; }
 
 		// NYI
@@ -17,6 +17,14 @@ void IObjectComponent::check_dependencies() const
 	//			to check aren't required to provide a stub implementation.
 }
 
+/**
+Returns the integer ID of the component's group type (see ObjectSpecification::group_id).
+*/
+int IObjectComponent::group_id() const
+{
+	return m_groupID;
+}
+
 const ObjectID& IObjectComponent::object_id() const
 {
 	return m_objectID;
@@ -28,7 +36,25 @@ void IObjectComponent::register_listening()
 	//			to any messages aren't required to provide a stub implementation.
 }
 
+/**
+Subscribes the component to each type of message it handles. Components only receive the broadcasted
+messages to which they've subscribed, so any component which derives from MessageHandler<...> must
+override this (the object manager checks that it does when the component's object is created).
+
+@param subscriberTable	The table to which to add the subscriptions
+*/
+void IObjectComponent::subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+{
+	// Note:	A default implementation is provided so that components which don't handle any messages
+	//			aren't required to provide a stub implementation.
+}
+
 //#################### PROTECTED METHODS ####################
+void IObjectComponent::set_group_id(int groupID)
+{
+	m_groupID = groupID;
+}
+
 void IObjectComponent::set_object_id(const ObjectID& objectID)
 {
 	m_objectID = objectID;
@@ -17,6 +17,7 @@ using boost::shared_ptr;
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
+class MessageSubscriberTable;
 class ObjectManager;
 class Properties;
 
@@ -27,6 +28,7 @@ class IObjectComponent : public virtual MessageHandlerBase
 
 	//#################### PROTECTED VARIABLES ####################
 protected:
+	int m_groupID;
 	ObjectID m_objectID;
 	ObjectManager *m_objectManager;
 
@@ -43,11 +45,14 @@ public:
 	//#################### PUBLIC METHODS ####################
 public:
 	virtual void check_dependencies() const;
+	int group_id() const;
 	const ObjectID& object_id() const;
 	virtual void register_listening();
+	virtual void subscribe_to_messages(MessageSubscriberTable& subscriberTable);
 
 	//#################### PROTECTED METHODS ####################
 protected:
+	void set_group_id(int groupID);
 	void set_object_id(const ObjectID& objectID);
 	virtual void set_object_manager(ObjectManager *objectManager);
 };
@@ -8,12 +8,12 @@
 namespace hesp {
 
 //#################### PUBLIC METHODS ####################
-void ListenerTable::add_listener(const ObjectID& sourceObject, const std::string& sourceComponent, const ObjectID& destObject)
+void ListenerTable::add_listener(const ObjectID& sourceObject, int sourceComponent, const ObjectID& destObject)
 {
 	m_table.insert(Entry(sourceObject, sourceComponent, destObject));
 }
 
-std::vector<std::pair<ObjectID,std::string> > ListenerTable::get_listeners(const ObjectID& destObject) const
+std::vector<std::pair<ObjectID,int> > ListenerTable::get_listeners(const ObjectID& destObject) const
 {
 	typedef Table::index<dest>::type DestTable;
 	typedef DestTable::iterator DestIter;
@@ -21,7 +21,7 @@ std::vector<std::pair<ObjectID,std::string> > ListenerTable::get_listeners(const
 	const DestTable& destTable = m_table.get<dest>();
 	std::pair<DestIter,DestIter> p = destTable.equal_range(destObject);
 
-	std::vector<std::pair<ObjectID,std::string> > ret;
+	std::vector<std::pair<ObjectID,int> > ret;
 	for(DestIter it=p.first, iend=p.second; it!=iend; ++it)
 	{
 		const Entry& e = *it;
@@ -30,7 +30,7 @@ std::vector<std::pair<ObjectID,std::string> > ListenerTable::get_listeners(const
 	return ret;
 }
 
-void ListenerTable::remove_listener(const ObjectID& sourceObject, const std::string& sourceComponent, const ObjectID& destObject)
+void ListenerTable::remove_listener(const ObjectID& sourceObject, int sourceComponent, const ObjectID& destObject)
 {
 	m_table.erase(Entry(sourceObject, sourceComponent, destObject));
 }
@@ -25,10 +25,10 @@ private:
 	struct Entry
 	{
 		ObjectID m_sourceObject;				// the object containing the component doing the listening
-		std::string m_sourceComponent;			// which component of the object is doing the listening
+		int m_sourceComponent;					// the group ID of the component of the object which is doing the listening
 		ObjectID m_destObject;					// the object being listened to (-1 is used to represent "all objects" in this context)
 
-		Entry(const ObjectID& sourceObject, const std::string& sourceComponent, const ObjectID& destObject)
+		Entry(const ObjectID& sourceObject, int sourceComponent, const ObjectID& destObject)
 		:	m_sourceObject(sourceObject), m_sourceComponent(sourceComponent), m_destObject(destObject)
 		{}
 
@@ -36,7 +36,7 @@ private:
 		{
 			return	m_sourceObject < rhs.m_sourceObject ||
 					(m_sourceObject == rhs.m_sourceObject && m_destObject < rhs.m_destObject) ||
-					(m_sourceObject == rhs.m_sourceObject && m_destObject == rhs.m_destObject && m_sourceComponent  < rhs.m_sourceComponent);
+					(m_sourceObject == rhs.m_sourceObject && m_destObject == rhs.m_destObject && m_sourceComponent < rhs.m_sourceComponent);
 		}
 	};
 
@@ -61,9 +61,9 @@ private:
 
 	//#################### PUBLIC METHODS ####################
 public:
-	void add_listener(const ObjectID& sourceObject, const std::string& sourceComponent, const ObjectID& destObject);
-	std::vector<std::pair<ObjectID,std::string> > get_listeners(const ObjectID& destObject) const;
-	void remove_listener(const ObjectID& sourceObject, const std::string& sourceComponent, const ObjectID& destObject);
+	void add_listener(const ObjectID& sourceObject, int sourceComponent, const ObjectID& destObject);
+	std::vector<std::pair<ObjectID,int> > get_listeners(const ObjectID& destObject) const;
+	void remove_listener(const ObjectID& sourceObject, int sourceComponent, const ObjectID& destObject);
 	void remove_listeners_from(const ObjectID& sourceObject);
 	void remove_listeners_to(const ObjectID& destObject);
 };
@@ -0,0 +1,17 @@
+/***
+ * hesperus: Message.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "Message.h"
+
+namespace hesp {
+
+//#################### PRIVATE METHODS ####################
+int Message::next_message_type_id()
+{
+	static int nextID = 0;
+	return nextID++;
+}
+
+}
@@ -27,17 +27,24 @@ public:
 
 	//#################### PUBLIC ABSTRACT METHODS ####################
 public:
-	virtual void dispatch(MessageHandlerBase *handler) const = 0;
 	virtual std::set<ObjectID> referenced_objects() const = 0;
+	virtual int type_id() const = 0;
 
-	//#################### PROTECTED METHODS ####################
-protected:
+	//#################### PUBLIC METHODS ####################
+public:
+	/**
+	Returns the ID of the message type MessageType, assigning it one the first time it's used.
+	*/
 	template <typename MessageType>
-	static void dynamic_dispatch(MessageHandlerBase *handler, const MessageType& self)
+	static int message_type_id()
 	{
-		MessageHandler<MessageType> *msgHandler = dynamic_cast<MessageHandler<MessageType>*>(handler);
-		if(msgHandler) msgHandler->process_message(self);
+		static int typeID = next_message_type_id();
+		return typeID;
 	}
+
+	//#################### PRIVATE METHODS ####################
+private:
+	static int next_message_type_id();
 };
 
 //#################### TYPEDEFS ####################
@@ -10,14 +10,34 @@ namespace hesp {
 
 class MessageHandlerBase
 {
+	//#################### PRIVATE VARIABLES ####################
+private:
+	int m_handledMessageTypeCount;		// the number of MessageHandler<...> bases the object has
+
+	//#################### CONSTRUCTORS ####################
+protected:
+	MessageHandlerBase() : m_handledMessageTypeCount(0) {}
+
 	//#################### DESTRUCTOR ####################
 public:
 	virtual ~MessageHandlerBase() {}
+
+	//#################### PUBLIC METHODS ####################
+public:
+	int handled_message_type_count() const	{ return m_handledMessageTypeCount; }
+
+	//#################### PROTECTED METHODS ####################
+protected:
+	void add_handled_message_type()			{ ++m_handledMessageTypeCount; }
 };
 
 template <typename MessageType>
 class MessageHandler : public virtual MessageHandlerBase
 {
+	//#################### CONSTRUCTORS ####################
+protected:
+	MessageHandler()						{ add_handled_message_type(); }
+
 	//#################### PUBLIC ABSTRACT METHODS ####################
 public:
 	virtual void process_message(const MessageType& msg) = 0;
@@ -0,0 +1,87 @@
+/***
+ * hesperus: MessageSubscriberTable.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "MessageSubscriberTable.h"
+
+namespace hesp {
+
+//#################### PUBLIC METHODS ####################
+/**
+Dispatches the specified message to every component which has subscribed to messages of its type.
+
+@param msg	The message
+*/
+void MessageSubscriberTable::dispatch(const Message& msg) const
+{
+	int typeID = msg.type_id();
+	if(typeID < static_cast<int>(m_subscriberLists.size()) && m_subscriberLists[typeID])
+	{
+		m_subscriberLists[typeID]->dispatch(msg);
+	}
+}
+
+/**
+Dispatches the specified message to the specified component, provided it has subscribed to messages of its type.
+
+@param msg		The message
+@param objectID	The ID of the object containing the component
+@param groupID	The group ID of the component
+*/
+void MessageSubscriberTable::dispatch(const Message& msg, const ObjectID& objectID, int groupID) const
+{
+	int typeID = msg.type_id();
+	if(typeID < static_cast<int>(m_subscriberLists.size()) && m_subscriberLists[typeID])
+	{
+		m_subscriberLists[typeID]->dispatch(msg, objectID, groupID);
+	}
+}
+
+/**
+Dispatches the specified message to all the components of the specified object which have subscribed
+to messages of its type, in ascending order of their group IDs.
+
+@param msg		The message
+@param objectID	The ID of the object
+*/
+void MessageSubscriberTable::dispatch(const Message& msg, const ObjectID& objectID) const
+{
+	int typeID = msg.type_id();
+	if(typeID < static_cast<int>(m_subscriberLists.size()) && m_subscriberLists[typeID])
+	{
+		m_subscriberLists[typeID]->dispatch(msg, objectID);
+	}
+}
+
+/**
+Unsubscribes all the components of the specified object from every type of message.
+
+@param objectID	The ID of the object
+*/
+void MessageSubscriberTable::remove_subscribers(const ObjectID& objectID)
+{
+	for(size_t i=0, size=m_subscriberLists.size(); i<size; ++i)
+	{
+		if(m_subscriberLists[i]) m_subscriberLists[i]->remove_subscribers(objectID);
+	}
+}
+
+/**
+Returns the number of subscriptions held by the specified component, across all types of message.
+
+@param objectID	The ID of the object containing the component
+@param groupID	The group ID of the component
+@return			As stated
+*/
+int MessageSubscriberTable::subscription_count(const ObjectID& objectID, int groupID) const
+{
+	int count = 0;
+	for(size_t i=0, size=m_subscriberLists.size(); i<size; ++i)
+	{
+		if(m_subscriberLists[i]) count += m_subscriberLists[i]->subscription_count(objectID, groupID);
+	}
+	return count;
+}
+
+}
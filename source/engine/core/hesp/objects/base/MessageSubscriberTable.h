@@ -0,0 +1,95 @@
+/***
+ * hesperus: MessageSubscriberTable.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_MESSAGESUBSCRIBERTABLE
+#define H_HESP_MESSAGESUBSCRIBERTABLE
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include "Message.h"
+#include "MessageHandler.h"
+#include "ObjectID.h"
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+class IObjectComponent;
+
+/**
+This class stores, for each type of message, the components which have subscribed to receive it.
+Each message type has its own dense list of subscribers, whose handlers are cast to the right
+MessageHandler type once, when they subscribe, so dispatching a message to them involves neither
+RTTI nor any work for components which aren't interested in it. The subscribers in each list are
+kept in ascending order of (object ID, component group ID), which is the order in which the object
+manager stores the components themselves. Components subscribe themselves to the messages they handle
+(see IObjectComponent::subscribe_to_messages), and the object manager checks that they haven't missed any.
+*/
+class MessageSubscriberTable
+{
+	//#################### NESTED CLASSES ####################
+private:
+	struct SubscriberListBase
+	{
+		virtual ~SubscriberListBase() {}
+		virtual void dispatch(const Message& msg) const = 0;
+		virtual void dispatch(const Message& msg, const ObjectID& objectID, int groupID) const = 0;
+		virtual void dispatch(const Message& msg, const ObjectID& objectID) const = 0;
+		virtual void remove_subscribers(const ObjectID& objectID) = 0;
+		virtual int subscription_count(const ObjectID& objectID, int groupID) const = 0;
+	};
+
+	template <typename MessageType>
+	struct SubscriberList : SubscriberListBase
+	{
+		struct Entry
+		{
+			ObjectID objectID;
+			int groupID;
+			MessageHandler<MessageType> *handler;
+
+			Entry(const ObjectID& objectID_, int groupID_, MessageHandler<MessageType> *handler_)
+			:	objectID(objectID_), groupID(groupID_), handler(handler_)
+			{}
+
+			bool operator<(const Entry& rhs) const
+			{
+				return objectID < rhs.objectID || (objectID == rhs.objectID && groupID < rhs.groupID);
+			}
+		};
+
+		std::vector<Entry> entries;
+
+		void add_subscriber(const Entry& entry);
+		void dispatch(const Message& msg) const;
+		void dispatch(const Message& msg, const ObjectID& objectID, int groupID) const;
+		void dispatch(const Message& msg, const ObjectID& objectID) const;
+		void remove_subscribers(const ObjectID& objectID);
+		int subscription_count(const ObjectID& objectID, int groupID) const;
+	};
+
+	typedef shared_ptr<SubscriberListBase> SubscriberList_Ptr;
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<SubscriberList_Ptr> m_subscriberLists;		// indexed by message type ID (the lists are created on demand)
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void dispatch(const Message& msg) const;
+	void dispatch(const Message& msg, const ObjectID& objectID, int groupID) const;
+	void dispatch(const Message& msg, const ObjectID& objectID) const;
+	void remove_subscribers(const ObjectID& objectID);
+	template <typename MessageType> void subscribe(IObjectComponent *component);
+	int subscription_count(const ObjectID& objectID, int groupID) const;
+};
+
+}
+
+#include "MessageSubscriberTable.tpp"
+
+#endif
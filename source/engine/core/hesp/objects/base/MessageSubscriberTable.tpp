@@ -0,0 +1,93 @@
+/***
+ * hesperus: MessageSubscriberTable.tpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <algorithm>
+#include <climits>
+
+#include <hesp/exceptions/Exception.h>
+#include "IObjectComponent.h"
+
+namespace hesp {
+
+//#################### PUBLIC METHODS ####################
+/**
+Subscribes the specified component to messages of type MessageType.
+
+@param component	The component
+@throws Exception	If the component can't handle messages of type MessageType, or has already subscribed to them
+*/
+template <typename MessageType>
+void MessageSubscriberTable::subscribe(IObjectComponent *component)
+{
+	MessageHandler<MessageType> *handler = dynamic_cast<MessageHandler<MessageType>*>(component);
+	if(!handler) throw Exception(component->own_type() + " components cannot handle the messages to which they are subscribed");
+
+	int typeID = Message::message_type_id<MessageType>();
+	if(typeID >= static_cast<int>(m_subscriberLists.size())) m_subscriberLists.resize(typeID + 1);
+
+	SubscriberList_Ptr& subscriberList = m_subscriberLists[typeID];
+	if(!subscriberList) subscriberList.reset(new SubscriberList<MessageType>);
+
+	typedef typename SubscriberList<MessageType>::Entry Entry;
+	static_cast<SubscriberList<MessageType>&>(*subscriberList).add_subscriber(Entry(component->object_id(), component->group_id(), handler));
+}
+
+//#################### NESTED CLASSES ####################
+template <typename MessageType>
+void MessageSubscriberTable::SubscriberList<MessageType>::add_subscriber(const Entry& entry)
+{
+	typename std::vector<Entry>::iterator it = std::upper_bound(entries.begin(), entries.end(), entry);
+	if(it != entries.begin() && !(*(it-1) < entry)) throw Exception("Components cannot subscribe to the same type of message more than once");
+	entries.insert(it, entry);
+}
+
+template <typename MessageType>
+void MessageSubscriberTable::SubscriberList<MessageType>::dispatch(const Message& msg) const
+{
+	// Note:	The message is guaranteed to be of the right type, since the list was looked up by its type ID.
+	const MessageType& typedMsg = static_cast<const MessageType&>(msg);
+	for(size_t i=0, size=entries.size(); i<size; ++i)
+	{
+		entries[i].handler->process_message(typedMsg);
+	}
+}
+
+template <typename MessageType>
+void MessageSubscriberTable::SubscriberList<MessageType>::dispatch(const Message& msg, const ObjectID& objectID, int groupID) const
+{
+	Entry key(objectID, groupID, NULL);
+	typename std::vector<Entry>::const_iterator it = std::lower_bound(entries.begin(), entries.end(), key);
+	if(it != entries.end() && !(key < *it)) it->handler->process_message(static_cast<const MessageType&>(msg));
+}
+
+template <typename MessageType>
+void MessageSubscriberTable::SubscriberList<MessageType>::dispatch(const Message& msg, const ObjectID& objectID) const
+{
+	const MessageType& typedMsg = static_cast<const MessageType&>(msg);
+	typename std::vector<Entry>::const_iterator first = std::lower_bound(entries.begin(), entries.end(), Entry(objectID, INT_MIN, NULL));
+	typename std::vector<Entry>::const_iterator last = std::upper_bound(first, entries.end(), Entry(objectID, INT_MAX, NULL));
+	for(typename std::vector<Entry>::const_iterator it=first; it!=last; ++it)
+	{
+		it->handler->process_message(typedMsg);
+	}
+}
+
+template <typename MessageType>
+void MessageSubscriberTable::SubscriberList<MessageType>::remove_subscribers(const ObjectID& objectID)
+{
+	typename std::vector<Entry>::iterator first = std::lower_bound(entries.begin(), entries.end(), Entry(objectID, INT_MIN, NULL));
+	typename std::vector<Entry>::iterator last = std::upper_bound(first, entries.end(), Entry(objectID, INT_MAX, NULL));
+	entries.erase(first, last);
+}
+
+template <typename MessageType>
+int MessageSubscriberTable::SubscriberList<MessageType>::subscription_count(const ObjectID& objectID, int groupID) const
+{
+	Entry key(objectID, groupID, NULL);
+	std::pair<typename std::vector<Entry>::const_iterator,typename std::vector<Entry>::const_iterator> range = std::equal_range(entries.begin(), entries.end(), key);
+	return static_cast<int>(range.second - range.first);
+}
+
+}
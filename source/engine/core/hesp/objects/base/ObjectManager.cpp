@@ -5,7 +5,10 @@
 
 #include "ObjectManager.h"
 
+#include <algorithm>
+
 #include <hesp/objects/ai/AiScriptRegistrar.h>
+#include <hesp/objects/ai/ScriptModuleCache.h>
 #include <hesp/objects/components/ICmpActivatable.h>
 #include <hesp/objects/components/ICmpInventory.h>
 #include <hesp/objects/components/ICmpModelRender.h>
@@ -37,10 +40,12 @@ ObjectManager::ObjectManager(const BoundsManager_CPtr& boundsManager, const Comp
 							 const ModelManager_Ptr& modelManager, const SpriteManager_Ptr& spriteManager,
 							 const Database_Ptr& database)
 :	m_aiEngine(new ASXEngine),
+	m_aiModuleCache(new ScriptModuleCache(m_aiEngine)),
 	m_archetypes(archetypes),
 	m_boundsManager(boundsManager),
 	m_componentPropertyTypes(componentPropertyTypes),
 	m_database(database),
+	m_groupConsistencyChecking(false),
 	m_modelManager(modelManager),
 	m_physicsSystem(new PhysicsSystem),
 	m_spriteManager(spriteManager)
@@ -73,7 +78,7 @@ broadcasted messsages about the specified object.
 */
 void ObjectManager::add_listener(IObjectComponent *listener, const ObjectID& id)
 {
-	m_listenerTable.add_listener(listener->object_id(), listener->group_type(), id);
+	m_listenerTable.add_listener(listener->object_id(), listener->group_id(), id);
 }
 
 const ASXEngine_Ptr& ObjectManager::ai_engine()
@@ -81,44 +86,49 @@ const ASXEngine_Ptr& ObjectManager::ai_engine()
 	return m_aiEngine;
 }
 
+const ScriptModuleCache_Ptr& ObjectManager::ai_module_cache()
+{
+	return m_aiModuleCache;
+}
+
 const BoundsManager_CPtr& ObjectManager::bounds_manager() const
 {
 	return m_boundsManager;
 }
 
+/**
+Broadcasts the specified message to the components which have subscribed to messages of its type
+(components subscribe to the messages they handle when their objects are created).
+Messages which aren't about particular objects go to all of the subscribers; messages which are only go
+to those subscribers which have also registered an interest in (at least one of) the objects concerned.
+In either case, the cost is proportional to the number of components receiving the message.
+
+@param msg	The message
+*/
 void ObjectManager::broadcast_message(const Message_CPtr& msg)
 {
 	std::set<ObjectID> msgObjs = msg->referenced_objects();
 	if(msgObjs.empty())
 	{
-		// This isn't a message about particular objects: dispatch it to every component which can receive it.
-		for(std::map<ObjectID,Object>::const_iterator it=m_objects.begin(), iend=m_objects.end(); it!=iend; ++it)
-		{
-			const Object& object = it->second;
-			for(Object::const_iterator jt=object.begin(), jend=object.end(); jt!=jend; ++jt)
-			{
-				IObjectComponent_Ptr component = jt->second;
-				msg->dispatch(component.get());
-			}
-		}
+		// This isn't a message about particular objects: dispatch it to every component which has subscribed to it.
+		m_subscriberTable.dispatch(*msg);
 	}
 	else
 	{
 		// This is a message about particular objects: only broadcast it to components which have registered an interest.
 
 		// Calculate the set of interested listeners.
-		std::set<std::pair<ObjectID,std::string> > listeners;
+		std::set<std::pair<ObjectID,int> > listeners;
 		for(std::set<ObjectID>::const_iterator it=msgObjs.begin(), iend=msgObjs.end(); it!=iend; ++it)
 		{
-			std::vector<std::pair<ObjectID,std::string> > result = m_listenerTable.get_listeners(*it);
+			std::vector<std::pair<ObjectID,int> > result = m_listenerTable.get_listeners(*it);
 			std::copy(result.begin(), result.end(), std::inserter(listeners, listeners.end()));
 		}
 
 		// Dispatch the message to each of them in turn.
-		for(std::set<std::pair<ObjectID,std::string> >::const_iterator it=listeners.begin(), iend=listeners.end(); it!=iend; ++it)
+		for(std::set<std::pair<ObjectID,int> >::const_iterator it=listeners.begin(), iend=listeners.end(); it!=iend; ++it)
 		{
-			IObjectComponent_Ptr listener = get_component<IObjectComponent>(it->first, it->second);
-			if(listener) msg->dispatch(listener.get());
+			m_subscriberTable.dispatch(*msg, it->first, it->second);
 		}
 	}
 }
@@ -170,21 +180,28 @@ std::vector<IObjectComponent_Ptr> ObjectManager::get_components(const ObjectID&
 	return components;
 }
 
-std::vector<ObjectID> ObjectManager::group(const std::string& name) const
+/**
+Returns the members of the specified object group, in ascending order of object ID. The members are
+maintained incrementally, so this doesn't involve evaluating the group predicate. Note that the returned
+array changes when objects are created or destroyed, or when an object's group membership is updated.
+
+@param name			The name of the group
+@return				The members of the group
+@throws Exception	If there's no such group, or if consistency checking is enabled and the
+					group's members don't match the result of evaluating its predicate
+*/
+const std::vector<ObjectID>& ObjectManager::group(const std::string& name) const
 {
-	std::vector<ObjectID> ret;
-
-	std::map<std::string,GroupPredicate>::const_iterator gt = m_groupPredicates.find(name);
-	if(gt == m_groupPredicates.end()) throw Exception("No such object group: " + name);
-	const GroupPredicate& pred = gt->second;
+	std::map<std::string,Group>::const_iterator gt = m_groups.find(name);
+	if(gt == m_groups.end()) throw Exception("No such object group: " + name);
+	const Group& g = gt->second;
 
-	for(std::map<ObjectID,Object>::const_iterator it=m_objects.begin(), iend=m_objects.end(); it!=iend; ++it)
+	if(m_groupConsistencyChecking && scan_group(g.predicate) != g.members)
 	{
-		const ObjectID& objectID = it->first;
-		if(pred(objectID, this)) ret.push_back(objectID);
+		throw Exception("The members of the object group " + name + " are out of date");
 	}
 
-	return ret;
+	return g.members;
 }
 
 const ModelManager_Ptr& ObjectManager::model_manager()
@@ -213,16 +230,17 @@ ObjectID ObjectManager::player() const
 	return ObjectID(0);
 }
 
+/**
+Posts the specified message to those components of the specified object which have subscribed to messages of its type.
+
+@param target		The ID of the object
+@param msg			The message
+@throws Exception	If there's no object with the specified ID
+*/
 void ObjectManager::post_message(const ObjectID& target, const Message_CPtr& msg)
 {
-	std::map<ObjectID,Object>::iterator it = m_objects.find(target);
-	if(it == m_objects.end()) throw Exception("Invalid object ID: " + target.to_string());
-
-	Object& obj = it->second;
-	for(Object::iterator jt=obj.begin(), jend=obj.end(); jt!=jend; ++jt)
-	{
-		msg->dispatch(jt->second.get());
-	}
+	if(m_objects.find(target) == m_objects.end()) throw Exception("Invalid object ID: " + target.to_string());
+	m_subscriberTable.dispatch(*msg, target);
 }
 
 void ObjectManager::queue_child_for_destruction(const ObjectID& child, const ObjectID& parent)
@@ -243,7 +261,9 @@ void ObjectManager::queue_for_destruction(const ObjectID& id)
 
 void ObjectManager::register_group(const std::string& name, const GroupPredicate& pred)
 {
-	m_groupPredicates[name] = pred;
+	Group& g = m_groups[name];
+	g.predicate = pred;
+	g.members = scan_group(pred);
 }
 
 /**
@@ -255,7 +275,18 @@ in receiving broadcasted messsages about the specified object.
 */
 void ObjectManager::remove_listener(IObjectComponent *listener, const ObjectID& id)
 {
-	m_listenerTable.remove_listener(listener->object_id(), listener->group_type(), id);
+	m_listenerTable.remove_listener(listener->object_id(), listener->group_id(), id);
+}
+
+/**
+Sets whether or not each group query should check the group's maintained members against the
+result of evaluating its predicate over every object. This is expensive, and intended for testing.
+
+@param enabled	Whether or not consistency checking should be enabled
+*/
+void ObjectManager::set_group_consistency_checking(bool enabled)
+{
+	m_groupConsistencyChecking = enabled;
 }
 
 const SpriteManager_Ptr& ObjectManager::sprite_manager()
@@ -268,6 +299,22 @@ SpriteManager_CPtr ObjectManager::sprite_manager() const
 	return m_spriteManager;
 }
 
+/**
+Re-evaluates the group predicates for the specified object and updates its group memberships
+accordingly. Components must call this whenever they change state on which a group predicate
+depends (e.g. the owner of an ownable object).
+
+@param id	The ID of the object
+*/
+void ObjectManager::update_group_membership(const ObjectID& id)
+{
+	for(std::map<std::string,Group>::iterator it=m_groups.begin(), iend=m_groups.end(); it!=iend; ++it)
+	{
+		Group& g = it->second;
+		set_group_membership(g, id, g.predicate(id, this));
+	}
+}
+
 //#################### PRIVATE METHODS ####################
 ObjectID ObjectManager::create_object(const ObjectSpecification& specification)
 {
@@ -276,29 +323,43 @@ ObjectID ObjectManager::create_object(const ObjectSpecification& specification)
 	ObjectID id(m_idAllocator.allocate());
 	Object& object = m_objects[id];
 
+	int slot = id.value();
+	if(slot >= static_cast<int>(m_liveObjects.size())) m_liveObjects.resize(slot + 1);
+	m_liveObjects[slot] = true;
+
 	// Add the components to the object manager.
 	for(size_t i=0, size=components.size(); i<size; ++i)
 	{
+		components[i]->set_group_id(ObjectSpecification::group_id(components[i]->group_type()));
 		components[i]->set_object_id(id);
 		components[i]->set_object_manager(this);
 		object.insert(std::make_pair(components[i]->group_type(), components[i]));
+
+		for(size_t j=0, arrayCount=m_componentArrays.size(); j<arrayCount; ++j)
+		{
+			if(m_componentArrays[j]) m_componentArrays[j]->add_component(slot, components[i]);
+		}
 	}
 
-	// Check component dependencies and register listening (note that these must happen
-	// after all the components have been added above).
+	// Check component dependencies, register listening and subscribe the components to the messages
+	// they handle (note that these must happen after all the components have been added above).
 	for(size_t i=0, size=components.size(); i<size; ++i)
 	{
 		components[i]->check_dependencies();
 		components[i]->register_listening();
+		subscribe_to_messages(components[i].get());
 	}
 
+	update_group_membership(id);
+
 	return id;
 }
 
 void ObjectManager::destroy_object(const ObjectID& id)
 {
-	// Remove all the listeners which are components of the object being deleted.
+	// Remove all the listeners and subscribers which are components of the object being deleted.
 	m_listenerTable.remove_listeners_from(id);
+	m_subscriberTable.remove_subscribers(id);
 
 	broadcast_message(Message_CPtr(new MsgObjectDestroyed(id)));
 
@@ -306,7 +367,20 @@ void ObjectManager::destroy_object(const ObjectID& id)
 	m_listenerTable.remove_listeners_to(id);
 
 	m_objects.erase(id);
-	m_idAllocator.deallocate(id.value());
+
+	for(std::map<std::string,Group>::iterator it=m_groups.begin(), iend=m_groups.end(); it!=iend; ++it)
+	{
+		set_group_membership(it->second, id, false);
+	}
+
+	int slot = id.value();
+	m_liveObjects[slot] = false;
+	for(size_t i=0, arrayCount=m_componentArrays.size(); i<arrayCount; ++i)
+	{
+		if(m_componentArrays[i]) m_componentArrays[i]->remove_component(slot);
+	}
+
+	m_idAllocator.deallocate(slot);
 }
 
 void ObjectManager::flush_construction_queue()
@@ -345,6 +419,54 @@ void ObjectManager::flush_destruction_queue()
 	}
 }
 
+int ObjectManager::next_component_type_id()
+{
+	static int nextID = 0;
+	return nextID++;
+}
+
+/**
+Finds the members of a group by evaluating its predicate over every object.
+
+@param pred	The group predicate
+@return		The IDs of the objects which satisfy the predicate, in ascending order
+*/
+std::vector<ObjectID> ObjectManager::scan_group(const GroupPredicate& pred) const
+{
+	std::vector<ObjectID> ret;
+	for(std::map<ObjectID,Object>::const_iterator it=m_objects.begin(), iend=m_objects.end(); it!=iend; ++it)
+	{
+		const ObjectID& objectID = it->first;
+		if(pred(objectID, this)) ret.push_back(objectID);
+	}
+	return ret;
+}
+
+void ObjectManager::set_group_membership(Group& group, const ObjectID& id, bool member)
+{
+	std::vector<ObjectID>& members = group.members;
+	std::vector<ObjectID>::iterator it = std::lower_bound(members.begin(), members.end(), id);
+	bool present = it != members.end() && *it == id;
+	if(member && !present) members.insert(it, id);
+	else if(!member && present) members.erase(it);
+}
+
+/**
+Subscribes the specified component to the messages it handles, and checks that it has subscribed to
+every type of message for which it has a handler (a component which hasn't would silently miss them).
+
+@param component	The component
+@throws Exception	If the component's subscriptions don't match its message handlers
+*/
+void ObjectManager::subscribe_to_messages(IObjectComponent *component)
+{
+	component->subscribe_to_messages(m_subscriberTable);
+	if(m_subscriberTable.subscription_count(component->object_id(), component->group_id()) != component->handled_message_type_count())
+	{
+		throw Exception(component->own_type() + " components must subscribe to each type of message they handle exactly once");
+	}
+}
+
 //#################### LOCAL METHODS - DEFINITIONS ####################
 bool has_owner(const ObjectID& id, const ObjectManager *objectManager)
 {
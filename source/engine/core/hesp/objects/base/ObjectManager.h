@@ -12,6 +12,7 @@
 #include <vector>
 
 #include <boost/function.hpp>
+#include <boost/pointer_cast.hpp>
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
 
@@ -20,7 +21,9 @@ using boost::shared_ptr;
 #include <hesp/util/IDAllocator.h>
 #include <hesp/util/PriorityQueue.h>
 #include "ComponentPropertyTypeMap.h"
+#include "IObjectComponent.h"
 #include "ListenerTable.h"
+#include "MessageSubscriberTable.h"
 #include "ObjectID.h"
 #include "ObjectSpecification.h"
 
@@ -35,6 +38,7 @@ typedef shared_ptr<const class Message> Message_CPtr;
 typedef shared_ptr<class ModelManager> ModelManager_Ptr;
 typedef shared_ptr<const class ModelManager> ModelManager_CPtr;
 typedef shared_ptr<class PhysicsSystem> PhysicsSystem_Ptr;
+typedef shared_ptr<class ScriptModuleCache> ScriptModuleCache_Ptr;
 typedef shared_ptr<class SpriteManager> SpriteManager_Ptr;
 typedef shared_ptr<const class SpriteManager> SpriteManager_CPtr;
 
@@ -48,15 +52,69 @@ private:
 	typedef PriorityQueue<ObjectID,int,bool,std::greater<int> > DestructionQueue;
 	typedef std::map<std::string,IObjectComponent_Ptr> Object;
 
+	//#################### NESTED CLASSES ####################
+private:
+	/**
+	The components of an object manager which can be looked up via a particular interface type,
+	stored densely by object ID (object IDs are allocated compactly, so this wastes little space).
+	Components are cast to the interface type once, when they're added, which means that typed
+	lookups are just array accesses.
+	*/
+	struct ComponentArrayBase
+	{
+		virtual ~ComponentArrayBase() {}
+		virtual void add_component(int slot, const IObjectComponent_Ptr& component) = 0;
+		virtual void remove_component(int slot) = 0;
+	};
+
+	template <typename T>
+	struct ComponentArray : ComponentArrayBase
+	{
+		std::vector<shared_ptr<T> > components;
+
+		void add_component(int slot, const IObjectComponent_Ptr& component)
+		{
+			if(component->group_type() != T::static_group_type()) return;
+
+			shared_ptr<T> typedComponent = boost::dynamic_pointer_cast<T,IObjectComponent>(component);
+			if(!typedComponent) return;
+
+			if(slot >= static_cast<int>(components.size())) components.resize(slot + 1);
+			components[slot] = typedComponent;
+		}
+
+		void remove_component(int slot)
+		{
+			if(slot < static_cast<int>(components.size())) components[slot].reset();
+		}
+	};
+
+	typedef shared_ptr<ComponentArrayBase> ComponentArray_Ptr;
+
+	/**
+	An object group's members are kept up to date as objects are created and destroyed, and when
+	components tell the object manager that state on which the group predicates depend has changed.
+	They are stored in ascending order of object ID (i.e. in the same order as a full scan would find them).
+	*/
+	struct Group
+	{
+		GroupPredicate predicate;
+		std::vector<ObjectID> members;
+	};
+
 	//#################### PRIVATE VARIABLES ####################
 private:
 	ASXEngine_Ptr m_aiEngine;
+	ScriptModuleCache_Ptr m_aiModuleCache;
 	std::map<std::string,ObjectSpecification> m_archetypes;
 	BoundsManager_CPtr m_boundsManager;
+	mutable std::vector<ComponentArray_Ptr> m_componentArrays;		// indexed by component type ID (the arrays are created on demand)
 	ComponentPropertyTypeMap m_componentPropertyTypes;
 	Database_Ptr m_database;
-	std::map<std::string,GroupPredicate> m_groupPredicates;
+	bool m_groupConsistencyChecking;
+	std::map<std::string,Group> m_groups;
 	IDAllocator m_idAllocator;
+	std::vector<bool> m_liveObjects;								// indexed by object ID
 	ModelManager_Ptr m_modelManager;
 	std::map<ObjectID,Object> m_objects;
 	PhysicsSystem_Ptr m_physicsSystem;
@@ -65,6 +123,7 @@ private:
 	ConstructionQueue m_constructionQueue;
 	DestructionQueue m_destructionQueue;
 	ListenerTable m_listenerTable;
+	MessageSubscriberTable m_subscriberTable;
 
 	//#################### CONSTRUCTORS ####################
 public:
@@ -74,6 +133,7 @@ public:
 public:
 	void add_listener(IObjectComponent *listener, const ObjectID& id);
 	const ASXEngine_Ptr& ai_engine();
+	const ScriptModuleCache_Ptr& ai_module_cache();
 	const BoundsManager_CPtr& bounds_manager() const;
 	void broadcast_message(const Message_CPtr& msg);
 	const ComponentPropertyTypeMap& component_property_types() const;
@@ -84,7 +144,7 @@ public:
 	template <typename T> shared_ptr<T> get_component(const ObjectID& id, const shared_ptr<T>& = shared_ptr<T>());
 	template <typename T> shared_ptr<const T> get_component(const ObjectID& id, const shared_ptr<const T>& = shared_ptr<const T>()) const;
 	std::vector<IObjectComponent_Ptr> get_components(const ObjectID& id);
-	std::vector<ObjectID> group(const std::string& name) const;
+	const std::vector<ObjectID>& group(const std::string& name) const;
 	const ModelManager_Ptr& model_manager();
 	ModelManager_CPtr model_manager() const;
 	int object_count() const;
@@ -96,17 +156,24 @@ public:
 	void queue_for_destruction(const ObjectID& id);
 	void register_group(const std::string& name, const GroupPredicate& pred);
 	void remove_listener(IObjectComponent *listener, const ObjectID& id);
+	void set_group_consistency_checking(bool enabled);
 	const SpriteManager_Ptr& sprite_manager();
 	SpriteManager_CPtr sprite_manager() const;
+	void update_group_membership(const ObjectID& id);
 
 	//#################### PRIVATE METHODS ####################
 private:
+	template <typename T> ComponentArray<T>& component_array() const;
+	template <typename T> static int component_type_id();
 	ObjectID create_object(const ObjectSpecification& specification);
 	void destroy_object(const ObjectID& id);
 	void flush_construction_queue();
 	void flush_destruction_queue();
-	template <typename T> shared_ptr<T> get_component(const ObjectID& id, const std::string& group);
-	template <typename T> shared_ptr<const T> get_component(const ObjectID& id, const std::string& group) const;
+	template <typename T> shared_ptr<T> lookup_component(const ObjectID& id) const;
+	static int next_component_type_id();
+	std::vector<ObjectID> scan_group(const GroupPredicate& pred) const;
+	static void set_group_membership(Group& group, const ObjectID& id, bool member);
+	void subscribe_to_messages(IObjectComponent *component);
 };
 
 //#################### TYPEDEFS ####################
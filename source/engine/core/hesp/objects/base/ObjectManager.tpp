@@ -11,38 +11,69 @@
 namespace hesp {
 
 //#################### PUBLIC METHODS ####################
+/**
+Looks up the component of the specified object which can be accessed via the interface type T.
+This is a typed lookup into a dense array, so it involves neither string comparisons nor RTTI.
+
+@param id			The ID of the object
+@return				The component, if the object has one, or NULL otherwise
+@throws Exception	If the object ID is invalid
+*/
 template <typename T>
 shared_ptr<T> ObjectManager::get_component(const ObjectID& id, const shared_ptr<T>&)
 {
-	return get_component<T>(id, T::static_group_type());
+	return lookup_component<T>(id);
 }
 
 template <typename T>
 shared_ptr<const T> ObjectManager::get_component(const ObjectID& id, const shared_ptr<const T>&) const
 {
-	return get_component<const T>(id, T::static_group_type());
+	return lookup_component<T>(id);
 }
 
 //#################### PRIVATE METHODS ####################
+/**
+Returns the dense array of the components which can be accessed via the interface type T,
+creating it (and filling it in from the existing objects) if it doesn't exist yet.
+*/
 template <typename T>
-shared_ptr<T> ObjectManager::get_component(const ObjectID& id, const std::string& group)
+ObjectManager::ComponentArray<T>& ObjectManager::component_array() const
 {
-	return boost::const_pointer_cast<T,const T>(const_cast<const ObjectManager *>(this)->get_component<const T>(id, group));
+	int typeID = component_type_id<T>();
+	if(typeID >= static_cast<int>(m_componentArrays.size())) m_componentArrays.resize(typeID + 1);
+
+	ComponentArray_Ptr& arr = m_componentArrays[typeID];
+	if(!arr)
+	{
+		arr.reset(new ComponentArray<T>);
+		for(std::map<ObjectID,Object>::const_iterator it=m_objects.begin(), iend=m_objects.end(); it!=iend; ++it)
+		{
+			Object::const_iterator jt = it->second.find(T::static_group_type());
+			if(jt != it->second.end()) arr->add_component(it->first.value(), jt->second);
+		}
+	}
+
+	return static_cast<ComponentArray<T>&>(*arr);
 }
 
+/**
+Returns the ID of the component type T, assigning it one the first time it's used.
+*/
 template <typename T>
-shared_ptr<const T> ObjectManager::get_component(const ObjectID& id, const std::string& group) const
+int ObjectManager::component_type_id()
 {
-	std::map<ObjectID,Object>::const_iterator it = m_objects.find(id);
-	if(it == m_objects.end()) throw Exception("Invalid object ID: " + id.to_string());
-
-	const Object& object = it->second;
+	static int typeID = next_component_type_id();
+	return typeID;
+}
 
-	Object::const_iterator jt = object.find(group);
-	if(jt == object.end()) return shared_ptr<const T>();
+template <typename T>
+shared_ptr<T> ObjectManager::lookup_component(const ObjectID& id) const
+{
+	int slot = id.value();
+	if(slot < 0 || slot >= static_cast<int>(m_liveObjects.size()) || !m_liveObjects[slot]) throw Exception("Invalid object ID: " + id.to_string());
 
-	// Note that there's an implicit T -> const T conversion done when returning here.
-	return boost::dynamic_pointer_cast<T,IObjectComponent>(jt->second);
+	const std::vector<shared_ptr<T> >& components = component_array<T>().components;
+	return slot < static_cast<int>(components.size()) ? components[slot] : shared_ptr<T>();
 }
 
 }
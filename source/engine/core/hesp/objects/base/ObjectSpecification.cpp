@@ -30,6 +30,7 @@ namespace hesp {
 //#################### STATIC VARIABLES ####################
 bool ObjectSpecification::s_mapsBuilt = false;
 std::map<std::string,ObjectSpecification::ComponentLoader> ObjectSpecification::s_componentLoaders;
+std::map<std::string,int> ObjectSpecification::s_groupIDs;
 std::map<std::string,std::string> ObjectSpecification::s_groupNames;
 
 //#################### PUBLIC METHODS ####################
@@ -53,6 +54,23 @@ std::vector<IObjectComponent_Ptr> ObjectSpecification::instantiate_components()
 	return ret;
 }
 
+//#################### PUBLIC LOOKUP METHODS ####################
+/**
+Returns the integer ID of the specified component group. The IDs are in the same order as the group names,
+so ordering components by group ID is equivalent to ordering them by group name.
+
+@param groupName	The name of the group
+@return				The ID of the group
+@throws Exception	If no component types have been registered in the group
+*/
+int ObjectSpecification::group_id(const std::string& groupName)
+{
+	std::map<std::string,int>& groupIDs = group_ids();
+	std::map<std::string,int>::const_iterator it = groupIDs.find(groupName);
+	if(it != groupIDs.end()) return it->second;
+	else throw Exception("No components have been registered in the group: " + groupName);
+}
+
 //#################### LOOKUP METHODS ####################
 #define ADD_ELEMENTS(c) s_componentLoaders[#c] = &Cmp##c::load; s_groupNames[#c] = Cmp##c::static_group_type();
 
@@ -78,6 +96,18 @@ void ObjectSpecification::build_maps()
 		ADD_ELEMENTS(Simulation);
 		ADD_ELEMENTS(SpriteRender);
 		ADD_ELEMENTS(UserBipedYoke);
+
+		// Number the groups in order of their names.
+		for(std::map<std::string,std::string>::const_iterator it=s_groupNames.begin(), iend=s_groupNames.end(); it!=iend; ++it)
+		{
+			s_groupIDs.insert(std::make_pair(it->second, 0));
+		}
+		int groupID = 0;
+		for(std::map<std::string,int>::iterator it=s_groupIDs.begin(), iend=s_groupIDs.end(); it!=iend; ++it)
+		{
+			it->second = groupID++;
+		}
+
 		s_mapsBuilt = true;
 	}
 }
@@ -90,6 +120,12 @@ std::map<std::string,ObjectSpecification::ComponentLoader>& ObjectSpecification:
 	return s_componentLoaders;
 }
 
+std::map<std::string,int>& ObjectSpecification::group_ids()
+{
+	build_maps();
+	return s_groupIDs;
+}
+
 std::map<std::string,std::string>& ObjectSpecification::group_names()
 {
 	build_maps();
@@ -34,6 +34,7 @@ private:
 
 	static bool s_mapsBuilt;
 	static std::map<std::string,ComponentLoader> s_componentLoaders;
+	static std::map<std::string,int> s_groupIDs;
 	static std::map<std::string,std::string> s_groupNames;
 
 	//#################### PUBLIC METHODS ####################
@@ -42,10 +43,15 @@ public:
 	std::vector<IObjectComponent_Ptr> instantiate_components() const;
 	template <typename T> void set_component_property(const std::string& groupName, const std::string& propertyName, const T& value);
 
+	//#################### PUBLIC LOOKUP METHODS ####################
+public:
+	static int group_id(const std::string& groupName);
+
 	//#################### LOOKUP METHODS ####################
 private:
 	static void build_maps();
 	static std::map<std::string,ComponentLoader>& component_loaders();
+	static std::map<std::string,int>& group_ids();
 	static std::map<std::string,std::string>& group_names();
 	static IObjectComponent_Ptr invoke_component_loader(const std::string& componentName, const Properties& properties);
 	static std::string lookup_group(const std::string& componentName);
@@ -5,6 +5,7 @@
 
 #include "CmpBasicProjectile.h"
 
+#include <hesp/objects/base/MessageSubscriberTable.h>
 #include <hesp/objects/messages/MsgObjectDestroyed.h>
 
 namespace hesp {
@@ -52,4 +53,9 @@ Properties CmpBasicProjectile::save() const
 	return properties;
 }
 
+void CmpBasicProjectile::subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+{
+	subscriberTable.subscribe<MsgObjectDestroyed>(this);
+}
+
 }
@@ -37,6 +37,7 @@ public:
 	void process_message(const MsgObjectDestroyed& msg);
 	void register_listening();
 	Properties save() const;
+	void subscribe_to_messages(MessageSubscriberTable& subscriberTable);
 
 	std::string own_type() const			{ return "BasicProjectile"; }
 	static std::string static_own_type()	{ return "BasicProjectile"; }
@@ -8,6 +8,7 @@
 #include <set>
 #include <vector>
 
+#include <hesp/objects/base/MessageSubscriberTable.h>
 #include <hesp/objects/messages/MsgObjectDestroyed.h>
 #include <hesp/objects/messages/MsgObjectPredestroyed.h>
 #include <hesp/util/Properties.h>
@@ -142,6 +143,12 @@ Properties CmpInventory::save() const
 	return properties;
 }
 
+void CmpInventory::subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+{
+	subscriberTable.subscribe<MsgObjectDestroyed>(this);
+	subscriberTable.subscribe<MsgObjectPredestroyed>(this);
+}
+
 //#################### PRIVATE METHODS ####################
 void CmpInventory::initialise_if_necessary() const
 {
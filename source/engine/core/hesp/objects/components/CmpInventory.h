@@ -51,6 +51,7 @@ public:
 	void register_listening();
 	void remove_item(const ObjectID& id);
 	Properties save() const;
+	void subscribe_to_messages(MessageSubscriberTable& subscriberTable);
 
 	//#################### PRIVATE METHODS ####################
 private:
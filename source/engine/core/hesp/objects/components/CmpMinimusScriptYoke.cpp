@@ -37,7 +37,7 @@ void CmpMinimusScriptYoke::check_dependencies() const
 
 std::vector<ObjectCommand_Ptr> CmpMinimusScriptYoke::generate_commands(InputState& input)
 {
-	if(!m_yoke) m_yoke.reset(new MinimusScriptYoke(m_objectID, m_objectManager, m_scriptName, m_objectManager->ai_engine()));
+	if(!m_yoke) m_yoke.reset(new MinimusScriptYoke(m_objectID, m_objectManager, m_scriptName, m_objectManager->ai_module_cache()));
 	return m_yoke->generate_commands(input);
 }
 
@@ -5,6 +5,7 @@
 
 #include "CmpOwnable.h"
 
+#include <hesp/objects/base/ObjectManager.h>
 #include <hesp/util/Properties.h>
 
 namespace hesp {
@@ -36,6 +37,7 @@ const std::string& CmpOwnable::attach_point() const
 void CmpOwnable::clear_owner()
 {
 	m_owner = ObjectID();
+	m_objectManager->update_group_membership(m_objectID);
 }
 
 const ObjectID& CmpOwnable::owner() const
@@ -55,6 +57,7 @@ Properties CmpOwnable::save() const
 void CmpOwnable::set_owner(const ObjectID& owner)
 {
 	m_owner = owner;
+	m_objectManager->update_group_membership(m_objectID);
 }
 
 }
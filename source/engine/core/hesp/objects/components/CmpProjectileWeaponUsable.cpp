@@ -5,6 +5,7 @@
 
 #include "CmpProjectileWeaponUsable.h"
 
+#include <hesp/objects/base/MessageSubscriberTable.h>
 #include <hesp/objects/messages/MsgTimeElapsed.h>
 #include <hesp/util/Properties.h>
 #include "ICmpInventory.h"
@@ -59,6 +60,11 @@ Properties CmpProjectileWeaponUsable::save() const
 	return properties;
 }
 
+void CmpProjectileWeaponUsable::subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+{
+	subscriberTable.subscribe<MsgTimeElapsed>(this);
+}
+
 void CmpProjectileWeaponUsable::use()
 {
 	if(m_timeTillCanFire == 0)
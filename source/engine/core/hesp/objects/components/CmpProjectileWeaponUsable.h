@@ -46,6 +46,7 @@ public:
 	void check_dependencies() const;
 	void process_message(const MsgTimeElapsed& msg);
 	Properties save() const;
+	void subscribe_to_messages(MessageSubscriberTable& subscriberTable);
 	void use();
 
 	std::string own_type() const			{ return "ProjectileWeaponUsable"; }
@@ -17,6 +17,13 @@ BounceContactResolver::BounceContactResolver(double restitutionCoefficient)
 :	m_restitutionCoefficient(restitutionCoefficient)
 {}
 
+//#################### PUBLIC METHODS ####################
+bool BounceContactResolver::is_thread_safe() const
+{
+	// Bouncing only modifies the objects involved in the contact.
+	return true;
+}
+
 //#################### PRIVATE METHODS ####################
 void BounceContactResolver::resolve_object_object(const Contact& contact, const OnionTree_CPtr& tree) const
 {
@@ -20,6 +20,10 @@ private:
 public:
 	explicit BounceContactResolver(double restitutionCoefficient);
 
+	//#################### PUBLIC METHODS ####################
+public:
+	bool is_thread_safe() const;
+
 	//#################### PRIVATE METHODS ####################
 private:
 	void resolve_object_object(const Contact& contact, const OnionTree_CPtr& tree) const;
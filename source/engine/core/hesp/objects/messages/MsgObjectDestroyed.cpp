@@ -13,11 +13,6 @@ MsgObjectDestroyed::MsgObjectDestroyed(const ObjectID& id)
 {}
 
 //#################### PUBLIC METHODS ####################
-void MsgObjectDestroyed::dispatch(MessageHandlerBase *handler) const
-{
-	dynamic_dispatch(handler, *this);
-}
-
 const ObjectID& MsgObjectDestroyed::object_id() const
 {
 	return m_id;
@@ -30,4 +25,9 @@ std::set<ObjectID> MsgObjectDestroyed::referenced_objects() const
 	return ret;
 }
 
+int MsgObjectDestroyed::type_id() const
+{
+	return message_type_id<MsgObjectDestroyed>();
+}
+
 }
@@ -23,9 +23,9 @@ public:
 
 	//#################### PUBLIC METHODS ####################
 public:
-	void dispatch(MessageHandlerBase *handler) const;
 	const ObjectID& object_id() const;
 	std::set<ObjectID> referenced_objects() const;
+	int type_id() const;
 };
 
 }
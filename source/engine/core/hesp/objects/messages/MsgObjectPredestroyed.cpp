@@ -13,11 +13,6 @@ MsgObjectPredestroyed::MsgObjectPredestroyed(const ObjectID& id)
 {}
 
 //#################### PUBLIC METHODS ####################
-void MsgObjectPredestroyed::dispatch(MessageHandlerBase *handler) const
-{
-	dynamic_dispatch(handler, *this);
-}
-
 const ObjectID& MsgObjectPredestroyed::object_id() const
 {
 	return m_id;
@@ -30,4 +25,9 @@ std::set<ObjectID> MsgObjectPredestroyed::referenced_objects() const
 	return ret;
 }
 
+int MsgObjectPredestroyed::type_id() const
+{
+	return message_type_id<MsgObjectPredestroyed>();
+}
+
 }
@@ -15,11 +15,6 @@ MsgTimeElapsed::MsgTimeElapsed(int milliseconds)
 {}
 
 //#################### PUBLIC METHODS ####################
-void MsgTimeElapsed::dispatch(MessageHandlerBase *handler) const
-{
-	dynamic_dispatch(handler, *this);
-}
-
 int MsgTimeElapsed::milliseconds() const
 {
 	return m_milliseconds;
@@ -30,4 +25,9 @@ std::set<ObjectID> MsgTimeElapsed::referenced_objects() const
 	return std::set<ObjectID>();
 }
 
+int MsgTimeElapsed::type_id() const
+{
+	return message_type_id<MsgTimeElapsed>();
+}
+
 }
@@ -22,9 +22,9 @@ public:
 
 	//#################### PUBLIC METHODS ####################
 public:
-	void dispatch(MessageHandlerBase *handler) const;
 	int milliseconds() const;
 	std::set<ObjectID> referenced_objects() const;
+	int type_id() const;
 };
 
 }
@@ -7,12 +7,12 @@
 
 #include <hesp/bounds/BoundsManager.h>
 #include <hesp/database/Database.h>
-#include <hesp/nav/GlobalPathfinder.h>
 #include <hesp/nav/NavDataset.h>
 #include <hesp/nav/NavLink.h>
 #include <hesp/nav/NavManager.h>
 #include <hesp/nav/NavMesh.h>
 #include <hesp/nav/NavMeshUtil.h>
+#include <hesp/nav/PathQueryService.h>
 #include <hesp/objects/commands/CmdBipedSetLook.h>
 #include <hesp/objects/commands/CmdBipedWalk.h>
 #include <hesp/objects/components/ICmpMovement.h>
@@ -22,9 +22,15 @@ namespace hesp {
 
 //#################### CONSTRUCTORS ####################
 MinimusGotoPositionYoke::MinimusGotoPositionYoke(const ObjectID& objectID, const ObjectManager *objectManager, const Vector3d& dest)
-:	m_objectID(objectID), m_objectManager(objectManager), m_dest(dest)
+:	m_objectID(objectID), m_objectManager(objectManager), m_dest(dest), m_pathQueryID(-1)
 {}
 
+//#################### DESTRUCTOR ####################
+MinimusGotoPositionYoke::~MinimusGotoPositionYoke()
+{
+	if(m_pathQueryID != -1) m_pathQueryService->cancel_query(m_pathQueryID);
+}
+
 	//#################### PUBLIC METHODS ####################
 std::vector<ObjectCommand_Ptr> MinimusGotoPositionYoke::generate_commands(InputState& input)
 {
@@ -46,23 +52,34 @@ std::vector<ObjectCommand_Ptr> MinimusGotoPositionYoke::generate_commands(InputS
 
 	if(!m_path)
 	{
-		int mapIndex = m_objectManager->bounds_manager()->lookup_bounds_index(cmpSimulation->bounds_group(), cmpSimulation->posture());
-		NavDataset_CPtr navDataset = navManager->dataset(mapIndex);
-		NavMesh_CPtr navMesh = navDataset->nav_mesh();
-		GlobalPathfinder pathfinder(navMesh, navDataset->adjacency_list(), navDataset->path_table());
-
-		int suggestedSourcePoly = cmpMovement->cur_nav_poly_index();
-		int sourcePoly = NavMeshUtil::find_nav_polygon(source, suggestedSourcePoly, *polygons, tree, navMesh);
-		if(sourcePoly == -1)	{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
-		int destPoly = NavMeshUtil::find_nav_polygon(m_dest, -1, *polygons, tree, navMesh);
-		if(destPoly == -1)		{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
-
-		// FIXME: It's wasteful to copy the array of links each time (even though it's an array of pointers).
-		m_links = navMesh->links();
-
-		m_path.reset(new std::list<int>);
-		bool pathFound = pathfinder.find_path(source, sourcePoly, m_dest, destPoly, *m_path);
-		if(!pathFound)			{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
+		// If we haven't yet asked for a path, submit a path query. The path query service will
+		// process it at the end of the yoke phase, so we'll get the result next time round.
+		if(m_pathQueryID == -1)
+		{
+			int mapIndex = m_objectManager->bounds_manager()->lookup_bounds_index(cmpSimulation->bounds_group(), cmpSimulation->posture());
+			NavMesh_CPtr navMesh = navManager->dataset(mapIndex)->nav_mesh();
+
+			int suggestedSourcePoly = cmpMovement->cur_nav_poly_index();
+			int sourcePoly = NavMeshUtil::find_nav_polygon(source, suggestedSourcePoly, *polygons, tree, navMesh);
+			if(sourcePoly == -1)	{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
+			int destPoly = NavMeshUtil::find_nav_polygon(m_dest, -1, *polygons, tree, navMesh);
+			if(destPoly == -1)		{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
+
+			// FIXME: It's wasteful to copy the array of links each time (even though it's an array of pointers).
+			m_links = navMesh->links();
+
+			m_pathQueryService = db.get("db://PathQueryService", m_pathQueryService);
+			m_pathQueryID = m_pathQueryService->submit_query(mapIndex, source, sourcePoly, m_dest, destPoly);
+			return std::vector<ObjectCommand_Ptr>();
+		}
+
+		shared_ptr<std::list<int> > path(new std::list<int>);
+		PathQueryService::QueryStatus status = m_pathQueryService->take_result(m_pathQueryID, *path);
+		if(status == PathQueryService::QUERY_PENDING) return std::vector<ObjectCommand_Ptr>();
+
+		m_pathQueryID = -1;
+		if(status == PathQueryService::QUERY_FAILED)	{ m_state = YOKE_FAILED; return std::vector<ObjectCommand_Ptr>(); }
+		m_path = path;
 	}
 
 	// FIXME:	The way this yoke decides that it's traversed a link isn't sufficient.
@@ -17,6 +17,7 @@ namespace hesp {
 //#################### FORWARD DECLARATIONS ####################
 typedef shared_ptr<class NavLink> NavLink_Ptr;
 class ObjectManager;
+typedef shared_ptr<class PathQueryService> PathQueryService_Ptr;
 
 /**
 This class represents a goto position yoke for the Minimus bot.
@@ -32,10 +33,17 @@ private:
 	std::vector<NavLink_Ptr> m_links;
 	shared_ptr<std::list<int> > m_path;
 
+	PathQueryService_Ptr m_pathQueryService;
+	int m_pathQueryID;						// the ID of the outstanding path query (if any), or -1 otherwise
+
 	//#################### CONSTRUCTORS ####################
 public:
 	MinimusGotoPositionYoke(const ObjectID& objectID, const ObjectManager *objectManager, const Vector3d& dest);
 
+	//#################### DESTRUCTOR ####################
+public:
+	~MinimusGotoPositionYoke();
+
 	//#################### PUBLIC METHODS ####################
 public:
 	std::vector<ObjectCommand_Ptr> generate_commands(InputState& input);
@@ -5,30 +5,33 @@
 
 #include "MinimusScriptYoke.h"
 
-#include <iostream>
-
-#include <hesp/exceptions/Exception.h>
-#include <hesp/io/util/DirectoryFinder.h>
+#include <hesp/objects/ai/ScriptModuleCache.h>
 #include "MinimusGotoPositionYoke.h"
-namespace bf = boost::filesystem;
 
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
-MinimusScriptYoke::MinimusScriptYoke(const ObjectID& objectID, ObjectManager *objectManager, const std::string& scriptName, const ASXEngine_Ptr& engine)
-:	m_objectID(objectID), m_objectManager(objectManager), m_engine(engine), m_initialised(false)
+MinimusScriptYoke::MinimusScriptYoke(const ObjectID& objectID, ObjectManager *objectManager, const std::string& scriptName, const ScriptModuleCache_Ptr& moduleCache)
+:	m_objectID(objectID), m_objectManager(objectManager), m_moduleCache(moduleCache), m_initialised(false)
 {
-	bf::path scriptsDir = DirectoryFinder::instance().determine_scripts_directory();
-	std::string scriptFilename = (scriptsDir / (scriptName + ".as")).file_string();
-
-	m_engine->clear_messages();
-	if(!m_engine->load_and_build_script(scriptFilename, scriptName))
-	{
-		m_engine->output_messages(std::cout);
-		throw Exception("Could not build script module " + scriptName);
-	}
+	// Each yoke gets its own module (so that it has its own copy of the script's global state), but the
+	// script itself is only built once. The script functions are looked up once here, rather than every frame.
+	m_moduleName = m_moduleCache->instantiate_module(scriptName);
+	m_module = m_moduleCache->engine()->get_module(m_moduleName);
+	ScriptFunction init = m_module->get_global_function("init", init);
+	ScriptFunction process = m_module->get_global_function("process", process);
+	m_initFunction.reset(new ScriptFunction(init));
+	m_processFunction.reset(new ScriptFunction(process));
+}
 
-	m_module = m_engine->get_module(scriptName);
+//#################### DESTRUCTOR ####################
+MinimusScriptYoke::~MinimusScriptYoke()
+{
+	// Note: The script functions and module must be released before the module is discarded.
+	m_initFunction.reset();
+	m_processFunction.reset();
+	m_module.reset();
+	m_moduleCache->release_module(m_moduleName);
 }
 
 //#################### PUBLIC METHODS ####################
@@ -42,15 +45,13 @@ std::vector<ObjectCommand_Ptr> MinimusScriptYoke::generate_commands(InputState&
 	if(!m_initialised)
 	{
 		// Run the script init method.
-		ASXFunction<void(MinimusScriptYoke*)> init = m_module->get_global_function("init", init);
-		init(this);
+		(*m_initFunction)(this);
 
 		m_initialised = true;
 	}
 
 	// Run the script process method.
-	ASXFunction<void(MinimusScriptYoke*)> process = m_module->get_global_function("process", process);
-	process(this);
+	(*m_processFunction)(this);
 
 	if(m_subyoke && m_subyoke->state() == YOKE_ACTIVE)
 	{
@@ -17,23 +17,36 @@ namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
 class ObjectManager;
+typedef shared_ptr<class ScriptModuleCache> ScriptModuleCache_Ptr;
 
 class MinimusScriptYoke : public IYoke, public ASXRefType<MinimusScriptYoke>
 {
+	//#################### TYPEDEFS ####################
+private:
+	typedef ASXFunction<void(MinimusScriptYoke*)> ScriptFunction;
+	typedef shared_ptr<ScriptFunction> ScriptFunction_Ptr;
+
 	//#################### PRIVATE VARIABLES ####################
 private:
 	ObjectID m_objectID;
 	ObjectManager *m_objectManager;
 
-	ASXEngine_Ptr m_engine;
+	ScriptModuleCache_Ptr m_moduleCache;
+	std::string m_moduleName;
 	ASXModule_Ptr m_module;
+	ScriptFunction_Ptr m_initFunction;
+	ScriptFunction_Ptr m_processFunction;
 	bool m_initialised;
 
 	IYoke_Ptr m_subyoke;
 
 	//#################### CONSTRUCTORS ####################
 public:
-	MinimusScriptYoke(const ObjectID& objectID, ObjectManager *objectManager, const std::string& scriptName, const ASXEngine_Ptr& engine);
+	MinimusScriptYoke(const ObjectID& objectID, ObjectManager *objectManager, const std::string& scriptName, const ScriptModuleCache_Ptr& moduleCache);
+
+	//#################### DESTRUCTOR ####################
+public:
+	~MinimusScriptYoke();
 
 	//#################### PUBLIC METHODS ####################
 public:
@@ -5,6 +5,7 @@
 
 #include "BroadPhaseCollisionDetector.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -14,24 +15,113 @@
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
-BroadPhaseCollisionDetector::BroadPhaseCollisionDetector(const BoundsManager_CPtr& boundsManager,
-														 double minObjectSize, double maxObjectSize)
-:	m_boundsManager(boundsManager)
+BroadPhaseCollisionDetector::BroadPhaseCollisionDetector(double minObjectSize, double maxObjectSize)
+:	m_freeEntries(-1)
 {
-	for(double gridSize=minObjectSize; gridSize<maxObjectSize*2; gridSize*=2)
+	Grid grid;
+	grid.usedCellCount = 0;
+	grid.objectCount = 0;
+
+	for(double cellSize=minObjectSize; cellSize<maxObjectSize*2; cellSize*=2)
 	{
-		m_hgrid.insert(std::make_pair(gridSize, Grid()));
+		grid.cellSize = cellSize;
+		m_grids.push_back(grid);
 	}
 
-	m_hgrid.insert(std::make_pair(std::numeric_limits<double>::max(), Grid()));
+	grid.cellSize = std::numeric_limits<double>::max();
+	m_grids.push_back(grid);
 }
 
 //#################### PUBLIC METHODS ####################
-void BroadPhaseCollisionDetector::add_object(const PhysicsObject_Ptr& object)
+/**
+Finds the pairs of objects which might be colliding, based on the latest updates to the objects.
+
+@return	The potential collisions, in ascending order of object ID
+*/
+const BroadPhaseCollisionDetector::ObjectPairs& BroadPhaseCollisionDetector::find_potential_collisions()
+{
+	m_pairIDs.clear();
+
+	const int gridCount = static_cast<int>(m_grids.size());
+	for(int id=0, objectCount=static_cast<int>(m_objects.size()); id<objectCount; ++id)
+	{
+		const ObjectState& state = m_objects[id];
+		if(state.grid == -1) continue;
+
+		// Look for objects which overlap the same cells as this one in its own lowest grid, or
+		// in the lowest grids of objects which are bigger than it. (Pairs of objects sharing the
+		// same lowest grid would find each other, so only the object with the lower ID records them.)
+		for(int g=state.grid; g<gridCount; ++g)
+		{
+			const Grid& grid = m_grids[g];
+			if(grid.objectCount == 0) continue;
+
+			CellIndex minCell = g == state.grid ? state.minCell : determine_cell(state.mins, grid.cellSize);
+			CellIndex maxCell = g == state.grid ? state.maxCell : determine_cell(state.maxs, grid.cellSize);
+
+			for(int i=minCell.i; i<=maxCell.i; ++i)
+				for(int j=minCell.j; j<=maxCell.j; ++j)
+					for(int k=minCell.k; k<=maxCell.k; ++k)
+					{
+						int cell = find_cell(grid, CellIndex(i,j,k));
+						if(cell == -1) continue;
+
+						for(int e=grid.cells[cell].firstEntry; e!=-1; e=m_entries[e].next)
+						{
+							int otherID = m_entries[e].objectID;
+							if(g == state.grid && otherID <= id) continue;
+							m_pairIDs.push_back(std::make_pair(std::min(id, otherID), std::max(id, otherID)));
+						}
+					}
+		}
+	}
+
+	// A pair of objects may have been recorded once for each cell they share.
+	std::sort(m_pairIDs.begin(), m_pairIDs.end());
+	m_pairIDs.erase(std::unique(m_pairIDs.begin(), m_pairIDs.end()), m_pairIDs.end());
+
+	m_potentialCollisions.clear();
+	for(std::vector<std::pair<int,int> >::const_iterator it=m_pairIDs.begin(), iend=m_pairIDs.end(); it!=iend; ++it)
+	{
+		m_potentialCollisions.push_back(std::make_pair(m_objects[it->first].object.get(), m_objects[it->second].object.get()));
+	}
+
+	return m_potentialCollisions;
+}
+
+const BroadPhaseCollisionDetector::ObjectPairs& BroadPhaseCollisionDetector::potential_collisions() const
+{
+	return m_potentialCollisions;
+}
+
+/**
+Removes the object with the specified ID from the detector (if it's present).
+
+@param id	The ID of the object
+*/
+void BroadPhaseCollisionDetector::remove_object(int id)
+{
+	if(id < 0 || id >= static_cast<int>(m_objects.size())) return;
+
+	ObjectState& state = m_objects[id];
+	if(state.grid == -1) return;
+
+	remove_from_cells(id, state.grid, state.minCell, state.maxCell);
+	state.object.reset();
+	state.grid = -1;
+}
+
+/**
+Updates the detector to take account of the latest movement of an object (adding the object
+to the detector if necessary). The object's cells only change if it has moved into different ones.
+
+@param object			The object
+@param boundsManager	The bounds manager which contains the bounds for the object
+*/
+void BroadPhaseCollisionDetector::update_object(const PhysicsObject_Ptr& object, const BoundsManager_CPtr& boundsManager)
 {
-	// Step 1:	Determine the lowest grid for the object, based on the maximum dimension of
-	// the bounding box of its movement.
-	Vector3d halfDimensions = object->bounds(m_boundsManager)->half_dimensions();
+	// Step 1:	Determine the bounding box of the object's movement.
+	Vector3d halfDimensions = object->bounds(boundsManager)->half_dimensions();
 	Vector3d previousPos = object->previous_position() ? *object->previous_position() : object->position();
 	Vector3d pos = object->position();
 
@@ -40,102 +130,193 @@ void BroadPhaseCollisionDetector::add_object(const PhysicsObject_Ptr& object)
 	Vector3d maxs(std::max(previousPos.x, pos.x), std::max(previousPos.y, pos.y), std::max(previousPos.z, pos.z));
 	maxs += halfDimensions;
 
+	// Step 2:	Determine the lowest grid for the object, based on the maximum dimension of the bounding box,
+	//			and the cells it overlaps in that grid.
 	Vector3d size = maxs - mins;
 	double maxDimension = std::max(std::max(size.x, size.y), size.z);
 
-	HGrid::iterator lowestGrid = m_hgrid.lower_bound(maxDimension);
+	int gridIndex = 0;
+	while(m_grids[gridIndex].cellSize < maxDimension) ++gridIndex;	// the last grid's cells are infinitely big, so this terminates
 
-	// Step 2:	Determine which cells it overlaps on the lowest grid just identified.
-	std::set<CellIndex> cells = determine_overlapped_cells(mins, maxs, lowestGrid->first);
+	CellIndex minCell = determine_cell(mins, m_grids[gridIndex].cellSize);
+	CellIndex maxCell = determine_cell(maxs, m_grids[gridIndex].cellSize);
 
-	// Step 3:	Insert the object into every grid above (and including) the lowest one,
-	//			flagging collisions where applicable.
-	for(HGrid::iterator it=lowestGrid, iend=m_hgrid.end(); it!=iend; ++it)
+	// Step 3:	Update the object's state, moving it to its new cells if they've changed.
+	int id = object->id();
+	if(id >= static_cast<int>(m_objects.size()))
 	{
-		bool lowest = it == lowestGrid;
+		ObjectState blankState;
+		blankState.grid = -1;
+		m_objects.resize(id + 1, blankState);
+	}
 
-		if(!lowest)
-		{
-			// Propagate the cells up to the next layer.
-			cells = propagate_cells(cells);
-		}
+	ObjectState& state = m_objects[id];
+	if(state.object != object)
+	{
+		remove_object(id);
+		state.object = object;
+	}
 
-		for(std::set<CellIndex>::const_iterator jt=cells.begin(), jend=cells.end(); jt!=jend; ++jt)
-		{
-			CellData& data = it->second[*jt];
+	if(state.grid != gridIndex || state.minCell != minCell || state.maxCell != maxCell)
+	{
+		if(state.grid != -1) remove_from_cells(id, state.grid, state.minCell, state.maxCell);
+		add_to_cells(id, gridIndex, minCell, maxCell);
+		state.grid = gridIndex;
+		state.minCell = minCell;
+		state.maxCell = maxCell;
+	}
+
+	state.mins = mins;
+	state.maxs = maxs;
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Adds a cell to a grid's hash table, rebuilding the table first if it's getting full.
+
+@param grid		The grid
+@param index	The index of the cell (which must not already be in the table)
+@return			The slot in the hash table which now holds the cell
+*/
+int BroadPhaseCollisionDetector::add_cell(Grid& grid, const CellIndex& index)
+{
+	// Keep the table at most half full, so that probe sequences stay short.
+	if((grid.usedCellCount + 1) * 2 > static_cast<int>(grid.cells.size())) rebuild_cells(grid);
+
+	int mask = static_cast<int>(grid.cells.size()) - 1;
+	int slot = hash(index, mask);
+	while(grid.cells[slot].used) slot = (slot + 1) & mask;
+
+	Cell& cell = grid.cells[slot];
+	cell.index = index;
+	cell.firstEntry = -1;
+	cell.used = true;
+	++grid.usedCellCount;
+	return slot;
+}
 
-			// Look through the objects already overlapping the cell and flag any necessary collisions.
-			for(CellData::const_iterator kt=data.begin(), kend=data.end(); kt!=kend; ++kt)
+void BroadPhaseCollisionDetector::add_to_cells(int id, int gridIndex, const CellIndex& minCell, const CellIndex& maxCell)
+{
+	Grid& grid = m_grids[gridIndex];
+	for(int i=minCell.i; i<=maxCell.i; ++i)
+		for(int j=minCell.j; j<=maxCell.j; ++j)
+			for(int k=minCell.k; k<=maxCell.k; ++k)
 			{
-				if(lowest || kt->second)	// if this is the lowest layer for at least one of the objects
+				CellIndex index(i,j,k);
+				int cell = find_cell(grid, index);
+				if(cell == -1) cell = add_cell(grid, index);
+
+				int e;
+				if(m_freeEntries != -1)
 				{
-					m_potentialCollisions.insert(std::make_pair(kt->first, object));
+					e = m_freeEntries;
+					m_freeEntries = m_entries[e].next;
 				}
+				else
+				{
+					e = static_cast<int>(m_entries.size());
+					m_entries.push_back(CellEntry());
+				}
+
+				m_entries[e].objectID = id;
+				m_entries[e].next = grid.cells[cell].firstEntry;
+				grid.cells[cell].firstEntry = e;
 			}
 
-			// Add the object itself to the set of those overlapping the cell.
-			data.push_back(std::make_pair(object, lowest));
-		}
-	}
+	++grid.objectCount;
 }
 
-const BroadPhaseCollisionDetector::ObjectPairs& BroadPhaseCollisionDetector::potential_collisions() const
+BroadPhaseCollisionDetector::CellIndex
+BroadPhaseCollisionDetector::determine_cell(const Vector3d& p, double cellSize)
 {
-	return m_potentialCollisions;
+	return CellIndex(static_cast<int>(floor(p.x / cellSize)),
+					 static_cast<int>(floor(p.y / cellSize)),
+					 static_cast<int>(floor(p.z / cellSize)));
 }
 
-void BroadPhaseCollisionDetector::reset()
+/**
+Looks up a cell in a grid's hash table.
+
+@param grid		The grid
+@param index	The index of the cell
+@return			The slot in the hash table which holds the cell, or -1 if the cell isn't in the table
+*/
+int BroadPhaseCollisionDetector::find_cell(const Grid& grid, const CellIndex& index)
 {
-	for(HGrid::iterator it=m_hgrid.begin(), iend=m_hgrid.end(); it!=iend; ++it)
+	if(grid.cells.empty()) return -1;
+
+	int mask = static_cast<int>(grid.cells.size()) - 1;
+	for(int slot=hash(index, mask); grid.cells[slot].used; slot=(slot+1)&mask)
 	{
-		it->second.clear();
+		if(grid.cells[slot].index == index) return slot;
 	}
-
-	m_potentialCollisions.clear();
+	return -1;
 }
 
-//#################### PRIVATE METHODS ####################
-BroadPhaseCollisionDetector::CellIndex
-BroadPhaseCollisionDetector::determine_cell(const Vector3d& p, double gridSize)
+int BroadPhaseCollisionDetector::hash(const CellIndex& index, int mask)
 {
-	return CellIndex(static_cast<int>(floor(p.x / gridSize)),
-					 static_cast<int>(floor(p.y / gridSize)),
-					 static_cast<int>(floor(p.z / gridSize)));
+	unsigned int h = static_cast<unsigned int>(index.i) * 73856093u ^ static_cast<unsigned int>(index.j) * 19349663u ^ static_cast<unsigned int>(index.k) * 83492791u;
+	return static_cast<int>(h & static_cast<unsigned int>(mask));
 }
 
-std::set<BroadPhaseCollisionDetector::CellIndex>
-BroadPhaseCollisionDetector::determine_overlapped_cells(const Vector3d& mins, const Vector3d& maxs, double gridSize)
+/**
+Rebuilds a grid's hash table, discarding any empty cells and resizing the table
+so that it's at most a quarter full afterwards.
+
+@param grid	The grid
+*/
+void BroadPhaseCollisionDetector::rebuild_cells(Grid& grid)
 {
-	CellIndex minCell = determine_cell(mins, gridSize);
-	CellIndex maxCell = determine_cell(maxs, gridSize);
+	std::vector<Cell> oldCells;
+	oldCells.swap(grid.cells);
+
+	int nonEmptyCellCount = 0;
+	for(size_t i=0, size=oldCells.size(); i<size; ++i)
+	{
+		if(oldCells[i].used && oldCells[i].firstEntry != -1) ++nonEmptyCellCount;
+	}
+
+	int capacity = 16;
+	while(capacity < (nonEmptyCellCount + 1) * 4) capacity *= 2;
+
+	Cell emptyCell;
+	emptyCell.firstEntry = -1;
+	emptyCell.used = false;
+	grid.cells.assign(capacity, emptyCell);
+	grid.usedCellCount = 0;
+
+	for(size_t i=0, size=oldCells.size(); i<size; ++i)
+	{
+		if(oldCells[i].used && oldCells[i].firstEntry != -1)
+		{
+			int slot = add_cell(grid, oldCells[i].index);
+			grid.cells[slot].firstEntry = oldCells[i].firstEntry;
+		}
+	}
+}
 
-	std::set<CellIndex> ret;
+void BroadPhaseCollisionDetector::remove_from_cells(int id, int gridIndex, const CellIndex& minCell, const CellIndex& maxCell)
+{
+	Grid& grid = m_grids[gridIndex];
 	for(int i=minCell.i; i<=maxCell.i; ++i)
 		for(int j=minCell.j; j<=maxCell.j; ++j)
 			for(int k=minCell.k; k<=maxCell.k; ++k)
 			{
-				ret.insert(CellIndex(i,j,k));
-			}
-	return ret;
-}
+				int cell = find_cell(grid, CellIndex(i,j,k));
+				if(cell == -1) continue;
 
-BroadPhaseCollisionDetector::CellIndex
-BroadPhaseCollisionDetector::propagate_cell(const CellIndex& cell)
-{
-	return CellIndex(static_cast<int>(floor(cell.i*0.5)),
-					 static_cast<int>(floor(cell.j*0.5)),
-					 static_cast<int>(floor(cell.k*0.5)));
-}
+				// Unlink the object's entry from the cell's list and return it to the free list.
+				int *link = &grid.cells[cell].firstEntry;
+				while(*link != -1 && m_entries[*link].objectID != id) link = &m_entries[*link].next;
+				if(*link == -1) continue;
 
-std::set<BroadPhaseCollisionDetector::CellIndex>
-BroadPhaseCollisionDetector::propagate_cells(const std::set<CellIndex>& cells)
-{
-	std::set<CellIndex> ret;
-	for(std::set<CellIndex>::const_iterator it=cells.begin(), iend=cells.end(); it!=iend; ++it)
-	{
-		ret.insert(propagate_cell(*it));
-	}
-	return ret;
+				int e = *link;
+				*link = m_entries[e].next;
+				m_entries[e].next = m_freeEntries;
+				m_freeEntries = e;
+			}
+
+	--grid.objectCount;
 }
 
 }
@@ -6,8 +6,6 @@
 #ifndef H_HESP_BROADPHASECOLLISIONDETECTOR
 #define H_HESP_BROADPHASECOLLISIONDETECTOR
 
-#include <map>
-#include <set>
 #include <utility>
 #include <vector>
 
@@ -21,14 +19,26 @@ namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
 typedef shared_ptr<const class BoundsManager> BoundsManager_CPtr;
-typedef shared_ptr<const class Contact> Contact_CPtr;
 typedef shared_ptr<class PhysicsObject> PhysicsObject_Ptr;
 
+/**
+This class finds the pairs of physics objects which might be colliding, using a hierarchical
+grid. Each object is stored in the cells it overlaps in the lowest grid whose cells are at
+least as big as the bounding box of its movement. Two objects might be colliding if, in the
+higher of their two lowest grids, the cells overlapped by one of them include a cell which
+is overlapped by the other.
+
+The detector persists between updates: each grid's non-empty cells are stored in a flat,
+open-addressing hash table, and an object's cells are only updated when the object moves
+into different cells. The potential collisions are found afresh on each update, and are
+returned in ascending order of object ID.
+*/
 class BroadPhaseCollisionDetector
 {
 	//#################### TYPEDEFS ####################
-private:
-	typedef std::pair<PhysicsObject_Ptr,PhysicsObject_Ptr> ObjectPair;
+public:
+	typedef std::pair<PhysicsObject*,PhysicsObject*> ObjectPair;
+	typedef std::vector<ObjectPair> ObjectPairs;
 
 	//#################### NESTED CLASSES ####################
 private:
@@ -36,55 +46,83 @@ private:
 	{
 		int i, j, k;
 
+		CellIndex() : i(0), j(0), k(0) {}
 		CellIndex(int i_, int j_, int k_) : i(i_), j(j_), k(k_) {}
 
-		bool operator<(const CellIndex& rhs) const
+		bool operator==(const CellIndex& rhs) const
 		{
-			return	i < rhs.i ||
-					(i == rhs.i && j < rhs.j) ||
-					(i == rhs.i && j == rhs.j && k < rhs.k);
+			return i == rhs.i && j == rhs.j && k == rhs.k;
 		}
-	};
 
-	struct ObjectPairPred
-	{
-		bool operator()(const ObjectPair& lhs, const ObjectPair& rhs) const
+		bool operator!=(const CellIndex& rhs) const
 		{
-			return	lhs.first->id() < rhs.first->id() ||
-					(lhs.first->id() == rhs.first->id() && lhs.second->id() < rhs.second->id());
+			return !(*this == rhs);
 		}
 	};
 
-	//#################### TYPEDEFS ####################
-private:
-	typedef std::vector<std::pair<PhysicsObject_Ptr,bool> > CellData;
-	typedef std::map<CellIndex,CellData> Grid;
-	typedef std::map<double,Grid> HGrid;
-public:
-	typedef std::set<ObjectPair,ObjectPairPred> ObjectPairs;
+	struct Cell
+	{
+		CellIndex index;
+		int firstEntry;		// the first entry in the cell's list of objects, or -1 if the cell is empty
+		bool used;			// has this slot in the hash table been assigned to a cell?
+	};
+
+	struct CellEntry
+	{
+		int objectID;
+		int next;			// the next entry in the same cell (or in the free list), or -1 if there isn't one
+	};
+
+	/**
+	A single level of the hierarchical grid. Cells which become empty keep their hash table
+	slots (so that the probe sequences of other cells aren't broken) until the table is next
+	rebuilt.
+	*/
+	struct Grid
+	{
+		double cellSize;
+		std::vector<Cell> cells;
+		int usedCellCount;
+		int objectCount;
+	};
+
+	struct ObjectState
+	{
+		PhysicsObject_Ptr object;
+		int grid;					// the index of the object's lowest grid, or -1 if the object isn't in the detector
+		CellIndex minCell, maxCell;	// the range of cells the object overlaps in its lowest grid
+		Vector3d mins, maxs;		// the bounding box of the object's latest movement
+	};
 
 	//#################### PRIVATE VARIABLES ####################
 private:
-	BoundsManager_CPtr m_boundsManager;
-	HGrid m_hgrid;
+	std::vector<Grid> m_grids;						// in ascending order of cell size
+	std::vector<CellEntry> m_entries;
+	int m_freeEntries;								// the head of the list of unused entries, or -1 if there aren't any
+	std::vector<ObjectState> m_objects;				// indexed by physics object ID
+	std::vector<std::pair<int,int> > m_pairIDs;		// working storage for finding the potential collisions
 	ObjectPairs m_potentialCollisions;
 
 	//#################### CONSTRUCTORS ####################
 public:
-	BroadPhaseCollisionDetector(const BoundsManager_CPtr& boundsManager, double minObjectSize = 0.1, double maxObjectSize = 51.2);
+	explicit BroadPhaseCollisionDetector(double minObjectSize = 0.1, double maxObjectSize = 51.2);
 
 	//#################### PUBLIC METHODS ####################
 public:
-	void add_object(const PhysicsObject_Ptr& object);
+	const ObjectPairs& find_potential_collisions();
 	const ObjectPairs& potential_collisions() const;
-	void reset();
+	void remove_object(int id);
+	void update_object(const PhysicsObject_Ptr& object, const BoundsManager_CPtr& boundsManager);
 
 	//#################### PRIVATE METHODS ####################
 private:
-	static CellIndex determine_cell(const Vector3d& p, double gridSize);
-	static std::set<CellIndex> determine_overlapped_cells(const Vector3d& mins, const Vector3d& maxs, double gridSize);
-	static CellIndex propagate_cell(const CellIndex& cell);
-	static std::set<CellIndex> propagate_cells(const std::set<CellIndex>& cells);
+	int add_cell(Grid& grid, const CellIndex& index);
+	void add_to_cells(int id, int gridIndex, const CellIndex& minCell, const CellIndex& maxCell);
+	static CellIndex determine_cell(const Vector3d& p, double cellSize);
+	static int find_cell(const Grid& grid, const CellIndex& index);
+	static int hash(const CellIndex& index, int mask);
+	void rebuild_cells(Grid& grid);
+	void remove_from_cells(int id, int gridIndex, const CellIndex& minCell, const CellIndex& maxCell);
 };
 
 }
@@ -10,6 +10,20 @@
 namespace hesp {
 
 //#################### PUBLIC METHODS ####################
+/**
+Returns whether or not the resolver can safely be used to resolve contacts on several
+threads at once, provided no two of the contacts involve the same object. Resolvers
+which only modify the objects involved in the contacts they resolve should override
+this to return true; resolvers which modify other shared state (e.g. the object
+manager) should leave it returning false.
+
+@return	true, if the resolver is thread-safe, or false otherwise
+*/
+bool ContactResolver::is_thread_safe() const
+{
+	return false;
+}
+
 void ContactResolver::resolve_contact(const Contact& contact, const OnionTree_CPtr& tree) const
 {
 	if(contact.objectB())	resolve_object_object(contact, tree);
@@ -28,6 +28,7 @@ private:
 
 	//#################### PUBLIC METHODS ####################
 public:
+	virtual bool is_thread_safe() const;
 	virtual void resolve_contact(const Contact& contact, const OnionTree_CPtr& tree) const;
 };
 
@@ -0,0 +1,181 @@
+/***
+ * hesperus: InlineSupportMappings.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_INLINESUPPORTMAPPINGS
+#define H_HESP_INLINESUPPORTMAPPINGS
+
+#include <hesp/bounds/Bounds.h>
+#include <hesp/math/vectors/Vector3.h>
+
+namespace hesp {
+
+/*
+The classes in this file are value-type equivalents of the SupportMapping hierarchy. They are
+composed by template rather than by pointer, so that the narrow phase collision detector can build
+the support mapping for a pair of objects on the stack and have all of its calls inlined. Each of
+them calculates exactly what its SupportMapping equivalent does, in the same order, so the results
+are bitwise identical.
+*/
+
+/**
+The support mapping for an AABBBounds, centred at the origin.
+*/
+class InlineAABBSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	Vector3d m_scale;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit InlineAABBSupportMapping(const Vector3d& scale)
+	:	m_scale(scale)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		return Vector3d(n.x > 0 ? m_scale.x : -m_scale.x, n.y > 0 ? m_scale.y : -m_scale.y, n.z > 0 ? m_scale.z : -m_scale.z);
+	}
+};
+
+/**
+The support mapping for arbitrary bounds, which simply forwards to the bounds. This is the
+fallback for bounds which don't have a specialised support mapping.
+*/
+class InlineBoundsSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	const Bounds *m_bounds;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit InlineBoundsSupportMapping(const Bounds& bounds)
+	:	m_bounds(&bounds)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		return m_bounds->support_point(n);
+	}
+};
+
+/**
+The support mapping for the Minkowski difference of two other support mappings.
+*/
+template <typename Lhs, typename Rhs>
+class InlineMinkDiffSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	Lhs m_lhs;
+	Rhs m_rhs;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	InlineMinkDiffSupportMapping(const Lhs& lhs, const Rhs& rhs)
+	:	m_lhs(lhs), m_rhs(rhs)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		return m_lhs(n) - m_rhs(-n);
+	}
+};
+
+/**
+The support mapping for PointBounds, centred at the origin.
+*/
+class InlinePointSupportMapping
+{
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d&) const
+	{
+		return Vector3d(0,0,0);
+	}
+};
+
+/**
+The support mapping for a line segment.
+*/
+class InlineSegmentSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	Vector3d m_endpoint0, m_endpoint1;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	InlineSegmentSupportMapping(const Vector3d& endpoint0, const Vector3d& endpoint1)
+	:	m_endpoint0(endpoint0), m_endpoint1(endpoint1)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		Vector3d dir = m_endpoint1 - m_endpoint0;
+		return dir.dot(n) >= 0 ? m_endpoint1 : m_endpoint0;
+	}
+};
+
+/**
+The support mapping for SphereBounds, centred at the origin.
+*/
+class InlineSphereSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	double m_radius;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit InlineSphereSupportMapping(double radius)
+	:	m_radius(radius)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		return m_radius * n;
+	}
+};
+
+/**
+The support mapping obtained by sweeping out one support mapping with another.
+*/
+template <typename Mapping1, typename Mapping2>
+class InlineSweptSupportMapping
+{
+	//#################### PRIVATE VARIABLES ####################
+private:
+	Mapping1 m_mapping1;
+	Mapping2 m_mapping2;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	InlineSweptSupportMapping(const Mapping1& mapping1, const Mapping2& mapping2)
+	:	m_mapping1(mapping1), m_mapping2(mapping2)
+	{}
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	Vector3d operator()(const Vector3d& n) const
+	{
+		return m_mapping1(n) + m_mapping2(n);
+	}
+};
+
+}
+
+#endif
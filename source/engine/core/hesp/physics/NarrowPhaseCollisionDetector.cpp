@@ -9,12 +9,15 @@
 
 #include <boost/tuple/tuple.hpp>
 
+#include <hesp/bounds/AABBBounds.h>
 #include <hesp/bounds/BoundsManager.h>
+#include <hesp/bounds/PointBounds.h>
+#include <hesp/bounds/SphereBounds.h>
 #include <hesp/exceptions/Exception.h>
 #include <hesp/math/Constants.h>
 #include <hesp/math/geom/Plane.h>
 #include <hesp/trees/OnionUtil.h>
-#include "BoundsSupportMapping.h"
+#include "InlineSupportMappings.h"
 #include "MinkDiffSupportMapping.h"
 #include "NormalPhysicsObject.h"
 #include "SegmentSupportMapping.h"
@@ -40,12 +43,53 @@ NarrowPhaseCollisionDetector::object_vs_object(PhysicsObject& objectA, PhysicsOb
 	the XenoCollide forums.
 	*/
 
-	SupportMapping_CPtr mapping, mappingA, mappingS;
-	Vector3d interiorPoint;
-	Vector3d relativeMovement;
-	construct_support_mappings(objectA, objectB, mapping, mappingA, mappingS, interiorPoint, relativeMovement);
-	boost::optional<Contact> contact = xeno_collide(objectA, objectB, mapping, mappingA, mappingS,
-													interiorPoint, relativeMovement);
+	// Dispatch on the types of the two objects' bounds, so that the support mappings and the MPR loop
+	// are specialised for them.
+	Bounds_CPtr boundsA = objectA.bounds(m_boundsManager);
+	Bounds_CPtr boundsB = objectB.bounds(m_boundsManager);
+
+	if(dynamic_cast<const SphereBounds*>(boundsA.get()))
+	{
+		return collide_with_boundsB(objectA, objectB, InlineSphereSupportMapping(boundsA->half_dimensions().x), *boundsB);
+	}
+	else if(dynamic_cast<const AABBBounds*>(boundsA.get()))
+	{
+		return collide_with_boundsB(objectA, objectB, InlineAABBSupportMapping(boundsA->half_dimensions()), *boundsB);
+	}
+	else if(dynamic_cast<const PointBounds*>(boundsA.get()))
+	{
+		return collide_with_boundsB(objectA, objectB, InlinePointSupportMapping(), *boundsB);
+	}
+	else
+	{
+		return collide_with_boundsB(objectA, objectB, InlineBoundsSupportMapping(*boundsA), *boundsB);
+	}
+}
+
+/**
+Tests two objects for a collision over the course of their latest movements, using the specified
+support mappings for their shapes rather than their bounds. The support mappings are composed on the
+heap and called virtually, so this is noticeably slower than the bounds-based test.
+
+@param objectA	The first object
+@param objectB	The second object
+@param mappingA	The support mapping for the shape of the first object (centred at the origin)
+@param mappingB	The support mapping for the shape of the second object (centred at the origin)
+@return			The contact between the objects, if any
+*/
+boost::optional<Contact>
+NarrowPhaseCollisionDetector::object_vs_object(PhysicsObject& objectA, PhysicsObject& objectB,
+											   const SupportMapping_CPtr& mappingA, const SupportMapping_CPtr& mappingB) const
+{
+	Vector3d bRelPos0, bRelPos1, interiorPoint, relativeMovement;
+	determine_relative_movement(objectA, objectB, bRelPos0, bRelPos1, interiorPoint, relativeMovement);
+
+	// Construct the support mapping for S (the relative, swept B), and for the Minkowski difference S - A.
+	SupportMapping_CPtr mappingL(new SegmentSupportMapping(bRelPos0, bRelPos1));
+	SupportMapping_CPtr mappingS(new SweptSupportMapping(mappingB, mappingL));
+	SupportMapping_CPtr mapping(new MinkDiffSupportMapping(mappingS, mappingA));
+
+	boost::optional<Contact> contact = xeno_collide(objectA, objectB, *mapping, *mappingA, *mappingS, interiorPoint, relativeMovement);
 	return convert_to_world_contact(contact);
 }
 
@@ -106,37 +150,75 @@ NarrowPhaseCollisionDetector::object_vs_world(NormalPhysicsObject& object) const
 }
 
 //#################### PRIVATE METHODS ####################
-void NarrowPhaseCollisionDetector::construct_support_mappings(const PhysicsObject& objectA, const PhysicsObject& objectB,
-															  SupportMapping_CPtr& mapping, SupportMapping_CPtr& mappingA,
-															  SupportMapping_CPtr& mappingS, Vector3d& interiorPoint,
-															  Vector3d& relativeMovement) const
+template <typename MappingA, typename MappingB>
+boost::optional<Contact>
+NarrowPhaseCollisionDetector::collide(PhysicsObject& objectA, PhysicsObject& objectB,
+									  const MappingA& mappingA, const MappingB& mappingB) const
 {
-	// Construct the support mapping in the reference frame of A. (In that frame, A is centred at the origin.)
-	// We'll be colliding a relative, swept version of B (called S) against a stationary A and then transforming
-	// the result back into world space.
+	Vector3d bRelPos0, bRelPos1, interiorPoint, relativeMovement;
+	determine_relative_movement(objectA, objectB, bRelPos0, bRelPos1, interiorPoint, relativeMovement);
+
+	// Construct the support mapping for S (the relative, swept B), and for the Minkowski difference S - A.
+	typedef InlineSweptSupportMapping<MappingB,InlineSegmentSupportMapping> MappingS;
+	MappingS mappingS(mappingB, InlineSegmentSupportMapping(bRelPos0, bRelPos1));
+	InlineMinkDiffSupportMapping<MappingS,MappingA> mapping(mappingS, mappingA);
+
+	boost::optional<Contact> contact = xeno_collide(objectA, objectB, mapping, mappingA, mappingS, interiorPoint, relativeMovement);
+	return convert_to_world_contact(contact);
+}
+
+template <typename MappingA>
+boost::optional<Contact>
+NarrowPhaseCollisionDetector::collide_with_boundsB(PhysicsObject& objectA, PhysicsObject& objectB,
+												   const MappingA& mappingA, const Bounds& boundsB) const
+{
+	if(dynamic_cast<const SphereBounds*>(&boundsB))
+	{
+		return collide(objectA, objectB, mappingA, InlineSphereSupportMapping(boundsB.half_dimensions().x));
+	}
+	else if(dynamic_cast<const AABBBounds*>(&boundsB))
+	{
+		return collide(objectA, objectB, mappingA, InlineAABBSupportMapping(boundsB.half_dimensions()));
+	}
+	else if(dynamic_cast<const PointBounds*>(&boundsB))
+	{
+		return collide(objectA, objectB, mappingA, InlinePointSupportMapping());
+	}
+	else
+	{
+		return collide(objectA, objectB, mappingA, InlineBoundsSupportMapping(boundsB));
+	}
+}
+
+boost::optional<Contact>
+NarrowPhaseCollisionDetector::convert_to_world_contact(const boost::optional<Contact>& relativeContact) const
+{
+	if(!relativeContact) return boost::none;
+	const Contact& rc = *relativeContact;
+
+	// This makes the relative point on B relative to the centre of B rather than to the centre of A.
+	return Contact(rc.relative_pointA(),
+				   rc.relative_pointB() + rc.objectA().position() - rc.objectB()->position(),
+				   rc.normal(), rc.time(), rc.objectA(), rc.map_indexA(), rc.objectB(), rc.map_indexB());
+}
+
+void NarrowPhaseCollisionDetector::determine_relative_movement(const PhysicsObject& objectA, const PhysicsObject& objectB,
+															   Vector3d& bRelPos0, Vector3d& bRelPos1,
+															   Vector3d& interiorPoint, Vector3d& relativeMovement)
+{
+	// We work in the reference frame of A. (In that frame, A is centred at the origin.) We'll be colliding
+	// a relative, swept version of B (called S) against a stationary A and then transforming the result
+	// back into world space.
 
 	Vector3d aPos0 = objectA.previous_position() ? *objectA.previous_position() : objectA.position();
 	Vector3d aPos1 = objectA.position();
 	Vector3d bPos0 = objectB.previous_position() ? *objectB.previous_position() : objectB.position();
 	Vector3d bPos1 = objectB.position();
 
-	Vector3d bRelPos0 = bPos0 - aPos0;
-	Vector3d bRelPos1 = bPos1 - aPos1;
+	bRelPos0 = bPos0 - aPos0;
+	bRelPos1 = bPos1 - aPos1;
 	relativeMovement = bRelPos1 - bRelPos0;
 
-	// Construct the support mapping for the stationary A.
-	Bounds_CPtr aBounds = objectA.bounds(m_boundsManager);
-	mappingA.reset(new BoundsSupportMapping(aBounds));
-
-	// Construct the support mapping for S (the relative, swept B).
-	Bounds_CPtr bBounds = objectB.bounds(m_boundsManager);
-	SupportMapping_CPtr mappingB(new BoundsSupportMapping(bBounds));
-	SupportMapping_CPtr mappingL(new SegmentSupportMapping(bRelPos0, bRelPos1));
-	mappingS.reset(new SweptSupportMapping(mappingB, mappingL));
-
-	// Construct the support mapping for their Minkowski difference (S - A).
-	mapping.reset(new MinkDiffSupportMapping(mappingS, mappingA));
-
 	// Find a point interior to S - A. Note that the midpoint of B's relative movement
 	// vector will do because it's definitely inside S (which is the relative sweep of
 	// B as it moves), whilst A is centred at the origin and symmetrical about it, so
@@ -148,25 +230,14 @@ void NarrowPhaseCollisionDetector::construct_support_mappings(const PhysicsObjec
 	if(interiorPoint.length_squared() < EPSILON*EPSILON) interiorPoint = Vector3d(EPSILON, 0, 0);
 }
 
-boost::optional<Contact>
-NarrowPhaseCollisionDetector::convert_to_world_contact(const boost::optional<Contact>& relativeContact) const
-{
-	if(!relativeContact) return boost::none;
-	const Contact& rc = *relativeContact;
-
-	// This makes the relative point on B relative to the centre of B rather than to the centre of A.
-	return Contact(rc.relative_pointA(),
-				   rc.relative_pointB() + rc.objectA().position() - rc.objectB()->position(),
-				   rc.normal(), rc.time(), rc.objectA(), rc.map_indexA(), rc.objectB(), rc.map_indexB());
-}
-
-Contact NarrowPhaseCollisionDetector::make_contact(const Vector3d& v0, const SupportMapping_CPtr& mappingA,
-												   const SupportMapping_CPtr& mappingB, const Vector3d& relativeMovement,
+template <typename MappingA, typename MappingB>
+Contact NarrowPhaseCollisionDetector::make_contact(const Vector3d& v0, const MappingA& mappingA,
+												   const MappingB& mappingB, const Vector3d& relativeMovement,
 												   PhysicsObject& objectA, PhysicsObject& objectB) const
 {
 	Vector3d contactNormal = (-v0).normalize();
-	Vector3d contactPointA = (*mappingA)(-contactNormal);
-	Vector3d contactPointB = (*mappingB)(contactNormal);
+	Vector3d contactPointA = mappingA(-contactNormal);
+	Vector3d contactPointB = mappingB(contactNormal);
 	double penetrationDepth = (contactPointB - contactPointA).dot(contactNormal);
 	assert(penetrationDepth > 0);
 	double contactDistanceMoved = relativeMovement.dot(contactNormal);
@@ -178,10 +249,11 @@ Contact NarrowPhaseCollisionDetector::make_contact(const Vector3d& v0, const Sup
 	return Contact(contactPointA, contactPointB, contactNormal, time, objectA, mapIndexA, objectB, mapIndexB);
 }
 
+template <typename Mapping, typename MappingA, typename MappingB>
 boost::optional<Contact>
 NarrowPhaseCollisionDetector::xeno_collide(PhysicsObject& objectA, PhysicsObject& objectB,
-										   const SupportMapping_CPtr& mapping, const SupportMapping_CPtr& mappingA,
-										   const SupportMapping_CPtr& mappingB, const Vector3d& v0,
+										   const Mapping& mapping, const MappingA& mappingA,
+										   const MappingB& mappingB, const Vector3d& v0,
 										   const Vector3d& relativeMovement) const
 try
 {
@@ -193,7 +265,7 @@ try
 
 	// Find the support point in the direction of the origin ray 0 - v0 = -v0.
 	Vector3d n = (-v0).normalize();		// note: v0 is guaranteed to be non-zero by construction
-	v1 = (*mapping)(n);
+	v1 = mapping(n);
 
 	if(n.dot(v1) <= 0)
 	{
@@ -223,7 +295,7 @@ try
 	}
 
 	n.normalize();	// note: if we get here, n is non-zero
-	v2 = (*mapping)(n);
+	v2 = mapping(n);
 
 	if(n.dot(v2) <= 0)
 	{
@@ -259,7 +331,7 @@ try
 	while(iterations++ < ITERATION_LIMIT)
 	{
 		// Find the support point in the direction normal to the existing plane.
-		v3 = (*mapping)(n);
+		v3 = mapping(n);
 		if(n.dot(v3) <= 0)
 		{
 			// Special Case: The origin doesn't lie on the near side of the support plane containing v3 -> MISS.
@@ -317,7 +389,7 @@ try
 
 		// If the origin's not behind the portal, find the support plane in the direction of the portal normal.
 		// This has equation n.x - n.v4 = 0.
-		Vector3d v4 = (*mapping)(n);
+		Vector3d v4 = mapping(n);
 
 		// Check whether the origin's not behind the support plane, which faces towards the outside of the shape.
 		// If so, it's outside the shape -> MISS. The origin's not behind the support plane if -n.v4 >= 0, i.e.
@@ -11,6 +11,7 @@
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
+class Bounds;
 typedef shared_ptr<const class BoundsManager> BoundsManager_CPtr;
 typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
 class NormalPhysicsObject;
@@ -18,6 +19,17 @@ class PhysicsObject;
 typedef shared_ptr<const class Plane> Plane_CPtr;
 typedef shared_ptr<const class SupportMapping> SupportMapping_CPtr;
 
+/**
+This class tests pairs of physics objects (and individual objects against the world) for
+collisions over the course of their latest movements.
+
+Object-object tests use Minkowski Portal Refinement on the support mapping of the relative,
+swept shapes of the two objects. For the bounds which the bounds manager actually uses (spheres,
+AABBs and points), that support mapping is composed on the stack out of the value types in
+InlineSupportMappings.h, and the MPR loop is instantiated separately for each combination of
+bounds types. Arbitrary support mappings can still be tested via the overload which takes them
+(this composes them on the heap, and calls through them virtually).
+*/
 class NarrowPhaseCollisionDetector
 {
 	//#################### PRIVATE VARIABLES ####################
@@ -32,14 +44,17 @@ public:
 	//#################### PUBLIC METHODS ####################
 public:
 	boost::optional<Contact> object_vs_object(PhysicsObject& objectA, PhysicsObject& objectB) const;
+	boost::optional<Contact> object_vs_object(PhysicsObject& objectA, PhysicsObject& objectB, const SupportMapping_CPtr& mappingA, const SupportMapping_CPtr& mappingB) const;
 	boost::optional<Contact> object_vs_world(NormalPhysicsObject& object) const;
 
 	//#################### PRIVATE METHODS ####################
 private:
-	void construct_support_mappings(const PhysicsObject& objectA, const PhysicsObject& objectB, SupportMapping_CPtr& mapping, SupportMapping_CPtr& mappingA, SupportMapping_CPtr& mappingS, Vector3d& interiorPoint, Vector3d& relativeMovement) const;
+	template <typename MappingA, typename MappingB> boost::optional<Contact> collide(PhysicsObject& objectA, PhysicsObject& objectB, const MappingA& mappingA, const MappingB& mappingB) const;
+	template <typename MappingA> boost::optional<Contact> collide_with_boundsB(PhysicsObject& objectA, PhysicsObject& objectB, const MappingA& mappingA, const Bounds& boundsB) const;
 	boost::optional<Contact> convert_to_world_contact(const boost::optional<Contact>& relativeContact) const;
-	Contact make_contact(const Vector3d& v0, const SupportMapping_CPtr& mappingA, const SupportMapping_CPtr& mappingB, const Vector3d& relativeMovement, PhysicsObject& objectA, PhysicsObject& objectB) const;
-	boost::optional<Contact> xeno_collide(PhysicsObject& objectA, PhysicsObject& objectB, const SupportMapping_CPtr& mapping, const SupportMapping_CPtr& mappingA, const SupportMapping_CPtr& mappingB, const Vector3d& v0, const Vector3d& relativeMovement) const;
+	static void determine_relative_movement(const PhysicsObject& objectA, const PhysicsObject& objectB, Vector3d& bRelPos0, Vector3d& bRelPos1, Vector3d& interiorPoint, Vector3d& relativeMovement);
+	template <typename MappingA, typename MappingB> Contact make_contact(const Vector3d& v0, const MappingA& mappingA, const MappingB& mappingB, const Vector3d& relativeMovement, PhysicsObject& objectA, PhysicsObject& objectB) const;
+	template <typename Mapping, typename MappingA, typename MappingB> boost::optional<Contact> xeno_collide(PhysicsObject& objectA, PhysicsObject& objectB, const Mapping& mapping, const MappingA& mappingA, const MappingB& mappingB, const Vector3d& v0, const Vector3d& relativeMovement) const;
 };
 
 }
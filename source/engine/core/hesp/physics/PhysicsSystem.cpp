@@ -5,9 +5,12 @@
 
 #include "PhysicsSystem.h"
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
 #include <boost/pointer_cast.hpp>
 
-#include "BroadPhaseCollisionDetector.h"
+#include <hesp/util/WorkerPool.h>
 #include "ContactResolver.h"
 #include "ForceGenerator.h"
 #include "NarrowPhaseCollisionDetector.h"
@@ -16,7 +19,67 @@
 
 namespace hesp {
 
+//#################### LOCAL METHODS ####################
+namespace {
+
+/**
+Finds the root of the union-find tree containing the specified element, halving the
+path to it on the way so that later searches are faster.
+
+@param parents	The parent of each element in the union-find forest
+@param i		The element
+@return			The root of its tree
+*/
+int find_root(std::vector<int>& parents, int i)
+{
+	while(parents[i] != i)
+	{
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+
+}
+
+//#################### NESTED CLASSES ####################
+/**
+Orders contacts by time (prioritising object-world contacts when contacts occur simultaneously,
+as ContactPred does), breaking any remaining ties using the IDs of the objects involved.
+*/
+bool PhysicsSystem::DeterministicContactPred::operator()(const Contact_CPtr& lhs, const Contact_CPtr& rhs) const
+{
+	if(lhs->time() != rhs->time()) return lhs->time() < rhs->time();
+
+	int lhsB = lhs->objectB() ? lhs->objectB()->id() : -1;
+	int rhsB = rhs->objectB() ? rhs->objectB()->id() : -1;
+	if(lhsB == -1 && rhsB != -1) return true;
+	if(lhsB != -1 && rhsB == -1) return false;
+
+	int lhsA = lhs->objectA().id(), rhsA = rhs->objectA().id();
+	if(lhsA != rhsA) return lhsA < rhsA;
+	return lhsB < rhsB;
+}
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs a physics system.
+
+@param threadCount		The number of threads to use when resolving contacts
+@param deterministic	Whether or not to resolve contacts in deterministic mode (see the class comment)
+*/
+PhysicsSystem::PhysicsSystem(int threadCount, bool deterministic)
+:	m_deterministic(deterministic), m_threadCount(1)
+{
+	set_thread_count(threadCount);
+}
+
 //#################### PUBLIC METHODS ####################
+bool PhysicsSystem::deterministic() const
+{
+	return m_deterministic;
+}
+
 PhysicsObjectHandle PhysicsSystem::register_object(const PhysicsObject_Ptr& object)
 {
 	int id = m_idAllocator.allocate();
@@ -44,12 +107,37 @@ void PhysicsSystem::set_contact_resolver(PhysicsMaterial material1, PhysicsMater
 	m_contactResolverRegistry.set_resolver(material1, material2, resolver);
 }
 
+void PhysicsSystem::set_deterministic(bool deterministic)
+{
+	m_deterministic = deterministic;
+}
+
 void PhysicsSystem::set_force_generator(const PhysicsObjectHandle& handle, const std::string& forceName,
 										const ForceGenerator_CPtr& generator)
 {
 	m_forceGeneratorRegistry.set_generator(*handle, forceName, generator);
 }
 
+/**
+Sets the number of threads to use when resolving contacts. The worker threads are started
+here (rather than on each update), and persist until the thread count is next changed.
+
+@param threadCount	The number of threads (including the one which calls update())
+*/
+void PhysicsSystem::set_thread_count(int threadCount)
+{
+	threadCount = std::max(threadCount, 1);
+	if(threadCount == m_threadCount) return;
+
+	m_threadCount = threadCount;
+	m_workerPool.reset(threadCount > 1 ? new WorkerPool(threadCount - 1) : NULL);
+}
+
+int PhysicsSystem::thread_count() const
+{
+	return m_threadCount;
+}
+
 void PhysicsSystem::update(const BoundsManager_CPtr& boundsManager, const OnionTree_CPtr& tree, int milliseconds)
 {
 	typedef std::vector<Contact_CPtr> ContactSet;
@@ -64,29 +152,74 @@ void PhysicsSystem::update(const BoundsManager_CPtr& boundsManager, const OnionT
 	ContactSet contacts;
 	detect_contacts(contacts, boundsManager, tree);
 
-	// Step 4:	Batch the contacts into groups which might mutually interact.
-	std::vector<ContactSet> batches = batch_contacts(contacts);
+	// Step 4:	Batch the contacts into islands which might mutually interact.
+	std::vector<ContactIsland> islands;
+	batch_contacts(contacts, islands);
 
-	// Step 5:	Resolve each batch of contacts in turn.
-	for(std::vector<ContactSet>::const_iterator it=batches.begin(), iend=batches.end(); it!=iend; ++it)
-	{
-		resolve_contacts(*it, tree);
-	}
+	// Step 5:	Resolve the islands (independently of each other).
+	resolve_islands(islands, tree);
 }
 
 //#################### PRIVATE METHODS ####################
 /**
-Group the contacts into batches which might interact with each other.
+Groups the contacts into islands which might interact with each other. Two contacts which
+share an object are in the same island; contacts with the world don't link islands, since
+resolving them only moves the object involved.
 
 @param contacts	The array of contacts which need resolving
-@return			The contact batches
+@param islands	Used to return the contact islands, in ascending order of minimum object ID
 */
-std::vector<std::vector<Contact_CPtr> > PhysicsSystem::batch_contacts(const std::vector<Contact_CPtr>& contacts)
+void PhysicsSystem::batch_contacts(const std::vector<Contact_CPtr>& contacts, std::vector<ContactIsland>& islands)
 {
-	// TODO: This is the simplest possible batching processor (for test purposes only) - it needs doing properly.
-	std::vector<std::vector<Contact_CPtr> > batches;
-	if(!contacts.empty()) batches.push_back(contacts);
-	return batches;
+	islands.clear();
+	if(contacts.empty()) return;
+
+	// Step 1:	Join the objects involved in each object-object contact using union-find. The root of
+	//			each tree is always the smallest ID in it, so it's the minimum object ID of the island.
+	int idCount = m_objects.rbegin()->first + 1;
+	m_islandParents.resize(idCount);
+	for(int i=0; i<idCount; ++i) m_islandParents[i] = i;
+
+	for(std::vector<Contact_CPtr>::const_iterator it=contacts.begin(), iend=contacts.end(); it!=iend; ++it)
+	{
+		const Contact& contact = **it;
+		if(!contact.objectB()) continue;
+
+		int rootA = find_root(m_islandParents, contact.objectA().id());
+		int rootB = find_root(m_islandParents, contact.objectB()->id());
+		if(rootA < rootB) m_islandParents[rootB] = rootA;
+		else if(rootB < rootA) m_islandParents[rootA] = rootB;
+	}
+
+	// Step 2:	Number the islands in ascending order of their roots.
+	m_islandIndices.assign(idCount, -1);
+	for(std::vector<Contact_CPtr>::const_iterator it=contacts.begin(), iend=contacts.end(); it!=iend; ++it)
+	{
+		m_islandIndices[find_root(m_islandParents, (*it)->objectA().id())] = 0;
+	}
+
+	for(int i=0; i<idCount; ++i)
+	{
+		if(m_islandIndices[i] == -1) continue;
+		m_islandIndices[i] = static_cast<int>(islands.size());
+		islands.push_back(ContactIsland());
+		islands.back().minObjectID = i;
+		islands.back().threadSafe = true;
+	}
+
+	// Step 3:	Add each contact to its island, noting any islands which contain contacts whose
+	//			resolvers aren't thread-safe.
+	for(std::vector<Contact_CPtr>::const_iterator it=contacts.begin(), iend=contacts.end(); it!=iend; ++it)
+	{
+		const Contact& contact = **it;
+		ContactIsland& island = islands[m_islandIndices[find_root(m_islandParents, contact.objectA().id())]];
+		island.contacts.push_back(*it);
+
+		PhysicsMaterial materialA = contact.objectA().material();
+		PhysicsMaterial materialB = contact.objectB() ? contact.objectB()->material() : PM_WORLD;
+		ContactResolver_CPtr resolver = m_contactResolverRegistry.lookup_resolver(materialA, materialB);
+		if(resolver && !resolver->is_thread_safe()) island.threadSafe = false;
+	}
 }
 
 /**
@@ -102,6 +235,7 @@ void PhysicsSystem::check_objects()
 			int id = it->first;
 			m_idAllocator.deallocate(id);
 			m_forceGeneratorRegistry.deregister_id(id);
+			m_broadPhaseDetector.remove_object(id);
 			m_objects.erase(it++);
 		}
 		else ++it;
@@ -118,17 +252,17 @@ Perform collision detection and generate any necessary contacts.
 void PhysicsSystem::detect_contacts(std::vector<Contact_CPtr>& contacts,
 									const BoundsManager_CPtr& boundsManager, const OnionTree_CPtr& tree)
 {
-	BroadPhaseCollisionDetector broadDetector(boundsManager);
 	NarrowPhaseCollisionDetector narrowDetector(boundsManager, tree);
 
-	// Detect object-object contacts.
+	// Detect object-object contacts. Note that the broad phase detector persists between updates,
+	// so only the objects which have moved into different cells need to be re-inserted into it.
 	for(std::map<int,ObjectData>::const_iterator it=m_objects.begin(), iend=m_objects.end(); it!=iend; ++it)
 	{
-		broadDetector.add_object(it->second.m_object);
+		m_broadPhaseDetector.update_object(it->second.m_object, boundsManager);
 	}
 
 	typedef BroadPhaseCollisionDetector::ObjectPairs ObjectPairs;
-	const ObjectPairs& potentialCollisions = broadDetector.potential_collisions();
+	const ObjectPairs& potentialCollisions = m_broadPhaseDetector.find_potential_collisions();
 
 	for(ObjectPairs::const_iterator it=potentialCollisions.begin(), iend=potentialCollisions.end(); it!=iend; ++it)
 	{
@@ -157,11 +291,12 @@ Resolve the contacts using the appropriate contact resolver for each pair of col
 @param contacts	The array of contacts which need resolving
 @param tree		The tree representing the world for collision purposes
 */
-void PhysicsSystem::resolve_contacts(const std::vector<Contact_CPtr>& contacts, const OnionTree_CPtr& tree)
+void PhysicsSystem::resolve_contacts(const std::vector<Contact_CPtr>& contacts, const OnionTree_CPtr& tree) const
 {
 	// Step 1:	Sort the contacts in ascending order of occurrence.
 	std::vector<Contact_CPtr> sortedContacts(contacts);
-	std::sort(sortedContacts.begin(), sortedContacts.end(), ContactPred());
+	if(m_deterministic) std::sort(sortedContacts.begin(), sortedContacts.end(), DeterministicContactPred());
+	else std::sort(sortedContacts.begin(), sortedContacts.end(), ContactPred());
 
 	// Step 2:	Resolve each contact in turn. Note that resolving one contact may affect others,
 	//			which can't be handled completely without abandoning the sequential resolution
@@ -186,6 +321,71 @@ void PhysicsSystem::resolve_contacts(const std::vector<Contact_CPtr>& contacts,
 	}
 }
 
+/**
+Resolves the contact islands. The islands whose resolvers are thread-safe are shared out between
+this thread and the worker pool's threads (largest first, unless we're in deterministic mode), and the others are resolved
+on this thread, in ascending order of minimum object ID. Since no two islands share an object, the
+order in which the islands are resolved doesn't affect the results.
+
+@param islands	The contact islands
+@param tree		The tree representing the world for collision purposes
+*/
+void PhysicsSystem::resolve_islands(const std::vector<ContactIsland>& islands, const OnionTree_CPtr& tree) const
+{
+	std::vector<int> parallelIslands;
+	for(int i=0, islandCount=static_cast<int>(islands.size()); i<islandCount; ++i)
+	{
+		if(islands[i].threadSafe && m_threadCount > 1) parallelIslands.push_back(i);
+		else resolve_contacts(islands[i].contacts, tree);
+	}
+
+	if(parallelIslands.empty()) return;
+
+	if(!m_deterministic)
+	{
+		// Hand out the largest islands first, so that the work is shared out more evenly.
+		std::stable_sort(parallelIslands.begin(), parallelIslands.end(), LargerIslandPred(islands));
+	}
+
+	int next = 0;
+	boost::mutex nextMutex;
+
+	if(parallelIslands.size() == 1)
+	{
+		resolve_islands_worker(islands, parallelIslands, next, nextMutex, tree);
+	}
+	else
+	{
+		m_workerPool->run(boost::bind(&PhysicsSystem::resolve_islands_worker, this, boost::cref(islands), boost::cref(parallelIslands), boost::ref(next), boost::ref(nextMutex), boost::cref(tree)));
+	}
+}
+
+/**
+Repeatedly takes the next contact island and resolves it, until there are no islands left.
+
+@param islands		The contact islands
+@param order		The indices of the islands to resolve, in the order in which to hand them out
+@param next			The position in order of the next island to resolve (shared between the workers)
+@param nextMutex	The mutex protecting next
+@param tree			The tree representing the world for collision purposes
+*/
+void PhysicsSystem::resolve_islands_worker(const std::vector<ContactIsland>& islands, const std::vector<int>& order,
+										   int& next, boost::mutex& nextMutex, const OnionTree_CPtr& tree) const
+{
+	int size = static_cast<int>(order.size());
+	for(;;)
+	{
+		int i;
+		{
+			boost::mutex::scoped_lock lock(nextMutex);
+			if(next == size) return;
+			i = order[next++];
+		}
+
+		resolve_contacts(islands[i].contacts, tree);
+	}
+}
+
 /**
 Accumulate the forces on each physics object and update them appropriately.
 
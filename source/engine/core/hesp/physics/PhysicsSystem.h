@@ -9,10 +9,12 @@
 #include <map>
 #include <vector>
 
+#include <boost/thread/mutex.hpp>
 #include <boost/weak_ptr.hpp>
 using boost::weak_ptr;
 
 #include <hesp/util/IDAllocator.h>
+#include "BroadPhaseCollisionDetector.h"
 #include "Contact.h"
 #include "ContactResolverRegistry.h"
 #include "ForceGeneratorRegistry.h"
@@ -24,10 +26,29 @@ typedef shared_ptr<const class BoundsManager> BoundsManager_CPtr;
 typedef shared_ptr<const class Contact> Contact_CPtr;
 typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
 typedef shared_ptr<class PhysicsObject> PhysicsObject_Ptr;
+typedef shared_ptr<class WorkerPool> WorkerPool_Ptr;
 
 //#################### TYPEDEFS ####################
 typedef shared_ptr<int> PhysicsObjectHandle;
 
+/**
+This class manages the physics objects in a level: it simulates them, detects the contacts
+between them (and between them and the world), and resolves those contacts.
+
+The contacts are resolved in islands: two contacts are in the same island if they are linked
+by a chain of contacts which share objects. Resolving a contact only affects the objects involved
+in it, so the islands can be resolved independently. Any islands containing contacts whose resolvers
+aren't thread-safe (and every island, if there's only one thread) are resolved first, on the calling
+thread, in ascending order of their minimum object ID. The remaining islands are then shared out
+between several threads (which persist between updates), largest first.
+
+In deterministic mode, the contacts in each island are resolved in an order which depends only on
+their times and the IDs of the objects involved, and the thread-safe islands are handed out in
+ascending order of their minimum object ID rather than by size. Since no two islands share an object,
+this makes the final state of every object independent of the order in which the contacts were
+detected and of how many threads are used. It doesn't fix the order in which the islands themselves
+are resolved, which varies with the thread scheduling.
+*/
 class PhysicsSystem
 {
 	//#################### NESTED CLASSES ####################
@@ -41,6 +62,32 @@ private:
 		}
 	};
 
+	struct DeterministicContactPred
+	{
+		bool operator()(const Contact_CPtr& lhs, const Contact_CPtr& rhs) const;
+	};
+
+	struct ContactIsland
+	{
+		int minObjectID;						// the smallest ID of any object involved in the island's contacts
+		std::vector<Contact_CPtr> contacts;
+		bool threadSafe;						// can the island be resolved on a worker thread?
+	};
+
+	struct LargerIslandPred
+	{
+		const std::vector<ContactIsland>& m_islands;
+
+		explicit LargerIslandPred(const std::vector<ContactIsland>& islands)
+		:	m_islands(islands)
+		{}
+
+		bool operator()(int lhs, int rhs) const
+		{
+			return m_islands[lhs].contacts.size() > m_islands[rhs].contacts.size();
+		}
+	};
+
 	struct ObjectData
 	{
 		weak_ptr<int> m_wid;
@@ -53,26 +100,42 @@ private:
 
 	//#################### PRIVATE VARIABLES ####################
 private:
+	BroadPhaseCollisionDetector m_broadPhaseDetector;
 	ContactResolverRegistry m_contactResolverRegistry;
+	bool m_deterministic;
 	ForceGeneratorRegistry m_forceGeneratorRegistry;
 	IDAllocator m_idAllocator;
+	std::vector<int> m_islandIndices;			// working storage for batching the contacts (indexed by physics object ID)
+	std::vector<int> m_islandParents;			// working storage for batching the contacts (indexed by physics object ID)
 	std::map<int,ObjectData> m_objects;
+	int m_threadCount;
+	WorkerPool_Ptr m_workerPool;				// the threads other than the calling one which resolve the islands (if m_threadCount > 1)
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit PhysicsSystem(int threadCount = 1, bool deterministic = false);
 
 	//#################### PUBLIC METHODS ####################
 public:
+	bool deterministic() const;
 	PhysicsObjectHandle register_object(const PhysicsObject_Ptr& object);
 	void remove_contact_resolver(PhysicsMaterial material1, PhysicsMaterial material2);
 	void remove_force_generator(const PhysicsObjectHandle& handle, const std::string& forceName);
 	void set_contact_resolver(PhysicsMaterial material1, PhysicsMaterial material2, const ContactResolver_CPtr& resolver);
+	void set_deterministic(bool deterministic);
 	void set_force_generator(const PhysicsObjectHandle& handle, const std::string& forceName, const ForceGenerator_CPtr& generator);
+	void set_thread_count(int threadCount);
+	int thread_count() const;
 	void update(const BoundsManager_CPtr& boundsManager, const OnionTree_CPtr& tree, int milliseconds);
 
 	//#################### PRIVATE METHODS ####################
 private:
-	std::vector<std::vector<Contact_CPtr> > batch_contacts(const std::vector<Contact_CPtr>& contacts);
+	void batch_contacts(const std::vector<Contact_CPtr>& contacts, std::vector<ContactIsland>& islands);
 	void check_objects();
 	void detect_contacts(std::vector<Contact_CPtr>& contacts, const BoundsManager_CPtr& boundsManager, const OnionTree_CPtr& tree);
-	void resolve_contacts(const std::vector<Contact_CPtr>& contacts, const OnionTree_CPtr& tree);
+	void resolve_contacts(const std::vector<Contact_CPtr>& contacts, const OnionTree_CPtr& tree) const;
+	void resolve_islands(const std::vector<ContactIsland>& islands, const OnionTree_CPtr& tree) const;
+	void resolve_islands_worker(const std::vector<ContactIsland>& islands, const std::vector<int>& order, int& next, boost::mutex& nextMutex, const OnionTree_CPtr& tree) const;
 	void simulate_objects(int milliseconds);
 };
 
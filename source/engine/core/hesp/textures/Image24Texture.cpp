@@ -16,9 +16,7 @@ namespace hesp {
 //#################### CONSTRUCTORS ####################
 Image24Texture::Image24Texture(const Image24_CPtr& image, bool clamp)
 :	Texture(clamp), m_image(image)
-{
-	reload();
-}
+{}
 
 //#################### PROTECTED METHODS ####################
 void Image24Texture::reload_image() const
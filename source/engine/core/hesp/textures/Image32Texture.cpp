@@ -16,9 +16,7 @@ namespace hesp {
 //#################### CONSTRUCTORS ####################
 Image32Texture::Image32Texture(const Image32_CPtr& image, bool clamp)
 :	Texture(clamp), m_image(image)
-{
-	reload();
-}
+{}
 
 //#################### PROTECTED METHODS ####################
 void Image32Texture::reload_image() const
@@ -22,7 +22,7 @@ struct TextureDeleter
 
 //#################### CONSTRUCTORS ####################
 /**
-Constructs an empty texture (the subclass constructor will initialise it).
+Constructs an empty texture (it will be loaded when it's first bound).
 
 @param clamp	Whether or not the texture should be clamped to its edges (rather than wrapped)
 */
@@ -35,11 +35,11 @@ Texture::~Texture() {}
 
 //#################### PUBLIC METHODS ####################
 /**
-Binds the texture to GL_TEXTURE_2D (reloads it first if necessary).
+Binds the texture to GL_TEXTURE_2D (loads or reloads it first if necessary).
 */
 void Texture::bind() const
 {
-	if(!glIsTexture(*m_id)) reload();
+	if(!m_id || !glIsTexture(*m_id)) reload();
 	glBindTexture(GL_TEXTURE_2D, *m_id);
 }
 
@@ -16,6 +16,8 @@ namespace hesp {
 /**
 This class represents OpenGL textures. Essentially it's just a simple wrapper for an OpenGL texture ID,
 but with reloading capabilities (i.e. the texture will reload itself if the screen resolution is changed).
+Textures are only uploaded to OpenGL when they're first bound, so resources which contain them (e.g. levels
+and models) can be loaded without an OpenGL context (e.g. by headless tools).
 */
 class Texture
 {
@@ -6,13 +6,32 @@
 #ifndef H_HESP_BSPCOMPILEREX
 #define H_HESP_BSPCOMPILEREX
 
+#include <string>
 #include <vector>
 
+#include <boost/cstdint.hpp>
+
 #include <hesp/math/geom/Plane.h>
 #include "BSPTree.h"
 
 namespace hesp {
 
+/**
+This class compiles a BSP tree from a set of polygons (plus optional hint polygons).
+
+The compilation happens in two phases. The first partitions the polygons recursively
+(splitting them as necessary) into an intermediate tree; once a subtree is big enough,
+its two halves can be partitioned in parallel, since they share no polygons. The second
+phase then walks the intermediate tree in the order the recursion would have visited it
+in a single thread, numbering the nodes and polygon fragments. The output is therefore
+the same however many threads are used.
+
+By default, the splitter at each node is chosen by scoring every candidate polygon against
+every other polygon, which is quadratic in the number of polygons. For big maps, the compiler
+can instead score a stratified random sample of the candidates against a stratified random
+sample of the polygons. The samples are drawn from a generator seeded from a fixed seed and
+the node's position in the tree, so sampled compilation is also reproducible.
+*/
 template <typename Poly>
 class BSPCompiler
 {
@@ -25,51 +44,100 @@ private:
 		SD_SOLID
 	};
 
+	//#################### TYPEDEFS ####################
+private:
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::vector<Poly_Ptr> PolyVector;
+
 	//#################### NESTED CLASSES ####################
 private:
-	struct PolyIndex
+	/**
+	A slot in the output polygon array. Splitting a polygon replaces the contents of its
+	cell with the back half and puts the front half in a new cell. Cells are only given
+	their final indices once the partitioning is complete.
+	*/
+	struct PolyCell
 	{
+		Poly_Ptr poly;
 		int index;
+
+		PolyCell(const Poly_Ptr& poly_, int index_)
+		:	poly(poly_), index(index_)
+		{}
+	};
+
+	typedef shared_ptr<PolyCell> PolyCell_Ptr;
+
+	struct PolyIndex
+	{
+		PolyCell_Ptr cell;
 		bool splitCandidate;	// is the plane of the referenced polygon a split candidate?
 		bool hint;				// is the referenced polygon a hint polygon?
 
-		PolyIndex(int index_, bool splitCandidate_, bool hint_)
-		:	index(index_), splitCandidate(splitCandidate_), hint(hint_)
+		PolyIndex(const PolyCell_Ptr& cell_, bool splitCandidate_, bool hint_)
+		:	cell(cell_), splitCandidate(splitCandidate_), hint(hint_)
 		{}
 	};
 
-	//#################### TYPEDEFS ####################
-private:
-	typedef shared_ptr<Poly> Poly_Ptr;
-	typedef std::vector<Poly_Ptr> PolyVector;
 	typedef shared_ptr<const PolyIndex> PolyIndex_CPtr;
 
+	struct PartitionNode;
+	typedef shared_ptr<PartitionNode> PartitionNode_Ptr;
+
+	/**
+	A node of the intermediate tree built by the partitioning phase.
+	*/
+	struct PartitionNode
+	{
+		Plane_Ptr splitter;						// null for a leaf
+		PartitionNode_Ptr front, back;
+		bool solid;								// is this a solid leaf?
+		std::vector<PolyCell_Ptr> leafCells;	// the (non-hint) polygons in an empty leaf
+		std::vector<PolyCell_Ptr> fragments;	// the cells created by splitting polygons against the splitter
+	};
+
+	//#################### CONSTANTS ####################
+private:
+	enum { PARALLEL_THRESHOLD = 256 };		// the minimum number of polygons in a subtree for its halves to be partitioned in parallel
+
 	//#################### PRIVATE VARIABLES ####################
 private:
 	// Input data
+	int m_candidateSampleSize;	// the number of candidate splitters to score at each node (0 to score them all)
+	boost::uint64_t m_seed;
+	int m_testSampleSize;		// the number of polygons to score each candidate against
+	int m_threadCount;
 	double m_weight;
 
 	// Intermediate data
-	PolyVector m_polygons;
 	std::vector<PolyIndex> m_polyIndices;
 
 	// Output data
+	PolyVector m_polygons;
+	int m_splitCount;
 	BSPTree_Ptr m_tree;
 
 	//#################### CONSTRUCTORS ####################
 public:
-	BSPCompiler(const PolyVector& polygons, const PolyVector& hintPolygons, double weight);
+	BSPCompiler(const PolyVector& polygons, const PolyVector& hintPolygons, double weight, int threadCount = 1);
 
 	//#################### PUBLIC METHODS ####################
 public:
 	void build_tree();
 	const PolyVector& polygons() const;
+	void set_splitter_sampling(int candidateSampleSize, int testSampleSize, unsigned int seed);
+	int split_count() const;
 	BSPTree_Ptr tree() const;
 
 	//#################### PRIVATE METHODS ####################
 private:
-	BSPNode_Ptr build_subtree(const std::vector<PolyIndex>& polyIndices, std::vector<BSPNode_Ptr>& nodes, SolidityDescriptor solidityDescriptor);
-	PolyIndex_CPtr choose_split_poly(const std::vector<PolyIndex>& polyIndices) const;
+	PartitionNode_Ptr build_subtree(const std::vector<PolyIndex>& polyIndices, SolidityDescriptor solidityDescriptor, boost::uint64_t key, int threadCount) const;
+	void build_subtree_task(const std::vector<PolyIndex>& polyIndices, SolidityDescriptor solidityDescriptor, boost::uint64_t key, int threadCount,
+							PartitionNode_Ptr& result, std::string& error) const;
+	PolyIndex_CPtr choose_split_poly(const std::vector<PolyIndex>& polyIndices, boost::uint64_t key) const;
+	static boost::uint64_t mix(boost::uint64_t x);
+	BSPNode_Ptr output_subtree(const PartitionNode_Ptr& partitionNode, std::vector<BSPNode_Ptr>& nodes);
+	static std::vector<int> stratified_sample(const std::vector<int>& items, int sampleSize, boost::uint64_t& state);
 };
 
 }
@@ -3,21 +3,28 @@
  * Copyright Stuart Golodetz, 2009. All rights reserved.
  ***/
 
+#include <exception>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
 template <typename Poly>
-BSPCompiler<Poly>::BSPCompiler(const PolyVector& polygons, const PolyVector& hintPolygons, double weight)
-:	m_polygons(polygons), m_weight(weight)
+BSPCompiler<Poly>::BSPCompiler(const PolyVector& polygons, const PolyVector& hintPolygons, double weight, int threadCount)
+:	m_candidateSampleSize(0), m_seed(0), m_testSampleSize(0), m_threadCount(threadCount), m_weight(weight), m_splitCount(0)
 {
-	std::copy(hintPolygons.begin(), hintPolygons.end(), std::back_inserter(m_polygons));
+	PolyVector allPolygons(polygons);
+	std::copy(hintPolygons.begin(), hintPolygons.end(), std::back_inserter(allPolygons));
 
 	int normalPolyCount = static_cast<int>(polygons.size());
-	int totalPolyCount = static_cast<int>(m_polygons.size());
+	int totalPolyCount = static_cast<int>(allPolygons.size());
 	m_polyIndices.reserve(totalPolyCount);
 	for(int i=0; i<totalPolyCount; ++i)
 	{
-		m_polyIndices.push_back(PolyIndex(i, true, i >= normalPolyCount));
+		PolyCell_Ptr cell(new PolyCell(allPolygons[i], i));
+		m_polyIndices.push_back(PolyIndex(cell, true, i >= normalPolyCount));
 	}
 }
 
@@ -25,8 +32,19 @@ BSPCompiler<Poly>::BSPCompiler(const PolyVector& polygons, const PolyVector& hin
 template <typename Poly>
 void BSPCompiler<Poly>::build_tree()
 {
+	// Partition the polygons. (Note that this updates the cells referenced by m_polyIndices.)
+	PartitionNode_Ptr root = build_subtree(m_polyIndices, SD_UNKNOWN, 1, m_threadCount);
+
+	// Number the nodes and polygon fragments, and build the actual tree.
+	m_polygons.clear();
+	for(typename std::vector<PolyIndex>::const_iterator it=m_polyIndices.begin(), iend=m_polyIndices.end(); it!=iend; ++it)
+	{
+		m_polygons.push_back(it->cell->poly);
+	}
+	m_splitCount = 0;
+
 	std::vector<BSPNode_Ptr> nodes;
-	build_subtree(m_polyIndices, nodes, SD_UNKNOWN);
+	output_subtree(root, nodes);
 	m_tree.reset(new BSPTree(nodes));
 }
 
@@ -36,6 +54,31 @@ const typename BSPCompiler<Poly>::PolyVector& BSPCompiler<Poly>::polygons() cons
 	return m_polygons;
 }
 
+/**
+Makes the compiler choose each splitter by scoring a sample of the candidate polygons against
+a sample of the other polygons, rather than scoring all of them against each other.
+
+@param candidateSampleSize	The maximum number of candidate splitters to score at each node (0 to score all of them)
+@param testSampleSize		The maximum number of polygons to score each candidate against
+@param seed					The seed for the samples
+*/
+template <typename Poly>
+void BSPCompiler<Poly>::set_splitter_sampling(int candidateSampleSize, int testSampleSize, unsigned int seed)
+{
+	m_candidateSampleSize = candidateSampleSize;
+	m_testSampleSize = testSampleSize;
+	m_seed = seed;
+}
+
+/**
+Returns the number of times a polygon had to be split when the tree was built.
+*/
+template <typename Poly>
+int BSPCompiler<Poly>::split_count() const
+{
+	return m_splitCount;
+}
+
 template <typename Poly>
 BSPTree_Ptr BSPCompiler<Poly>::tree() const
 {
@@ -43,17 +86,29 @@ BSPTree_Ptr BSPCompiler<Poly>::tree() const
 }
 
 //#################### PRIVATE METHODS ####################
+/**
+Partitions a set of polygons into an intermediate subtree.
+
+@param polyIndices			The polygons
+@param solidityDescriptor	Whether the subtree's leaves are known to be empty or solid
+@param key					A key identifying the subtree's position in the tree (used to seed the splitter sampling)
+@param threadCount			The number of threads available for partitioning the subtree
+@return						The root of the subtree
+*/
 template <typename Poly>
-BSPNode_Ptr BSPCompiler<Poly>::build_subtree(const std::vector<PolyIndex>& polyIndices, std::vector<BSPNode_Ptr>& nodes, SolidityDescriptor solidityDescriptor)
+typename BSPCompiler<Poly>::PartitionNode_Ptr
+BSPCompiler<Poly>::build_subtree(const std::vector<PolyIndex>& polyIndices, SolidityDescriptor solidityDescriptor, boost::uint64_t key, int threadCount) const
 {
 	typedef typename Poly::Vert Vert;
 	typedef typename Poly::AuxData AuxData;
 
-	PolyIndex_CPtr splitPoly = choose_split_poly(polyIndices);
+	PolyIndex_CPtr splitPoly = choose_split_poly(polyIndices, key);
 
 	// Don't allow hint polygons to split solid leaves.
 	if(solidityDescriptor == SD_SOLID && splitPoly && splitPoly->hint) splitPoly.reset();
 
+	PartitionNode_Ptr node(new PartitionNode);
+
 	// If there were no suitable split candidates, we must have ended up in a leaf.
 	if(!splitPoly)
 	{
@@ -66,32 +121,31 @@ BSPNode_Ptr BSPCompiler<Poly>::build_subtree(const std::vector<PolyIndex>& polyI
 			}
 			case SD_EMPTY:
 			{
-				std::vector<int> indicesOnly;
+				node->solid = false;
 				for(size_t i=0, size=polyIndices.size(); i<size; ++i)
 				{
-					if(!polyIndices[i].hint) indicesOnly.push_back(polyIndices[i].index);
+					if(!polyIndices[i].hint) node->leafCells.push_back(polyIndices[i].cell);
 				}
-				nodes.push_back(BSPLeaf::make_empty_leaf((int)nodes.size(), indicesOnly));
 				break;
 			}
 			case SD_SOLID:
 			{
-				nodes.push_back(BSPLeaf::make_solid_leaf((int)nodes.size()));
+				node->solid = true;
 				break;
 			}
 		}
-		return nodes.back();
+		return node;
 	}
 
-	Plane_Ptr splitter(new Plane(make_plane(*m_polygons[splitPoly->index])));
+	node->splitter.reset(new Plane(make_plane(*splitPoly->cell->poly)));
+	const Plane& splitter = *node->splitter;
 
 	std::vector<PolyIndex> backPolys, frontPolys;
 
 	for(typename std::vector<PolyIndex>::const_iterator it=polyIndices.begin(), iend=polyIndices.end(); it!=iend; ++it)
 	{
-		int curIndex = it->index;
-		const Polygon<Vert,AuxData>& curPoly = *m_polygons[curIndex];
-		switch(classify_polygon_against_plane(curPoly, *splitter))
+		const Polygon<Vert,AuxData>& curPoly = *it->cell->poly;
+		switch(classify_polygon_against_plane(curPoly, splitter))
 		{
 			case CP_BACK:
 			{
@@ -100,8 +154,8 @@ BSPNode_Ptr BSPCompiler<Poly>::build_subtree(const std::vector<PolyIndex>& polyI
 			}
 			case CP_COPLANAR:
 			{
-				if(splitter->normal().dot(curPoly.normal()) > 0) frontPolys.push_back(PolyIndex(curIndex,false,it->hint));
-				else backPolys.push_back(PolyIndex(curIndex,false,it->hint));
+				if(splitter.normal().dot(curPoly.normal()) > 0) frontPolys.push_back(PolyIndex(it->cell,false,it->hint));
+				else backPolys.push_back(PolyIndex(it->cell,false,it->hint));
 				break;
 			}
 			case CP_FRONT:
@@ -111,55 +165,116 @@ BSPNode_Ptr BSPCompiler<Poly>::build_subtree(const std::vector<PolyIndex>& polyI
 			}
 			case CP_STRADDLE:
 			{
-				SplitResults<Vert,AuxData> sr = split_polygon(curPoly, *splitter);
-				m_polygons[curIndex] = sr.back;
-				int k = static_cast<int>(m_polygons.size());
-				m_polygons.push_back(sr.front);
-				backPolys.push_back(PolyIndex(curIndex,it->splitCandidate,it->hint));
-				frontPolys.push_back(PolyIndex(k,it->splitCandidate,it->hint));
+				SplitResults<Vert,AuxData> sr = split_polygon(curPoly, splitter);
+				it->cell->poly = sr.back;
+				PolyCell_Ptr frontCell(new PolyCell(sr.front, -1));
+				node->fragments.push_back(frontCell);
+				backPolys.push_back(PolyIndex(it->cell,it->splitCandidate,it->hint));
+				frontPolys.push_back(PolyIndex(frontCell,it->splitCandidate,it->hint));
 				break;
 			}
 		}
 	}
 
-	BSPNode_Ptr left, right;
-	if(splitPoly->hint)
+	SolidityDescriptor frontDescriptor = splitPoly->hint ? solidityDescriptor : SD_EMPTY;
+	SolidityDescriptor backDescriptor = splitPoly->hint ? solidityDescriptor : SD_SOLID;
+	boost::uint64_t frontKey = mix(key * 2), backKey = mix(key * 2 + 1);
+
+	// The two halves share no polygons, so if they're big enough, partition them in parallel.
+	if(threadCount > 1 && frontPolys.size() + backPolys.size() >= PARALLEL_THRESHOLD)
 	{
-		left = build_subtree(frontPolys, nodes, solidityDescriptor);
-		right = build_subtree(backPolys, nodes, solidityDescriptor);
+		int frontThreadCount = threadCount / 2;
+		std::string frontError;
+		boost::thread frontThread(boost::bind(&BSPCompiler::build_subtree_task, this, boost::cref(frontPolys), frontDescriptor, frontKey, frontThreadCount,
+											  boost::ref(node->front), boost::ref(frontError)));
+		try
+		{
+			node->back = build_subtree(backPolys, backDescriptor, backKey, threadCount - frontThreadCount);
+		}
+		catch(...)
+		{
+			frontThread.join();
+			throw;
+		}
+		frontThread.join();
+
+		// Re-raise any error from the front half on this thread (the task records errors of all kinds,
+		// since an exception which escaped the thread function would terminate the program).
+		if(!frontError.empty()) throw Exception(frontError);
 	}
 	else
 	{
-		left = build_subtree(frontPolys, nodes, SD_EMPTY);
-		right = build_subtree(backPolys, nodes, SD_SOLID);
+		node->front = build_subtree(frontPolys, frontDescriptor, frontKey, threadCount);
+		node->back = build_subtree(backPolys, backDescriptor, backKey, threadCount);
 	}
 
-	BSPNode_Ptr subtreeRoot(new BSPBranch((int)nodes.size(), splitter, left, right));
-	nodes.push_back(subtreeRoot);
-	return subtreeRoot;
+	return node;
 }
 
 template <typename Poly>
-typename BSPCompiler<Poly>::PolyIndex_CPtr BSPCompiler<Poly>::choose_split_poly(const std::vector<PolyIndex>& polyIndices) const
+void BSPCompiler<Poly>::build_subtree_task(const std::vector<PolyIndex>& polyIndices, SolidityDescriptor solidityDescriptor, boost::uint64_t key, int threadCount,
+										   PartitionNode_Ptr& result, std::string& error) const
+try
 {
-	PolyIndex_CPtr bestPolyIndex;
-	double bestMetric = INT_MAX;
+	result = build_subtree(polyIndices, solidityDescriptor, key, threadCount);
+}
+catch(Exception& e)			{ error = e.cause(); }
+catch(std::exception& e)	{ error = std::string("Error whilst building a BSP subtree: ") + e.what(); }
+catch(...)					{ error = "Unknown error whilst building a BSP subtree"; }
 
+template <typename Poly>
+typename BSPCompiler<Poly>::PolyIndex_CPtr BSPCompiler<Poly>::choose_split_poly(const std::vector<PolyIndex>& polyIndices, boost::uint64_t key) const
+{
 	int indexCount = static_cast<int>(polyIndices.size());
-	for(int i=0; i<indexCount; ++i)
+
+	// Determine which candidates to score, and which polygons to score them against.
+	std::vector<int> candidates, tests;
+	if(m_candidateSampleSize > 0)
 	{
-		if(!polyIndices[i].splitCandidate) continue;
+		// Sample from the normal candidates if there are any, since hint planes are chosen last anyway.
+		std::vector<int> normalCandidates, hintCandidates;
+		for(int i=0; i<indexCount; ++i)
+		{
+			if(!polyIndices[i].splitCandidate) continue;
+			if(polyIndices[i].hint) hintCandidates.push_back(i);
+			else normalCandidates.push_back(i);
+		}
+		if(normalCandidates.empty() && hintCandidates.empty()) return PolyIndex_CPtr();
+
+		for(int i=0; i<indexCount; ++i)
+		{
+			if(!polyIndices[i].hint) tests.push_back(i);		// hint polygons shouldn't affect balance or splitting
+		}
 
-		Plane plane = make_plane(*m_polygons[polyIndices[i].index]);
+		boost::uint64_t state = mix(m_seed ^ key);
+		candidates = stratified_sample(!normalCandidates.empty() ? normalCandidates : hintCandidates, m_candidateSampleSize, state);
+		tests = stratified_sample(tests, m_testSampleSize, state);
+	}
+	else
+	{
+		for(int i=0; i<indexCount; ++i)
+		{
+			if(polyIndices[i].splitCandidate) candidates.push_back(i);
+			if(!polyIndices[i].hint) tests.push_back(i);		// hint polygons shouldn't affect balance or splitting
+		}
+	}
+
+	PolyIndex_CPtr bestPolyIndex;
+	double bestMetric = INT_MAX;
+
+	for(std::vector<int>::const_iterator it=candidates.begin(), iend=candidates.end(); it!=iend; ++it)
+	{
+		int i = *it;
+		Plane plane = make_plane(*polyIndices[i].cell->poly);
 		int balance = 0, splits = 0;
 		int hintPenalty = polyIndices[i].hint ? 100000 : 0;		// make sure hint planes are chosen last
 
-		for(int j=0; j<indexCount; ++j)
+		for(std::vector<int>::const_iterator jt=tests.begin(), jend=tests.end(); jt!=jend; ++jt)
 		{
+			int j = *jt;
 			if(j == i) continue;
-			if(polyIndices[j].hint) continue;	// hint polygons shouldn't affect balance or splitting
 
-			switch(classify_polygon_against_plane(*m_polygons[polyIndices[j].index], plane))
+			switch(classify_polygon_against_plane(*polyIndices[j].cell->poly, plane))
 			{
 				case CP_BACK:
 					--balance;
@@ -186,4 +301,89 @@ typename BSPCompiler<Poly>::PolyIndex_CPtr BSPCompiler<Poly>::choose_split_poly(
 	return bestPolyIndex;
 }
 
+/**
+Scrambles a 64-bit value (this is the finaliser from the SplitMix64 generator).
+*/
+template <typename Poly>
+boost::uint64_t BSPCompiler<Poly>::mix(boost::uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**
+Numbers the nodes and polygon fragments in an intermediate subtree, and builds the
+corresponding subtree of the output tree. The fragments are numbered in pre-order and
+the nodes in post-order (visiting front subtrees before back subtrees in both cases),
+which is the order in which a single-threaded recursive compiler would create them.
+
+@param partitionNode	The root of the intermediate subtree
+@param nodes			The output nodes (the subtree's nodes are appended to these)
+@return					The root of the output subtree
+*/
+template <typename Poly>
+BSPNode_Ptr BSPCompiler<Poly>::output_subtree(const PartitionNode_Ptr& partitionNode, std::vector<BSPNode_Ptr>& nodes)
+{
+	if(!partitionNode->splitter)
+	{
+		if(partitionNode->solid)
+		{
+			nodes.push_back(BSPLeaf::make_solid_leaf((int)nodes.size()));
+		}
+		else
+		{
+			std::vector<int> indicesOnly;
+			indicesOnly.reserve(partitionNode->leafCells.size());
+			for(typename std::vector<PolyCell_Ptr>::const_iterator it=partitionNode->leafCells.begin(), iend=partitionNode->leafCells.end(); it!=iend; ++it)
+			{
+				indicesOnly.push_back((*it)->index);
+			}
+			nodes.push_back(BSPLeaf::make_empty_leaf((int)nodes.size(), indicesOnly));
+		}
+		return nodes.back();
+	}
+
+	for(typename std::vector<PolyCell_Ptr>::const_iterator it=partitionNode->fragments.begin(), iend=partitionNode->fragments.end(); it!=iend; ++it)
+	{
+		(*it)->index = static_cast<int>(m_polygons.size());
+		m_polygons.push_back((*it)->poly);
+	}
+	m_splitCount += static_cast<int>(partitionNode->fragments.size());
+
+	BSPNode_Ptr left = output_subtree(partitionNode->front, nodes);
+	BSPNode_Ptr right = output_subtree(partitionNode->back, nodes);
+
+	BSPNode_Ptr subtreeRoot(new BSPBranch((int)nodes.size(), partitionNode->splitter, left, right));
+	nodes.push_back(subtreeRoot);
+	return subtreeRoot;
+}
+
+/**
+Chooses a stratified random sample from a set of items: the items are divided into
+equal-sized strata, and one item is chosen at random from each stratum.
+
+@param items		The items
+@param sampleSize	The size of the sample
+@param state		The state of the random number generator
+@return				The sample (or all the items, if there are no more of them than the sample size)
+*/
+template <typename Poly>
+std::vector<int> BSPCompiler<Poly>::stratified_sample(const std::vector<int>& items, int sampleSize, boost::uint64_t& state)
+{
+	int itemCount = static_cast<int>(items.size());
+	if(itemCount <= sampleSize) return items;
+
+	std::vector<int> sample;
+	sample.reserve(sampleSize);
+	for(int s=0; s<sampleSize; ++s)
+	{
+		int lo = static_cast<int>(static_cast<boost::uint64_t>(s) * itemCount / sampleSize);
+		int hi = static_cast<int>(static_cast<boost::uint64_t>(s+1) * itemCount / sampleSize);
+		state += 0x9e3779b97f4a7c15ULL;
+		sample.push_back(items[lo + static_cast<int>(mix(state) % (hi - lo))]);
+	}
+	return sample;
+}
+
 }
@@ -16,6 +16,7 @@ using boost::lexical_cast;
 #include <hesp/exceptions/Exception.h>
 #include <hesp/io/util/LineIO.h>
 #include <hesp/math/geom/GeomUtil.h>
+#include "BakedTree.h"
 
 namespace hesp {
 
@@ -24,9 +25,22 @@ BSPTree::BSPTree(const std::vector<BSPNode_Ptr>& nodes)
 :	m_nodes(nodes)
 {
 	index_leaves();
+	m_bakedTree.reset(new BakedTree(m_nodes));
 }
 
 //#################### PUBLIC METHODS ####################
+/**
+Returns a baked copy of the tree's structure, for use by queries that walk the tree
+many times. Note that this is made when the tree is constructed, so it doesn't need
+to be rebuilt when the polygon indices stored in the leaves change.
+
+@return	As stated
+*/
+BakedTree_CPtr BSPTree::baked_tree() const
+{
+	return m_bakedTree;
+}
+
 /**
 Returns the number of empty leaves in the tree.
 
@@ -11,6 +11,9 @@
 
 namespace hesp {
 
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<const class BakedTree> BakedTree_CPtr;
+
 //#################### TYPEDEFS ####################
 typedef shared_ptr<class BSPTree> BSPTree_Ptr;
 typedef shared_ptr<const class BSPTree> BSPTree_CPtr;
@@ -28,6 +31,7 @@ private:
 	std::vector<BSPNode_Ptr> m_nodes;
 	std::vector<BSPLeaf*> m_leaves;
 	int m_emptyLeafCount;
+	BakedTree_CPtr m_bakedTree;
 
 	//#################### CONSTRUCTORS ####################
 public:
@@ -35,6 +39,7 @@ public:
 
 	//#################### PUBLIC METHODS ####################
 public:
+	BakedTree_CPtr baked_tree() const;
 	int empty_leaf_count() const;
 	BSPLeaf *leaf(int n);
 	const BSPLeaf *leaf(int n) const;
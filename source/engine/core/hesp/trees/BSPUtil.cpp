@@ -5,6 +5,8 @@
 
 #include "BSPUtil.h"
 
+#include <algorithm>
+
 namespace hesp {
 
 //#################### PUBLIC METHODS ####################
@@ -18,46 +20,193 @@ Determines whether or not there is line-of-sight between p1 and p2 in the specif
 */
 bool BSPUtil::line_of_sight(const Vector3d& p1, const Vector3d& p2, const BSPTree_CPtr& tree)
 {
-	return line_of_sight_sub(p1, p2, tree->root());
+	return line_of_sight(p1, p2, *tree->baked_tree());
 }
 
-//#################### PRIVATE METHODS ####################
-bool BSPUtil::line_of_sight_sub(const Vector3d& p1, const Vector3d& p2, const BSPNode_CPtr& node)
+/**
+Determines whether or not there is line-of-sight between p1 and p2 in the specified baked BSP tree.
+
+@param p1		A point in the world
+@param p2		Another point in the world
+@param tree		The baked BSP tree
+@return			true, if there is line-of-sight between the points, or false otherwise
+*/
+bool BSPUtil::line_of_sight(const Vector3d& p1, const Vector3d& p2, const BakedTree& tree)
 {
-	if(node->is_leaf())
+	// The stack never needs more entries than the depth of the tree, so only very deep trees need a heap-allocated one.
+	LineOfSightFrame inlineStack[INLINE_STACK_SIZE];
+	if(tree.depth() <= INLINE_STACK_SIZE)
 	{
-		// If both points are in the same leaf, there's line-of-sight provided the leaf's not solid.
-		const BSPLeaf *leaf = node->as_leaf();
-		return !leaf->is_solid();
+		return line_of_sight_sub(p1, p2, tree, inlineStack, NULL);
 	}
+	else
+	{
+		std::vector<LineOfSightFrame> stack(tree.depth());
+		return line_of_sight_sub(p1, p2, tree, &stack[0], NULL);
+	}
+}
+
+/**
+Determines whether or not there is line-of-sight between the endpoints of each of a batch of
+line segments in the specified BSP tree.
+
+@param segments		The line segments
+@param tree			The BSP tree
+@return				A bitset whose i'th bit is set iff there is line-of-sight between the endpoints of segments[i]
+*/
+boost::dynamic_bitset<> BSPUtil::lines_of_sight(const std::vector<LineSegment3d>& segments, const BSPTree_CPtr& tree)
+{
+	return lines_of_sight(segments, *tree->baked_tree());
+}
+
+/**
+Determines whether or not there is line-of-sight between the endpoints of each of a batch of
+line segments in the specified baked BSP tree. This is intended for the case where many of the
+segments start from the same point (e.g. the shadow rays from a light to the points on a surface):
+consecutive segments with the same start point share its classifications against the split planes,
+and if the start point is found to be in a solid leaf, all of them fail at once without being walked
+through the tree. The working storage is allocated once for the whole batch.
+
+@param segments		The line segments
+@param tree			The baked BSP tree
+@return				A bitset whose i'th bit is set iff there is line-of-sight between the endpoints of segments[i]
+*/
+boost::dynamic_bitset<> BSPUtil::lines_of_sight(const std::vector<LineSegment3d>& segments, const BakedTree& tree)
+{
+	int segmentCount = static_cast<int>(segments.size());
+	boost::dynamic_bitset<> result(segmentCount);
+	if(segmentCount == 0) return result;
+
+	std::vector<LineOfSightFrame> stack(std::max(tree.depth(), 1));
 
-	const BSPBranch *branch = node->as_branch();
-	PlaneClassifier cp1, cp2;
-	switch(classify_linesegment_against_plane(p1, p2, *branch->splitter(), cp1, cp2))
+	SourceClassifications sourceClassifications;
+	sourceClassifications.source = segments[0].e1;
+	sourceClassifications.stamp = 0;
+	sourceClassifications.stamps.resize(tree.node_count(), -1);
+	sourceClassifications.classifiers.resize(tree.node_count());
+	sourceClassifications.sourceInSolidLeaf = source_in_solid_leaf(tree, sourceClassifications);
+
+	for(int i=0; i<segmentCount; ++i)
 	{
-		case CP_BACK:
+		const Vector3d& source = segments[i].e1;
+		if(source.x != sourceClassifications.source.x || source.y != sourceClassifications.source.y || source.z != sourceClassifications.source.z)
 		{
-			return line_of_sight_sub(p1, p2, branch->right());
+			sourceClassifications.source = source;
+			++sourceClassifications.stamp;
+			sourceClassifications.sourceInSolidLeaf = source_in_solid_leaf(tree, sourceClassifications);
 		}
-		case CP_COPLANAR:
-		case CP_FRONT:
+
+		if(sourceClassifications.sourceInSolidLeaf) continue;
+		result[i] = line_of_sight_sub(source, segments[i].e2, tree, &stack[0], &sourceClassifications);
+	}
+
+	return result;
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Walks the line segment p1-p2 through the tree, splitting it at each plane it straddles. The near
+part of a split segment is followed first, with the far part being pushed on to the stack to be
+visited afterwards: there's line-of-sight iff none of the parts ends up in a solid leaf.
+
+@param p1						A point in the world
+@param p2						Another point in the world
+@param tree						The baked BSP tree
+@param stack					A stack with room for at least tree.depth() frames
+@param sourceClassifications	Cached classifications of p1 against the tree's split planes (may be NULL)
+@return							true, if there is line-of-sight between the points, or false otherwise
+*/
+bool BSPUtil::line_of_sight_sub(const Vector3d& p1, const Vector3d& p2, const BakedTree& tree, LineOfSightFrame *stack, SourceClassifications *sourceClassifications)
+{
+	int stackSize = 0;
+
+	int cur = tree.root_index();
+	Vector3d s = p1, e = p2;
+	bool sIsSource = true;	// the start of the current segment is p1 until we pop a far part off the stack
+
+	for(;;)
+	{
+		const BakedTree::Node& node = tree.node(cur);
+		if(node.is_leaf())
 		{
-			return line_of_sight_sub(p1, p2, branch->left());
+			if(tree.is_solid(node.leafIndex)) return false;
+			if(stackSize == 0) return true;
+
+			const LineOfSightFrame& frame = stack[--stackSize];
+			cur = frame.node;
+			s = frame.p1;
+			e = frame.p2;
+			sIsSource = false;
+			continue;
 		}
-		default:	// case CP_STRADDLE
+
+		const Plane& splitter = tree.plane(node.planeIndex);
+
+		PlaneClassifier cs;
+		if(sIsSource && sourceClassifications)
 		{
-			Vector3d q = determine_linesegment_intersection_with_plane(p1, p2, *branch->splitter()).first;
-			if(cp1 == CP_BACK)
-			{
-				// cp2 == CP_FRONT
-				return line_of_sight_sub(p1, q, branch->right()) && line_of_sight_sub(q, p2, branch->left());
-			}
-			else
+			int& stamp = sourceClassifications->stamps[cur];
+			PlaneClassifier& classifier = sourceClassifications->classifiers[cur];
+			if(stamp != sourceClassifications->stamp)
 			{
-				// cp1 == CP_FRONT, cp2 == CP_BACK
-				return line_of_sight_sub(p1, q, branch->left()) && line_of_sight_sub(q, p2, branch->right());
+				classifier = classify_point_against_plane(s, splitter);
+				stamp = sourceClassifications->stamp;
 			}
+			cs = classifier;
 		}
+		else cs = classify_point_against_plane(s, splitter);
+
+		PlaneClassifier ce = classify_point_against_plane(e, splitter);
+
+		// This mirrors classify_linesegment_against_plane: coplanar segments are treated as being in front of the plane.
+		bool backFlag = cs == CP_BACK || ce == CP_BACK;
+		bool frontFlag = cs == CP_FRONT || ce == CP_FRONT;
+		if(backFlag && frontFlag)
+		{
+			Vector3d q = determine_linesegment_intersection_with_plane(s, e, splitter).first;
+			int nearChild = cs == CP_BACK ? node.right : node.left;
+			int farChild = cs == CP_BACK ? node.left : node.right;
+
+			LineOfSightFrame& frame = stack[stackSize++];
+			frame.node = farChild;
+			frame.p1 = q;
+			frame.p2 = e;
+
+			cur = nearChild;
+			e = q;
+		}
+		else cur = backFlag ? node.right : node.left;
+	}
+}
+
+/**
+Determines whether the source point of a batch of line segments lies in a solid leaf of the tree,
+filling in its classifications against the planes on the way down as it goes.
+
+Note:	The first part of each segment walked by line_of_sight_sub follows the source down the tree
+		as long as the source isn't on any of the split planes. Its walk therefore ends in the same
+		leaf, and if that's solid, none of the segments can have line-of-sight. If the source is on
+		one of the planes, which leaf its segments end up in depends on their directions, so we
+		can't say anything about them here and just return false.
+
+@param tree						The baked BSP tree
+@param sourceClassifications	The classifications of the source point (its stamp must be up-to-date)
+@return							true, if the source point is strictly within a solid leaf, or false otherwise
+*/
+bool BSPUtil::source_in_solid_leaf(const BakedTree& tree, SourceClassifications& sourceClassifications)
+{
+	int cur = tree.root_index();
+	for(;;)
+	{
+		const BakedTree::Node& node = tree.node(cur);
+		if(node.is_leaf()) return tree.is_solid(node.leafIndex);
+
+		PlaneClassifier cp = classify_point_against_plane(sourceClassifications.source, tree.plane(node.planeIndex));
+		sourceClassifications.classifiers[cur] = cp;
+		sourceClassifications.stamps[cur] = sourceClassifications.stamp;
+
+		if(cp == CP_COPLANAR) return false;
+		cur = cp == CP_BACK ? node.right : node.left;
 	}
 }
 
@@ -7,24 +7,60 @@
 #define H_HESP_BSPUTIL
 
 #include <list>
+#include <vector>
 
+#include <boost/dynamic_bitset.hpp>
+
+#include <hesp/math/geom/LineSegment.h>
 #include <hesp/math/geom/Polygon.h>
 #include <hesp/math/vectors/Vector3.h>
+#include "BakedTree.h"
 #include "BSPTree.h"
 
 namespace hesp {
 
 class BSPUtil
 {
+	//#################### NESTED CLASSES ####################
+private:
+	struct LineOfSightFrame
+	{
+		int node;
+		Vector3d p1, p2;
+	};
+
+	/**
+	The classifications of a point against the planes of a baked tree, calculated on demand.
+	When a batch of line segments share a start point (e.g. a light), this saves classifying
+	it against the same planes over and over again. We also record whether the point is in a
+	solid leaf, since if so none of the segments starting from it can have line-of-sight.
+	*/
+	struct SourceClassifications
+	{
+		Vector3d source;
+		bool sourceInSolidLeaf;
+		int stamp;								// the entries in classifiers are only valid if the corresponding stamp matches this
+		std::vector<int> stamps;
+		std::vector<PlaneClassifier> classifiers;
+	};
+
+	//#################### CONSTANTS ####################
+private:
+	enum { INLINE_STACK_SIZE = 64 };
+
 	//#################### PUBLIC METHODS ####################
 public:
 	template <typename Vert, typename AuxData> static std::list<int> find_leaf_indices(const Polygon<Vert,AuxData>& poly, const BSPTree_CPtr& tree);
 	static bool line_of_sight(const Vector3d& p1, const Vector3d& p2, const BSPTree_CPtr& tree);
+	static bool line_of_sight(const Vector3d& p1, const Vector3d& p2, const BakedTree& tree);
+	static boost::dynamic_bitset<> lines_of_sight(const std::vector<LineSegment3d>& segments, const BSPTree_CPtr& tree);
+	static boost::dynamic_bitset<> lines_of_sight(const std::vector<LineSegment3d>& segments, const BakedTree& tree);
 
 	//#################### PRIVATE METHODS ####################
 private:
 	template <typename Vert, typename AuxData> static std::list<int> find_leaf_indices_sub(const Polygon<Vert,AuxData>& poly, const BSPNode_CPtr& node);
-	static bool line_of_sight_sub(const Vector3d& p1, const Vector3d& p2, const BSPNode_CPtr& node);
+	static bool line_of_sight_sub(const Vector3d& p1, const Vector3d& p2, const BakedTree& tree, LineOfSightFrame *stack, SourceClassifications *sourceClassifications);
+	static bool source_in_solid_leaf(const BakedTree& tree, SourceClassifications& sourceClassifications);
 };
 
 }
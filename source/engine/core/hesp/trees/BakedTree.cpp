@@ -0,0 +1,167 @@
+/***
+ * hesperus: BakedTree.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "BakedTree.h"
+
+#include <algorithm>
+
+#include <hesp/exceptions/Exception.h>
+#include "BSPBranch.h"
+#include "BSPLeaf.h"
+#include "OnionBranch.h"
+#include "OnionLeaf.h"
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Bakes the nodes of a BSP tree. The leaves must already have been indexed.
+
+@param nodes		The nodes of the BSP tree, in node index order
+@throws Exception	If a branch node precedes either of its children
+*/
+BakedTree::BakedTree(const std::vector<BSPNode_Ptr>& nodes)
+:	m_nodes(nodes.size()), m_mapCount(1), m_masksPerLeaf(1)
+{
+	int nodeCount = static_cast<int>(nodes.size());
+	m_leafSolidity.resize(nodeCount, 0);
+
+	int leafCount = 0;
+	for(int i=0; i<nodeCount; ++i)
+	{
+		if(nodes[i]->is_leaf())
+		{
+			const BSPLeaf *leaf = nodes[i]->as_leaf();
+			Node& node = m_nodes[i];
+			node.planeIndex = node.left = node.right = -1;
+			node.leafIndex = leaf->leaf_index();
+			if(leaf->is_solid()) m_leafSolidity[node.leafIndex] = 1;
+			++leafCount;
+		}
+		else
+		{
+			const BSPBranch *branch = nodes[i]->as_branch();
+			bake_branch(i, branch->splitter(), branch->left()->index(), branch->right()->index());
+		}
+	}
+
+	m_leafSolidity.resize(leafCount);
+	calculate_depth();
+}
+
+/**
+Bakes the nodes of an onion tree. The leaves must already have been indexed.
+
+@param nodes		The nodes of the onion tree, in node index order
+@param mapCount		The number of maps in the onion tree
+@throws Exception	If a branch node precedes either of its children
+*/
+BakedTree::BakedTree(const std::vector<OnionNode_Ptr>& nodes, int mapCount)
+:	m_nodes(nodes.size()), m_mapCount(mapCount), m_masksPerLeaf(std::max((mapCount + MAPS_PER_MASK - 1) / MAPS_PER_MASK, 1))
+{
+	int nodeCount = static_cast<int>(nodes.size());
+	m_leafSolidity.resize(nodeCount * m_masksPerLeaf, 0);
+
+	int leafCount = 0;
+	for(int i=0; i<nodeCount; ++i)
+	{
+		if(nodes[i]->is_leaf())
+		{
+			const OnionLeaf *leaf = nodes[i]->as_leaf();
+			Node& node = m_nodes[i];
+			node.planeIndex = node.left = node.right = -1;
+			node.leafIndex = leaf->leaf_index();
+			for(int m=0; m<mapCount; ++m)
+			{
+				if(leaf->is_solid(m)) m_leafSolidity[node.leafIndex * m_masksPerLeaf + m / MAPS_PER_MASK] |= MapMask(1) << (m % MAPS_PER_MASK);
+			}
+			++leafCount;
+		}
+		else
+		{
+			const OnionBranch *branch = nodes[i]->as_branch();
+			bake_branch(i, branch->splitter(), branch->left()->index(), branch->right()->index());
+		}
+	}
+
+	m_leafSolidity.resize(leafCount * m_masksPerLeaf);
+	calculate_depth();
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Returns the depth of the tree, i.e. the largest number of branch nodes on any path from
+the root to a leaf. This is an upper bound on the size of the stack needed to walk a
+line segment through the tree.
+
+@return	As stated
+*/
+int BakedTree::depth() const
+{
+	return m_depth;
+}
+
+/**
+Returns whether or not the specified leaf is solid in the specified map.
+
+@param leafIndex	The leaf index of the leaf
+@param mapIndex		The map (this is always 0 for a baked BSP tree)
+@return				true, if the leaf is solid in the map, or false otherwise
+*/
+bool BakedTree::is_solid(int leafIndex, int mapIndex) const
+{
+	return ((m_leafSolidity[leafIndex * m_masksPerLeaf + mapIndex / MAPS_PER_MASK] >> (mapIndex % MAPS_PER_MASK)) & 1) != 0;
+}
+
+int BakedTree::map_count() const							{ return m_mapCount; }
+int BakedTree::mask_count() const							{ return m_masksPerLeaf; }
+const BakedTree::Node& BakedTree::node(int n) const			{ return m_nodes[n]; }
+int BakedTree::node_count() const							{ return static_cast<int>(m_nodes.size()); }
+const Plane& BakedTree::plane(int n) const					{ return m_planes[n]; }
+int BakedTree::root_index() const							{ return static_cast<int>(m_nodes.size()) - 1; }
+
+/**
+Returns the solidity of the specified leaf in a block of MAPS_PER_MASK consecutive maps.
+
+@param leafIndex	The leaf index of the leaf
+@param maskIndex	The index of the block of maps (in the range [0,mask_count()))
+@return				A mask whose bit m is set iff the leaf is solid in map maskIndex * MAPS_PER_MASK + m
+*/
+BakedTree::MapMask BakedTree::solidity_mask(int leafIndex, int maskIndex) const
+{
+	return m_leafSolidity[leafIndex * m_masksPerLeaf + maskIndex];
+}
+
+const Plane_CPtr& BakedTree::splitter(int n) const			{ return m_splitters[n]; }
+
+//#################### PRIVATE METHODS ####################
+void BakedTree::bake_branch(int n, const Plane_CPtr& splitter, int left, int right)
+{
+	if(left >= n || right >= n) throw Exception("The tree nodes are not stored in postorder");
+
+	Node& node = m_nodes[n];
+	node.planeIndex = static_cast<int>(m_planes.size());
+	node.left = left;
+	node.right = right;
+	node.leafIndex = -1;
+
+	m_planes.push_back(*splitter);
+	m_splitters.push_back(splitter);
+}
+
+void BakedTree::calculate_depth()
+{
+	// Since the nodes are in postorder, the depth of each node's subtree can be calculated in a single pass.
+	int nodeCount = static_cast<int>(m_nodes.size());
+	std::vector<int> subtreeDepths(nodeCount, 0);
+	for(int i=0; i<nodeCount; ++i)
+	{
+		const Node& node = m_nodes[i];
+		if(!node.is_leaf()) subtreeDepths[i] = 1 + std::max(subtreeDepths[node.left], subtreeDepths[node.right]);
+	}
+	m_depth = nodeCount > 0 ? subtreeDepths.back() : 0;
+}
+
+}
@@ -0,0 +1,97 @@
+/***
+ * hesperus: BakedTree.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_BAKEDTREE
+#define H_HESP_BAKEDTREE
+
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include <hesp/math/geom/Plane.h>
+#include "BSPNode.h"
+#include "OnionNode.h"
+
+namespace hesp {
+
+/**
+This class represents a compact, read-only copy of the structure of a BSP or onion tree,
+for use by queries which need to walk the tree many times (e.g. the line-of-sight tests
+made when lighting a level, or the movement and collision tests made every frame). The
+nodes are stored contiguously in node index order (the same order as in the original
+tree, so the root is the last node), and refer to their children and split planes by
+index rather than by pointer. A query can thus walk the tree without any virtual calls
+or reference count updates.
+
+A BSP tree is baked as a tree with a single map, so that the same queries can be run on
+both kinds of tree. The solidity of each leaf is packed into bitmasks, each covering a block
+of MAPS_PER_MASK consecutive maps, so that a query can follow a ray for several maps at once.
+Trees with more maps than fit in one mask just store several masks per leaf.
+*/
+class BakedTree
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef boost::uint32_t MapMask;	// bit m of mask k refers to map k * MAPS_PER_MASK + m
+
+	//#################### CONSTANTS ####################
+public:
+	enum { MAPS_PER_MASK = 32 };
+
+	//#################### NESTED CLASSES ####################
+public:
+	struct Node
+	{
+		int planeIndex;		// the index of the node's split plane in the plane table, or -1 if the node is a leaf
+		int left;			// the node index of the left child (branches only)
+		int right;			// the node index of the right child (branches only)
+		int leafIndex;		// the leaf index of the node (leaves only)
+
+		bool is_leaf() const	{ return planeIndex == -1; }
+	};
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	std::vector<Node> m_nodes;
+	std::vector<Plane> m_planes;
+	std::vector<Plane_CPtr> m_splitters;		// the original split planes, in the same order as m_planes
+	std::vector<MapMask> m_leafSolidity;		// bit m of element l * m_masksPerLeaf + k indicates whether the leaf with leaf index l is solid in map k * MAPS_PER_MASK + m
+	int m_mapCount;
+	int m_masksPerLeaf;
+	int m_depth;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit BakedTree(const std::vector<BSPNode_Ptr>& nodes);
+	BakedTree(const std::vector<OnionNode_Ptr>& nodes, int mapCount);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	int depth() const;
+	bool is_solid(int leafIndex, int mapIndex = 0) const;
+	int map_count() const;
+	int mask_count() const;
+	const Node& node(int n) const;
+	int node_count() const;
+	const Plane& plane(int n) const;
+	int root_index() const;
+	MapMask solidity_mask(int leafIndex, int maskIndex = 0) const;
+	const Plane_CPtr& splitter(int n) const;
+
+	//#################### PRIVATE METHODS ####################
+private:
+	void bake_branch(int n, const Plane_CPtr& splitter, int left, int right);
+	void calculate_depth();
+};
+
+//#################### TYPEDEFS ####################
+typedef shared_ptr<BakedTree> BakedTree_Ptr;
+typedef shared_ptr<const BakedTree> BakedTree_CPtr;
+
+}
+
+#endif
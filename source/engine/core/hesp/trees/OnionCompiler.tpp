@@ -215,15 +215,15 @@ Vector3d OnionCompiler<Poly>::find_arbitrary_leaf_point(const std::vector<Plane_
 	planes.push_back(Plane_Ptr(new Plane(Vector3d(0,0,-1), -HALFWORLDBOUND)));	// z = HALFWORLDBOUND (dir -z)
 
 	typedef Polygon<Vector3d,NullAuxData> SimplePoly;
-	typedef shared_ptr<SimplePoly> SimplePoly_Ptr;
 
-	std::vector<SimplePoly_Ptr> faces;
+	std::vector<SimplePoly> faces;
+	typename SimplePoly::VertexList backVerts, frontVerts;
 
 	int planeCount = static_cast<int>(planes.size());
 	for(int i=0; i<planeCount; ++i)
 	{
 		// Build a large initial face on each plane.
-		SimplePoly_Ptr face = make_universe_polygon<NullAuxData>(*planes[i], NullAuxData());
+		SimplePoly face = *make_universe_polygon<NullAuxData>(*planes[i], NullAuxData());
 
 		// Clip it to the other planes.
 		bool discard = false;
@@ -231,7 +231,7 @@ Vector3d OnionCompiler<Poly>::find_arbitrary_leaf_point(const std::vector<Plane_
 		{
 			if(j == i) continue;
 
-			switch(classify_polygon_against_plane(*face, *planes[j]))
+			switch(classify_polygon_against_plane(face, *planes[j]))
 			{
 				case CP_BACK:
 				{
@@ -252,8 +252,8 @@ Vector3d OnionCompiler<Poly>::find_arbitrary_leaf_point(const std::vector<Plane_
 				case CP_STRADDLE:
 				{
 					// The face straddles the plane, so split it and keep the bit in front of it.
-					SplitResults<Vector3d,NullAuxData> sr = split_polygon(*face, *planes[j]);
-					face = sr.front;
+					split_polygon(face, *planes[j], backVerts, frontVerts);
+					face = SimplePoly(frontVerts, face.auxiliary_data());
 					break;
 				}
 			}
@@ -271,7 +271,7 @@ Vector3d OnionCompiler<Poly>::find_arbitrary_leaf_point(const std::vector<Plane_
 	int faceCount = static_cast<int>(faces.size());
 	for(int i=0; i<faceCount; ++i)
 	{
-		const SimplePoly& face = *faces[i];
+		const SimplePoly& face = faces[i];
 		int vertCount = face.vertex_count();
 		for(int j=0; j<vertCount; ++j)
 		{
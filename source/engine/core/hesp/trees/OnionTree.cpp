@@ -13,6 +13,7 @@ using boost::lexical_cast;
 #include <hesp/exceptions/Exception.h>
 #include <hesp/io/util/LineIO.h>
 #include <hesp/math/geom/GeomUtil.h>
+#include "BakedTree.h"
 
 namespace hesp {
 
@@ -21,9 +22,21 @@ OnionTree::OnionTree(const std::vector<OnionNode_Ptr>& nodes, int mapCount)
 :	m_nodes(nodes), m_mapCount(mapCount)
 {
 	index_leaves();
+	m_bakedTree.reset(new BakedTree(m_nodes, mapCount));
 }
 
 //#################### PUBLIC METHODS ####################
+/**
+Returns a baked copy of the tree's structure, for use by the movement and collision
+queries (which walk the tree many times per frame).
+
+@return	As stated
+*/
+BakedTree_CPtr OnionTree::baked_tree() const
+{
+	return m_bakedTree;
+}
+
 const OnionLeaf *OnionTree::leaf(int n) const
 {
 	return m_leaves[n];
@@ -11,6 +11,9 @@
 
 namespace hesp {
 
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<const class BakedTree> BakedTree_CPtr;
+
 //#################### TYPEDEFS ####################
 typedef shared_ptr<class OnionTree> OnionTree_Ptr;
 typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
@@ -28,6 +31,7 @@ private:
 	std::vector<OnionNode_Ptr> m_nodes;
 	std::vector<OnionLeaf*> m_leaves;
 	int m_mapCount;
+	BakedTree_CPtr m_bakedTree;
 
 	//#################### CONSTRUCTORS ####################
 public:
@@ -35,6 +39,7 @@ public:
 
 	//#################### PUBLIC METHODS ####################
 public:
+	BakedTree_CPtr baked_tree() const;
 	const OnionLeaf *leaf(int n) const;
 	static OnionTree_Ptr load_postorder_text(std::istream& is);
 	int map_count() const;
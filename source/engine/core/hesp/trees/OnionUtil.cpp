@@ -10,6 +10,7 @@ using boost::lexical_cast;
 
 #include <hesp/exceptions/Exception.h>
 #include <hesp/math/geom/GeomUtil.h>
+#include "BakedTree.h"
 #include "OnionTree.h"
 
 namespace hesp {
@@ -18,130 +19,236 @@ namespace hesp {
 OnionUtil::Transition
 OnionUtil::find_first_transition(int mapIndex, const Vector3d& source, const Vector3d& dest, const OnionTree_CPtr& tree)
 {
-	if(0 <= mapIndex && mapIndex < tree->map_count())
+	return find_first_transition(mapIndex, source, dest, *tree->baked_tree());
+}
+
+/**
+Finds the first transition (if any) between empty and solid space along the ray from source to dest in the specified map.
+
+@param mapIndex		The map
+@param source		The start of the ray
+@param dest			The end of the ray
+@param tree			The baked onion tree
+@return				The first transition along the ray
+@throws Exception	If the tree doesn't contain the map
+*/
+OnionUtil::Transition
+OnionUtil::find_first_transition(int mapIndex, const Vector3d& source, const Vector3d& dest, const BakedTree& tree)
+{
+	if(0 <= mapIndex && mapIndex < tree.map_count())
 	{
-		return find_first_transition_sub(mapIndex, source, dest, tree->root());
+		const int bit = mapIndex % BakedTree::MAPS_PER_MASK;
+		Transition transitions[BakedTree::MAPS_PER_MASK];
+		find_first_transitions(BakedTree::MapMask(1) << bit, source, dest, tree, transitions, mapIndex / BakedTree::MAPS_PER_MASK);
+		return transitions[bit];
 	}
 	else throw Exception("The onion tree does not contain a map with index " + lexical_cast<std::string>(mapIndex));
 }
 
-//#################### PRIVATE METHODS ####################
-OnionUtil::Transition
-OnionUtil::find_first_transition_sub(int mapIndex, const Vector3d& source, const Vector3d& dest, const OnionNode_CPtr& node)
+void OnionUtil::find_first_transitions(BakedTree::MapMask maps, const Vector3d& source, const Vector3d& dest,
+									   const OnionTree_CPtr& tree, Transition *transitions, int maskIndex)
 {
-	if(node->is_leaf())
+	find_first_transitions(maps, source, dest, *tree->baked_tree(), transitions, maskIndex);
+}
+
+/**
+Finds the first transitions between empty and solid space along the ray from source to dest in several maps at once.
+The ray is only walked through the tree once, and each leaf it passes through is checked for all of the maps together.
+The results are the same as those of calling find_first_transition for each map in turn. The maps are specified
+within a single block of BakedTree::MAPS_PER_MASK consecutive maps (trees with more maps than that have several blocks).
+
+@param maps			A mask specifying the maps (map maskIndex * MAPS_PER_MASK + m is included iff bit m is set)
+@param source		The start of the ray
+@param dest			The end of the ray
+@param tree			The baked onion tree
+@param transitions	An array with MAPS_PER_MASK elements: transitions[m] is set to the first transition along
+					the ray in map maskIndex * MAPS_PER_MASK + m (for each bit m set in the mask)
+@param maskIndex	The index of the block of maps
+@throws Exception	If the tree doesn't contain all of the specified maps
+*/
+void OnionUtil::find_first_transitions(BakedTree::MapMask maps, const Vector3d& source, const Vector3d& dest,
+									   const BakedTree& tree, Transition *transitions, int maskIndex)
+{
+	int mapsInMask = tree.map_count() - maskIndex * BakedTree::MAPS_PER_MASK;
+	if(maskIndex < 0 || maskIndex >= tree.mask_count() || (mapsInMask < BakedTree::MAPS_PER_MASK && (maps >> mapsInMask) != 0))
+	{
+		throw Exception("The onion tree does not contain all of the specified maps");
+	}
+
+	// The stack never needs more entries than the depth of the tree, so only very deep trees need a heap-allocated one.
+	TransitionFrame inlineStack[INLINE_STACK_SIZE];
+	if(tree.depth() <= INLINE_STACK_SIZE)
+	{
+		find_first_transitions_sub(maps, maskIndex, source, dest, tree, tree.root_index(), inlineStack, transitions);
+	}
+	else
 	{
-		const OnionLeaf *leaf = node->as_leaf();
-		if(leaf->is_solid(mapIndex)) return Transition(RAY_SOLID);
-		else return Transition(RAY_EMPTY);
+		std::vector<TransitionFrame> stack(tree.depth());
+		find_first_transitions_sub(maps, maskIndex, source, dest, tree, tree.root_index(), &stack[0], transitions);
 	}
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Walks the line segment source-dest through the subtree rooted at the specified node, from front to back.
+The segment is split at each plane it straddles, with the near part being followed first and the far part
+being pushed on to the stack to be visited afterwards. Each map's first transition is at the start of the
+first part of the segment whose solidity differs from that of the first part. (A segment which lies in a
+split plane is walked through both of the plane's subtrees, and their results are combined as a single part.)
 
-	const OnionBranch *branch = node->as_branch();
-	OnionNode_CPtr left = branch->left();
-	OnionNode_CPtr right = branch->right();
+@param maps			The maps whose transitions are wanted
+@param maskIndex	The index of the block of maps to which the mask refers
+@param source		The start of the segment
+@param dest			The end of the segment
+@param tree			The baked onion tree
+@param root			The index of the root node of the subtree
+@param stack		A stack with room for at least as many frames as the depth of the subtree
+@param transitions	Used to return the first transition in each map
+*/
+void OnionUtil::find_first_transitions_sub(BakedTree::MapMask maps, int maskIndex, const Vector3d& source, const Vector3d& dest,
+										   const BakedTree& tree, int root, TransitionFrame *stack, Transition *transitions)
+{
+	typedef BakedTree::MapMask MapMask;
+
+	MapMask pending = maps;		// the maps whose first transitions haven't yet been found
+	MapMask solidity = 0;		// the solidity of the segment so far in the pending maps
+	bool first = true;			// are we on the first part of the segment?
 
-	Plane_CPtr splitter = branch->splitter();
-	PlaneClassifier cpSource, cpDest;
-	switch(classify_linesegment_against_plane(source, dest, *splitter, cpSource, cpDest))
+	int stackSize = 0;
+	int cur = root;
+	int entryPlane = -1;
+	Vector3d s = source, e = dest;
+
+	while(pending)
 	{
-		case CP_BACK:
+		const BakedTree::Node& node = tree.node(cur);
+		if(node.is_leaf())
 		{
-			return find_first_transition_sub(mapIndex, source, dest, right);
-		}
-		case CP_COPLANAR:
-		{
-			Transition trLeft = find_first_transition_sub(mapIndex, source, dest, left);
-			Transition trRight = find_first_transition_sub(mapIndex, source, dest, right);
-			if(trLeft.classifier == trRight.classifier)
+			MapMask leafSolidity = tree.solidity_mask(node.leafIndex, maskIndex);
+			if(first)
+			{
+				solidity = leafSolidity;
+				first = false;
+			}
+			else
 			{
-				switch(trLeft.classifier)
+				MapMask changed = (leafSolidity ^ solidity) & pending;
+				for(int m=0; changed; ++m, changed >>= 1)
 				{
-					case RAY_EMPTY:
-					case RAY_SOLID:
+					if(changed & 1)
 					{
-						return trLeft;
-					}
-					default:
-					{
-						double dLeft = source.distance_squared(*trLeft.location);
-						double dRight = source.distance_squared(*trRight.location);
-						if(dLeft < dRight) return trLeft;
-						else return trRight;
+						RayClassifier classifier = (solidity >> m) & 1 ? RAY_TRANSITION_SE : RAY_TRANSITION_ES;
+						transitions[m] = Transition(classifier, s, &tree.plane(entryPlane));
+						pending &= ~(MapMask(1) << m);
 					}
 				}
 			}
-			else if(trLeft.classifier == RAY_TRANSITION_ES || trLeft.classifier == RAY_TRANSITION_SE)
-			{
-				return trLeft;
-			}
-			else if(trRight.classifier == RAY_TRANSITION_ES || trRight.classifier == RAY_TRANSITION_SE)
-			{
-				return trRight;
-			}
-			else
-			{
-				return Transition(RAY_EMPTY);
-			}
-		}
-		case CP_FRONT:
-		{
-			return find_first_transition_sub(mapIndex, source, dest, left);
 		}
-		default:	// case CP_STRADDLE
+		else
 		{
-			Vector3d mid = determine_linesegment_intersection_with_plane(source, dest, *splitter).first;
-			OnionNode_CPtr near, far;
-			if(cpSource == CP_FRONT)
-			{
-				near = left;
-				far = right;
-			}
-			else
-			{
-				near = right;
-				far = left;
-			}
-
-			// Search for a transition on the near side of the plane: if we find one, that's the first transition.
-			Transition trNear = find_first_transition_sub(mapIndex, source, mid, near);
-			if(trNear.location) return trNear;
-
-			// Search for a transition on the far side of the plane.
-			Transition trFar = find_first_transition_sub(mapIndex, mid, dest, far);
-
-			switch(trFar.classifier)
+			const Plane& splitter = tree.plane(node.planeIndex);
+			PlaneClassifier cpSource, cpDest;
+			switch(classify_linesegment_against_plane(s, e, splitter, cpSource, cpDest))
 			{
-				case RAY_EMPTY:
+				case CP_BACK:
 				{
-					// If both sides are empty, there's no transition, otherwise there's a solid -> empty transition
-					// at the point where the ray intersects the current split plane.
-					if(trNear.classifier == RAY_EMPTY) return Transition(RAY_EMPTY);
-					else return Transition(RAY_TRANSITION_SE, Vector3d_Ptr(new Vector3d(mid)), splitter);
+					cur = node.right;
+					continue;
 				}
-				case RAY_SOLID:
+				case CP_FRONT:
 				{
-					// If both sides are solid, there's no transition, otherwise there's an empty -> solid transition
-					// at the point where the ray intersects the current split plane.
-					if(trNear.classifier == RAY_EMPTY) return Transition(RAY_TRANSITION_ES, Vector3d_Ptr(new Vector3d(mid)), splitter);
-					else return Transition(RAY_SOLID);
+					cur = node.left;
+					continue;
 				}
-				case RAY_TRANSITION_ES:
+				case CP_STRADDLE:
 				{
-					// If the near side is empty, the first transition is the empty -> solid one on the far side.
-					// Otherwise, there's a nearer solid -> empty transition on the current split plane.
-					if(trNear.classifier == RAY_EMPTY) return trFar;
-					else return Transition(RAY_TRANSITION_SE, Vector3d_Ptr(new Vector3d(mid)), splitter);
+					Vector3d mid = determine_linesegment_intersection_with_plane(s, e, splitter).first;
+
+					TransitionFrame& frame = stack[stackSize++];
+					frame.node = cpSource == CP_FRONT ? node.right : node.left;
+					frame.entryPlane = node.planeIndex;
+					frame.s[0] = mid.x;	frame.s[1] = mid.y;	frame.s[2] = mid.z;
+					frame.e[0] = e.x;	frame.e[1] = e.y;	frame.e[2] = e.z;
+
+					cur = cpSource == CP_FRONT ? node.left : node.right;
+					e = mid;
+					continue;
 				}
-				default:	// case RAY_TRANSITION_SE
+				default:	// case CP_COPLANAR
 				{
-					// If the near side is solid, the first transition is the solid -> empty one on the far side.
-					// Otherwise, there's a nearer empty -> solid transition on the current split plane.
-					if(trNear.classifier == RAY_SOLID) return trFar;
-					else return Transition(RAY_TRANSITION_ES, Vector3d_Ptr(new Vector3d(mid)), splitter);
+					// Walk the segment through both subtrees, and combine the results for each map.
+					Transition trLefts[BakedTree::MAPS_PER_MASK], trRights[BakedTree::MAPS_PER_MASK];
+					find_first_transitions_sub(pending, maskIndex, s, e, tree, node.left, stack + stackSize, trLefts);
+					find_first_transitions_sub(pending, maskIndex, s, e, tree, node.right, stack + stackSize, trRights);
+
+					MapMask remaining = pending;
+					for(int m=0; remaining; ++m, remaining >>= 1)
+					{
+						if(!(remaining & 1)) continue;
+
+						const Transition& trLeft = trLefts[m];
+						const Transition& trRight = trRights[m];
+						Transition tr;
+						if(trLeft.classifier == trRight.classifier)
+						{
+							// If both subtrees have the same kind of transition, the nearer one is the first.
+							if(trLeft.location && s.distance_squared(*trLeft.location) >= s.distance_squared(*trRight.location)) tr = trRight;
+							else tr = trLeft;
+						}
+						else if(trLeft.location) tr = trLeft;
+						else if(trRight.location) tr = trRight;
+						else tr = Transition(RAY_EMPTY);
+
+						MapMask bit = MapMask(1) << m;
+						if(first)
+						{
+							if(tr.classifier == RAY_SOLID) solidity |= bit;
+							else if(tr.location)
+							{
+								transitions[m] = tr;
+								pending &= ~bit;
+							}
+						}
+						else if(is_solid_initially(tr) != ((solidity & bit) != 0))
+						{
+							RayClassifier classifier = solidity & bit ? RAY_TRANSITION_SE : RAY_TRANSITION_ES;
+							transitions[m] = Transition(classifier, s, &tree.plane(entryPlane));
+							pending &= ~bit;
+						}
+						else if(tr.location)
+						{
+							transitions[m] = tr;
+							pending &= ~bit;
+						}
+					}
+					first = false;
+					break;
 				}
 			}
 		}
+
+		// Move on to the next part of the segment (if any).
+		if(stackSize == 0) break;
+		const TransitionFrame& frame = stack[--stackSize];
+		cur = frame.node;
+		entryPlane = frame.entryPlane;
+		s = Vector3d(frame.s[0], frame.s[1], frame.s[2]);
+		e = Vector3d(frame.e[0], frame.e[1], frame.e[2]);
+	}
+
+	// Any maps whose transitions weren't found are either entirely empty or entirely solid along the segment.
+	for(int m=0; pending; ++m, pending >>= 1)
+	{
+		if(pending & 1) transitions[m] = Transition((solidity >> m) & 1 ? RAY_SOLID : RAY_EMPTY);
 	}
 }
 
+/**
+Returns whether or not the ray for which a transition was found starts in solid space.
+*/
+bool OnionUtil::is_solid_initially(const Transition& transition)
+{
+	return transition.classifier == RAY_SOLID || transition.classifier == RAY_TRANSITION_SE;
+}
+
 }
@@ -6,14 +6,15 @@
 #ifndef H_HESP_ONIONUTIL
 #define H_HESP_ONIONUTIL
 
+#include <boost/optional.hpp>
+
 #include <hesp/math/vectors/Vector3.h>
+#include "BakedTree.h"
 
 namespace hesp {
 
 //#################### FORWARD DECLARATIONS ####################
-typedef shared_ptr<const class OnionNode> OnionNode_CPtr;
 typedef shared_ptr<const class OnionTree> OnionTree_CPtr;
-typedef shared_ptr<const class Plane> Plane_CPtr;
 
 class OnionUtil
 {
@@ -29,13 +30,17 @@ public:
 
 	//#################### NESTED CLASSES ####################
 public:
+	/**
+	The first transition of a ray in a map. The location and plane are only set if there is a
+	transition. The plane belongs to the (baked) tree, so it's only valid as long as the tree is.
+	*/
 	struct Transition
 	{
 		RayClassifier classifier;
-		Vector3d_Ptr location;
-		Plane_CPtr plane;
+		boost::optional<Vector3d> location;
+		const Plane *plane;
 
-		explicit Transition(RayClassifier classifier_, const Vector3d_Ptr& location_ = Vector3d_Ptr(), const Plane_CPtr& plane_ = Plane_CPtr())
+		explicit Transition(RayClassifier classifier_ = RAY_EMPTY, const boost::optional<Vector3d>& location_ = boost::none, const Plane *plane_ = NULL)
 		:	classifier(classifier_), location(location_), plane(plane_)
 		{}
 	};
@@ -43,13 +48,33 @@ public:
 	typedef shared_ptr<Transition> Transition_Ptr;
 	typedef shared_ptr<const Transition> Transition_CPtr;
 
+private:
+	/**
+	A part of the segment which remains to be walked. The endpoints are stored as plain doubles
+	so that the stack can be allocated without constructing all of its frames.
+	*/
+	struct TransitionFrame
+	{
+		int node;
+		int entryPlane;		// the index of the plane on which the segment starts
+		double s[3], e[3];
+	};
+
+	//#################### CONSTANTS ####################
+private:
+	enum { INLINE_STACK_SIZE = 64 };
+
 	//#################### PUBLIC METHODS ####################
 public:
 	static Transition find_first_transition(int mapIndex, const Vector3d& source, const Vector3d& dest, const OnionTree_CPtr& tree);
+	static Transition find_first_transition(int mapIndex, const Vector3d& source, const Vector3d& dest, const BakedTree& tree);
+	static void find_first_transitions(BakedTree::MapMask maps, const Vector3d& source, const Vector3d& dest, const OnionTree_CPtr& tree, Transition *transitions, int maskIndex = 0);
+	static void find_first_transitions(BakedTree::MapMask maps, const Vector3d& source, const Vector3d& dest, const BakedTree& tree, Transition *transitions, int maskIndex = 0);
 
 	//#################### PRIVATE METHODS ####################
 private:
-	static Transition find_first_transition_sub(int mapIndex, const Vector3d& source, const Vector3d& dest, const OnionNode_CPtr& node);
+	static void find_first_transitions_sub(BakedTree::MapMask maps, int maskIndex, const Vector3d& source, const Vector3d& dest, const BakedTree& tree, int root, TransitionFrame *stack, Transition *transitions);
+	static bool is_solid_initially(const Transition& transition);
 };
 
 }
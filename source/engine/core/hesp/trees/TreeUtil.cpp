@@ -0,0 +1,42 @@
+/***
+ * hesperus: TreeUtil.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "TreeUtil.h"
+
+namespace hesp {
+
+//#################### PUBLIC METHODS ####################
+/**
+Finds the index of the leaf in the specified baked tree in which the specified point resides.
+
+@param p		The point
+@param tree		The baked tree
+@return			The leaf index
+*/
+int TreeUtil::find_leaf_index(const Vector3d& p, const BakedTree& tree)
+{
+	int cur = tree.root_index();
+	for(;;)
+	{
+		const BakedTree::Node& node = tree.node(cur);
+		if(node.is_leaf()) return node.leafIndex;
+
+		switch(classify_point_against_plane(p, tree.plane(node.planeIndex)))
+		{
+			case CP_BACK:
+			{
+				cur = node.right;
+				break;
+			}
+			default:	// CP_COPLANAR or CP_FRONT
+			{
+				cur = node.left;
+				break;
+			}
+		}
+	}
+}
+
+}
@@ -16,12 +16,16 @@ using boost::shared_ptr;
 
 namespace hesp {
 
+//#################### FORWARD DECLARATIONS ####################
+class BakedTree;
+
 class TreeUtil
 {
 	//#################### PUBLIC METHODS ####################
 public:
 	template <typename Tree> static int find_leaf_index(const Vector3d& p, shared_ptr<Tree> tree);
 	template <typename Tree> static int find_leaf_index(const Vector3d& p, shared_ptr<const Tree> tree);
+	static int find_leaf_index(const Vector3d& p, const BakedTree& tree);
 	template <typename Tree> static std::list<Plane_CPtr> split_planes(shared_ptr<Tree> tree);
 	template <typename Tree> static std::list<Plane_CPtr> split_planes(shared_ptr<const Tree> tree);
 
@@ -4,6 +4,7 @@
  ***/
 
 #include <hesp/math/geom/GeomUtil.h>
+#include "BakedTree.h"
 
 namespace hesp {
 
@@ -20,6 +21,7 @@ int TreeUtil::find_leaf_index(const Vector3d& p, shared_ptr<Tree> tree)
 
 /**
 Finds the index of the leaf in the specified tree in which the specified point resides.
+The search is run on the tree's baked copy.
 
 @param p		The point
 @param tree		The tree
@@ -28,31 +30,7 @@ Finds the index of the leaf in the specified tree in which the specified point r
 template <typename Tree>
 int TreeUtil::find_leaf_index(const Vector3d& p, shared_ptr<const Tree> tree)
 {
-	typedef typename Tree::Branch Branch;
-	typedef typename Tree::Leaf Leaf;
-	typedef typename Tree::Node Node;
-
-	shared_ptr<const Node> cur = tree->root();
-	while(!cur->is_leaf())
-	{
-		const Branch *branch = cur->as_branch();
-		switch(classify_point_against_plane(p, *branch->splitter()))
-		{
-			case CP_BACK:
-			{
-				cur = branch->right();
-				break;
-			}
-			default:	// CP_COPLANAR or CP_FRONT
-			{
-				cur = branch->left();
-				break;
-			}
-		}
-	}
-
-	const Leaf *leaf = cur->as_leaf();
-	return leaf->leaf_index();
+	return find_leaf_index(p, *tree->baked_tree());
 }
 
 /**
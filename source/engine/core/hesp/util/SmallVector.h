@@ -0,0 +1,76 @@
+/***
+ * hesperus: SmallVector.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_SMALLVECTOR
+#define H_HESP_SMALLVECTOR
+
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+namespace hesp {
+
+/**
+This class template is a vector which stores up to N elements inline (i.e. within the object itself),
+and only allocates memory on the heap if it grows beyond that. It's intended for small collections
+which are created and destroyed in large numbers (e.g. the vertices of polygons), for which the cost
+of a heap allocation per collection would otherwise dominate.
+*/
+template <typename T, int N>
+class SmallVector
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	typename boost::aligned_storage<N * sizeof(T), boost::alignment_of<T>::value>::type m_inlineStorage;
+	T *m_data;				// points to the inline storage, or to a heap block if the vector has outgrown it
+	int m_size;
+	int m_capacity;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	SmallVector();
+	SmallVector(const SmallVector& rhs);
+	template <typename InputIterator> SmallVector(InputIterator first, InputIterator last);
+
+	//#################### DESTRUCTOR ####################
+public:
+	~SmallVector();
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	SmallVector& operator=(const SmallVector& rhs);
+	T& operator[](int i)				{ return m_data[i]; }
+	const T& operator[](int i) const	{ return m_data[i]; }
+
+	//#################### PUBLIC METHODS ####################
+public:
+	T& back()							{ return m_data[m_size-1]; }
+	const T& back() const				{ return m_data[m_size-1]; }
+	iterator begin()					{ return m_data; }
+	const_iterator begin() const		{ return m_data; }
+	void clear();
+	bool empty() const					{ return m_size == 0; }
+	iterator end()						{ return m_data + m_size; }
+	const_iterator end() const			{ return m_data + m_size; }
+	void pop_back();
+	void push_back(const T& t);
+	void reserve(int capacity);
+	int size() const					{ return m_size; }
+
+	//#################### PRIVATE METHODS ####################
+private:
+	T *inline_data()					{ return reinterpret_cast<T*>(&m_inlineStorage); }
+};
+
+}
+
+#include "SmallVector.tpp"
+
+#endif
@@ -0,0 +1,113 @@
+/***
+ * hesperus: SmallVector.tpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <new>
+
+#define SmallVector_HEADER	template <typename T, int N>
+#define SmallVector_THIS	SmallVector<T,N>
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+SmallVector_HEADER
+SmallVector_THIS::SmallVector()
+:	m_data(inline_data()), m_size(0), m_capacity(N)
+{}
+
+SmallVector_HEADER
+SmallVector_THIS::SmallVector(const SmallVector& rhs)
+:	m_data(inline_data()), m_size(0), m_capacity(N)
+{
+	reserve(rhs.m_size);
+	for(int i=0; i<rhs.m_size; ++i) push_back(rhs.m_data[i]);
+}
+
+SmallVector_HEADER
+template <typename InputIterator>
+SmallVector_THIS::SmallVector(InputIterator first, InputIterator last)
+:	m_data(inline_data()), m_size(0), m_capacity(N)
+{
+	for(; first!=last; ++first) push_back(*first);
+}
+
+//#################### DESTRUCTOR ####################
+SmallVector_HEADER
+SmallVector_THIS::~SmallVector()
+{
+	clear();
+	if(m_data != inline_data()) ::operator delete(m_data);
+}
+
+//#################### PUBLIC OPERATORS ####################
+SmallVector_HEADER
+SmallVector_THIS& SmallVector_THIS::operator=(const SmallVector& rhs)
+{
+	if(&rhs != this)
+	{
+		clear();
+		reserve(rhs.m_size);
+		for(int i=0; i<rhs.m_size; ++i) push_back(rhs.m_data[i]);
+	}
+	return *this;
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Destroys all the elements in the vector. Note that any heap storage is kept for reuse.
+*/
+SmallVector_HEADER
+void SmallVector_THIS::clear()
+{
+	for(int i=0; i<m_size; ++i) m_data[i].~T();
+	m_size = 0;
+}
+
+SmallVector_HEADER
+void SmallVector_THIS::pop_back()
+{
+	m_data[--m_size].~T();
+}
+
+SmallVector_HEADER
+void SmallVector_THIS::push_back(const T& t)
+{
+	if(m_size == m_capacity)
+	{
+		// Note:	The element is copied before growing the storage, in case it's one of our own elements.
+		T copy(t);
+		reserve(m_capacity * 2);
+		new (m_data + m_size) T(copy);
+	}
+	else new (m_data + m_size) T(t);
+	++m_size;
+}
+
+/**
+Ensures that the vector has room for at least the specified number of elements
+(moving its elements to the heap if the inline storage isn't big enough).
+
+@param capacity	The number of elements for which the vector should have room
+*/
+SmallVector_HEADER
+void SmallVector_THIS::reserve(int capacity)
+{
+	if(capacity <= m_capacity) return;
+
+	T *data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+	for(int i=0; i<m_size; ++i)
+	{
+		new (data + i) T(m_data[i]);
+		m_data[i].~T();
+	}
+
+	if(m_data != inline_data()) ::operator delete(m_data);
+	m_data = data;
+	m_capacity = capacity;
+}
+
+}
+
+#undef SmallVector_THIS
+#undef SmallVector_HEADER
@@ -0,0 +1,127 @@
+/***
+ * hesperus: WorkerPool.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "WorkerPool.h"
+
+#include <exception>
+
+#include <boost/bind.hpp>
+
+#include <hesp/exceptions/Exception.h>
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs a worker pool and starts its worker threads.
+
+@param workerCount	The number of worker threads (in addition to the thread calling run())
+*/
+WorkerPool::WorkerPool(int workerCount)
+:	m_workerCount(workerCount), m_busyCount(0), m_generation(0), m_stopping(false)
+{
+	for(int i=0; i<workerCount; ++i)
+	{
+		m_threads.create_thread(boost::bind(&WorkerPool::worker_loop, this));
+	}
+}
+
+//#################### DESTRUCTOR ####################
+WorkerPool::~WorkerPool()
+{
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_stopping = true;
+	}
+	m_taskAvailable.notify_all();
+	m_threads.join_all();
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Runs the specified task on each of the worker threads and on the calling thread, and waits
+for all of them to finish. The task is responsible for sharing out the work between the threads
+running it (e.g. by having each of them repeatedly take the next item from a shared queue).
+The workers are always waited for, even if the task fails, since the task may refer to data
+owned by the caller.
+
+@param task			The task
+@throws Exception	If the task fails on any of the threads (the calling thread's error takes precedence)
+*/
+void WorkerPool::run(const Task& task)
+{
+	if(m_workerCount > 0)
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_task = task;
+		m_busyCount = m_workerCount;
+		m_error.clear();
+		++m_generation;
+		m_taskAvailable.notify_all();
+	}
+
+	// This thread acts as one of the workers.
+	std::string error = run_task(task);
+
+	if(m_workerCount > 0)
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		while(m_busyCount > 0) m_taskFinished.wait(lock);
+		m_task.clear();
+		if(error.empty()) error = m_error;
+		m_error.clear();
+	}
+
+	if(!error.empty()) throw Exception(error);
+}
+
+int WorkerPool::worker_count() const
+{
+	return m_workerCount;
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Runs the specified task, catching anything it throws (an exception which escaped a worker
+thread's function would terminate the program).
+
+@param task	The task
+@return		A description of the error raised by the task, or the empty string if it succeeded
+*/
+std::string WorkerPool::run_task(const Task& task)
+try
+{
+	task();
+	return "";
+}
+catch(Exception& e)			{ return e.cause(); }
+catch(std::exception& e)	{ return std::string("Error in a worker pool task: ") + e.what(); }
+catch(...)					{ return "Unknown error in a worker pool task"; }
+
+void WorkerPool::worker_loop()
+{
+	int lastGeneration = 0;
+	for(;;)
+	{
+		Task task;
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			while(!m_stopping && m_generation == lastGeneration) m_taskAvailable.wait(lock);
+			if(m_stopping) return;
+			lastGeneration = m_generation;
+			task = m_task;
+		}
+
+		std::string error = run_task(task);
+
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			if(m_error.empty()) m_error = error;
+			if(--m_busyCount == 0) m_taskFinished.notify_one();
+		}
+	}
+}
+
+}
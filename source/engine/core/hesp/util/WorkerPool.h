@@ -0,0 +1,69 @@
+/***
+ * hesperus: WorkerPool.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HESP_WORKERPOOL
+#define H_HESP_WORKERPOOL
+
+#include <string>
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace hesp {
+
+/**
+This class manages a fixed set of worker threads which persist for the lifetime of the pool,
+so that work can be shared out between several threads repeatedly (e.g. once per frame)
+without the cost of creating and joining new threads each time.
+*/
+class WorkerPool
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef boost::function<void()> Task;
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	boost::thread_group m_threads;
+	int m_workerCount;
+
+	boost::mutex m_mutex;						// protects the variables below
+	boost::condition_variable m_taskAvailable;
+	boost::condition_variable m_taskFinished;
+	int m_busyCount;							// the number of workers which have yet to finish the current task
+	std::string m_error;						// the first error raised by a worker during the current task (if any)
+	int m_generation;							// incremented each time a new task is started
+	bool m_stopping;
+	Task m_task;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit WorkerPool(int workerCount);
+
+	//#################### DESTRUCTOR ####################
+public:
+	~WorkerPool();
+
+	//#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void run(const Task& task);
+	int worker_count() const;
+
+	//#################### PRIVATE METHODS ####################
+private:
+	static std::string run_task(const Task& task);
+	void worker_loop();
+};
+
+}
+
+#endif
@@ -8,6 +8,8 @@
 
 #include <vector>
 
+#include <boost/optional.hpp>
+
 #include <hesp/math/geom/Plane.h>
 #include <hesp/math/vectors/Vector3.h>
 #include <hesp/portals/Portal.h>
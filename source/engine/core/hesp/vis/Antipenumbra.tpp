@@ -19,10 +19,14 @@ Antipenumbra::clip(const shared_ptr<Polygon<Vert,AuxData> >& poly)
 	typedef Polygon<Vert,AuxData> Poly;
 	typedef shared_ptr<Poly> Poly_Ptr;
 
-	Poly_Ptr ret = poly;
+	// Note:	The polygon is only copied once a plane actually clips it, and is clipped by value from then on,
+	//			so that only the final result (if any) needs to be allocated on the heap.
+	const Poly *current = poly.get();
+	boost::optional<Poly> clippedPoly;
+	typename Poly::VertexList frontVerts;
 	for(std::vector<Plane>::const_iterator it=m_planes.begin(), iend=m_planes.end(); it!=iend; ++it)
 	{
-		switch(classify_polygon_against_plane(*ret, *it))
+		switch(clip_polygon_to_plane(*current, *it, frontVerts))
 		{
 			case CP_BACK:
 			{
@@ -41,14 +45,15 @@ Antipenumbra::clip(const shared_ptr<Polygon<Vert,AuxData> >& poly)
 			}
 			case CP_STRADDLE:
 			{
-				// Split the polygon across the clip plane and keep the bit inside the antipenumbra.
-				ret = split_polygon(*ret, *it).front;
+				// Keep the bit of the polygon inside the antipenumbra.
+				clippedPoly = Poly(frontVerts, current->auxiliary_data());
+				current = &*clippedPoly;
 				break;
 			}
 		}
 	}
 
-	return ret;
+	return clippedPoly ? Poly_Ptr(new Poly(*clippedPoly)) : poly;
 }
 
 }
@@ -5,16 +5,20 @@
 
 #include "VisCalculator.h"
 
+#include <algorithm>
 #include <stack>
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <hesp/math/geom/GeomUtil.h>
 #include "Antipenumbra.h"
 
 namespace hesp {
 
 //#################### CONSTRUCTORS ####################
-VisCalculator::VisCalculator(int emptyLeafCount, const std::vector<Portal_Ptr>& portals)
-:	m_emptyLeafCount(emptyLeafCount), m_portals(portals)
+VisCalculator::VisCalculator(int emptyLeafCount, const std::vector<Portal_Ptr>& portals, int threadCount)
+:	m_emptyLeafCount(emptyLeafCount), m_portals(portals), m_threadCount(std::max(threadCount, 1)), m_nextPortal(0)
 {
 	// Fill in the portal indices: these will be needed later.
 	int portalCount = static_cast<int>(m_portals.size());
@@ -53,6 +57,10 @@ out of a given leaf.
 */
 void VisCalculator::build_portals_from_leaf_lookup()
 {
+	// Note:	Every leaf gets an entry (even if no portals lead out of it), so that the lookup
+	//			can be read concurrently during the full portal vis phase without being modified.
+	m_portalsFromLeaf.resize(m_emptyLeafCount);
+
 	int portalCount = static_cast<int>(m_portals.size());
 	for(int i=0; i<portalCount; ++i)
 	{
@@ -63,16 +71,24 @@ void VisCalculator::build_portals_from_leaf_lookup()
 
 /**
 Calculates the set of portals that are potentially visible from
-the specified portal, and updates the portal visibility table
-accordingly.
+the specified portal, and writes it into the corresponding row of
+the full portal visibility table.
+
+Note:	Only the original source's row of the full table is written here,
+		so that several portals' PVSs can safely be calculated at the same
+		time. Other portals' rows are only read once they've been finished
+		(see may_see), so the result is the same however many threads are used.
 
 @param originalSource	The portal for which to calculate the PVS
 */
 void VisCalculator::calculate_portal_pvs(const Portal_Ptr& originalSource)
 {
 	int originalSourceIndex = portal_index(originalSource);
+	int originalSourcePosition = m_portalPositions[originalSourceIndex];
 	Plane originalSourcePlane = make_plane(*originalSource);
 
+	std::vector<bool> finishedRowsSeen(m_portals.size(), false);
+
 	std::stack<PortalTriple> st;
 
 	// Initialise the stack with triples targeting all the portals that can be
@@ -83,14 +99,14 @@ void VisCalculator::calculate_portal_pvs(const Portal_Ptr& originalSource)
 	{
 		Portal_Ptr target = m_portals[originalCandidates[i]];
 		int targetIndex = originalCandidates[i];
-		if((*m_portalVis)(originalSourceIndex, targetIndex) != PV_NO)
+		if((*m_portalVis)(originalSourceIndex, targetIndex))
 		{
-			if((*m_classifiers)(originalSourceIndex, targetIndex) == CP_STRADDLE)
+			if((*m_straddles)(originalSourceIndex, targetIndex))
 			{
 				target = split_polygon(*target, originalSourcePlane).front;
 			}
 			st.push(PortalTriple(originalSource, Portal_Ptr(), target));
-			(*m_portalVis)(originalSourceIndex, targetIndex) = PV_YES;
+			m_fullPortalVis->set(originalSourceIndex, targetIndex);
 		}
 	}
 
@@ -112,8 +128,8 @@ void VisCalculator::calculate_portal_pvs(const Portal_Ptr& originalSource)
 
 			// If this generator portal might be visible from both the intermediate portal
 			// (if it exists) and the target portal, then we need to clip it to find out.
-			if((!inter || (*m_portalVis)(portal_index(inter), generatorIndex) != PV_NO) &&
-			   ((*m_portalVis)(targetIndex, generatorIndex) != PV_NO))
+			if((!inter || may_see(portal_index(inter), generatorIndex, originalSourcePosition, finishedRowsSeen)) &&
+			   may_see(targetIndex, generatorIndex, originalSourcePosition, finishedRowsSeen))
 			{
 				Portal_Ptr clippedGen = ap.clip(generator);
 				if(clippedGen)
@@ -123,20 +139,15 @@ void VisCalculator::calculate_portal_pvs(const Portal_Ptr& originalSource)
 					if(clippedSrc)
 					{
 						st.push(PortalTriple(clippedSrc, target, clippedGen));
-						(*m_portalVis)(originalSourceIndex, generatorIndex) = PV_YES;
+						m_fullPortalVis->set(originalSourceIndex, generatorIndex);
 					}
 				}
 			}
 		}
 	}
 
-	// Any portals which haven't been definitely marked as potentially visible at this point can't be seen.
-	int portalCount = static_cast<int>(m_portals.size());
-	for(int i=0; i<portalCount; ++i)
-	{
-		if((*m_portalVis)(originalSourceIndex,i) != PV_YES)
-			(*m_portalVis)(originalSourceIndex,i) = PV_NO;
-	}
+	// Note:	Any portals which haven't been definitely marked as potentially visible at this point can't be seen,
+	//			but there's no need to mark them explicitly, because the full table was initialised to false.
 }
 
 /**
@@ -145,8 +156,8 @@ Clears all the intermediate data structures used during the calculation process.
 void VisCalculator::clean_intermediate()
 {
 	m_portalsFromLeaf.clear();
-	m_classifiers.reset();
 	m_portalVis.reset();
+	m_straddles.reset();
 }
 
 /**
@@ -160,15 +171,12 @@ void VisCalculator::flood_fill()
 	int portalCount = static_cast<int>(m_portals.size());
 	for(int i=0; i<portalCount; ++i)
 	{
-		flood_from(i);
+		PortalVisTable reached(1, portalCount, false);
+		flood_from(i, reached);
 
-		// If any portals previously thought possible didn't get marked by the flood fill,
+		// If any portals previously thought possible didn't get reached by the flood fill,
 		// then they're not actually possible and need to be marked as such.
-		for(int j=0; j<portalCount; ++j)
-		{
-			if((*m_portalVis)(i,j) == PV_INITIALMAYBE)
-				(*m_portalVis)(i,j) = PV_NO;
-		}
+		m_portalVis->and_row(i, reached, 0);
 	}
 }
 
@@ -177,8 +185,9 @@ Peforms a flood fill from a given portal to refine its approximate
 PVS before it is calculated for real.
 
 @param originalSource	The portal from which to flood fill
+@param reached			A single-row table in which to mark the portals reached by the flood fill
 */
-void VisCalculator::flood_from(int originalSource)
+void VisCalculator::flood_from(int originalSource, PortalVisTable& reached)
 {
 	std::stack<int> st;
 	st.push(originalSource);
@@ -188,15 +197,16 @@ void VisCalculator::flood_from(int originalSource)
 		int curPortal = st.top();
 		st.pop();
 
-		if(curPortal != originalSource)
-			(*m_portalVis)(originalSource, curPortal) = PV_FLOODFILLMAYBE;
-
 		int leaf = m_portals[curPortal]->auxiliary_data().toLeaf;
 		const std::vector<int>& candidates = m_portalsFromLeaf[leaf];
 		for(size_t i=0, size=candidates.size(); i<size; ++i)
 		{
-			if((*m_portalVis)(originalSource, candidates[i]) == PV_INITIALMAYBE)
-				st.push(candidates[i]);
+			int candidate = candidates[i];
+			if((*m_portalVis)(originalSource, candidate) && !reached(0, candidate))
+			{
+				reached.set(0, candidate);
+				st.push(candidate);
+			}
 		}
 	}
 }
@@ -207,14 +217,66 @@ in which the real PVS is calculated for each portal.
 */
 void VisCalculator::full_portal_vis()
 {
-	// FIXME:	We should process the portals in ascending order of the
-	//			number of other portals they can potentially see: this
-	//			will speed the whole thing up.
-
 	int portalCount = static_cast<int>(m_portals.size());
+
+	// Sort the portals into ascending order of the number of other portals they can potentially see
+	// after the flood fill (ties are broken by portal index, to keep the order deterministic). The
+	// cheap portals at the front of the order then finish early, and their rows of the full table
+	// can be used to prune the calculations for the more expensive portals later on.
+	std::vector<std::pair<int,int> > maybeCounts(portalCount);
 	for(int i=0; i<portalCount; ++i)
 	{
-		calculate_portal_pvs(m_portals[i]);
+		maybeCounts[i] = std::make_pair(m_portalVis->count_row(i), i);
+	}
+	std::sort(maybeCounts.begin(), maybeCounts.end());
+
+	m_portalOrder.resize(portalCount);
+	m_portalPositions.resize(portalCount);
+	for(int i=0; i<portalCount; ++i)
+	{
+		m_portalOrder[i] = maybeCounts[i].second;
+		m_portalPositions[m_portalOrder[i]] = i;
+	}
+	m_portalFinished.assign(portalCount, false);
+	m_nextPortal = 0;
+
+	// Calculate the real PVS for each portal, running several workers at once if desired. Each
+	// worker only ever writes to the rows of the full table for the portals it processes.
+	m_fullPortalVis.reset(new PortalVisTable(portalCount, false));
+
+	if(m_threadCount == 1)
+	{
+		full_portal_vis_worker();
+	}
+	else
+	{
+		boost::thread_group workers;
+		for(int i=0; i<m_threadCount; ++i)
+		{
+			workers.create_thread(boost::bind(&VisCalculator::full_portal_vis_worker, this));
+		}
+		workers.join_all();
+	}
+
+	m_portalVis = m_fullPortalVis;
+	m_fullPortalVis.reset();
+	m_portalOrder.clear();
+	m_portalPositions.clear();
+	m_portalFinished.clear();
+}
+
+/**
+Repeatedly takes the next unprocessed portal from the work queue and calculates
+its PVS, until there are no portals left. This is run by each worker thread during
+the full portal vis phase (or directly, if only one thread is being used).
+*/
+void VisCalculator::full_portal_vis_worker()
+{
+	int portal;
+	while((portal = next_portal_to_process()) != -1)
+	{
+		calculate_portal_pvs(m_portals[portal]);
+		mark_portal_finished(portal);
 	}
 }
 
@@ -227,50 +289,94 @@ table. This helps avoid a lot of unnecessary clipping later on.
 void VisCalculator::initial_portal_vis()
 {
 	int portalCount = static_cast<int>(m_portals.size());
-	m_portalVis.reset(new PortalVisTable(portalCount, PV_INITIALMAYBE));
+	m_portalVis.reset(new PortalVisTable(portalCount, true));
+	m_straddles.reset(new PortalVisTable(portalCount, false));
 
-	// Calculate the classification relation between the portals. Specifically,
-	// classifiers(i,j) will contain the classification of polygon j relative
-	// to the plane of i.
+	// Classify each portal j against the plane of each other portal i, and use the results to
+	// mark (*m_portalVis)(i,j) as false if portal i definitely can't see through portal j. We
+	// also record which portals straddle which portal planes, since that's needed later on.
 
 	// Note:	This bit could potentially be optimized if we required that portal pairs
 	//			occupied consecutive indices in the list (e.g. if 1 were necessarily the
 	//			reverse portal of 0, etc.).
-	m_classifiers.reset(new ClassifierTable(portalCount));
 	for(int i=0; i<portalCount; ++i)
 	{
+		m_portalVis->set(i, i, false);
+
 		const Plane plane = make_plane(*m_portals[i]);
 		for(int j=0; j<portalCount; ++j)
 		{
-			if(j == i) (*m_classifiers)(i,j) = CP_COPLANAR;
-			else (*m_classifiers)(i,j) = classify_polygon_against_plane(*m_portals[j], plane);
-		}
-	}
+			if(j == i) continue;
 
-	// Run through the portal visibility table and mark (*m_portalVis)(i,j) as PV_NO
-	// if portal i definitely can't see through portal j.
-	for(int i=0; i<portalCount; ++i)
-	{
-		for(int j=0; j<portalCount; ++j)
-		{
-			if(j == i)
+			// Note: Portals can only see through the back of other portals.
+			switch(classify_polygon_against_plane(*m_portals[j], plane))
 			{
-				(*m_portalVis)(i,j) = PV_NO;
-				continue;
+				case CP_BACK:
+				case CP_COPLANAR:
+				{
+					// If portal j is behind or on the plane of portal i, then i can't see it.
+					m_portalVis->set(i, j, false);
+					break;
+				}
+				case CP_FRONT:
+				{
+					// If portal j is completely in front of portal i, then portal i is
+					// facing it and j can't see through i.
+					m_portalVis->set(j, i, false);
+					break;
+				}
+				case CP_STRADDLE:
+				{
+					m_straddles->set(i, j);
+					break;
+				}
 			}
+		}
+	}
+}
 
-			// Note: Portals can only see through the back of other portals.
+/**
+Marks the specified portal's row of the full portal visibility table as finished,
+and wakes up any workers which are waiting to use it.
 
-			// If portal j is behind or on the plane of portal i, then i can't see it.
-			if((*m_classifiers)(i,j) == CP_BACK || (*m_classifiers)(i,j) == CP_COPLANAR)
-				(*m_portalVis)(i,j) = PV_NO;
+@param portal	The index of the portal
+*/
+void VisCalculator::mark_portal_finished(int portal)
+{
+	boost::mutex::scoped_lock lock(m_portalOrderMutex);
+	m_portalFinished[portal] = true;
+	m_portalFinishedCondition.notify_all();
+}
 
-			// If portal i is completely in front of portal j, then it's facing i
-			// and i can't see through it.
-			if((*m_classifiers)(j,i) == CP_FRONT)
-				(*m_portalVis)(i,j) = PV_NO;
-		}
+/**
+Determines whether portal i may be able to see portal j, for the purposes of calculating
+the PVS of the portal at the specified position in the processing order.
+
+If portal i comes earlier in the order, its row of the full table is used (waiting for it
+to be finished if necessary), since it's much tighter than the flood-filled one. Otherwise,
+the flood-filled table is used. This is exactly what a single thread would see, since it
+would already have finished all the earlier portals and none of the later ones.
+
+Note:	A worker never waits for a portal later than the one it's processing, and the
+		portals are handed out in order, so every portal being waited for is either
+		finished or being processed by a worker which can make progress.
+
+@param i					The index of portal i
+@param j					The index of portal j
+@param sourcePosition		The position of the portal whose PVS is being calculated
+@param finishedRowsSeen		The portals whose rows are already known to be finished (updated as necessary)
+@return						true, if portal i may be able to see portal j, or false otherwise
+*/
+bool VisCalculator::may_see(int i, int j, int sourcePosition, std::vector<bool>& finishedRowsSeen)
+{
+	if(m_portalPositions[i] >= sourcePosition) return (*m_portalVis)(i,j);
+
+	if(!finishedRowsSeen[i])
+	{
+		wait_for_portal(i);
+		finishedRowsSeen[i] = true;
 	}
+	return (*m_fullPortalVis)(i,j);
 }
 
 /**
@@ -284,6 +390,20 @@ int VisCalculator::neighbour_leaf(const Portal_Ptr& portal) const
 	return portal->auxiliary_data().toLeaf;
 }
 
+/**
+Takes the next portal to process off the front of the work queue for the full portal
+vis phase, i.e. in ascending order of the number of other portals they can potentially
+see after the flood fill.
+
+@return	The index of the next portal to process, or -1 if there are none left
+*/
+int VisCalculator::next_portal_to_process()
+{
+	boost::mutex::scoped_lock lock(m_portalOrderMutex);
+	if(m_nextPortal == static_cast<int>(m_portalOrder.size())) return -1;
+	return m_portalOrder[m_nextPortal++];
+}
+
 /**
 Returns the index of the specified portal.
 
@@ -306,31 +426,43 @@ void VisCalculator::portal_to_leaf_vis()
 {
 	const int portalCount = static_cast<int>(m_portals.size());
 
-	m_leafVis.reset(new LeafVisTable(m_emptyLeafCount, LEAFVIS_NO));
+	// Work out which leaves can be seen through each portal: this is the leaf the portal
+	// points to (even though the portal can't see itself), plus all the leaves pointed to
+	// by the portals it can see.
+	PortalVisTable portalLeafVis(portalCount, m_emptyLeafCount, false);
+	for(int j=0; j<portalCount; ++j)
+	{
+		portalLeafVis.set(j, neighbour_leaf(m_portals[j]));
+		for(int k=m_portalVis->next_set_column(j,0); k!=-1; k=m_portalVis->next_set_column(j,k+1))
+		{
+			portalLeafVis.set(j, neighbour_leaf(m_portals[k]));
+		}
+	}
+
+	m_leafVis.reset(new LeafVisTable(m_emptyLeafCount, false));
 
 	for(int i=0; i<m_emptyLeafCount; ++i)
 	{
-		// Leaf i can see itself, plus the union of whatever leaves its portals can see.
-		(*m_leafVis)(i, i) = LEAFVIS_YES;
+		// Leaf i can see itself, plus the union of whatever leaves can be seen through its portals.
+		m_leafVis->set(i, i);
 
 		const std::vector<int>& ps = m_portalsFromLeaf[i];
 		for(std::vector<int>::const_iterator jt=ps.begin(), jend=ps.end(); jt!=jend; ++jt)
 		{
-			const int j = *jt;
-
-			// Leaf i can see the leaf pointed to by portal j (even though portal j can't see itself).
-			(*m_leafVis)(i, m_portals[j]->auxiliary_data().toLeaf) = LEAFVIS_YES;
-
-			// Leaf i can see all the leaves pointed to by portals portal j can see.
-			for(int k=0; k<portalCount; ++k)
-			{
-				if((*m_portalVis)(j,k) == PV_YES)
-				{
-					(*m_leafVis)(i, m_portals[k]->auxiliary_data().toLeaf) = LEAFVIS_YES;
-				}
-			}
+			m_leafVis->or_row(i, portalLeafVis, *jt);
 		}
 	}
 }
 
+/**
+Waits until the specified portal's row of the full portal visibility table has been finished.
+
+@param portal	The index of the portal
+*/
+void VisCalculator::wait_for_portal(int portal)
+{
+	boost::mutex::scoped_lock lock(m_portalOrderMutex);
+	while(!m_portalFinished[portal]) m_portalFinishedCondition.wait(lock);
+}
+
 }
@@ -6,10 +6,11 @@
 #ifndef H_HESP_VISCALCULATOR
 #define H_HESP_VISCALCULATOR
 
-#include <map>
 #include <vector>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 using boost::shared_ptr;
 
 #include <hesp/math/geom/Plane.h>
@@ -20,16 +21,6 @@ namespace hesp {
 
 class VisCalculator
 {
-	//#################### ENUMERATIONS ####################
-private:
-	enum PortalVisState
-	{
-		PV_NO,				// these portals definitely can't see each other
-		PV_INITIALMAYBE,	// after the initial calculations, it's still possible these portals can see each other
-		PV_FLOODFILLMAYBE,	// after the flood fill, it's still possible these portals can see each other
-		PV_YES				// these portals definitely can see each other
-	};
-
 	//#################### NESTED CLASSES ####################
 private:
 	struct PortalTriple
@@ -43,9 +34,11 @@ private:
 
 	//#################### TYPEDEFS ####################
 private:
-	typedef VisTable<PlaneClassifier> ClassifierTable;
-	typedef shared_ptr<ClassifierTable> ClassifierTable_Ptr;
-	typedef VisTable<PortalVisState> PortalVisTable;
+	// Note:	A cell (i,j) of a portal vis table is set if portal i may be able to see portal j. During the calculation
+	//			process, this is refined as we go along: after the initial portal vis, it means the portals weren't
+	//			obviously unable to see each other; after the flood fill, it means that j was also reachable from i
+	//			through other such portals; and after the full portal vis, it means i definitely can see j.
+	typedef VisTable<bool> PortalVisTable;
 	typedef shared_ptr<PortalVisTable> PortalVisTable_Ptr;
 
 	//#################### PRIVATE VARIABLES ####################
@@ -53,18 +46,28 @@ private:
 	// Input data
 	int m_emptyLeafCount;
 	std::vector<Portal_Ptr> m_portals;
+	int m_threadCount;
 
 	// Intermediate data
-	std::map<int,std::vector<int> > m_portalsFromLeaf;
-	ClassifierTable_Ptr m_classifiers;
+	std::vector<std::vector<int> > m_portalsFromLeaf;
 	PortalVisTable_Ptr m_portalVis;
+	PortalVisTable_Ptr m_straddles;	// (i,j) is set if portal j straddles the plane of portal i
+
+	// Work queue for the full portal vis phase
+	PortalVisTable_Ptr m_fullPortalVis;
+	std::vector<int> m_portalOrder;
+	std::vector<int> m_portalPositions;		// the position of each portal in m_portalOrder
+	std::vector<bool> m_portalFinished;		// whether each portal's row of m_fullPortalVis has been finished
+	int m_nextPortal;
+	boost::mutex m_portalOrderMutex;
+	boost::condition_variable m_portalFinishedCondition;
 
 	// Output data
 	LeafVisTable_Ptr m_leafVis;
 
 	//#################### CONSTRUCTORS ####################
 public:
-	VisCalculator(int emptyLeafCount, const std::vector<Portal_Ptr>& portals);
+	VisCalculator(int emptyLeafCount, const std::vector<Portal_Ptr>& portals, int threadCount = 1);
 
 	//#################### PUBLIC METHODS ####################
 public:
@@ -76,12 +79,17 @@ private:
 	void calculate_portal_pvs(const Portal_Ptr& originalSource);
 	void clean_intermediate();
 	void flood_fill();
-	void flood_from(int originalSource);
+	void flood_from(int originalSource, PortalVisTable& reached);
 	void full_portal_vis();
+	void full_portal_vis_worker();
 	void initial_portal_vis();
+	void mark_portal_finished(int portal);
+	bool may_see(int i, int j, int sourcePosition, std::vector<bool>& finishedRowsSeen);
 	int neighbour_leaf(const Portal_Ptr& portal) const;
+	int next_portal_to_process();
 	int portal_index(const Portal_Ptr& portal) const;
 	void portal_to_leaf_vis();
+	void wait_for_portal(int portal);
 };
 
 }
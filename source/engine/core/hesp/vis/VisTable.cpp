@@ -0,0 +1,320 @@
+/***
+ * hesperus: VisTable.cpp
+ * Copyright Stuart Golodetz, 2008. All rights reserved.
+ ***/
+
+#include "VisTable.h"
+
+#include <cassert>
+
+#include <hesp/exceptions/Exception.h>
+
+namespace hesp {
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs a square bit table.
+
+@param n				The number of rows (and columns) in the table
+@param initialValue		The value to which to initialise every cell
+*/
+VisTable<bool>::VisTable(int n, bool initialValue)
+:	m_rowCount(n), m_columnCount(n), m_compressedRowCount(0)
+{
+	initialise(initialValue);
+}
+
+/**
+Constructs a (potentially) rectangular bit table.
+
+@param rowCount			The number of rows in the table
+@param columnCount		The number of columns in the table
+@param initialValue		The value to which to initialise every cell
+*/
+VisTable<bool>::VisTable(int rowCount, int columnCount, bool initialValue)
+:	m_rowCount(rowCount), m_columnCount(columnCount), m_compressedRowCount(0)
+{
+	initialise(initialValue);
+}
+
+/**
+Constructs a square bit table from a sequence of compressed rows (as produced by
+compress_row). The rows are only decompressed when they are first accessed.
+
+@param n					The number of rows (and columns) in the table
+@param compressedRows		The concatenated compressed rows
+@throws Exception			If the compressed rows are malformed
+*/
+VisTable<bool>::VisTable(int n, const std::vector<unsigned char>& compressedRows)
+:	m_rowCount(n), m_columnCount(n), m_compressedRows(compressedRows), m_compressedRowOffsets(n), m_compressedRowCount(n)
+{
+	initialise(false);
+
+	// Find the start of each compressed row, checking as we go that each row decompresses to the right length.
+	const int rowBytes = bytes_per_row();
+	const int dataSize = static_cast<int>(m_compressedRows.size());
+	int offset = 0;
+	for(int i=0; i<n; ++i)
+	{
+		m_compressedRowOffsets[i] = offset;
+
+		int decompressedBytes = 0;
+		while(decompressedBytes < rowBytes)
+		{
+			if(offset == dataSize) throw Exception("Unexpected end of compressed vis table data");
+			if(m_compressedRows[offset++] != 0) ++decompressedBytes;
+			else
+			{
+				if(offset == dataSize || m_compressedRows[offset] == 0) throw Exception("Bad zero run in compressed vis table data");
+				decompressedBytes += m_compressedRows[offset++];
+			}
+		}
+
+		if(decompressedBytes != rowBytes) throw Exception("Compressed vis table row has the wrong length");
+	}
+
+	if(offset != dataSize) throw Exception("Unexpected data after the end of the compressed vis table rows");
+}
+
+//#################### PUBLIC OPERATORS ####################
+bool VisTable<bool>::operator()(int i, int j) const
+{
+	ensure_decompressed(i);
+	return (m_words[i * m_wordsPerRow + j / BITS_PER_WORD] >> (j % BITS_PER_WORD) & 1) != 0;
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Intersects row i of this table with row j of another table (which must have the same number of columns).
+
+@param i	The row of this table to update
+@param rhs	The other table (this can be the same table)
+@param j	The row of the other table
+*/
+void VisTable<bool>::and_row(int i, const VisTable& rhs, int j)
+{
+	assert(rhs.m_columnCount == m_columnCount);
+	ensure_decompressed(i);
+	rhs.ensure_decompressed(j);
+	Word *dest = &m_words[i * m_wordsPerRow];
+	const Word *src = &rhs.m_words[j * m_wordsPerRow];
+	for(int k=0; k<m_wordsPerRow; ++k) dest[k] &= src[k];
+}
+
+int VisTable<bool>::column_count() const
+{
+	return m_columnCount;
+}
+
+/**
+Compresses the specified row and appends the result to an output buffer. Each row is
+treated as a sequence of bytes (the cells of the row in order, least significant bit
+first), and each run of zero bytes is replaced with a zero byte followed by the length
+of the run (at most 255). Non-zero bytes are copied as-is.
+
+@param i		The row to compress
+@param output	The buffer to which to append the compressed row
+*/
+void VisTable<bool>::compress_row(int i, std::vector<unsigned char>& output) const
+{
+	ensure_decompressed(i);
+
+	const Word *row = &m_words[i * m_wordsPerRow];
+	const int rowBytes = bytes_per_row();
+	for(int k=0; k<rowBytes;)
+	{
+		unsigned char b = static_cast<unsigned char>(row[k / 8] >> (k % 8 * 8));
+		if(b != 0)
+		{
+			output.push_back(b);
+			++k;
+		}
+		else
+		{
+			int runLength = 0;
+			while(k < rowBytes && runLength < 255 && static_cast<unsigned char>(row[k / 8] >> (k % 8 * 8)) == 0)
+			{
+				++runLength;
+				++k;
+			}
+			output.push_back(0);
+			output.push_back(static_cast<unsigned char>(runLength));
+		}
+	}
+}
+
+/**
+Counts the set cells in the specified row.
+
+@param i	The row
+@return		The number of cells in row i which are set
+*/
+int VisTable<bool>::count_row(int i) const
+{
+	ensure_decompressed(i);
+	int count = 0;
+	const Word *row = &m_words[i * m_wordsPerRow];
+	for(int k=0; k<m_wordsPerRow; ++k) count += popcount(row[k]);
+	return count;
+}
+
+/**
+Decompresses any rows which have yet to be decompressed. After this, the table can
+safely be read from several threads at once.
+*/
+void VisTable<bool>::decompress_all_rows() const
+{
+	for(int i=0; i<m_rowCount && m_compressedRowCount > 0; ++i)
+	{
+		ensure_decompressed(i);
+	}
+}
+
+/**
+Finds the first set cell in row i, starting from (and including) column j. This
+makes it possible to iterate over the set cells of a sparse row a word at a time,
+e.g. for(int j=t.next_set_column(i,0); j!=-1; j=t.next_set_column(i,j+1)) ...
+
+@param i	The row
+@param j	The column from which to start searching
+@return		The column of the first set cell at or after column j, or -1 if there isn't one
+*/
+int VisTable<bool>::next_set_column(int i, int j) const
+{
+	if(j >= m_columnCount) return -1;
+
+	ensure_decompressed(i);
+
+	const Word *row = &m_words[i * m_wordsPerRow];
+	int k = j / BITS_PER_WORD;
+
+	// Mask off the bits in the first word which precede column j.
+	Word w = row[k] & (~Word(0) << (j % BITS_PER_WORD));
+	for(;;)
+	{
+		if(w) return k * BITS_PER_WORD + lowest_set_bit(w);
+		if(++k == m_wordsPerRow) return -1;
+		w = row[k];
+	}
+}
+
+/**
+Unites row i of this table with row j of another table (which must have the same number of columns).
+
+@param i	The row of this table to update
+@param rhs	The other table (this can be the same table)
+@param j	The row of the other table
+*/
+void VisTable<bool>::or_row(int i, const VisTable& rhs, int j)
+{
+	assert(rhs.m_columnCount == m_columnCount);
+	ensure_decompressed(i);
+	rhs.ensure_decompressed(j);
+	Word *dest = &m_words[i * m_wordsPerRow];
+	const Word *src = &rhs.m_words[j * m_wordsPerRow];
+	for(int k=0; k<m_wordsPerRow; ++k) dest[k] |= src[k];
+}
+
+void VisTable<bool>::set(int i, int j, bool value)
+{
+	ensure_decompressed(i);
+	Word& w = m_words[i * m_wordsPerRow + j / BITS_PER_WORD];
+	Word bit = Word(1) << (j % BITS_PER_WORD);
+	if(value) w |= bit;
+	else w &= ~bit;
+}
+
+/**
+Returns the number of rows in the table.
+
+@return	As stated
+*/
+int VisTable<bool>::size() const
+{
+	return m_rowCount;
+}
+
+//#################### PRIVATE METHODS ####################
+int VisTable<bool>::bytes_per_row() const
+{
+	return (m_columnCount + 7) / 8;
+}
+
+void VisTable<bool>::decompress_row(int i) const
+{
+	Word *row = &m_words[i * m_wordsPerRow];
+	const int rowBytes = bytes_per_row();
+	int offset = m_compressedRowOffsets[i];
+	for(int k=0; k<rowBytes;)
+	{
+		unsigned char b = m_compressedRows[offset++];
+		if(b != 0)
+		{
+			row[k / 8] |= Word(b) << (k % 8 * 8);
+			++k;
+		}
+		else k += m_compressedRows[offset++];
+	}
+
+	// Make sure the unused bits at the end of the row are clear, whatever was in the input.
+	int usedBits = m_columnCount % BITS_PER_WORD;
+	if(usedBits != 0) row[m_wordsPerRow - 1] &= (Word(1) << usedBits) - 1;
+
+	m_compressedRowOffsets[i] = -1;
+
+	// Once every row has been decompressed, the compressed data is no longer needed.
+	if(--m_compressedRowCount == 0)
+	{
+		std::vector<int>().swap(m_compressedRowOffsets);
+		std::vector<unsigned char>().swap(m_compressedRows);
+	}
+}
+
+void VisTable<bool>::ensure_decompressed(int i) const
+{
+	if(m_compressedRowCount != 0 && m_compressedRowOffsets[i] != -1) decompress_row(i);
+}
+
+void VisTable<bool>::initialise(bool initialValue)
+{
+	m_wordsPerRow = (m_columnCount + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	m_words.resize(m_rowCount * m_wordsPerRow, initialValue ? ~Word(0) : Word(0));
+
+	// Clear the unused bits at the end of each row (see the class comment).
+	int usedBits = m_columnCount % BITS_PER_WORD;
+	if(initialValue && usedBits != 0)
+	{
+		Word lastWordMask = (Word(1) << usedBits) - 1;
+		for(int i=0; i<m_rowCount; ++i)
+		{
+			m_words[(i + 1) * m_wordsPerRow - 1] &= lastWordMask;
+		}
+	}
+}
+
+int VisTable<bool>::lowest_set_bit(Word w)
+{
+#ifdef __GNUC__
+	return __builtin_ctzll(w);
+#else
+	int n = 0;
+	while((w & 0xFFFFFFFF) == 0)	{ w >>= 32; n += 32; }
+	while((w & 0xFF) == 0)			{ w >>= 8; n += 8; }
+	while((w & 1) == 0)				{ w >>= 1; ++n; }
+	return n;
+#endif
+}
+
+int VisTable<bool>::popcount(Word w)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(w);
+#else
+	w = w - ((w >> 1) & 0x5555555555555555ULL);
+	w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+	w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+}
@@ -8,21 +8,12 @@
 
 #include <vector>
 
+#include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
 using boost::shared_ptr;
 
 namespace hesp {
 
-//#################### ENUMERATIONS ####################
-// Note:	We don't use bool instead of LeafVisState because VisTable
-//			can be implemented internally using std::vector, and sadly
-//			std::vector<bool> is not a container (yuk!)
-enum LeafVisState
-{
-	LEAFVIS_NO,
-	LEAFVIS_YES
-};
-
 //#################### CLASSES ####################
 /**
 This class template represents a visibility table. It stores the
@@ -51,8 +42,78 @@ public:
 	int size() const;
 };
 
+/**
+This specialisation of VisTable stores a boolean visibility relation as a bit
+table, with each row packed into 64-bit words in a single contiguous allocation.
+Rows always start on a word boundary, so separate rows can safely be written by
+different threads at the same time, and the unused bits at the end of each row
+are always kept clear, so that whole rows can be combined and counted a word at
+a time. Unlike the general version, the table may be rectangular (e.g. to relate
+portals to leaves).
+
+Rows can also be compressed using run-length encoding of their zero bytes (as in
+Quake's PVS format), and a table constructed from compressed rows only decompresses
+each row when it is first accessed. Since this happens behind const accessors, a
+table constructed in this way should have decompress_all_rows() called on it before
+it is shared between threads.
+*/
+template <>
+class VisTable<bool>
+{
+	//#################### TYPEDEFS ####################
+public:
+	typedef boost::uint64_t Word;
+
+	//#################### CONSTANTS ####################
+public:
+	enum { BITS_PER_WORD = 64 };
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	int m_rowCount;
+	int m_columnCount;
+	int m_wordsPerRow;
+	mutable std::vector<Word> m_words;
+
+	// Rows which have yet to be decompressed (these are cleared once all the rows have been decompressed)
+	mutable std::vector<unsigned char> m_compressedRows;
+	mutable std::vector<int> m_compressedRowOffsets;	// the offset of each row in m_compressedRows, or -1 if it's been decompressed
+	mutable int m_compressedRowCount;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit VisTable(int n, bool initialValue = false);
+	VisTable(int rowCount, int columnCount, bool initialValue);
+	VisTable(int n, const std::vector<unsigned char>& compressedRows);
+
+	//#################### PUBLIC OPERATORS ####################
+public:
+	bool operator()(int i, int j) const;
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void and_row(int i, const VisTable& rhs, int j);
+	int column_count() const;
+	void compress_row(int i, std::vector<unsigned char>& output) const;
+	int count_row(int i) const;
+	void decompress_all_rows() const;
+	int next_set_column(int i, int j) const;
+	void or_row(int i, const VisTable& rhs, int j);
+	void set(int i, int j, bool value = true);
+	int size() const;
+
+	//#################### PRIVATE METHODS ####################
+private:
+	int bytes_per_row() const;
+	void decompress_row(int i) const;
+	void ensure_decompressed(int i) const;
+	void initialise(bool initialValue);
+	static int lowest_set_bit(Word w);
+	static int popcount(Word w);
+};
+
 //#################### TYPEDEFS ####################
-typedef VisTable<LeafVisState> LeafVisTable;
+typedef VisTable<bool> LeafVisTable;
 typedef shared_ptr<LeafVisTable> LeafVisTable_Ptr;
 typedef shared_ptr<const LeafVisTable> LeafVisTable_CPtr;
 
@@ -3,11 +3,13 @@
  * Copyright Stuart Golodetz, 2009. All rights reserved.
  ***/
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/lexical_cast.hpp>
 using boost::bad_lexical_cast;
 using boost::lexical_cast;
@@ -18,6 +20,35 @@ using boost::lexical_cast;
 #include <hesp/util/PolygonTypes.h>
 using namespace hesp;
 
+//#################### CLASSES ####################
+struct BuildOptions
+{
+	double weight;
+	int threadCount;
+	int candidateSampleSize;	// 0 to score all the candidate splitters
+	int testSampleSize;
+	unsigned int seed;
+	bool report;
+
+	BuildOptions()
+	:	weight(4), threadCount(1), candidateSampleSize(0), testSampleSize(0), seed(0), report(false)
+	{}
+};
+
+struct TreeQuality
+{
+	int maxDepth;
+	int emptyLeafCount;
+	int solidLeafCount;
+	int branchCount;
+	int splitCount;
+	boost::posix_time::time_duration buildTime;
+
+	TreeQuality()
+	:	maxDepth(0), emptyLeafCount(0), solidLeafCount(0), branchCount(0), splitCount(0)
+	{}
+};
+
 //#################### FUNCTIONS ####################
 void quit_with_error(const std::string& error)
 {
@@ -27,12 +58,65 @@ void quit_with_error(const std::string& error)
 
 void quit_with_usage()
 {
-	std::cout << "Usage: hbsp {-r|-c} <input geometry> {<input hints>|nohints} <output tree> [-w<number>]" << std::endl;
+	std::cout << "Usage: hbsp {-r|-c} <input geometry> {<input hints>|nohints} <output tree> [-w<number>] [-j<threads>] [-s<candidates>,<samples>[,<seed>]] [-q]" << std::endl;
 	exit(EXIT_FAILURE);
 }
 
+void measure_subtree(const BSPNode_CPtr& node, int depth, TreeQuality& quality)
+{
+	quality.maxDepth = std::max(quality.maxDepth, depth);
+	if(node->is_leaf())
+	{
+		if(node->as_leaf()->is_solid()) ++quality.solidLeafCount;
+		else ++quality.emptyLeafCount;
+	}
+	else
+	{
+		++quality.branchCount;
+		const BSPBranch *branch = node->as_branch();
+		measure_subtree(branch->left(), depth + 1, quality);
+		measure_subtree(branch->right(), depth + 1, quality);
+	}
+}
+
+void print_quality_row(const std::string& label, int value, int exhaustiveValue, bool compare)
+{
+	std::cout << "  " << label << value;
+	if(compare) std::cout << "\t(exhaustive: " << exhaustiveValue << ')';
+	std::cout << '\n';
+}
+
+void print_quality_report(const TreeQuality& quality, const TreeQuality *exhaustiveQuality)
+{
+	bool compare = exhaustiveQuality != NULL;
+	const TreeQuality& other = compare ? *exhaustiveQuality : quality;
+
+	std::cout << (compare ? "Tree quality (sampled splitters):\n" : "Tree quality:\n");
+	print_quality_row("Max depth:\t", quality.maxDepth, other.maxDepth, compare);
+	print_quality_row("Empty leaves:\t", quality.emptyLeafCount, other.emptyLeafCount, compare);
+	print_quality_row("Solid leaves:\t", quality.solidLeafCount, other.solidLeafCount, compare);
+	print_quality_row("Branches:\t", quality.branchCount, other.branchCount, compare);
+	print_quality_row("Splits:\t\t", quality.splitCount, other.splitCount, compare);
+	print_quality_row("Build time (ms):", static_cast<int>(quality.buildTime.total_milliseconds()),
+					  static_cast<int>(other.buildTime.total_milliseconds()), compare);
+	std::cout << std::flush;
+}
+
+template <typename Poly>
+TreeQuality build_tree(BSPCompiler<Poly>& compiler)
+{
+	boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+	compiler.build_tree();
+
+	TreeQuality quality;
+	quality.buildTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+	quality.splitCount = compiler.split_count();
+	measure_subtree(BSPTree_CPtr(compiler.tree())->root(), 0, quality);
+	return quality;
+}
+
 template <typename Poly>
-void run_compiler(const std::string& inputGeometryFilename, const std::string& hintGeometryFilename, const std::string& outputTreeFilename, double weight)
+void run_compiler(const std::string& inputGeometryFilename, const std::string& hintGeometryFilename, const std::string& outputTreeFilename, const BuildOptions& options)
 {
 	typedef shared_ptr<Poly> Poly_Ptr;
 	typedef std::vector<Poly_Ptr> PolyVector;
@@ -46,8 +130,24 @@ void run_compiler(const std::string& inputGeometryFilename, const std::string& h
 	if(hintGeometryFilename != "nohints") GeometryFile::load(hintGeometryFilename, hintPolygons);
 
 	// Build the BSP tree.
-	BSPCompiler<Poly> compiler(polygons, hintPolygons, weight);
-	compiler.build_tree();
+	BSPCompiler<Poly> compiler(polygons, hintPolygons, options.weight, options.threadCount);
+	if(options.candidateSampleSize > 0)
+	{
+		compiler.set_splitter_sampling(options.candidateSampleSize, options.testSampleSize, options.seed);
+	}
+	TreeQuality quality = build_tree(compiler);
+
+	// If requested, report on the quality of the tree (comparing it to an exhaustively-built one if the splitters were sampled).
+	if(options.report)
+	{
+		if(options.candidateSampleSize > 0)
+		{
+			BSPCompiler<Poly> exhaustiveCompiler(polygons, hintPolygons, options.weight, options.threadCount);
+			TreeQuality exhaustiveQuality = build_tree(exhaustiveCompiler);
+			print_quality_report(quality, &exhaustiveQuality);
+		}
+		else print_quality_report(quality, NULL);
+	}
 
 	// Save the polygons and the BSP tree to the output file.
 	TreeFile::save(outputTreeFilename, compiler.polygons(), compiler.tree());
@@ -56,7 +156,7 @@ void run_compiler(const std::string& inputGeometryFilename, const std::string& h
 int main(int argc, char *argv[])
 try
 {
-	if(argc != 5 && argc != 6) quit_with_usage();
+	if(argc < 5) quit_with_usage();
 
 	const std::vector<std::string> args(argv, argv+argc);
 
@@ -64,17 +164,41 @@ try
 	std::string hintGeometryFilename = args[3];
 	std::string outputTreeFilename = args[4];
 
-	double weight = 4;
-	if(argc == 6)
+	BuildOptions options;
+	for(int i=5; i<argc; ++i)
 	{
-		if(args[5].substr(0,2) != "-w") quit_with_usage();
-
-		try							{ weight = lexical_cast<double>(args[5].substr(2)); }
-		catch(bad_lexical_cast&)	{ quit_with_usage(); }
+		std::string flag = args[i].substr(0,2);
+		std::string value = args[i].substr(2);
+		try
+		{
+			if(flag == "-w") options.weight = lexical_cast<double>(value);
+			else if(flag == "-j")
+			{
+				options.threadCount = lexical_cast<int>(value);
+				if(options.threadCount < 1) quit_with_usage();
+			}
+			else if(flag == "-s")
+			{
+				// The sampling sizes are specified as <candidates>,<samples>[,<seed>].
+				std::string::size_type comma = value.find(',');
+				if(comma == std::string::npos) quit_with_usage();
+				options.candidateSampleSize = lexical_cast<int>(value.substr(0, comma));
+
+				std::string rest = value.substr(comma + 1);
+				std::string::size_type secondComma = rest.find(',');
+				options.testSampleSize = lexical_cast<int>(rest.substr(0, secondComma));
+				if(secondComma != std::string::npos) options.seed = lexical_cast<unsigned int>(rest.substr(secondComma + 1));
+
+				if(options.candidateSampleSize < 1 || options.testSampleSize < 1) quit_with_usage();
+			}
+			else if(args[i] == "-q") options.report = true;
+			else quit_with_usage();
+		}
+		catch(bad_lexical_cast&) { quit_with_usage(); }
 	}
 
-	if(args[1] == "-r") run_compiler<TexturedPolygon>(inputGeometryFilename, hintGeometryFilename, outputTreeFilename, weight);
-	else if(args[1] == "-c") run_compiler<CollisionPolygon>(inputGeometryFilename, hintGeometryFilename, outputTreeFilename, weight);
+	if(args[1] == "-r") run_compiler<TexturedPolygon>(inputGeometryFilename, hintGeometryFilename, outputTreeFilename, options);
+	else if(args[1] == "-c") run_compiler<CollisionPolygon>(inputGeometryFilename, hintGeometryFilename, outputTreeFilename, options);
 	else quit_with_usage();
 
 	return 0;
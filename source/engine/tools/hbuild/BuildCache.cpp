@@ -0,0 +1,157 @@
+/***
+ * hbuild: BuildCache.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "BuildCache.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+namespace bf = boost::filesystem;
+using boost::lexical_cast;
+using boost::uint64_t;
+
+#include <hesp/exceptions/Exception.h>
+
+namespace hesp {
+
+namespace {
+
+//#################### LOCAL METHODS ####################
+/**
+Updates a 64-bit FNV-1a hash with the specified bytes.
+*/
+void fnv1a(uint64_t& h, const char *bytes, size_t length)
+{
+	const uint64_t FNV_PRIME = (uint64_t(1) << 40) + 0x1b3;
+	for(size_t i=0; i<length; ++i)
+	{
+		h ^= static_cast<unsigned char>(bytes[i]);
+		h *= FNV_PRIME;
+	}
+}
+
+/**
+Updates a 64-bit FNV-1a hash with a length-prefixed string, so that the boundaries
+between consecutive strings contribute to the hash.
+*/
+void fnv1a(uint64_t& h, const std::string& s)
+{
+	std::string length = lexical_cast<std::string>(s.length()) + ':';
+	fnv1a(h, length.data(), length.length());
+	fnv1a(h, s.data(), s.length());
+}
+
+}
+
+//#################### CONSTRUCTORS ####################
+BuildCache::BuildCache(const bf::path& directory)
+:	m_directory(directory)
+{
+	bf::create_directories(m_directory);
+}
+
+//#################### PUBLIC METHODS ####################
+/**
+Calculates the cache key for a stage with the specified inputs.
+
+@param stage	The name of the stage (including any parameters which affect its outputs)
+@param inputs	The serialized inputs to the stage
+@return			The cache key
+*/
+std::string BuildCache::key(const std::string& stage, const std::vector<std::string>& inputs)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	fnv1a(h, lexical_cast<std::string>(VERSION));
+	fnv1a(h, stage);
+	for(size_t i=0, size=inputs.size(); i<size; ++i)
+	{
+		fnv1a(h, inputs[i]);
+	}
+
+	std::ostringstream oss;
+	oss << stage << '-' << std::hex << std::setw(16) << std::setfill('0') << h;
+	return oss.str();
+}
+
+/**
+Looks up the outputs stored for the specified cache key.
+
+@param key		The cache key
+@param outputs	Used to return the outputs (if present)
+@return			true, if the key was present in the cache, or false otherwise
+@throws Exception	If an output file for the key could not be read
+*/
+bool BuildCache::lookup(const std::string& key, std::vector<std::string>& outputs) const
+{
+	bf::path entryDir = m_directory / key;
+	if(!bf::exists(entryDir)) return false;
+
+	outputs.clear();
+	for(int i=0;; ++i)
+	{
+		bf::path outputPath = entryDir / lexical_cast<std::string>(i);
+		if(!bf::exists(outputPath)) break;
+
+		std::ifstream is(outputPath.file_string().c_str(), std::ios_base::binary);
+		if(is.fail()) throw Exception("Could not open " + outputPath.file_string() + " for reading");
+		std::ostringstream oss;
+		oss << is.rdbuf();
+		outputs.push_back(oss.str());
+	}
+	return true;
+}
+
+/**
+Removes all the entries from the cache except the specified ones.
+
+@param keysToKeep	The keys of the entries to keep
+*/
+void BuildCache::prune(const std::set<std::string>& keysToKeep) const
+{
+	std::vector<bf::path> entryDirs;
+	for(bf::directory_iterator it(m_directory), iend; it!=iend; ++it)
+	{
+		std::string key = bf::path(it->path().filename()).file_string();
+		if(keysToKeep.find(key) == keysToKeep.end()) entryDirs.push_back(it->path());
+	}
+
+	for(std::vector<bf::path>::const_iterator it=entryDirs.begin(), iend=entryDirs.end(); it!=iend; ++it)
+	{
+		bf::remove_all(*it);
+	}
+}
+
+/**
+Stores the outputs for the specified cache key. The outputs are written to a temporary
+directory which is then renamed, so that an interrupted build never leaves a partial entry.
+
+@param key		The cache key
+@param outputs	The outputs
+@throws Exception	If an output file for the key could not be written
+*/
+void BuildCache::store(const std::string& key, const std::vector<std::string>& outputs) const
+{
+	bf::path entryDir = m_directory / key;
+	bf::path tempDir = m_directory / (key + ".tmp");
+	bf::remove_all(tempDir);
+	bf::create_directory(tempDir);
+
+	for(size_t i=0, size=outputs.size(); i<size; ++i)
+	{
+		bf::path outputPath = tempDir / lexical_cast<std::string>(i);
+		std::ofstream os(outputPath.file_string().c_str(), std::ios_base::binary);
+		if(os.fail()) throw Exception("Could not open " + outputPath.file_string() + " for writing");
+		os.write(outputs[i].data(), static_cast<std::streamsize>(outputs[i].length()));
+	}
+
+	bf::remove_all(entryDir);
+	bf::rename(tempDir, entryDir);
+}
+
+}
@@ -0,0 +1,49 @@
+/***
+ * hbuild: BuildCache.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HBUILD_BUILDCACHE
+#define H_HBUILD_BUILDCACHE
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+namespace hesp {
+
+/**
+This class stores the outputs of the stages of a level build on disk, keyed by a hash of the
+stage name and the (serialized) stage inputs. Since the key depends only on the content of
+the inputs, a stage whose inputs are unchanged can be skipped, even if the stages before it
+had to be re-run.
+
+Each cache entry is a directory named after its key, containing one file per stage output.
+*/
+class BuildCache
+{
+	//#################### CONSTANTS ####################
+private:
+	enum { VERSION = 2 };	// bump this whenever a change to a stage would alter its outputs
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	boost::filesystem::path m_directory;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	explicit BuildCache(const boost::filesystem::path& directory);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	static std::string key(const std::string& stage, const std::vector<std::string>& inputs);
+	bool lookup(const std::string& key, std::vector<std::string>& outputs) const;
+	void prune(const std::set<std::string>& keysToKeep) const;
+	void store(const std::string& key, const std::vector<std::string>& outputs) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,559 @@
+/***
+ * hbuild: LevelBuilder.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include "LevelBuilder.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+namespace bf = boost::filesystem;
+using boost::lexical_cast;
+
+#include <hesp/bounds/BoundsManager.h>
+#include <hesp/io/files/DefinitionsFile.h>
+#include <hesp/io/files/DefinitionsSpecifierFile.h>
+#include <hesp/io/files/LevelFile.h>
+#include <hesp/io/files/LightsFile.h>
+#include <hesp/io/files/LitTreeFile.h>
+#include <hesp/io/files/MEFFile.h>
+#include <hesp/io/files/NavFile.h>
+#include <hesp/io/files/ObjectsFile.h>
+#include <hesp/io/files/OnionPortalsFile.h>
+#include <hesp/io/files/OnionTreeFile.h>
+#include <hesp/io/files/VisFile.h>
+#include <hesp/io/sections/LightmapsSection.h>
+#include <hesp/io/util/DirectoryFinder.h>
+#include <hesp/lighting/Lightmap.h>
+#include <hesp/lighting/LightmapAtlas.h>
+#include <hesp/lighting/LightmapGenerator.h>
+#include <hesp/nav/NavManager.h>
+#include <hesp/objects/base/ComponentPropertyTypeMap.h>
+#include <hesp/objects/base/ObjectSpecification.h>
+#include <hesp/portals/OnionPortalGenerator.h>
+#include <hesp/trees/OnionCompiler.h>
+#include <hesp/trees/OnionTree.h>
+#include <hesp/vis/VisCalculator.h>
+
+namespace hesp {
+
+namespace {
+
+//#################### LOCAL TYPEDEFS ####################
+typedef std::vector<std::string> Blobs;
+typedef std::vector<CollisionPolygon_Ptr> ColPolyVector;
+typedef std::vector<TexturedPolygon_Ptr> TexPolyVector;
+
+//#################### LOCAL CONSTANTS ####################
+const std::string LIGHTMAP_PREFIX = "LM";
+
+//#################### LOCAL METHODS ####################
+Blobs make_blobs(const std::string& a)
+{
+	return Blobs(1, a);
+}
+
+Blobs make_blobs(const std::string& a, const std::string& b)
+{
+	Blobs blobs;
+	blobs.push_back(a);
+	blobs.push_back(b);
+	return blobs;
+}
+
+Blobs make_blobs(const std::string& a, const std::string& b, const std::string& c)
+{
+	Blobs blobs = make_blobs(a, b);
+	blobs.push_back(c);
+	return blobs;
+}
+
+}
+
+//#################### CONSTRUCTORS ####################
+/**
+Constructs a level builder.
+
+@param levelDir				The directory containing the level's .mef and .obs files
+@param levelName			The name of the level
+@param lit					Whether or not to light the level
+@param keepIntermediates	Whether or not to write the intermediate files produced by the hmake script to the level directory
+@param threadCount			The number of threads to use for the CSG, BSP, vis, lighting and navigation stages
+*/
+LevelBuilder::LevelBuilder(const bf::path& levelDir, const std::string& levelName, bool lit, bool keepIntermediates, int threadCount)
+:	m_cache(levelDir / "buildcache"), m_cachedStageCount(0), m_keepIntermediates(keepIntermediates),
+	m_levelDir(levelDir), m_levelName(levelName), m_lit(lit), m_ranStageCount(0), m_threadCount(threadCount)
+{}
+
+//#################### PUBLIC METHODS ####################
+/**
+Builds the level, writing it to <level name>.bsp in the level directory.
+
+@throws Exception	If any of the stages of the build fail
+*/
+void LevelBuilder::build()
+{
+	// Convert the MEF file and separate the brushes according to their functions.
+	Blobs converted = run_stage("mef2input", &LevelBuilder::convert_mef, make_blobs(read_file(m_levelDir / (m_levelName + ".mef"))));
+	const std::string& bru = converted[0], dsf = converted[1], lum = converted[2];
+	keep_intermediate(".bru", bru);
+	keep_intermediate(".dsf", dsf);
+	keep_intermediate(".lum", lum);
+
+	Blobs divided = run_stage("hdivide", &LevelBuilder::divide_brushes, make_blobs(bru));
+	const std::string& rbr = divided[0], cbr = divided[1], dgm = divided[2], hgm = divided[3];
+	keep_intermediate(".rbr", rbr);
+	keep_intermediate(".cbr", cbr);
+	keep_intermediate(".dgm", dgm);
+	keep_intermediate(".hgm", hgm);
+	keep_intermediate(".sbr", divided[4]);
+
+	// Build the rendering tree, portals and vis table, and light the level if desired.
+	std::string rg1 = run_stage("hcsg-r", &LevelBuilder::run_csg<TexturedPolygon>, make_blobs(rbr))[0];
+	std::string rt1 = run_stage("hbsp-r", &LevelBuilder::build_tree<TexturedPolygon>, make_blobs(rg1, hgm))[0];
+	std::string rp1 = run_stage("hportal-r", &LevelBuilder::generate_portals<TexturedPolygon>, make_blobs(rt1))[0];
+	std::string rg2 = run_stage("hflood-r", &LevelBuilder::flood_fill<TexturedPolygon>, make_blobs(rt1, rp1))[0];
+	std::string rt2 = run_stage("hbsp-r", &LevelBuilder::build_tree<TexturedPolygon>, make_blobs(rg2, hgm))[0];
+	std::string rp2 = run_stage("hportal-r", &LevelBuilder::generate_portals<TexturedPolygon>, make_blobs(rt2))[0];
+	std::string vis = run_stage("hvis", &LevelBuilder::calculate_vis, make_blobs(rp2))[0];
+	std::string rt3 = run_stage("hdetail", &LevelBuilder::add_detail, make_blobs(rt2, dgm))[0];
+	keep_intermediate(".rg1", rg1);
+	keep_intermediate(".rt1", rt1);
+	keep_intermediate(".rp1", rp1);
+	keep_intermediate(".rg2", rg2);
+	keep_intermediate(".rt2", rt2);
+	keep_intermediate(".rp2", rp2);
+	keep_intermediate(".vis", vis);
+	keep_intermediate(".rt3", rt3);
+
+	std::string tree = rt3, lightmaps;
+	if(m_lit)
+	{
+		Blobs lit = run_stage("hlight", &LevelBuilder::calculate_lighting, make_blobs(rt3, vis, lum));
+		tree = lit[0];
+		lightmaps = lit[1];
+		keep_intermediate(".lbt", tree);
+
+		if(m_keepIntermediates)
+		{
+			// Note: The lightmaps file is named after the prefix recorded in the lit tree (as per hlight).
+			std::string filename = (m_levelDir / (LIGHTMAP_PREFIX + ".lmp")).file_string();
+			std::ofstream os(filename.c_str(), std::ios_base::binary);
+			if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+			os.write(lightmaps.data(), static_cast<std::streamsize>(lightmaps.length()));
+		}
+	}
+
+	// Build the collision onion tree, onion portals and navigation data. Note that the definitions file
+	// is an input to the stages which need the object bounds, so that changing it invalidates them.
+	std::istringstream dsfStream(dsf);
+	std::string definitionsFilename = DefinitionsSpecifierFile::load(dsfStream);
+	std::string definitions = read_file(DirectoryFinder::instance().determine_definitions_directory() / definitionsFilename);
+
+	Blobs ebrs = run_stage("hexpand", &LevelBuilder::expand_brushes, make_blobs(dsf, cbr, definitions));
+
+	Blobs geomTreePairs;
+	for(size_t i=0, size=ebrs.size(); i<size; ++i)
+	{
+		std::string cg1 = run_stage("hcsg-c", &LevelBuilder::run_csg<CollisionPolygon>, make_blobs(ebrs[i]))[0];
+		std::string ct1 = run_stage("hbsp-c", &LevelBuilder::build_tree<CollisionPolygon>, make_blobs(cg1))[0];
+		std::string cp = run_stage("hportal-c", &LevelBuilder::generate_portals<CollisionPolygon>, make_blobs(ct1))[0];
+		std::string cg2 = run_stage("hflood-c", &LevelBuilder::flood_fill<CollisionPolygon>, make_blobs(ct1, cp))[0];
+		std::string ct2 = run_stage("hbsp-c", &LevelBuilder::build_tree<CollisionPolygon>, make_blobs(cg2))[0];
+
+		std::string stem = "-" + lexical_cast<std::string>(i);
+		keep_intermediate(stem + ".ebr", ebrs[i]);
+		keep_intermediate(stem + ".cg1", cg1);
+		keep_intermediate(stem + ".ct1", ct1);
+		keep_intermediate(stem + ".cp", cp);
+		keep_intermediate(stem + ".cg2", cg2);
+		keep_intermediate(stem + ".ct2", ct2);
+
+		geomTreePairs.push_back(cg2);
+		geomTreePairs.push_back(ct2);
+	}
+
+	std::string ot = run_stage("hobsp-c", &LevelBuilder::build_onion_tree, geomTreePairs)[0];
+	std::string op = run_stage("hoportal-c", &LevelBuilder::generate_onion_portals, make_blobs(ot))[0];
+	std::string nav = run_stage("hnav", &LevelBuilder::generate_nav_data, make_blobs(dsf, ot, definitions))[0];
+	keep_intermediate(".ot", ot);
+	keep_intermediate(".op", op);
+	keep_intermediate(".nav", nav);
+
+	// Discard any cache entries which weren't used by this build.
+	m_cache.prune(m_usedKeys);
+
+	// Collate everything into the level file.
+	collate(tree, lightmaps, rp2, vis, ot, op, nav, dsf);
+
+	std::cout << "Built " << m_levelName << ".bsp (" << m_ranStageCount << " stages run, " << m_cachedStageCount << " up to date)" << std::endl;
+}
+
+//#################### STAGES ####################
+/**
+Adds the detail brushes to the rendering tree (as per hdetail).
+
+@param inputs	The polygons and tree, followed by the detail brushes
+@return			The polygons and tree with the detail added
+*/
+LevelBuilder::Blobs LevelBuilder::add_detail(const Blobs& inputs) const
+{
+	TexPolyVector polygons;
+	BSPTree_Ptr tree;
+	std::istringstream treeStream(inputs[0]);
+	TreeFile::load(treeStream, polygons, tree);
+
+	std::istringstream detailStream(inputs[1]);
+	BuildUtil::TexPolyBrushVector detailBrushes = BrushesFile::load<TexturedPolygon>(detailStream);
+
+	BuildUtil::add_detail(polygons, tree, detailBrushes);
+
+	std::ostringstream os;
+	TreeFile::save(os, polygons, tree);
+	return make_blobs(os.str());
+}
+
+/**
+Compiles the collision trees for the separate maps into an onion tree (as per hobsp).
+
+@param inputs	The polygons and tree for each map, in pairs
+@return			The polygons and onion tree
+*/
+LevelBuilder::Blobs LevelBuilder::build_onion_tree(const Blobs& inputs) const
+{
+	size_t mapCount = inputs.size() / 2;
+	std::vector<ColPolyVector> maps(mapCount);
+	std::vector<BSPTree_CPtr> mapTrees;
+	for(size_t i=0; i<mapCount; ++i)
+	{
+		std::istringstream geomStream(inputs[i*2]);
+		GeometryFile::load(geomStream, maps[i]);
+
+		ColPolyVector polygons;
+		BSPTree_Ptr mapTree;
+		std::istringstream treeStream(inputs[i*2+1]);
+		TreeFile::load(treeStream, polygons, mapTree);
+		mapTrees.push_back(mapTree);
+	}
+
+	OnionCompiler<CollisionPolygon> compiler(maps, mapTrees, 4);
+	compiler.build_tree();
+
+	std::ostringstream os;
+	OnionTreeFile::save(os, *compiler.polygons(), compiler.tree());
+	return make_blobs(os.str());
+}
+
+/**
+Lights the level (as per hlight).
+
+@param inputs	The polygons and tree, the vis table and the lights
+@return			The lit polygons and tree, followed by the lightmap atlas (in the format of a level file section)
+*/
+LevelBuilder::Blobs LevelBuilder::calculate_lighting(const Blobs& inputs) const
+{
+	TexPolyVector polygons;
+	BSPTree_Ptr tree;
+	std::istringstream treeStream(inputs[0]);
+	TreeFile::load(treeStream, polygons, tree);
+
+	std::istringstream visStream(inputs[1]);
+	LeafVisTable_Ptr leafVis = VisFile::load(visStream);
+
+	std::istringstream lightsStream(inputs[2]);
+	std::vector<Light> lights = LightsFile::load(lightsStream);
+
+	LightmapGenerator lg(polygons, lights, tree, leafVis, m_threadCount);
+	lg.generate_lightmaps();
+
+	typedef std::vector<Lightmap_Ptr> LightmapVector;
+	typedef shared_ptr<const LightmapVector> LightmapVector_CPtr;
+	typedef std::vector<TexturedLitPolygon_Ptr> TexLitPolyVector;
+	TexLitPolyVector litPolygons = *lg.lit_polygons();
+	LightmapVector_CPtr lightmaps = lg.lightmaps();
+	LightmapAtlas_Ptr atlas = LightmapAtlas::pack(*lightmaps, litPolygons);
+
+	std::ostringstream treeOS;
+	LitTreeFile::save(treeOS, litPolygons, tree, LIGHTMAP_PREFIX);
+
+	std::ostringstream lightmapsOS;
+	LightmapsSection::save(lightmapsOS, atlas);
+
+	return make_blobs(treeOS.str(), lightmapsOS.str());
+}
+
+/**
+Calculates the leaf vis table (as per hvis).
+
+@param inputs	The portals
+@return			The leaf vis table
+*/
+LevelBuilder::Blobs LevelBuilder::calculate_vis(const Blobs& inputs) const
+{
+	int emptyLeafCount;
+	std::vector<Portal_Ptr> portals;
+	std::istringstream is(inputs[0]);
+	PortalsFile::load(is, emptyLeafCount, portals);
+
+	VisCalculator visCalc(emptyLeafCount, portals, m_threadCount);
+	LeafVisTable_Ptr leafVis = visCalc.calculate_leaf_vis_table();
+
+	std::ostringstream os;
+	VisFile::save(os, leafVis);
+	return make_blobs(os.str());
+}
+
+/**
+Converts a MEF file (as per mef2input).
+
+@param inputs	The MEF file
+@return			The brushes, the definitions specifier and the lights
+*/
+LevelBuilder::Blobs LevelBuilder::convert_mef(const Blobs& inputs) const
+{
+	BuildUtil::TexPolyBrushVector brushes;
+	std::vector<Light> lights;
+	std::istringstream is(inputs[0]);
+	MEFFile::load(is, brushes, lights);
+
+	std::ostringstream brushesOS, definitionsSpecifierOS, lightsOS;
+	BrushesFile::save(brushesOS, brushes);
+	// FIXME: Write the proper specifier once it can be extracted from the MEF (see mef2input).
+	DefinitionsSpecifierFile::save(definitionsSpecifierOS, "test-def.xml");
+	LightsFile::save(lightsOS, lights);
+
+	return make_blobs(brushesOS.str(), definitionsSpecifierOS.str(), lightsOS.str());
+}
+
+/**
+Separates the brushes according to their functions (as per hdivide).
+
+@param inputs	The brushes
+@return			The rendering brushes, collision brushes, detail brushes, hint polygons and special brushes
+*/
+LevelBuilder::Blobs LevelBuilder::divide_brushes(const Blobs& inputs) const
+{
+	std::istringstream is(inputs[0]);
+	BuildUtil::TexPolyBrushVector inputBrushes = BrushesFile::load<TexturedPolygon>(is);
+
+	BuildUtil::TexPolyBrushVector renderingBrushes, detailBrushes, specialBrushes;
+	BuildUtil::ColPolyBrushVector collisionBrushes;
+	BuildUtil::TexPolyVector hintPolygons;
+	BuildUtil::divide_brushes(inputBrushes, renderingBrushes, collisionBrushes, detailBrushes, hintPolygons, specialBrushes);
+
+	std::ostringstream renderingOS, collisionOS, detailOS, hintOS, specialOS;
+	BrushesFile::save(renderingOS, renderingBrushes);
+	BrushesFile::save(collisionOS, collisionBrushes);
+	BrushesFile::save(detailOS, detailBrushes);
+	GeometryFile::save(hintOS, hintPolygons);
+	BrushesFile::save(specialOS, specialBrushes);
+
+	Blobs outputs = make_blobs(renderingOS.str(), collisionOS.str(), detailOS.str());
+	outputs.push_back(hintOS.str());
+	outputs.push_back(specialOS.str());
+	return outputs;
+}
+
+/**
+Expands the collision brushes against each of the object bounds (as per hexpand).
+
+@param inputs	The definitions specifier, the collision brushes and the definitions file
+@return			The expanded brushes for each bounds
+*/
+LevelBuilder::Blobs LevelBuilder::expand_brushes(const Blobs& inputs) const
+{
+	BoundsManager_Ptr boundsManager = load_bounds(inputs[0]);
+
+	std::istringstream is(inputs[1]);
+	BuildUtil::ColPolyBrushVector brushes = BrushesFile::load<CollisionPolygon>(is);
+
+	std::vector<BuildUtil::ColPolyBrushVector> expandedBrushes = BuildUtil::expand_brushes(brushes, boundsManager);
+
+	Blobs outputs;
+	for(size_t i=0, size=expandedBrushes.size(); i<size; ++i)
+	{
+		std::ostringstream os;
+		BrushesFile::save(os, expandedBrushes[i]);
+		outputs.push_back(os.str());
+	}
+	return outputs;
+}
+
+/**
+Generates the navigation data (as per hnav).
+
+@param inputs	The definitions specifier, the polygons and onion tree, and the definitions file
+@return			The navigation data
+*/
+LevelBuilder::Blobs LevelBuilder::generate_nav_data(const Blobs& inputs) const
+{
+	BoundsManager_Ptr boundsManager = load_bounds(inputs[0]);
+
+	ColPolyVector polygons;
+	OnionTree_Ptr tree;
+	std::istringstream is(inputs[1]);
+	OnionTreeFile::load(is, polygons, tree);
+
+	NavManager_Ptr navManager = BuildUtil::generate_nav_data(polygons, tree, boundsManager, m_threadCount);
+
+	std::ostringstream os;
+	NavFile::save(os, navManager);
+	return make_blobs(os.str());
+}
+
+/**
+Generates the onion portals for the onion tree (as per hoportal).
+
+@param inputs	The polygons and onion tree
+@return			The onion portals
+*/
+LevelBuilder::Blobs LevelBuilder::generate_onion_portals(const Blobs& inputs) const
+{
+	ColPolyVector polygons;
+	OnionTree_Ptr tree;
+	std::istringstream is(inputs[0]);
+	OnionTreeFile::load(is, polygons, tree);
+
+	shared_ptr<std::list<OnionPortal_Ptr> > portals = OnionPortalGenerator().generate_portals(tree);
+	std::vector<OnionPortal_Ptr> vec(portals->begin(), portals->end());
+
+	std::ostringstream os;
+	OnionPortalsFile::save(os, vec);
+	return make_blobs(os.str());
+}
+
+//#################### PRIVATE METHODS ####################
+/**
+Collates the results of the other stages into the level file (as per hcollate). This isn't
+cached, since it's cheap and its output has to be written anyway.
+*/
+void LevelBuilder::collate(const std::string& treeBlob, const std::string& lightmapsBlob, const std::string& portalsBlob, const std::string& visBlob,
+						   const std::string& onionTreeBlob, const std::string& onionPortalsBlob, const std::string& navBlob,
+						   const std::string& definitionsSpecifierBlob) const
+{
+	int emptyLeafCount;
+	std::vector<Portal_Ptr> portals;
+	std::istringstream portalsStream(portalsBlob);
+	PortalsFile::load(portalsStream, emptyLeafCount, portals);
+
+	std::istringstream visStream(visBlob);
+	LeafVisTable_Ptr leafVis = VisFile::load(visStream);
+
+	ColPolyVector onionPolygons;
+	OnionTree_Ptr onionTree;
+	std::istringstream onionTreeStream(onionTreeBlob);
+	OnionTreeFile::load(onionTreeStream, onionPolygons, onionTree);
+
+	std::istringstream onionPortalsStream(onionPortalsBlob);
+	std::vector<OnionPortal_Ptr> onionPortals = OnionPortalsFile::load(onionPortalsStream);
+
+	std::istringstream navStream(navBlob);
+	NavManager_Ptr navManager = NavFile::load(navStream);
+
+	std::istringstream dsfStream(definitionsSpecifierBlob);
+	std::string definitionsFilename = DefinitionsSpecifierFile::load(dsfStream);
+
+	bf::path definitionsDir = DirectoryFinder::instance().determine_definitions_directory();
+	BoundsManager_Ptr boundsManager;
+	ComponentPropertyTypeMap componentPropertyTypes;
+	std::map<std::string,ObjectSpecification> archetypes;
+	DefinitionsFile::load((definitionsDir / definitionsFilename).file_string(), boundsManager, componentPropertyTypes, archetypes);
+
+	std::string objectsFilename = (m_levelDir / (m_levelName + ".obs")).file_string();
+	ObjectManager_Ptr objectManager = ObjectsFile::load(objectsFilename, boundsManager, componentPropertyTypes, archetypes);
+
+	std::string outputFilename = (m_levelDir / (m_levelName + ".bsp")).file_string();
+	std::istringstream treeStream(treeBlob);
+	if(m_lit)
+	{
+		std::vector<TexturedLitPolygon_Ptr> polygons;
+		BSPTree_Ptr tree;
+		std::string lightmapPrefix;
+		LitTreeFile::load(treeStream, polygons, tree, lightmapPrefix);
+
+		std::istringstream lightmapsStream(lightmapsBlob);
+		LightmapAtlas_Ptr lightmaps = LightmapsSection::load(lightmapsStream);
+
+		LevelFile::save_lit(outputFilename, polygons, tree, portals, leafVis, lightmaps, onionPolygons, onionTree, onionPortals,
+							navManager, definitionsFilename, objectManager);
+	}
+	else
+	{
+		TexPolyVector polygons;
+		BSPTree_Ptr tree;
+		TreeFile::load(treeStream, polygons, tree);
+
+		LevelFile::save_unlit(outputFilename, polygons, tree, portals, leafVis, onionPolygons, onionTree, onionPortals,
+							  navManager, definitionsFilename, objectManager);
+	}
+}
+
+/**
+Writes an intermediate result to the level directory under the name the hmake script would
+have used for it (if intermediates are being kept).
+
+@param suffix	The part of the filename after the level name (e.g. ".rt1")
+@param blob		The intermediate result
+*/
+void LevelBuilder::keep_intermediate(const std::string& suffix, const std::string& blob) const
+{
+	if(!m_keepIntermediates) return;
+
+	std::string filename = (m_levelDir / (m_levelName + suffix)).file_string();
+	std::ofstream os(filename.c_str(), std::ios_base::binary);
+	if(os.fail()) throw Exception("Could not open " + filename + " for writing");
+	os.write(blob.data(), static_cast<std::streamsize>(blob.length()));
+}
+
+BoundsManager_Ptr LevelBuilder::load_bounds(const std::string& definitionsSpecifierBlob)
+{
+	std::istringstream is(definitionsSpecifierBlob);
+	std::string definitionsFilename = DefinitionsSpecifierFile::load(is);
+	bf::path definitionsDir = DirectoryFinder::instance().determine_definitions_directory();
+	return DefinitionsFile::load_bounds_only((definitionsDir / definitionsFilename).file_string());
+}
+
+std::string LevelBuilder::read_file(const bf::path& path)
+{
+	std::ifstream is(path.file_string().c_str(), std::ios_base::binary);
+	if(is.fail()) throw Exception("Could not open " + path.file_string() + " for reading");
+	std::ostringstream oss;
+	oss << is.rdbuf();
+	return oss.str();
+}
+
+/**
+Runs a stage of the build, or fetches its outputs from the cache if it has already been run
+on the same inputs.
+
+@param stage	The name of the stage
+@param method	The method which implements the stage
+@param inputs	The serialized inputs to the stage
+@return			The serialized outputs of the stage
+*/
+LevelBuilder::Blobs LevelBuilder::run_stage(const std::string& stage, StageMethod method, const Blobs& inputs)
+{
+	std::string key = BuildCache::key(stage, inputs);
+	m_usedKeys.insert(key);
+
+	Blobs outputs;
+	if(m_cache.lookup(key, outputs))
+	{
+		std::cout << stage << ": up to date" << std::endl;
+		++m_cachedStageCount;
+	}
+	else
+	{
+		std::cout << stage << ": running" << std::endl;
+		outputs = (this->*method)(inputs);
+		m_cache.store(key, outputs);
+		++m_ranStageCount;
+	}
+	return outputs;
+}
+
+}
@@ -0,0 +1,92 @@
+/***
+ * hbuild: LevelBuilder.h
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#ifndef H_HBUILD_LEVELBUILDER
+#define H_HBUILD_LEVELBUILDER
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/shared_ptr.hpp>
+using boost::shared_ptr;
+
+#include "BuildCache.h"
+
+namespace hesp {
+
+//#################### FORWARD DECLARATIONS ####################
+typedef shared_ptr<class BoundsManager> BoundsManager_Ptr;
+
+/**
+This class builds a level in-process, running the same stages as the hmake script (mef2input,
+hdivide, hcsg, hbsp, etc.) but handing the intermediate results from one stage to the next in
+memory rather than via files. The handoffs are still in the tools' file formats, since those
+formats round the numbers they contain: that way, the built level is byte-identical to the
+one produced by the script.
+
+The outputs of each stage are cached on disk (see BuildCache), so that rebuilding a level
+after a change only re-runs the stages whose inputs have actually changed.
+*/
+class LevelBuilder
+{
+	//#################### TYPEDEFS ####################
+private:
+	typedef std::vector<std::string> Blobs;
+	typedef Blobs (LevelBuilder::*StageMethod)(const Blobs&) const;
+
+	//#################### PRIVATE VARIABLES ####################
+private:
+	BuildCache m_cache;
+	int m_cachedStageCount;
+	bool m_keepIntermediates;
+	boost::filesystem::path m_levelDir;
+	std::string m_levelName;
+	bool m_lit;
+	int m_ranStageCount;
+	int m_threadCount;
+	std::set<std::string> m_usedKeys;
+
+	//#################### CONSTRUCTORS ####################
+public:
+	LevelBuilder(const boost::filesystem::path& levelDir, const std::string& levelName, bool lit, bool keepIntermediates, int threadCount);
+
+	//#################### PUBLIC METHODS ####################
+public:
+	void build();
+
+	//#################### STAGES ####################
+private:
+	Blobs add_detail(const Blobs& inputs) const;
+	Blobs build_onion_tree(const Blobs& inputs) const;
+	template <typename Poly> Blobs build_tree(const Blobs& inputs) const;
+	Blobs calculate_lighting(const Blobs& inputs) const;
+	Blobs calculate_vis(const Blobs& inputs) const;
+	Blobs convert_mef(const Blobs& inputs) const;
+	Blobs divide_brushes(const Blobs& inputs) const;
+	Blobs expand_brushes(const Blobs& inputs) const;
+	template <typename Poly> Blobs flood_fill(const Blobs& inputs) const;
+	Blobs generate_nav_data(const Blobs& inputs) const;
+	Blobs generate_onion_portals(const Blobs& inputs) const;
+	template <typename Poly> Blobs generate_portals(const Blobs& inputs) const;
+	template <typename Poly> Blobs run_csg(const Blobs& inputs) const;
+
+	//#################### PRIVATE METHODS ####################
+private:
+	void collate(const std::string& treeBlob, const std::string& lightmapsBlob, const std::string& portalsBlob, const std::string& visBlob,
+				 const std::string& onionTreeBlob, const std::string& onionPortalsBlob, const std::string& navBlob,
+				 const std::string& definitionsSpecifierBlob) const;
+	void keep_intermediate(const std::string& filename, const std::string& blob) const;
+	static BoundsManager_Ptr load_bounds(const std::string& definitionsSpecifierBlob);
+	static std::string read_file(const boost::filesystem::path& path);
+	Blobs run_stage(const std::string& stage, StageMethod method, const Blobs& inputs);
+};
+
+}
+
+#include "LevelBuilder.tpp"
+
+#endif
@@ -0,0 +1,132 @@
+/***
+ * hbuild: LevelBuilder.tpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <list>
+#include <sstream>
+
+#include <hesp/build/BuildUtil.h>
+#include <hesp/csg/CSGUtil.h>
+#include <hesp/io/files/BrushesFile.h>
+#include <hesp/io/files/GeometryFile.h>
+#include <hesp/io/files/PortalsFile.h>
+#include <hesp/io/files/TreeFile.h>
+#include <hesp/portals/PortalGenerator.h>
+#include <hesp/trees/BSPCompiler.h>
+
+namespace hesp {
+
+//#################### STAGES ####################
+/**
+Builds a BSP tree from some polygons (as per hbsp).
+
+@param inputs	The polygons, optionally followed by the hint polygons
+@return			The polygons and tree
+*/
+template <typename Poly>
+LevelBuilder::Blobs LevelBuilder::build_tree(const Blobs& inputs) const
+{
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::vector<Poly_Ptr> PolyVector;
+
+	PolyVector polygons;
+	std::istringstream polygonsStream(inputs[0]);
+	GeometryFile::load(polygonsStream, polygons);
+
+	PolyVector hintPolygons;
+	if(inputs.size() > 1)
+	{
+		std::istringstream hintsStream(inputs[1]);
+		GeometryFile::load(hintsStream, hintPolygons);
+	}
+
+	BSPCompiler<Poly> compiler(polygons, hintPolygons, 4, m_threadCount);
+	compiler.build_tree();
+
+	std::ostringstream os;
+	TreeFile::save(os, compiler.polygons(), compiler.tree());
+	return Blobs(1, os.str());
+}
+
+/**
+Discards the polygons which can be reached from outside the level (as per hflood).
+
+@param inputs	The polygons and tree, followed by the portals
+@return			The polygons in the valid leaves
+*/
+template <typename Poly>
+LevelBuilder::Blobs LevelBuilder::flood_fill(const Blobs& inputs) const
+{
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::vector<Poly_Ptr> PolyVector;
+
+	PolyVector polygons;
+	BSPTree_Ptr tree;
+	std::istringstream treeStream(inputs[0]);
+	TreeFile::load(treeStream, polygons, tree);
+
+	int emptyLeafCount;
+	std::vector<Portal_Ptr> portals;
+	std::istringstream portalsStream(inputs[1]);
+	PortalsFile::load(portalsStream, emptyLeafCount, portals);
+
+	PolyVector validPolygons = BuildUtil::flood_fill(polygons, tree, emptyLeafCount, portals);
+
+	std::ostringstream os;
+	GeometryFile::save(os, validPolygons);
+	return Blobs(1, os.str());
+}
+
+/**
+Generates the portals for a BSP tree (as per hportal).
+
+@param inputs	The polygons and tree
+@return			The portals
+*/
+template <typename Poly>
+LevelBuilder::Blobs LevelBuilder::generate_portals(const Blobs& inputs) const
+{
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::vector<Poly_Ptr> PolyVector;
+
+	PolyVector polygons;
+	BSPTree_Ptr tree;
+	std::istringstream is(inputs[0]);
+	TreeFile::load(is, polygons, tree);
+
+	shared_ptr<std::list<Portal_Ptr> > portals = PortalGenerator().generate_portals(tree);
+	std::vector<Portal_Ptr> vec(portals->begin(), portals->end());
+
+	std::ostringstream os;
+	PortalsFile::save(os, tree->empty_leaf_count(), vec);
+	return Blobs(1, os.str());
+}
+
+/**
+Performs a CSG union on some brushes (as per hcsg).
+
+@param inputs	The brushes
+@return			The polygons resulting from the union
+*/
+template <typename Poly>
+LevelBuilder::Blobs LevelBuilder::run_csg(const Blobs& inputs) const
+{
+	typedef typename Poly::Vert Vert;
+	typedef typename Poly::AuxData AuxData;
+	typedef shared_ptr<Poly> Poly_Ptr;
+	typedef std::list<Poly_Ptr> PolyList;
+	typedef shared_ptr<PolyList> PolyList_Ptr;
+
+	std::istringstream is(inputs[0]);
+	std::vector<shared_ptr<PolyhedralBrush<Poly> > > brushes = BrushesFile::load<Poly>(is);
+
+	PolyList_Ptr fragments = CSGUtil<Vert,AuxData>::union_all(brushes, m_threadCount);
+	std::vector<Poly_Ptr> polygons(fragments->begin(), fragments->end());
+
+	std::ostringstream os;
+	GeometryFile::save(os, polygons);
+	return Blobs(1, os.str());
+}
+
+}
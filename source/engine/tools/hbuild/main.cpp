@@ -0,0 +1,68 @@
+/***
+ * hbuild: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+namespace bf = boost::filesystem;
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/util/DirectoryFinder.h>
+#include "LevelBuilder.h"
+using namespace hesp;
+
+//#################### FUNCTIONS ####################
+void quit_with_error(const std::string& error)
+{
+	std::cout << "Error: " << error << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+void quit_with_usage()
+{
+	std::cout << "Usage: hbuild <game> <level> [-u] [-k] [-j<number of threads>]" << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+try
+{
+	if(argc < 3) quit_with_usage();
+	std::vector<std::string> args(argv, argv + argc);
+
+	bool lit = true;
+	bool keepIntermediates = false;
+	int threadCount = 1;
+	for(int i=3; i<argc; ++i)
+	{
+		if(args[i] == "-u") lit = false;
+		else if(args[i] == "-k") keepIntermediates = true;
+		else if(args[i].substr(0,2) == "-j")
+		{
+			try							{ threadCount = lexical_cast<int>(args[i].substr(2)); }
+			catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+			if(threadCount < 1) quit_with_usage();
+		}
+		else quit_with_usage();
+	}
+
+	// Set the appropriate resources directory.
+	DirectoryFinder& finder = DirectoryFinder::instance();
+	finder.set_resources_directory(finder.determine_resources_directory_from_tool(args[1]));
+
+	bf::path levelDir = finder.determine_levels_directory() / args[2];
+	if(!bf::exists(levelDir / (args[2] + ".mef"))) quit_with_error("The specified game or level does not exist");
+
+	LevelBuilder builder(levelDir, args[2], lit, keepIntermediates, threadCount);
+	builder.build();
+	return 0;
+}
+catch(Exception& e) { quit_with_error(e.cause()); }
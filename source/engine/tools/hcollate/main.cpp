@@ -8,16 +8,13 @@
 #include <vector>
 
 #include <boost/filesystem/operations.hpp>
-#include <boost/lexical_cast.hpp>
 namespace bf = boost::filesystem;
-using boost::bad_lexical_cast;
-using boost::lexical_cast;
 
 #include <hesp/exceptions/Exception.h>
-#include <hesp/images/PNGLoader.h>
 #include <hesp/io/files/DefinitionsFile.h>
 #include <hesp/io/files/DefinitionsSpecifierFile.h>
 #include <hesp/io/files/LevelFile.h>
+#include <hesp/io/files/LightmapsFile.h>
 #include <hesp/io/files/LitTreeFile.h>
 #include <hesp/io/files/NavFile.h>
 #include <hesp/io/files/ObjectsFile.h>
@@ -67,13 +64,8 @@ try
 	LeafVisTable_Ptr leafVis = VisFile::load(visFilename);
 
 	// Load the lightmaps.
-	int polyCount = static_cast<int>(polygons.size());
-	std::vector<Image24_Ptr> lightmaps(polyCount);
-	for(int i=0; i<polyCount; ++i)
-	{
-		std::string filename = lightmapPrefix + lexical_cast<std::string>(i) + ".png";
-		lightmaps[i] = PNGLoader::load_image24(filename);
-	}
+	LightmapAtlas_Ptr lightmaps = LightmapsFile::load(lightmapPrefix + ".lmp");
+	if(lightmaps->polygon_pages().size() != polygons.size()) throw Exception("The lightmaps file does not match the lit tree");
 
 	// Load the onion tree.
 	typedef std::vector<CollisionPolygon_Ptr> ColPolyVector;
@@ -7,6 +7,10 @@
 #include <string>
 #include <vector>
 
+#include <boost/lexical_cast.hpp>
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
+
 #include <hesp/csg/CSGUtil.h>
 #include <hesp/exceptions/Exception.h>
 #include <hesp/io/files/BrushesFile.h>
@@ -23,12 +27,12 @@ void quit_with_error(const std::string& error)
 
 void quit_with_usage()
 {
-	std::cout << "Usage: hcsg {-r|-c} <input brushes> <output geometry>" << std::endl;
+	std::cout << "Usage: hcsg {-r|-c} <input brushes> <output geometry> [-j<threads>]" << std::endl;
 	exit(EXIT_FAILURE);
 }
 
 template <typename Poly>
-void run_csg(const std::string& inputFilename, const std::string& outputFilename)
+void run_csg(const std::string& inputFilename, const std::string& outputFilename, int threadCount)
 {
 	typedef typename Poly::Vert Vert;
 	typedef typename Poly::AuxData AuxData;
@@ -43,7 +47,7 @@ void run_csg(const std::string& inputFilename, const std::string& outputFilename
 	typedef shared_ptr<Poly> Poly_Ptr;
 	typedef std::list<Poly_Ptr> PolyList;
 	typedef shared_ptr<PolyList> PolyList_Ptr;
-	PolyList_Ptr fragments = CSGUtil<Vert,AuxData>::union_all(brushes);
+	PolyList_Ptr fragments = CSGUtil<Vert,AuxData>::union_all(brushes, threadCount);
 
 	// Write the polygons to disk.
 	std::vector<Poly_Ptr> polygons(fragments->begin(), fragments->end());
@@ -53,11 +57,22 @@ void run_csg(const std::string& inputFilename, const std::string& outputFilename
 int main(int argc, char *argv[])
 try
 {
-	if(argc != 4) quit_with_usage();
+	if(argc != 4 && argc != 5) quit_with_usage();
 	std::vector<std::string> args(argv, argv + argc);
 
-	if(args[1] == "-r") run_csg<TexturedPolygon>(args[2], args[3]);
-	else if(args[1] == "-c") run_csg<CollisionPolygon>(args[2], args[3]);
+	int threadCount = 1;
+	if(argc == 5)
+	{
+		if(args[4].substr(0,2) != "-j") quit_with_usage();
+
+		try							{ threadCount = lexical_cast<int>(args[4].substr(2)); }
+		catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+		if(threadCount < 1) quit_with_usage();
+	}
+
+	if(args[1] == "-r") run_csg<TexturedPolygon>(args[2], args[3], threadCount);
+	else if(args[1] == "-c") run_csg<CollisionPolygon>(args[2], args[3], threadCount);
 	else quit_with_usage();
 
 	return 0;
@@ -4,26 +4,18 @@
  ***/
 
 #include <iostream>
-#include <list>
 #include <string>
 #include <vector>
 
-#include <hesp/brushes/PolyhedralBrush.h>
-#include <hesp/csg/CSGUtil.h>
+#include <hesp/build/BuildUtil.h>
 #include <hesp/exceptions/Exception.h>
 #include <hesp/io/files/BrushesFile.h>
 #include <hesp/io/files/TreeFile.h>
-#include <hesp/trees/BSPUtil.h>
-#include <hesp/util/PolygonTypes.h>
 using namespace hesp;
 
 //#################### TYPEDEFS ####################
-typedef std::list<TexturedPolygon_Ptr> TexPolyList;
-typedef shared_ptr<TexPolyList> TexPolyList_Ptr;
-typedef std::vector<TexturedPolygon_Ptr> TexPolyVector;
-typedef PolyhedralBrush<TexturedPolygon> TexPolyBrush;
-typedef shared_ptr<TexPolyBrush> TexPolyBrush_Ptr;
-typedef std::vector<TexPolyBrush_Ptr> TexPolyBrushVector;
+typedef BuildUtil::TexPolyBrushVector TexPolyBrushVector;
+typedef BuildUtil::TexPolyVector TexPolyVector;
 
 //#################### FUNCTIONS ####################
 void quit_with_error(const std::string& error)
@@ -41,36 +33,14 @@ void quit_with_usage()
 void run_detailer(const std::string& inputBSPFilename, const std::string& inputDetailGeometryFilename,
 				  const std::string& outputBSPFilename)
 {
-	typedef TexturedPolygon::Vert Vert;
-	typedef TexturedPolygon::AuxData AuxData;
-
 	// Read in the polygons and tree.
 	TexPolyVector polygons;
 	BSPTree_Ptr tree;
 	TreeFile::load(inputBSPFilename, polygons, tree);
 
-	// Read in the detail brushes and perform a CSG union on them.
+	// Read in the detail brushes and add them to the tree.
 	TexPolyBrushVector detailBrushes = BrushesFile::load<TexturedPolygon>(inputDetailGeometryFilename);
-	TexPolyList_Ptr detailFaces = CSGUtil<Vert,AuxData>::union_all(detailBrushes);
-
-	// Clip the detail faces to the tree.
-	TexPolyList fragments = CSGUtil<Vert,AuxData>::clip_polygons_to_tree(*detailFaces, tree, true);
-
-	// Add the face fragments to the polygons array.
-	int firstFragment = static_cast<int>(polygons.size());
-	std::copy(fragments.begin(), fragments.end(), std::back_inserter(polygons));
-	int lastFragment = static_cast<int>(polygons.size()) - 1;
-
-	// Add the face fragments to the relevant leaves.
-	for(int i=firstFragment; i<=lastFragment; ++i)
-	{
-		std::list<int> leafIndices = BSPUtil::find_leaf_indices(*polygons[i], tree);
-		for(std::list<int>::const_iterator jt=leafIndices.begin(), jend=leafIndices.end(); jt!=jend; ++jt)
-		{
-			BSPLeaf *leaf = tree->leaf(*jt);
-			leaf->add_polygon_index(i);
-		}
-	}
+	BuildUtil::add_detail(polygons, tree, detailBrushes);
 
 	// Write the modified polygon array and tree to disk.
 	TreeFile::save(outputBSPFilename, polygons, tree);
@@ -16,7 +16,7 @@ using boost::bad_lexical_cast;
 using boost::lexical_cast;
 
 #include <hesp/bounds/BoundsManager.h>
-#include <hesp/brushes/BrushExpander.h>
+#include <hesp/build/BuildUtil.h>
 #include <hesp/io/files/BrushesFile.h>
 #include <hesp/io/files/DefinitionsFile.h>
 #include <hesp/io/files/DefinitionsSpecifierFile.h>
@@ -47,9 +47,7 @@ void run_expander(const std::string& definitionsSpecifierFilename, const std::st
 	BoundsManager_Ptr boundsManager = DefinitionsFile::load_bounds_only((definitionsDir / definitionsFilename).file_string());
 
 	// Read in the input brushes.
-	typedef PolyhedralBrush<CollisionPolygon> ColPolyBrush;
-	typedef shared_ptr<ColPolyBrush> ColPolyBrush_Ptr;
-	typedef std::vector<ColPolyBrush_Ptr> ColPolyBrushVector;
+	typedef BuildUtil::ColPolyBrushVector ColPolyBrushVector;
 	ColPolyBrushVector inputBrushes = BrushesFile::load<CollisionPolygon>(inputFilename);
 
 	// Calculate the output stem and extension.
@@ -60,22 +58,16 @@ void run_expander(const std::string& definitionsSpecifierFilename, const std::st
 
 	const std::string outputExtension = ".ebr";
 
-	// For each bounds, expand the brushes and write the expanded brushes to file.
-	int boundsCount = boundsManager->bounds_count();
-	int brushCount = static_cast<int>(inputBrushes.size());
+	// Expand the brushes for each bounds.
+	std::vector<ColPolyBrushVector> expandedBrushes = BuildUtil::expand_brushes(inputBrushes, boundsManager);
+
+	// Write the expanded brushes for each bounds to file.
+	int boundsCount = static_cast<int>(expandedBrushes.size());
 	for(int i=0; i<boundsCount; ++i)
 	{
-		// Expand the brushes.
-		ColPolyBrushVector expandedBrushes(brushCount);
-		for(int j=0; j<brushCount; ++j)
-		{
-			expandedBrushes[j] = BrushExpander::expand_brush(inputBrushes[j], *boundsManager->bounds(i), i);
-		}
-
-		// Write the expanded brushes to file.
 		std::ostringstream oss;
 		oss << outputStem << i << outputExtension;
-		BrushesFile::save(oss.str(), expandedBrushes);
+		BrushesFile::save(oss.str(), expandedBrushes[i]);
 	}
 }
 
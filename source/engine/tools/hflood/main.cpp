@@ -3,17 +3,14 @@
  * Copyright Stuart Golodetz, 2008. All rights reserved.
  ***/
 
-#include <cmath>
 #include <iostream>
-#include <map>
-#include <set>
 #include <string>
 #include <vector>
 
+#include <hesp/build/BuildUtil.h>
 #include <hesp/io/files/GeometryFile.h>
 #include <hesp/io/files/PortalsFile.h>
 #include <hesp/io/files/TreeFile.h>
-#include <hesp/trees/TreeUtil.h>
 #include <hesp/util/PolygonTypes.h>
 using namespace hesp;
 
@@ -30,29 +27,6 @@ void quit_with_usage()
 	exit(EXIT_FAILURE);
 }
 
-void flood_from(int leaf, const std::map<int,std::vector<Portal_Ptr> >& portalsFromLeaf, std::set<int>& reachableLeaves)
-{
-	reachableLeaves.insert(leaf);
-
-	std::map<int,std::vector<Portal_Ptr> >::const_iterator it = portalsFromLeaf.find(leaf);
-	if(it != portalsFromLeaf.end())
-	{
-		const std::vector<Portal_Ptr>& outPortals = it->second;
-		int outPortalCount = static_cast<int>(outPortals.size());
-		for(int j=0; j<outPortalCount; ++j)
-		{
-			Portal_Ptr outPortal = outPortals[j];
-			int toLeaf = outPortal->auxiliary_data().toLeaf;
-
-			// If the destination of this portal is already marked as reachable, don't recurse.
-			if(reachableLeaves.find(toLeaf) != reachableLeaves.end()) continue;
-
-			// Otherwise, recursively flood from the leaf on the other side of this portal.
-			flood_from(toLeaf, portalsFromLeaf, reachableLeaves);
-		}
-	}
-}
-
 template <typename Poly>
 void run_flood(const std::string& treeFilename, const std::string& portalsFilename, const std::string& outputFilename)
 {
@@ -68,38 +42,8 @@ void run_flood(const std::string& treeFilename, const std::string& portalsFilena
 	std::vector<Portal_Ptr> portals;
 	PortalsFile::load(portalsFilename, emptyLeafCount, portals);
 
-	// Build the "portals from leaf" data structure.
-	std::map<int,std::vector<Portal_Ptr> > portalsFromLeaf;
-	for(std::vector<Portal_Ptr>::const_iterator it=portals.begin(), iend=portals.end(); it!=iend; ++it)
-	{
-		int fromLeaf = (*it)->auxiliary_data().fromLeaf;
-		portalsFromLeaf[fromLeaf].push_back(*it);
-	}
-
-	// Flood from an arbitrary point outside the level to figure out which leaves aren't valid.
-	int startLeaf = TreeUtil::find_leaf_index(Vector3d(100000, 0, 0), tree);
-
-	std::set<int> reachableLeaves;
-	flood_from(startLeaf, portalsFromLeaf, reachableLeaves);
-
-	// Determine the set of valid leaves, i.e. the ones which aren't reachable from outside the level.
-	std::set<int> emptyLeaves;
-	for(int i=0; i<emptyLeafCount; ++i) emptyLeaves.insert(i);
-	std::set<int> validLeaves;
-	std::set_difference(emptyLeaves.begin(), emptyLeaves.end(), reachableLeaves.begin(), reachableLeaves.end(), std::inserter(validLeaves, validLeaves.end()));
-
-	// Copy all the polygons from them to an array.
-	PolyVector validPolygons;
-	validPolygons.reserve(polygons.size());
-	for(std::set<int>::const_iterator it=validLeaves.begin(), iend=validLeaves.end(); it!=iend; ++it)
-	{
-		const BSPLeaf *leaf = tree->leaf(*it);
-		const std::vector<int>& polyIndices = leaf->polygon_indices();
-		for(std::vector<int>::const_iterator jt=polyIndices.begin(), jend=polyIndices.end(); jt!=jend; ++jt)
-		{
-			validPolygons.push_back(polygons[*jt]);
-		}
-	}
+	// Flood-fill the level to find the polygons in the valid leaves.
+	PolyVector validPolygons = BuildUtil::flood_fill(polygons, tree, emptyLeafCount, portals);
 
 	// Write the polygons to the output file.
 	GeometryFile::save(outputFilename, validPolygons);
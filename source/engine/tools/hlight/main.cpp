@@ -3,6 +3,7 @@
  * Copyright Stuart Golodetz, 2008. All rights reserved.
  ***/
 
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -11,12 +12,13 @@
 using boost::bad_lexical_cast;
 using boost::lexical_cast;
 
-#include <hesp/images/PNGSaver.h>
+#include <hesp/io/files/LightmapsFile.h>
 #include <hesp/io/files/LightsFile.h>
 #include <hesp/io/files/LitTreeFile.h>
 #include <hesp/io/files/TreeFile.h>
 #include <hesp/io/files/VisFile.h>
 #include <hesp/lighting/Lightmap.h>
+#include <hesp/lighting/LightmapAtlas.h>
 #include <hesp/lighting/LightmapGenerator.h>
 #include <hesp/util/PolygonTypes.h>
 using namespace hesp;
@@ -30,12 +32,12 @@ void quit_with_error(const std::string& error)
 
 void quit_with_usage()
 {
-	std::cout << "Usage: hlight <input tree> <input vis> <input lights> <lightmap file prefix> <output filename>" << std::endl;
+	std::cout << "Usage: hlight <input tree> <input vis> <input lights> <lightmap file prefix> <output filename> [-j<number of threads>]" << std::endl;
 	exit(EXIT_FAILURE);
 }
 
 void run_generator(const std::string& treeFilename, const std::string& visFilename, const std::string& lightsFilename,
-				   const std::string& lightmapPrefix, const std::string& outputFilename)
+				   const std::string& lightmapPrefix, const std::string& outputFilename, int threadCount)
 try		// <--- Note the "function try" syntax (this is a rarely-used C++ construct).
 {
 	// Read in the polygons and tree.
@@ -50,7 +52,7 @@ try		// <--- Note the "function try" syntax (this is a rarely-used C++ construct
 	std::vector<Light> lights = LightsFile::load(lightsFilename);
 
 	// Generate the lit polygons and lightmaps.
-	LightmapGenerator lg(polygons, lights, tree, leafVis);
+	LightmapGenerator lg(polygons, lights, tree, leafVis, threadCount);
 	lg.generate_lightmaps();
 
 	typedef std::vector<Lightmap_Ptr> LightmapVector;
@@ -58,27 +60,36 @@ try		// <--- Note the "function try" syntax (this is a rarely-used C++ construct
 	typedef std::vector<TexturedLitPolygon_Ptr> TexLitPolyVector;
 	typedef shared_ptr<const TexLitPolyVector> TexLitPolyVector_CPtr;
 
-	TexLitPolyVector_CPtr litPolygons = lg.lit_polygons();
+	TexLitPolyVector litPolygons = *lg.lit_polygons();
 	LightmapVector_CPtr lightmaps = lg.lightmaps();
 
+	// Pack the lightmaps into atlas pages (this rewrites the lightmap coordinates of the lit polygons).
+	LightmapAtlas_Ptr atlas = LightmapAtlas::pack(*lightmaps, litPolygons);
+
 	// Write the lit polygons, tree and lightmap prefix to the output file.
-	LitTreeFile::save(outputFilename, *litPolygons, tree, lightmapPrefix);
+	LitTreeFile::save(outputFilename, litPolygons, tree, lightmapPrefix);
 
-	// Write the lightmaps out as 24-bit bitmaps.
-	int lightmapCount = static_cast<int>(lightmaps->size());
-	for(int i=0; i<lightmapCount; ++i)
-	{
-		std::string lightmapFilename = lightmapPrefix + lexical_cast<std::string>(i) + ".png";
-		Image24_Ptr image = (*lightmaps)[i]->to_image();
-		PNGSaver::save_image24(lightmapFilename, image);
-	}
+	// Write the lightmap atlas to the lightmaps file.
+	LightmapsFile::save(lightmapPrefix + ".lmp", atlas);
 }
 catch(Exception& e) { quit_with_error(e.cause()); }
 
 int main(int argc, char *argv[])
 {
-	if(argc != 6) quit_with_usage();
+	if(argc != 6 && argc != 7) quit_with_usage();
 	std::vector<std::string> args(argv, argv + argc);
-	run_generator(args[1], args[2], args[3], args[4], args[5]);
+
+	int threadCount = 1;
+	if(argc == 7)
+	{
+		if(args[6].substr(0,2) != "-j") quit_with_usage();
+
+		try							{ threadCount = lexical_cast<int>(args[6].substr(2)); }
+		catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+		if(threadCount < 1) quit_with_usage();
+	}
+
+	run_generator(args[1], args[2], args[3], args[4], args[5], threadCount);
 	return 0;
 }
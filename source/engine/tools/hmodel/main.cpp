@@ -0,0 +1,54 @@
+/***
+ * hmodel: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/files/ModelFiles.h>
+using namespace hesp;
+
+//#################### FUNCTIONS ####################
+void quit_with_error(const std::string& error)
+{
+	std::cout << "Error: " << error << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+void quit_with_usage()
+{
+	std::cout << "Usage: hmodel <input .mesh.xml or .skeleton.xml filename> <output filename>" << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+bool ends_with(const std::string& s, const std::string& suffix)
+{
+	return s.length() >= suffix.length() && s.substr(s.length() - suffix.length()) == suffix;
+}
+
+void compile_model_file(const std::string& inputFilename, const std::string& outputFilename)
+try
+{
+	if(ends_with(inputFilename, ".mesh.xml"))
+	{
+		ModelFiles::save_compiled_mesh_data(outputFilename, ModelFiles::load_mesh_data(inputFilename));
+	}
+	else if(ends_with(inputFilename, ".skeleton.xml"))
+	{
+		ModelFiles::save_compiled_skeleton_data(outputFilename, ModelFiles::load_skeleton_data(inputFilename));
+	}
+	else quit_with_usage();
+}
+catch(Exception& e) { quit_with_error(e.cause()); }
+
+int main(int argc, char *argv[])
+{
+	if(argc != 3) quit_with_usage();
+	std::vector<std::string> args(argv, argv + argc);
+	compile_model_file(args[1], args[2]);
+	return 0;
+}
@@ -8,22 +8,20 @@
 #include <vector>
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
 namespace bf = boost::filesystem;
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
 
-#include <hesp/bounds/Bounds.h>
 #include <hesp/bounds/BoundsManager.h>
+#include <hesp/build/BuildUtil.h>
 #include <hesp/exceptions/Exception.h>
 #include <hesp/io/files/DefinitionsFile.h>
 #include <hesp/io/files/DefinitionsSpecifierFile.h>
 #include <hesp/io/files/NavFile.h>
 #include <hesp/io/files/OnionTreeFile.h>
 #include <hesp/io/util/DirectoryFinder.h>
-#include <hesp/nav/AdjacencyList.h>
-#include <hesp/nav/AdjacencyTable.h>
-#include <hesp/nav/NavDataset.h>
 #include <hesp/nav/NavManager.h>
-#include <hesp/nav/NavMeshGenerator.h>
-#include <hesp/nav/PathTableGenerator.h>
 #include <hesp/util/PolygonTypes.h>
 using namespace hesp;
 
@@ -36,11 +34,11 @@ void quit_with_error(const std::string& error)
 
 void quit_with_usage()
 {
-	std::cout << "Usage: hnav <input definitions specifier> <input onion tree> <output nav file>" << std::endl;
+	std::cout << "Usage: hnav <input definitions specifier> <input onion tree> <output nav file> [-j<number of threads>]" << std::endl;
 	exit(EXIT_FAILURE);
 }
 
-void run(const std::string& definitionsSpecifierFilename, const std::string& treeFilename, const std::string& outputFilename)
+void run(const std::string& definitionsSpecifierFilename, const std::string& treeFilename, const std::string& outputFilename, int threadCount)
 {
 	typedef std::vector<CollisionPolygon_Ptr> ColPolyVector;
 
@@ -56,48 +54,8 @@ void run(const std::string& definitionsSpecifierFilename, const std::string& tre
 	OnionTree_Ptr tree;
 	OnionTreeFile::load(treeFilename, polygons, tree);
 
-	// Check that the number of bounds and the number of maps in the tree match up.
-	int boundsCount = boundsManager->bounds_count();
-	int mapCount = tree->map_count();
-	if(boundsCount != mapCount) throw Exception("There must be exactly one bounds per map in the onion tree");
-
-	NavManager_Ptr navManager(new NavManager);
-
-	// For each separate map.
-	for(int i=0; i<mapCount; ++i)
-	{
-		// Skip this map if the bounds for it has its nav flag set to false.
-		if(!boundsManager->nav_flags()[i]) continue;
-
-		// Make a copy of the polygon array in which all the polygons that aren't
-		// in this map are set to non-walkable.
-		int polyCount = static_cast<int>(polygons.size());
-		ColPolyVector mapPolygons(polyCount);
-		for(int j=0; j<polyCount; ++j)
-		{
-			mapPolygons[j].reset(new CollisionPolygon(*polygons[j]));
-			if(mapPolygons[j]->auxiliary_data().map_index() != i)
-				mapPolygons[j]->auxiliary_data().set_walkable(false);
-		}
-
-		// Generate the navigation mesh.
-		double maxHeightDifference = boundsManager->bounds(i)->height() / 2;
-		NavMeshGenerator generator(mapPolygons, maxHeightDifference);
-		NavMesh_Ptr mesh = generator.generate_mesh();
-
-		// Build the navigation graph adjacency list.
-		AdjacencyList_Ptr adjList(new AdjacencyList(mesh));
-
-		// Build the navigation graph adjacency table (note that this is a very inefficient
-		// representation for the sparse graph in terms of space, but it's needed for the
-		// Floyd-Warshall algorithm used when building the path table).
-		AdjacencyTable adjTable(*adjList);
-
-		// Generate the path table.
-		PathTable_Ptr pathTable = PathTableGenerator::floyd_warshall(adjTable);
-
-		navManager->set_dataset(i, NavDataset_Ptr(new NavDataset(adjList, mesh, pathTable)));
-	}
+	// Generate the navigation datasets.
+	NavManager_Ptr navManager = BuildUtil::generate_nav_data(polygons, tree, boundsManager, threadCount);
 
 	// Write the navigation datasets to disk.
 	NavFile::save(outputFilename, navManager);
@@ -106,15 +64,26 @@ void run(const std::string& definitionsSpecifierFilename, const std::string& tre
 int main(int argc, char *argv[])
 try
 {
-	if(argc != 4) quit_with_usage();
+	if(argc != 4 && argc != 5) quit_with_usage();
 	std::vector<std::string> args(argv, argv + argc);
 
+	int threadCount = 1;
+	if(argc == 5)
+	{
+		if(args[4].substr(0,2) != "-j") quit_with_usage();
+
+		try							{ threadCount = lexical_cast<int>(args[4].substr(2)); }
+		catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+		if(threadCount < 1) quit_with_usage();
+	}
+
 	// Set the appropriate resources directory.
 	// FIXME: The game to use shouldn't be hard-coded like this.
 	DirectoryFinder& finder = DirectoryFinder::instance();
 	finder.set_resources_directory(finder.determine_resources_directory_from_tool("ScarletPimpernel"));
 
-	run(args[1], args[2], args[3]);
+	run(args[1], args[2], args[3], threadCount);
 	return 0;
 }
 catch(Exception& e) { quit_with_error(e.cause()); }
@@ -0,0 +1,243 @@
+/***
+ * hsim: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
+using boost::uint64_t;
+
+#include <hesp/axes/NUVAxes.h>
+#include <hesp/exceptions/Exception.h>
+#include <hesp/input/InputState.h>
+#include <hesp/io/files/InputScriptFile.h>
+#include <hesp/io/files/LevelFile.h>
+#include <hesp/io/util/DirectoryFinder.h>
+#include <hesp/level/Level.h>
+#include <hesp/objects/base/ObjectManager.h>
+#include <hesp/objects/components/ICmpHealth.h>
+#include <hesp/objects/components/ICmpOrientation.h>
+#include <hesp/objects/components/ICmpPosition.h>
+#include <hesp/objects/components/ICmpSimulation.h>
+#include <hesp/physics/PhysicsSystem.h>
+using namespace hesp;
+
+//#################### TYPEDEFS ####################
+typedef Level::UpdateTimings UpdateTimings;
+
+//#################### FUNCTIONS ####################
+void quit_with_error(const std::string& error)
+{
+	std::cout << "Error: " << error << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+void quit_with_usage()
+{
+	std::cout << "Usage: hsim <input level> <tick count> [-t<tick length in ms>] [-i<input script>] [-c<output checksums>] [-b<path query budget in us>] [-j<physics thread count>]" << std::endl;
+	exit(EXIT_FAILURE);
+}
+
+void fnv1a(uint64_t& h, const void *data, size_t length)
+{
+	const uint64_t FNV_PRIME = (uint64_t(1) << 40) + 0x1b3;
+	const unsigned char *bytes = static_cast<const unsigned char*>(data);
+	for(size_t i=0; i<length; ++i)
+	{
+		h ^= bytes[i];
+		h *= FNV_PRIME;
+	}
+}
+
+void fnv1a(uint64_t& h, int i)
+{
+	fnv1a(h, &i, sizeof(int));
+}
+
+void fnv1a(uint64_t& h, const Vector3d& v)
+{
+	fnv1a(h, &v.x, sizeof(double));
+	fnv1a(h, &v.y, sizeof(double));
+	fnv1a(h, &v.z, sizeof(double));
+}
+
+bool has_position(const ObjectID& id, const ObjectManager *objectManager)
+{
+	return objectManager->get_component<ICmpPosition>(id) != NULL;
+}
+
+/**
+Calculates a checksum of the simulation state of a level, namely the position, velocity,
+orientation and health of each of its positioned objects. The doubles are hashed bit-for-bit,
+so two runs only produce the same checksum if their simulations are bitwise identical.
+*/
+uint64_t calculate_checksum(const ObjectManager_Ptr& objectManager)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	fnv1a(h, objectManager->object_count());
+
+	std::vector<ObjectID> ids = objectManager->group("Positionables");
+	std::sort(ids.begin(), ids.end());
+	for(std::vector<ObjectID>::const_iterator it=ids.begin(), iend=ids.end(); it!=iend; ++it)
+	{
+		fnv1a(h, it->value());
+
+		ICmpPosition_CPtr cmpPosition = objectManager->get_component<ICmpPosition>(*it);
+		fnv1a(h, cmpPosition->position());
+
+		ICmpSimulation_CPtr cmpSimulation = objectManager->get_component<ICmpSimulation>(*it);
+		if(cmpSimulation) fnv1a(h, cmpSimulation->velocity());
+
+		ICmpOrientation_CPtr cmpOrientation = objectManager->get_component<ICmpOrientation>(*it);
+		if(cmpOrientation)
+		{
+			NUVAxes_CPtr nuvAxes = cmpOrientation->nuv_axes();
+			fnv1a(h, nuvAxes->n());
+			fnv1a(h, nuvAxes->u());
+			fnv1a(h, nuvAxes->v());
+		}
+
+		ICmpHealth_CPtr cmpHealth = objectManager->get_component<ICmpHealth>(*it);
+		if(cmpHealth) fnv1a(h, cmpHealth->health());
+	}
+
+	return h;
+}
+
+void accumulate_timing(int t, int& total, int& maximum)
+{
+	total += t;
+	maximum = std::max(maximum, t);
+}
+
+void print_timing(const std::string& phase, int total, int maximum, int tickCount)
+{
+	std::cout << std::left << std::setw(20) << phase << std::right
+			  << std::setw(12) << total
+			  << std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(total) / tickCount
+			  << std::setw(12) << maximum << std::endl;
+}
+
+std::string to_hex(uint64_t h)
+{
+	std::ostringstream os;
+	os << std::hex << std::setw(16) << std::setfill('0') << h;
+	return os.str();
+}
+
+int main(int argc, char *argv[])
+try
+{
+	if(argc < 3) quit_with_usage();
+	std::vector<std::string> args(argv, argv + argc);
+
+	int tickCount;
+	try							{ tickCount = lexical_cast<int>(args[2]); }
+	catch(bad_lexical_cast&)	{ quit_with_usage(); }
+	if(tickCount < 1) quit_with_usage();
+
+	// Note:	The path query budget is unlimited by default, so that the results of the
+	//			simulation don't depend on the speed of the machine running it.
+	int tickMilliseconds = 16;
+	int pathQueryBudget = -1;
+	int physicsThreadCount = 1;
+	std::string scriptFilename, checksumsFilename;
+	for(int i=3; i<argc; ++i)
+	{
+		std::string flag = args[i].substr(0,2), value = args[i].substr(2);
+		if(flag == "-i" && !value.empty()) scriptFilename = value;
+		else if(flag == "-c" && !value.empty()) checksumsFilename = value;
+		else if(flag == "-t" || flag == "-b" || flag == "-j")
+		{
+			int n;
+			try							{ n = lexical_cast<int>(value); }
+			catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+			if(flag == "-b") pathQueryBudget = n;
+			else if(n < 1) quit_with_usage();
+			else if(flag == "-t") tickMilliseconds = n;
+			else physicsThreadCount = n;
+		}
+		else quit_with_usage();
+	}
+
+	// FIXME: The game to use shouldn't be hard-coded like this.
+	DirectoryFinder& finder = DirectoryFinder::instance();
+	finder.set_resources_directory(finder.determine_resources_directory_from_tool("ScarletPimpernel"));
+
+	// Load the level, skipping the data which is only needed to render it.
+	Level_Ptr level = LevelFile::load(args[1], false);
+	level->set_path_query_budget(pathQueryBudget);
+
+	// The physics system is always run in deterministic mode, so that the checksums don't depend on the number of threads used.
+	ObjectManager_Ptr objectManager = level->object_manager();
+	objectManager->physics_system()->set_thread_count(physicsThreadCount);
+	objectManager->physics_system()->set_deterministic(true);
+	objectManager->register_group("Positionables", has_position);
+
+	InputScript_CPtr script;
+	if(!scriptFilename.empty()) script = InputScriptFile::load(scriptFilename);
+
+	std::ofstream checksumsStream;
+	if(!checksumsFilename.empty())
+	{
+		checksumsStream.open(checksumsFilename.c_str());
+		if(checksumsStream.fail()) quit_with_error("The checksums file could not be opened for writing");
+	}
+
+	// Run the simulation.
+	UpdateTimings totals = {0,0,0,0,0,0,0}, maxima = {0,0,0,0,0,0,0};
+	InputState input;
+	uint64_t checksum = 0;
+
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+	for(int tick=0; tick<tickCount; ++tick)
+	{
+		if(script) script->apply(tick, input);
+
+		UpdateTimings timings;
+		level->update(tickMilliseconds, input, &timings);
+
+		accumulate_timing(timings.yokes, totals.yokes, maxima.yokes);
+		accumulate_timing(timings.pathQueries, totals.pathQueries, maxima.pathQueries);
+		accumulate_timing(timings.physics, totals.physics, maxima.physics);
+		accumulate_timing(timings.animations, totals.animations, maxima.animations);
+		accumulate_timing(timings.activatables, totals.activatables, maxima.activatables);
+		accumulate_timing(timings.queueFlushes, totals.queueFlushes, maxima.queueFlushes);
+		accumulate_timing(timings.messageBroadcast, totals.messageBroadcast, maxima.messageBroadcast);
+
+		checksum = calculate_checksum(objectManager);
+		if(checksumsStream.is_open()) checksumsStream << tick << ' ' << to_hex(checksum) << '\n';
+	}
+	boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+
+	// Report the timings.
+	std::cout << std::left << std::setw(20) << "Phase" << std::right
+			  << std::setw(12) << "Total (us)" << std::setw(12) << "Mean (us)" << std::setw(12) << "Max (us)" << std::endl;
+	print_timing("Yokes", totals.yokes, maxima.yokes, tickCount);
+	print_timing("Path queries", totals.pathQueries, maxima.pathQueries, tickCount);
+	print_timing("Physics", totals.physics, maxima.physics, tickCount);
+	print_timing("Animations", totals.animations, maxima.animations, tickCount);
+	print_timing("Activatables", totals.activatables, maxima.activatables, tickCount);
+	print_timing("Queue flushes", totals.queueFlushes, maxima.queueFlushes, tickCount);
+	print_timing("Message broadcast", totals.messageBroadcast, maxima.messageBroadcast, tickCount);
+
+	double seconds = elapsed.total_microseconds() / 1000000.0;
+	std::cout << '\n' << tickCount << " ticks in " << std::setprecision(3) << seconds << "s";
+	if(seconds > 0) std::cout << " (" << std::setprecision(1) << tickCount / seconds << " ticks/s)";
+	std::cout << "\nFinal checksum: " << to_hex(checksum) << std::endl;
+
+	return 0;
+}
+catch(Exception& e) { quit_with_error(e.cause()); }
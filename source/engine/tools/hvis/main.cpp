@@ -3,10 +3,15 @@
  * Copyright Stuart Golodetz, 2008. All rights reserved.
  ***/
 
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include <boost/lexical_cast.hpp>
+using boost::bad_lexical_cast;
+using boost::lexical_cast;
+
 #include <hesp/io/files/PortalsFile.h>
 #include <hesp/io/files/VisFile.h>
 #include <hesp/vis/VisCalculator.h>
@@ -21,11 +26,11 @@ void quit_with_error(const std::string& error)
 
 void quit_with_usage()
 {
-	std::cout << "Usage: hvis <input filename> <output filename>" << std::endl;
+	std::cout << "Usage: hvis <input filename> <output filename> [-j<number of threads>]" << std::endl;
 	exit(EXIT_FAILURE);
 }
 
-void run_calculator(const std::string& inputFilename, const std::string& outputFilename)
+void run_calculator(const std::string& inputFilename, const std::string& outputFilename, int threadCount)
 try
 {
 	// Read in the empty leaf count and portals.
@@ -34,7 +39,7 @@ try
 	PortalsFile::load(inputFilename, emptyLeafCount, portals);
 
 	// Run the visibility calculator.
-	VisCalculator visCalc(emptyLeafCount, portals);
+	VisCalculator visCalc(emptyLeafCount, portals, threadCount);
 	LeafVisTable_Ptr leafVis = visCalc.calculate_leaf_vis_table();
 
 	// Write the leaf visibility table to the output file.
@@ -44,8 +49,20 @@ catch(Exception& e) { quit_with_error(e.cause()); }
 
 int main(int argc, char *argv[])
 {
-	if(argc != 3) quit_with_usage();
+	if(argc != 3 && argc != 4) quit_with_usage();
 	std::vector<std::string> args(argv, argv + argc);
-	run_calculator(args[1], args[2]);
+
+	int threadCount = 1;
+	if(argc == 4)
+	{
+		if(args[3].substr(0,2) != "-j") quit_with_usage();
+
+		try							{ threadCount = lexical_cast<int>(args[3].substr(2)); }
+		catch(bad_lexical_cast&)	{ quit_with_usage(); }
+
+		if(threadCount < 1) quit_with_usage();
+	}
+
+	run_calculator(args[1], args[2], threadCount);
 	return 0;
 }
@@ -43,6 +43,8 @@ try
 	options.set("height",			configModule->get_global_variable<int>("height"));
 	options.set("fullScreen",		configModule->get_global_variable<bool>("fullScreen"));
 	options.set("levelName",		configModule->get_global_variable<std::string>("levelName"));
+	options.set("physicsDeterministic",	configModule->get_global_variable<bool>("physicsDeterministic"));
+	options.set("physicsThreads",	configModule->get_global_variable<int>("physicsThreads"));
 	options.set("profile",			configModule->get_global_variable<std::string>("profile"));
 	options.set("renderNavMeshes",	configModule->get_global_variable<bool>("renderNavMeshes"));
 	options.set("renderPortals",	configModule->get_global_variable<bool>("renderPortals"));
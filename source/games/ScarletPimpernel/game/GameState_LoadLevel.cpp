@@ -10,6 +10,10 @@
 #include <hesp/gui/Screen.h>
 #include <hesp/io/files/LevelFile.h>
 #include <hesp/io/util/DirectoryFinder.h>
+#include <hesp/level/Level.h>
+#include <hesp/objects/base/ObjectManager.h>
+#include <hesp/physics/PhysicsSystem.h>
+#include <hesp/util/ConfigOptions.h>
 #include "GameData.h"
 
 namespace bf = boost::filesystem;
@@ -32,7 +36,18 @@ void GameState_LoadLevel::execute()
 {
 	// Ensure that the loading screen's been rendered before we try and load the level (render happens after updating).
 	if(m_firstTime) m_firstTime = false;
-	else m_gameData->set_level(LevelFile::load(m_gameData->level_filename()));
+	else
+	{
+		Level_Ptr level = LevelFile::load(m_gameData->level_filename());
+
+		// Set up the level's physics system as specified in the configuration options.
+		const ConfigOptions& options = ConfigOptions::instance();
+		const PhysicsSystem_Ptr& physicsSystem = level->object_manager()->physics_system();
+		physicsSystem->set_thread_count(options.get<int>("physicsThreads"));
+		physicsSystem->set_deterministic(options.get<bool>("physicsDeterministic"));
+
+		m_gameData->set_level(level);
+	}
 }
 
 //#################### PRIVATE METHODS ####################
@@ -0,0 +1,288 @@
+/***
+ * test-geometry: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/math/Constants.h>
+#include <hesp/math/geom/GeomUtil.h>
+#include <hesp/math/geom/Plane.h>
+#include <hesp/math/geom/Polygon.h>
+#include <hesp/util/SmallVector.h>
+using namespace hesp;
+
+//#################### TYPEDEFS ####################
+typedef Polygon<Vector3d,int> Poly;
+
+//#################### RANDOM GEOMETRY ####################
+double random_coord(double range)
+{
+	return (rand() % 2001 - 1000) * range / 1000;
+}
+
+Vector3d random_point(double range)
+{
+	return Vector3d(random_coord(range), random_coord(range), random_coord(range));
+}
+
+//#################### COMPARISONS ####################
+bool identical(const Vector3d& lhs, const Vector3d& rhs)
+{
+	return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+template <typename VertexList>
+bool identical(const VertexList& lhs, const std::vector<Vector3d>& rhs)
+{
+	if(lhs.size() != static_cast<int>(rhs.size())) return false;
+	for(int i=0, size=lhs.size(); i<size; ++i)
+	{
+		if(!identical(lhs[i], rhs[i])) return false;
+	}
+	return true;
+}
+
+bool identical(const Poly& lhs, const std::vector<Vector3d>& rhs)
+{
+	return identical(lhs.vertices(), rhs);
+}
+
+//#################### REFERENCE SPLIT ####################
+/**
+The implementation of split_polygon which preceded the current one, which built the halves in
+std::vectors. It's kept here as a reference for the results of the current one.
+*/
+std::pair<int,PlaneClassifier> reference_half_polygon(std::vector<Vector3d>& currentHalf, std::vector<Vector3d>& otherHalf, const Poly& poly,
+													  const Plane& plane, int i, PlaneClassifier cp)
+{
+	const int vertCount = poly.vertex_count();
+
+	PlaneClassifier oldcp;
+	do
+	{
+		currentHalf.push_back(poly.vertex(i));
+		i = next_vert(i, vertCount);
+		oldcp = cp;
+		cp = classify_point_against_plane(poly.vertex(i), plane);
+	} while(cp == oldcp);
+
+	if(cp == CP_COPLANAR)
+	{
+		currentHalf.push_back(poly.vertex(i));
+		otherHalf.push_back(poly.vertex(i));
+		i = next_vert(i, vertCount);
+		cp = classify_point_against_plane(poly.vertex(i), plane);
+		while(cp == CP_COPLANAR)
+		{
+			i = next_vert(i, vertCount);
+			cp = classify_point_against_plane(poly.vertex(i), plane);
+		}
+	}
+	else
+	{
+		Vector3d intersectionPoint = determine_linesegment_intersection_with_plane(poly.vertex(prev_vert(i, vertCount)), poly.vertex(i), plane).first;
+		currentHalf.push_back(intersectionPoint);
+		otherHalf.push_back(intersectionPoint);
+	}
+
+	return std::make_pair(i, cp);
+}
+
+void reference_split(const Poly& poly, const Plane& plane, std::vector<Vector3d>& backHalf, std::vector<Vector3d>& frontHalf)
+{
+	int startVert = -1;
+	PlaneClassifier cp = CP_COPLANAR;
+	const int vertCount = poly.vertex_count();
+	for(int i=0; i<vertCount; ++i)
+	{
+		cp = classify_point_against_plane(poly.vertex(i), plane);
+		if(cp != CP_COPLANAR)
+		{
+			startVert = i;
+			break;
+		}
+	}
+
+	std::vector<Vector3d>& originalHalf = cp == CP_BACK ? backHalf : frontHalf;
+	std::vector<Vector3d>& otherHalf = cp == CP_BACK ? frontHalf : backHalf;
+	std::pair<int,PlaneClassifier> p = reference_half_polygon(originalHalf, otherHalf, poly, plane, startVert, cp);
+	p = reference_half_polygon(otherHalf, originalHalf, poly, plane, p.first, p.second);
+	for(int i=p.first; i!=startVert; i=next_vert(i, vertCount)) originalHalf.push_back(poly.vertex(i));
+}
+
+//#################### TESTS ####################
+/**
+Checks that splitting random convex polygons (with up to 16 vertices, so both inline and
+heap-allocated vertex lists are involved) gives bitwise identical halves with the vertex list version
+of split_polygon, the SplitResults adapter and the std::vector-based reference, and that clipping a
+polygon to a plane agrees with splitting it.
+*/
+void test_split()
+{
+	const int SPLIT_POLYGONS = 20000;	// the number of random polygons tested against random planes
+	const int SPLIT_MAX_VERTICES = 16;	// the largest number of vertices of a random polygon (polygons store up to 8 inline)
+
+	srand(97531);
+
+	Poly::VertexList backVerts, frontVerts, clippedVerts;	// reused from one split to the next
+	int splitCount = 0, largeSplitCount = 0;
+	for(int t=0; t<SPLIT_POLYGONS; ++t)
+	{
+		// Make a random regular polygon in a random plane.
+		int vertCount = 3 + rand() % (SPLIT_MAX_VERTICES - 2);
+		Vector3d centre = random_point(10);
+		Vector3d u = random_point(1), w = random_point(1);
+		if(u.length() < 0.1 || u.cross(w).length() < 0.1) continue;
+		u.normalize();
+		Vector3d v = u.cross(w).normalize();
+		double radius = 1 + rand() % 10;
+
+		std::vector<Vector3d> verts;
+		for(int i=0; i<vertCount; ++i)
+		{
+			double theta = 2 * PI * i / vertCount;
+			verts.push_back(centre + u * (radius * cos(theta)) + v * (radius * sin(theta)));
+		}
+		Poly poly(verts, t);
+
+		Vector3d n = random_point(1);
+		if(n.length() < 0.1) continue;
+		n.normalize();
+		Plane plane(n, n.dot(centre) + random_coord(radius));
+
+		PlaneClassifier cp = clip_polygon_to_plane(poly, plane, clippedVerts);
+		if(cp != classify_polygon_against_plane(poly, plane)) throw Exception("Clipping a polygon classified it wrongly against the plane");
+		if(cp != CP_STRADDLE)
+		{
+			if(!clippedVerts.empty()) throw Exception("Clipping a polygon which doesn't straddle the plane copied it");
+			continue;
+		}
+
+		std::vector<Vector3d> referenceBack, referenceFront;
+		reference_split(poly, plane, referenceBack, referenceFront);
+
+		split_polygon(poly, plane, backVerts, frontVerts);
+		if(!identical(backVerts, referenceBack) || !identical(frontVerts, referenceFront)) throw Exception("split_polygon gave different halves to the reference");
+
+		SplitResults<Vector3d,int> results = split_polygon(poly, plane);
+		if(!identical(*results.back, referenceBack) || !identical(*results.front, referenceFront))
+		{
+			throw Exception("The SplitResults version of split_polygon gave different halves to the reference");
+		}
+		if(results.back->auxiliary_data() != t || results.front->auxiliary_data() != t) throw Exception("The halves didn't inherit the auxiliary data of the polygon");
+
+		if(!identical(clippedVerts, referenceFront)) throw Exception("Clipping a polygon didn't keep the front half of the split");
+
+		++splitCount;
+		if(vertCount > 8) ++largeSplitCount;
+	}
+
+	if(largeSplitCount == 0) throw Exception("None of the random polygons had more vertices than are stored inline");
+	std::cout << "Split: " << splitCount << " polygons (" << largeSplitCount << " with more than 8 vertices) split identically\n";
+}
+
+/**
+An element type which keeps track of how many instances of it are alive, so that the test can check
+that SmallVector constructs and destroys exactly as many elements as it should.
+*/
+struct Counted
+{
+	static int s_liveCount;
+	int value;
+
+	explicit Counted(int value_) : value(value_)	{ ++s_liveCount; }
+	Counted(const Counted& rhs) : value(rhs.value)	{ ++s_liveCount; }
+	~Counted()										{ --s_liveCount; }
+};
+
+int Counted::s_liveCount = 0;
+
+typedef SmallVector<Counted,4> CountedVector;
+
+bool holds_sequence(const CountedVector& vec, int size)
+{
+	if(vec.size() != size) return false;
+	for(int i=0; i<size; ++i)
+	{
+		if(vec[i].value != i) return false;
+	}
+	return true;
+}
+
+CountedVector make_sequence(int size)
+{
+	CountedVector vec;
+	for(int i=0; i<size; ++i) vec.push_back(Counted(i));
+	return vec;
+}
+
+/**
+Checks that SmallVector keeps its elements intact when it grows beyond its inline storage, when
+it's copied and when it's assigned (in each case both to and from inline and heap storage), and
+that it destroys all the elements it constructs.
+*/
+void test_small_vector()
+{
+	{
+		// Grow beyond the inline storage.
+		CountedVector vec;
+		for(int i=0; i<20; ++i)
+		{
+			vec.push_back(Counted(i));
+			if(!holds_sequence(vec, i+1)) throw Exception("A small vector lost its elements when it grew");
+			if(Counted::s_liveCount != i+1) throw Exception("A small vector leaked elements when it grew");
+		}
+
+		// Push back one of the vector's own elements when it's about to grow.
+		CountedVector aliased = make_sequence(4);
+		aliased.push_back(aliased[0]);
+		if(aliased.size() != 5 || aliased[4].value != 0 || !holds_sequence(CountedVector(aliased.begin(), aliased.begin() + 4), 4))
+		{
+			throw Exception("A small vector couldn't push back one of its own elements while growing");
+		}
+
+		// Copy inline and heap vectors.
+		CountedVector small = make_sequence(3), large = make_sequence(12);
+		CountedVector smallCopy(small), largeCopy(large);
+		if(!holds_sequence(smallCopy, 3) || !holds_sequence(largeCopy, 12)) throw Exception("Copying a small vector didn't copy its elements");
+		largeCopy[0].value = 99;
+		if(large[0].value != 0) throw Exception("A copy of a small vector shared its elements");
+
+		// Assign inline to heap, heap to inline and a vector to itself.
+		CountedVector target = make_sequence(10);
+		target = small;
+		if(!holds_sequence(target, 3)) throw Exception("Assigning a small vector to a grown one didn't replace its elements");
+		target = large;
+		if(!holds_sequence(target, 12)) throw Exception("Assigning a grown vector to a small one didn't replace its elements");
+		target = target;
+		if(!holds_sequence(target, 12)) throw Exception("Assigning a small vector to itself changed it");
+
+		// Clear and reuse a grown vector, and pop elements off it.
+		target.clear();
+		if(!target.empty()) throw Exception("Clearing a small vector didn't empty it");
+		for(int i=0; i<6; ++i) target.push_back(Counted(i));
+		target.pop_back();
+		if(!holds_sequence(target, 5)) throw Exception("A cleared small vector couldn't be reused");
+	}
+
+	if(Counted::s_liveCount != 0) throw Exception("Small vectors didn't destroy all the elements they constructed");
+	std::cout << "Small vector: passed\n";
+}
+
+int main()
+try
+{
+	test_split();
+	test_small_vector();
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << '\n';
+	return EXIT_FAILURE;
+}
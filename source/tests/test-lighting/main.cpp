@@ -0,0 +1,188 @@
+/***
+ * test-lighting: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/images/PixelTypes.h>
+#include <hesp/io/sections/LightmapsSection.h>
+#include <hesp/lighting/Lightmap.h>
+#include <hesp/lighting/LightmapAtlas.h>
+#include <hesp/lighting/SkylinePacker.h>
+using namespace hesp;
+
+bool is_power_of_two(int n)
+{
+	return n > 0 && (n & (n - 1)) == 0;
+}
+
+/**
+Packs a large number of randomly-sized rectangles into pages, and checks that none of
+them overlap or stick out of their pages.
+*/
+void test_packer()
+{
+	const int PAGE_SIZE = 512;
+	const int RECTANGLE_COUNT = 2000;
+
+	srand(12345);
+
+	std::vector<SkylinePacker> packers;
+	std::vector<std::vector<int> > owners;		// the rectangle covering each texel of each page (or -1)
+	int totalArea = 0;
+	for(int i=0; i<RECTANGLE_COUNT; ++i)
+	{
+		int width = 4 + rand() % 65, height = 4 + rand() % 65;
+		totalArea += width * height;
+
+		int x, y, page;
+		for(page=0; page<static_cast<int>(packers.size()); ++page)
+		{
+			if(packers[page].insert(width, height, x, y)) break;
+		}
+		if(page == static_cast<int>(packers.size()))
+		{
+			packers.push_back(SkylinePacker(PAGE_SIZE, PAGE_SIZE));
+			owners.push_back(std::vector<int>(PAGE_SIZE * PAGE_SIZE, -1));
+			if(!packers.back().insert(width, height, x, y)) throw Exception("A rectangle didn't fit on an empty page");
+		}
+
+		if(x < 0 || y < 0 || x + width > PAGE_SIZE || y + height > PAGE_SIZE) throw Exception("A rectangle sticks out of its page");
+		for(int v=y; v<y+height; ++v)
+			for(int u=x; u<x+width; ++u)
+			{
+				int& owner = owners[page][v * PAGE_SIZE + u];
+				if(owner != -1) throw Exception("Two rectangles overlap");
+				owner = i;
+			}
+	}
+
+	int pageCount = static_cast<int>(packers.size());
+	double utilisation = static_cast<double>(totalArea) / (static_cast<double>(pageCount) * PAGE_SIZE * PAGE_SIZE);
+	std::cout << "Skyline packer: " << RECTANGLE_COUNT << " rectangles on " << pageCount << " pages, overall utilisation " << utilisation << " (";
+	for(int p=0; p<pageCount; ++p)
+	{
+		std::cout << (p != 0 ? ", " : "") << packers[p].utilisation();
+	}
+	std::cout << ")\n";
+
+	// Every page but the last should be reasonably full.
+	for(int p=0; p<pageCount-1; ++p)
+	{
+		if(packers[p].utilisation() <= 0.75) throw Exception("A page other than the last is poorly utilised");
+	}
+}
+
+/**
+Packs randomly-coloured lightmaps of the sizes produced by LightmapGrid, and checks that each polygon's
+rewritten lightmap coordinates pick out its own lightmap (with a border of copies of its edge lumels).
+The atlas is then saved and reloaded, and checked against the original.
+*/
+void test_atlas()
+{
+	const int PAGE_SIZE = 512;
+	const int LIGHTMAP_COUNT = 500;
+
+	srand(23456);
+
+	std::vector<Lightmap_Ptr> lightmaps;
+	std::vector<TexturedLitPolygon_Ptr> polygons;
+	for(int i=0; i<LIGHTMAP_COUNT; ++i)
+	{
+		int rows = 8 << (rand() % 4), cols = 8 << (rand() % 4);
+		Lightmap_Ptr lightmap(new Lightmap(rows, cols));
+		for(int r=0; r<rows; ++r)
+			for(int c=0; c<cols; ++c)
+			{
+				(*lightmap)(r,c) = Colour3d((rand() % 256) / 255.0, (rand() % 256) / 255.0, (rand() % 256) / 255.0);
+			}
+		lightmaps.push_back(lightmap);
+
+		std::vector<TexturedLitVector3d> vertices;
+		vertices.push_back(TexturedLitVector3d(0, 0, i, 0, 0, 0, 0));
+		vertices.push_back(TexturedLitVector3d(1, 0, i, 1, 0, 1, 0));
+		vertices.push_back(TexturedLitVector3d(1, 1, i, 1, 1, 1, 1));
+		vertices.push_back(TexturedLitVector3d(0, 1, i, 0, 1, 0, 1));
+		polygons.push_back(TexturedLitPolygon_Ptr(new TexturedLitPolygon(vertices, "TEXTURE")));
+	}
+
+	const int padding = LightmapAtlas::DEFAULT_PADDING;
+	LightmapAtlas_Ptr atlas = LightmapAtlas::pack(lightmaps, polygons, PAGE_SIZE, padding);
+	const std::vector<Image24_Ptr>& pages = atlas->pages();
+	const std::vector<int>& polygonPages = atlas->polygon_pages();
+	if(static_cast<int>(polygonPages.size()) != LIGHTMAP_COUNT) throw Exception("There isn't a page index for each polygon");
+
+	for(size_t p=0, pageCount=pages.size(); p<pageCount; ++p)
+	{
+		if(pages[p]->width() != PAGE_SIZE || !is_power_of_two(pages[p]->height()) || pages[p]->height() > PAGE_SIZE)
+		{
+			throw Exception("A page has invalid dimensions");
+		}
+	}
+
+	for(int i=0; i<LIGHTMAP_COUNT; ++i)
+	{
+		const Image24& page = *pages[polygonPages[i]];
+		Image24_Ptr image = lightmaps[i]->to_image();
+		int width = image->width(), height = image->height();
+
+		// The lightmap coordinates of the first and third vertices pick out the corners of the lightmap.
+		const TexturedLitVector3d& v0 = polygons[i]->vertex(0);
+		const TexturedLitVector3d& v2 = polygons[i]->vertex(2);
+		double left = v0.lu * page.width(), top = v0.lv * page.height();
+		if(left != static_cast<int>(left) || top != static_cast<int>(top)) throw Exception("A lightmap isn't aligned to texels");
+		if(v2.lu * page.width() - left != width || v2.lv * page.height() - top != height) throw Exception("A lightmap is the wrong size in the atlas");
+		if(left < padding || top < padding || left + width + padding > page.width() || top + height + padding > page.height())
+		{
+			throw Exception("A lightmap's border sticks out of its page");
+		}
+
+		for(int y=-padding; y<height+padding; ++y)
+			for(int x=-padding; x<width+padding; ++x)
+			{
+				int sx = std::min(std::max(x, 0), width - 1), sy = std::min(std::max(y, 0), height - 1);
+				if(!(page(static_cast<int>(left) + x, static_cast<int>(top) + y) == (*image)(sx, sy)))
+				{
+					throw Exception("A lightmap or its border wasn't copied to the atlas correctly");
+				}
+			}
+	}
+
+	std::cout << "Lightmap atlas: " << LIGHTMAP_COUNT << " lightmaps on " << pages.size() << " pages\n";
+
+	// Check that the atlas survives a round trip through the level file format.
+	std::stringstream ss;
+	LightmapsSection::save(ss, atlas);
+	LightmapAtlas_Ptr loaded = LightmapsSection::load(ss);
+	if(loaded->polygon_pages() != polygonPages) throw Exception("The reloaded page indices don't match");
+	if(loaded->pages().size() != pages.size()) throw Exception("The reloaded page count doesn't match");
+	for(size_t p=0, pageCount=pages.size(); p<pageCount; ++p)
+	{
+		const Image24& lhs = *pages[p], & rhs = *loaded->pages()[p];
+		if(lhs.width() != rhs.width() || lhs.height() != rhs.height()) throw Exception("The reloaded page dimensions don't match");
+		for(int n=0, pixelCount=lhs.width()*lhs.height(); n<pixelCount; ++n)
+		{
+			if(!(lhs(n) == rhs(n))) throw Exception("The reloaded pixels don't match");
+		}
+	}
+	std::cout << "Lightmaps section: " << ss.str().size() << " bytes\n";
+}
+
+int main()
+try
+{
+	test_packer();
+	test_atlas();
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,211 @@
+/***
+ * test-messages: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/objects/base/IObjectComponent.h>
+#include <hesp/objects/base/Message.h>
+#include <hesp/objects/base/MessageSubscriberTable.h>
+#include <hesp/objects/base/ObjectID.h>
+#include <hesp/util/Properties.h>
+using namespace hesp;
+
+//#################### TYPEDEFS ####################
+typedef std::vector<std::pair<int,int> > DeliveryLog;	// the (object ID, group ID) of each component which received a message, in order
+
+//#################### MESSAGES ####################
+struct MsgPing : Message
+{
+	std::set<ObjectID> referenced_objects() const	{ return std::set<ObjectID>(); }
+	int type_id() const								{ return message_type_id<MsgPing>(); }
+};
+
+struct MsgPong : Message
+{
+	std::set<ObjectID> referenced_objects() const	{ return std::set<ObjectID>(); }
+	int type_id() const								{ return message_type_id<MsgPong>(); }
+};
+
+//#################### COMPONENTS ####################
+struct TestComponent : IObjectComponent
+{
+	DeliveryLog *m_log;
+
+	TestComponent(const ObjectID& objectID, int groupID, DeliveryLog *log)
+	:	m_log(log)
+	{
+		m_groupID = groupID;
+		m_objectID = objectID;
+		m_objectManager = NULL;
+	}
+
+	void log_delivery()	{ m_log->push_back(std::make_pair(m_objectID.value(), m_groupID)); }
+
+	std::string group_type() const	{ return "Test"; }
+	std::string own_type() const	{ return "Test"; }
+	Properties save() const			{ return Properties(); }
+};
+
+// Handles pings only.
+struct PingComponent : TestComponent, MessageHandler<MsgPing>
+{
+	PingComponent(const ObjectID& objectID, int groupID, DeliveryLog *log)
+	:	TestComponent(objectID, groupID, log)
+	{}
+
+	void process_message(const MsgPing& msg)	{ log_delivery(); }
+
+	void subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+	{
+		subscriberTable.subscribe<MsgPing>(this);
+	}
+};
+
+// Handles both pings and pongs, but (wrongly) only subscribes to pings.
+struct ForgetfulComponent : TestComponent, MessageHandler<MsgPing>, MessageHandler<MsgPong>
+{
+	ForgetfulComponent(const ObjectID& objectID, int groupID, DeliveryLog *log)
+	:	TestComponent(objectID, groupID, log)
+	{}
+
+	void process_message(const MsgPing& msg)	{ log_delivery(); }
+	void process_message(const MsgPong& msg)	{ log_delivery(); }
+
+	void subscribe_to_messages(MessageSubscriberTable& subscriberTable)
+	{
+		subscriberTable.subscribe<MsgPing>(this);
+	}
+};
+
+//#################### TESTS ####################
+/**
+Checks that broadcast and targeted messages reach exactly the subscribed components, in ascending order of
+(object ID, group ID) regardless of the order in which the components subscribed, and that an object's
+components stop receiving messages once they've been unsubscribed (as happens when it's destroyed).
+*/
+void test_dispatch()
+{
+	const int OBJECT_COUNT = 4, GROUP_COUNT = 3;
+
+	DeliveryLog log;
+	std::vector<shared_ptr<PingComponent> > components;
+	MessageSubscriberTable subscriberTable;
+
+	// Subscribe the components in a scrambled order.
+	for(int i=0; i<OBJECT_COUNT * GROUP_COUNT; ++i)
+	{
+		int k = (i * 5) % (OBJECT_COUNT * GROUP_COUNT);
+		components.push_back(shared_ptr<PingComponent>(new PingComponent(ObjectID(k / GROUP_COUNT), k % GROUP_COUNT, &log)));
+		components.back()->subscribe_to_messages(subscriberTable);
+		if(subscriberTable.subscription_count(components.back()->object_id(), components.back()->group_id()) != components.back()->handled_message_type_count())
+		{
+			throw Exception("A component which subscribed to all its messages doesn't have as many subscriptions as message handlers");
+		}
+	}
+
+	// Broadcast a ping: every component should receive it, in (object, group) order.
+	subscriberTable.dispatch(MsgPing());
+	if(static_cast<int>(log.size()) != OBJECT_COUNT * GROUP_COUNT) throw Exception("Not every subscriber received the broadcast message");
+	for(int i=0; i<OBJECT_COUNT * GROUP_COUNT; ++i)
+	{
+		if(log[i] != std::make_pair(i / GROUP_COUNT, i % GROUP_COUNT)) throw Exception("The broadcast message wasn't dispatched in (object, group) order");
+	}
+
+	// Broadcast a pong: nobody has subscribed to it.
+	log.clear();
+	subscriberTable.dispatch(MsgPong());
+	if(!log.empty()) throw Exception("A component received a message to which it hadn't subscribed");
+
+	// Post a ping to a single component, and to all the components of one object.
+	subscriberTable.dispatch(MsgPing(), ObjectID(2), 1);
+	if(log.size() != 1 || log[0] != std::make_pair(2, 1)) throw Exception("The targeted message didn't reach exactly its target component");
+
+	log.clear();
+	subscriberTable.dispatch(MsgPing(), ObjectID(1));
+	if(static_cast<int>(log.size()) != GROUP_COUNT) throw Exception("The posted message didn't reach each subscribed component of the object");
+	for(int g=0; g<GROUP_COUNT; ++g)
+	{
+		if(log[g] != std::make_pair(1, g)) throw Exception("The posted message wasn't dispatched in group order");
+	}
+
+	// Unsubscribe object 1's components (as destroying it would), and check that only the others still receive messages.
+	subscriberTable.remove_subscribers(ObjectID(1));
+	for(int g=0; g<GROUP_COUNT; ++g)
+	{
+		if(subscriberTable.subscription_count(ObjectID(1), g) != 0) throw Exception("A destroyed object's component still has subscriptions");
+	}
+
+	log.clear();
+	subscriberTable.dispatch(MsgPing());
+	if(static_cast<int>(log.size()) != (OBJECT_COUNT - 1) * GROUP_COUNT) throw Exception("The wrong number of components received the broadcast message after unsubscription");
+	for(size_t i=0, size=log.size(); i<size; ++i)
+	{
+		if(log[i].first == 1) throw Exception("A destroyed object's component received a broadcast message");
+		if(i > 0 && !(log[i-1] < log[i])) throw Exception("The broadcast message wasn't dispatched in order after unsubscription");
+	}
+
+	log.clear();
+	subscriberTable.dispatch(MsgPing(), ObjectID(1));
+	subscriberTable.dispatch(MsgPing(), ObjectID(1), 0);
+	if(!log.empty()) throw Exception("A destroyed object's component received a posted message");
+
+	std::cout << "Dispatch: " << OBJECT_COUNT * GROUP_COUNT << " subscribers received their messages in order\n";
+}
+
+/**
+Checks that the subscriptions which the object manager compares with a component's message handlers
+catch components which forget to subscribe to a message type, or which subscribe to the wrong ones.
+*/
+void test_subscription_checks()
+{
+	DeliveryLog log;
+	MessageSubscriberTable subscriberTable;
+
+	ForgetfulComponent forgetful(ObjectID(0), 0, &log);
+	if(forgetful.handled_message_type_count() != 2) throw Exception("A component miscounted the types of message it handles");
+	forgetful.subscribe_to_messages(subscriberTable);
+	if(subscriberTable.subscription_count(ObjectID(0), 0) == forgetful.handled_message_type_count())
+	{
+		throw Exception("A component which forgot to subscribe to one of its messages wasn't detected");
+	}
+
+	// A component can't subscribe to messages it doesn't handle.
+	PingComponent ping(ObjectID(1), 0, &log);
+	bool subscribed = true;
+	try					{ subscriberTable.subscribe<MsgPong>(&ping); }
+	catch(Exception&)	{ subscribed = false; }
+	if(subscribed) throw Exception("A component subscribed to a message it doesn't handle");
+
+	// A component can subscribe to the messages it handles, but only once.
+	subscriberTable.subscribe<MsgPong>(&forgetful);
+	if(subscriberTable.subscription_count(ObjectID(0), 0) != forgetful.handled_message_type_count())
+	{
+		throw Exception("A component which subscribed to all its messages didn't pass the check");
+	}
+
+	subscribed = true;
+	try					{ subscriberTable.subscribe<MsgPong>(&forgetful); }
+	catch(Exception&)	{ subscribed = false; }
+	if(subscribed) throw Exception("A component subscribed to the same message twice");
+
+	std::cout << "Subscription checks: passed\n";
+}
+
+int main()
+try
+{
+	test_dispatch();
+	test_subscription_checks();
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,308 @@
+/***
+ * test-models: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/files/ModelFiles.h>
+#include <hesp/materials/BasicMaterial.h>
+#include <hesp/math/matrices/RBTMatrix.h>
+#include <hesp/models/Animation.h>
+#include <hesp/models/AnimationController.h>
+#include <hesp/models/Bone.h>
+#include <hesp/models/BoneHierarchy.h>
+#include <hesp/models/ConfiguredBone.h>
+#include <hesp/models/ConfiguredPose.h>
+#include <hesp/models/Pose.h>
+#include <hesp/models/Skeleton.h>
+#include <hesp/models/SkinningPalette.h>
+#include <hesp/models/Submesh.h>
+using namespace hesp;
+
+bool equal_vectors(const Vector3d& lhs, const Vector3d& rhs)
+{
+	return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+bool equal_mesh_data(const MeshData& lhs, const MeshData& rhs)
+{
+	if(lhs.submeshes.size() != rhs.submeshes.size()) return false;
+	for(size_t i=0, submeshCount=lhs.submeshes.size(); i<submeshCount; ++i)
+	{
+		const MeshData::SubmeshData& l = lhs.submeshes[i];
+		const MeshData::SubmeshData& r = rhs.submeshes[i];
+		if(l.materialName != r.materialName || l.vertIndices != r.vertIndices || l.positions != r.positions ||
+		   l.normals != r.normals || l.texCoords != r.texCoords || l.boneAssignments.size() != r.boneAssignments.size())
+		{
+			return false;
+		}
+
+		for(size_t j=0, size=l.boneAssignments.size(); j<size; ++j)
+		{
+			const MeshData::BoneAssignment& la = l.boneAssignments[j];
+			const MeshData::BoneAssignment& ra = r.boneAssignments[j];
+			if(la.vertIndex != ra.vertIndex || la.boneIndex != ra.boneIndex || la.weight != ra.weight) return false;
+		}
+	}
+	return true;
+}
+
+bool equal_skeleton_data(const SkeletonData& lhs, const SkeletonData& rhs)
+{
+	if(lhs.bones.size() != rhs.bones.size()) return false;
+	for(size_t i=0, boneCount=lhs.bones.size(); i<boneCount; ++i)
+	{
+		const SkeletonData::BoneData& l = lhs.bones[i];
+		const SkeletonData::BoneData& r = rhs.bones[i];
+		if(l.name != r.name || l.parent != r.parent || !equal_vectors(l.position, r.position) ||
+		   !equal_vectors(l.rotationAxis, r.rotationAxis) || l.rotationAngle != r.rotationAngle)
+		{
+			return false;
+		}
+	}
+
+	if(lhs.animations.size() != rhs.animations.size()) return false;
+	for(size_t i=0, animationCount=lhs.animations.size(); i<animationCount; ++i)
+	{
+		const SkeletonData::AnimationData& l = lhs.animations[i];
+		const SkeletonData::AnimationData& r = rhs.animations[i];
+		if(l.name != r.name || l.length != r.length || l.tracks.size() != r.tracks.size()) return false;
+		for(size_t j=0, trackCount=l.tracks.size(); j<trackCount; ++j)
+		{
+			if(l.tracks[j].boneName != r.tracks[j].boneName || l.tracks[j].keyframes != r.tracks[j].keyframes) return false;
+		}
+	}
+	return true;
+}
+
+/**
+Determines whether or not two skeletons have the same bones and the same animation keyframes.
+*/
+bool equal_skeletons(const Skeleton_CPtr& lhs, const Skeleton_CPtr& rhs, const SkeletonData& data)
+{
+	BoneHierarchy_CPtr lbones = lhs->bone_hierarchy(), rbones = rhs->bone_hierarchy();
+	if(lbones->bone_count() != rbones->bone_count()) return false;
+	for(int i=0, boneCount=lbones->bone_count(); i<boneCount; ++i)
+	{
+		Bone_CPtr l = lbones->bones(i), r = rbones->bones(i);
+		if(l->name() != r->name() || !equal_vectors(l->base_position(), r->base_position()) ||
+		   l->base_rotation()->rep() != r->base_rotation()->rep() ||
+		   (l->parent() ? l->parent()->name() : "") != (r->parent() ? r->parent()->name() : ""))
+		{
+			return false;
+		}
+	}
+
+	for(size_t i=0, animationCount=data.animations.size(); i<animationCount; ++i)
+	{
+		const std::string& name = data.animations[i].name;
+		Animation_CPtr l = lhs->animation(name), r = rhs->animation(name);
+		if(l->length() != r->length() || l->keyframe_count() != r->keyframe_count()) return false;
+		for(int j=0, keyframeCount=l->keyframe_count(); j<keyframeCount; ++j)
+		{
+			const std::vector<RBTMatrix_CPtr>& lmats = l->keyframe(j)->relative_bone_matrices();
+			const std::vector<RBTMatrix_CPtr>& rmats = r->keyframe(j)->relative_bone_matrices();
+			if(lmats.size() != rmats.size()) return false;
+			for(size_t k=0, size=lmats.size(); k<size; ++k)
+			{
+				if(lmats[k]->rep() != rmats[k]->rep()) return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+Skins a set of vertices using the original double-precision skinning algorithm, which
+accumulates the weighted skinning matrices for each vertex in an RBTMatrix.
+*/
+void reference_skin(const Skeleton_CPtr& skeleton, const std::vector<ModelVertex>& vertices, std::vector<double>& vertArray)
+{
+	BoneHierarchy_CPtr boneHierarchy = skeleton->bone_hierarchy();
+	ConfiguredPose_CPtr pose = skeleton->get_pose();
+	int boneCount = boneHierarchy->bone_count();
+
+	std::vector<RBTMatrix_CPtr> skinningMatrices(boneCount);
+	for(int i=0; i<boneCount; ++i)
+	{
+		skinningMatrices[i] = pose->bones(i)->absolute_matrix() * skeleton->to_bone_matrix(i);
+	}
+
+	RBTMatrix_Ptr m = RBTMatrix::zeros();
+	for(int i=0, vertCount=static_cast<int>(vertices.size()); i<vertCount; ++i)
+	{
+		const std::vector<BoneWeight>& boneWeights = vertices[i].bone_weights();
+		Vector3d p = vertices[i].position();
+		if(!boneWeights.empty())
+		{
+			double boneWeightSum = 0;
+			for(size_t j=0, size=boneWeights.size(); j<size; ++j)
+			{
+				boneWeightSum += boneWeights[j].weight();
+				m->add_scaled(skinningMatrices[boneWeights[j].bone_index()], boneWeights[j].weight());
+			}
+			p = m->apply_to_point(p);
+			p /= boneWeightSum;
+			m->reset_to_zeros();
+		}
+
+		vertArray[i*3] = p.x;
+		vertArray[i*3+1] = p.y;
+		vertArray[i*3+2] = p.z;
+	}
+}
+
+double random_double(double low, double high)
+{
+	return low + (high - low) * std::rand() / RAND_MAX;
+}
+
+/**
+Checks that the single-precision submesh skinning matches the original skinning algorithm
+for a set of randomly-weighted vertices, and compares their speeds.
+*/
+void test_skinning(const Skeleton_Ptr& skeleton)
+{
+	const int SKIN_COUNT = 200;
+	const int SKIN_VERTEX_COUNT = 10000;
+
+	// Put the skeleton into a pose part-way through one of its animations.
+	AnimationController animController(true);
+	animController.set_skeleton(skeleton);
+	animController.request_animation("wave");
+	animController.update(150);
+	skeleton->set_pose(skeleton->bone_hierarchy()->configure_pose(animController.get_pose()));
+
+	// Make a submesh whose vertices have up to four random bone weights (some have none).
+	std::srand(12345);
+	int boneCount = skeleton->bone_hierarchy()->bone_count();
+	std::vector<ModelVertex> vertices;
+	for(int i=0; i<SKIN_VERTEX_COUNT; ++i)
+	{
+		Vector3d p(random_double(-2,2), random_double(-2,2), random_double(-2,2));
+		Vector3d n = p;
+		ModelVertex vertex(p, n.normalize());
+		int boneWeightCount = std::rand() % 5;
+		for(int j=0; j<boneWeightCount; ++j) vertex.add_bone_weight(BoneWeight(std::rand() % boneCount, random_double(0.1,1.0)));
+		vertices.push_back(vertex);
+	}
+
+	Material_Ptr material(new BasicMaterial(Colour3d(1,1,1), Colour3d(1,1,1), Colour3d(0,0,0), 1.0, Colour3d(0,0,0)));
+	Submesh submesh(std::vector<unsigned int>(), vertices, material, std::vector<TexCoords>());
+
+	SkinningPalette palette;
+	palette.update(skeleton);
+	submesh.skin(palette);
+
+	std::vector<double> referenceArray(SKIN_VERTEX_COUNT * 3);
+	reference_skin(skeleton, vertices, referenceArray);
+
+	const std::vector<GLfloat>& vertArray = submesh.vertex_array();
+	double maxError = 0;
+	for(int i=0; i<SKIN_VERTEX_COUNT * 3; ++i)
+	{
+		double error = fabs(vertArray[i] - referenceArray[i]);
+		if(error > 1e-4 * (1 + fabs(referenceArray[i]))) throw Exception("The skinned vertices differ from those produced by the original skinning algorithm");
+		maxError = std::max(maxError, error);
+	}
+	std::cout << "Skinned vertices match the original skinning algorithm (max error " << maxError << ")\n";
+
+	// Compare the skinning speeds.
+	clock_t start = clock();
+	for(int i=0; i<SKIN_COUNT; ++i) reference_skin(skeleton, vertices, referenceArray);
+	clock_t mid = clock();
+	for(int i=0; i<SKIN_COUNT; ++i)
+	{
+		palette.update(skeleton);
+		submesh.skin(palette);
+	}
+	clock_t end = clock();
+
+	double vertsSkinned = static_cast<double>(SKIN_COUNT) * SKIN_VERTEX_COUNT;
+	double referenceTime = static_cast<double>(mid - start) / CLOCKS_PER_SEC, time = static_cast<double>(end - mid) / CLOCKS_PER_SEC;
+	std::cout << "Original skinning: " << vertsSkinned / std::max(referenceTime, 1e-6) << " vertices/s\n";
+	std::cout << "Submesh skinning: " << vertsSkinned / std::max(time, 1e-6) << " vertices/s\n";
+}
+
+int main()
+try
+{
+	const int LOAD_COUNT = 200;
+	const std::string meshFilename = "../resources/TestModel.mesh.xml";
+	const std::string skeletonFilename = "../resources/TestModel.skeleton.xml";
+	const std::string compiledMeshFilename = "TestModel.mesh.bin";
+	const std::string compiledSkeletonFilename = "TestModel.skeleton.bin";
+	const std::string corruptMeshFilename = "TestModel.corrupt.mesh.bin";
+
+	// Compile the model, then check that the data loaded back in from the compiled files matches the XML data.
+	MeshData meshData = ModelFiles::load_mesh_data(meshFilename);
+	SkeletonData skeletonData = ModelFiles::load_skeleton_data(skeletonFilename);
+	ModelFiles::save_compiled_mesh_data(compiledMeshFilename, meshData);
+	ModelFiles::save_compiled_skeleton_data(compiledSkeletonFilename, skeletonData);
+
+	MeshData compiledMeshData = ModelFiles::load_compiled_mesh_data(compiledMeshFilename);
+	SkeletonData compiledSkeletonData = ModelFiles::load_compiled_skeleton_data(compiledSkeletonFilename);
+	if(!equal_mesh_data(meshData, compiledMeshData)) throw Exception("The compiled mesh data differs from the XML mesh data");
+	if(!equal_skeleton_data(skeletonData, compiledSkeletonData)) throw Exception("The compiled skeleton data differs from the XML skeleton data");
+
+	// Check that the skeletons made from the two sets of data are the same.
+	Skeleton_Ptr skeleton = ModelFiles::load_skeleton(skeletonFilename);
+	Skeleton_Ptr compiledSkeleton = ModelFiles::make_skeleton(compiledSkeletonData);
+	if(!equal_skeletons(skeleton, compiledSkeleton, skeletonData)) throw Exception("The skeleton made from the compiled data differs from the XML one");
+
+	std::cout << "Compiled model matches XML model (" << meshData.submeshes.size() << " submeshes, "
+			  << skeletonData.bones.size() << " bones, " << skeletonData.animations.size() << " animations)\n";
+
+	// Corrupt the submesh count in a copy of the compiled mesh file (it follows the 4-byte ID and the version),
+	// and check that loading it throws an Exception (which makes load_model fall back to the XML) rather than
+	// trying to allocate a huge number of submeshes.
+	{
+		std::ifstream is(compiledMeshFilename.c_str(), std::ios_base::binary);
+		std::string contents((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+		int badCount = 0x7fffffff;
+		contents.replace(8, sizeof(int), reinterpret_cast<const char*>(&badCount), sizeof(int));
+		std::ofstream os(corruptMeshFilename.c_str(), std::ios_base::binary);
+		os << contents;
+	}
+
+	bool corruptMeshLoaded = true;
+	try					{ ModelFiles::load_compiled_mesh_data(corruptMeshFilename); }
+	catch(Exception&)	{ corruptMeshLoaded = false; }
+	if(corruptMeshLoaded) throw Exception("A compiled mesh file with a corrupt count was loaded");
+	std::cout << "Compiled mesh with a corrupt count rejected\n";
+
+	// Compare the loading times.
+	clock_t start = clock();
+	for(int i=0; i<LOAD_COUNT; ++i)
+	{
+		ModelFiles::load_mesh_data(meshFilename);
+		ModelFiles::load_skeleton_data(skeletonFilename);
+	}
+	clock_t mid = clock();
+	for(int i=0; i<LOAD_COUNT; ++i)
+	{
+		ModelFiles::load_compiled_mesh_data(compiledMeshFilename);
+		ModelFiles::load_compiled_skeleton_data(compiledSkeletonFilename);
+	}
+	clock_t end = clock();
+
+	std::cout << "XML: " << LOAD_COUNT << " loads in " << static_cast<double>(mid - start) / CLOCKS_PER_SEC << "s\n";
+	std::cout << "Compiled: " << LOAD_COUNT << " loads in " << static_cast<double>(end - mid) / CLOCKS_PER_SEC << "s\n";
+
+	test_skinning(skeleton);
+
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << std::endl;
+	return EXIT_FAILURE;
+}
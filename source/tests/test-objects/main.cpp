@@ -0,0 +1,147 @@
+/***
+ * test-objects: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/math/vectors/Vector3.h>
+#include <hesp/objects/base/ObjectManager.h>
+#include <hesp/objects/base/ObjectSpecification.h>
+#include <hesp/objects/components/ICmpOwnable.h>
+#include <hesp/physics/PhysicsMaterial.h>
+using namespace hesp;
+
+/**
+Queries each of the object manager's groups. Group consistency checking is enabled in this test,
+so each query compares the incrementally-maintained members of the group against the result of
+evaluating the group predicate over every object, and throws if they differ.
+*/
+void check_groups(const ObjectManager& objectManager, const std::string& stage)
+{
+	const char *groupNames[] = { "Activatables", "Animatables", "Moveables", "Renderables", "Yokeables" };
+	std::cout << stage << ":";
+	for(size_t i=0, size=sizeof(groupNames)/sizeof(groupNames[0]); i<size; ++i)
+	{
+		std::cout << ' ' << groupNames[i] << '=' << objectManager.group(groupNames[i]).size();
+	}
+	std::cout << " (" << objectManager.object_count() << " objects)\n";
+}
+
+ObjectSpecification make_specification(int kind)
+{
+	ObjectSpecification specification;
+
+	Properties ownableProperties;
+	ownableProperties.set("AnimExtension", std::string(""));
+	ownableProperties.set("AttachPoint", std::string(""));
+	ownableProperties.set("Owner", ObjectID());
+
+	Properties positionProperties;
+	positionProperties.set("Position", Vector3d(kind,0,0));
+
+	Properties simulationProperties;
+	simulationProperties.set("BoundsGroup", std::string("sphere"));
+	simulationProperties.set("DampingFactor", 1.0);
+	simulationProperties.set("GravityStrength", 0.0);
+	simulationProperties.set("Posture", std::string("default"));
+	simulationProperties.set("InverseMass", 1.0);
+	simulationProperties.set("Material", PM_ITEM);
+	simulationProperties.set("Position", Vector3d(kind,0,0));
+	simulationProperties.set("Velocity", Vector3d(0,0,0));
+
+	Properties spriteProperties;
+	spriteProperties.set("SpriteName", std::string("test"));
+	spriteProperties.set("Width", 1.0);
+	spriteProperties.set("Height", 1.0);
+
+	// The kinds are: (0) a sprite, (1) an ownable sprite, (2) a moveable object, (3) an ownable moveable sprite.
+	switch(kind)
+	{
+		case 0:
+		case 1:
+			specification.add_component("Position", positionProperties);
+			specification.add_component("SpriteRender", spriteProperties);
+			break;
+		case 2:
+			specification.add_component("Simulation", simulationProperties);
+			specification.add_component("Movement", Properties());
+			break;
+		default:
+			specification.add_component("Simulation", simulationProperties);
+			specification.add_component("Movement", Properties());
+			specification.add_component("SpriteRender", spriteProperties);
+			break;
+	}
+
+	if(kind % 2 == 1) specification.add_component("Ownable", ownableProperties);
+
+	return specification;
+}
+
+int main()
+try
+{
+	const int OBJECT_COUNT = 40;
+	const int KIND_COUNT = 4;
+
+	// Set up an object manager with no archetypes or resources (none of the objects in this test need them).
+	ComponentPropertyTypeMap componentPropertyTypes;
+	std::map<std::string,ObjectSpecification> archetypes;
+	ObjectManager objectManager(BoundsManager_CPtr(), componentPropertyTypes, archetypes, ModelManager_Ptr(), SpriteManager_Ptr(), Database_Ptr());
+	objectManager.set_group_consistency_checking(true);
+	check_groups(objectManager, "Empty");
+
+	// Add some objects of each kind.
+	for(int i=0; i<OBJECT_COUNT; ++i) objectManager.queue_for_construction(make_specification(i % KIND_COUNT));
+	objectManager.flush_queues();
+	check_groups(objectManager, "Added");
+
+	// Remove every third object.
+	for(int i=0; i<OBJECT_COUNT; i+=3) objectManager.queue_for_destruction(ObjectID(i));
+	objectManager.flush_queues();
+	check_groups(objectManager, "Removed");
+
+	// Add some more objects (these reuse the IDs of the removed ones).
+	for(int i=0; i<OBJECT_COUNT/2; ++i) objectManager.queue_for_construction(make_specification(KIND_COUNT - 1 - i % KIND_COUNT));
+	objectManager.flush_queues();
+	check_groups(objectManager, "Re-added");
+
+	// Re-tag the ownable objects by giving them owners: this should take them out of the groups.
+	std::vector<ObjectID> ownables;
+	for(int i=0, count=objectManager.object_count(); i<count; ++i)
+	{
+		ICmpOwnable_Ptr cmpOwnable = objectManager.get_component(ObjectID(i), cmpOwnable);
+		if(cmpOwnable)
+		{
+			cmpOwnable->set_owner(ObjectID(0));
+			ownables.push_back(ObjectID(i));
+		}
+	}
+	check_groups(objectManager, "Owned");
+
+	// Release half of them again, and remove one of each of the owned and released objects.
+	for(size_t i=0, size=ownables.size(); i<size; i+=2)
+	{
+		ICmpOwnable_Ptr cmpOwnable = objectManager.get_component(ownables[i], cmpOwnable);
+		cmpOwnable->clear_owner();
+	}
+	check_groups(objectManager, "Released");
+
+	if(ownables.size() < 2) throw Exception("Expected at least two ownable objects");
+	objectManager.queue_for_destruction(ownables[0]);
+	objectManager.queue_for_destruction(ownables[1]);
+	objectManager.flush_queues();
+	check_groups(objectManager, "Removed ownables");
+
+	std::cout << "All of the incrementally-maintained groups match their full recomputations\n";
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << '\n';
+	return EXIT_FAILURE;
+}
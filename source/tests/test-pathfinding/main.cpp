@@ -0,0 +1,332 @@
+/***
+ * test-pathfinding: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iterator>
+
+#include <hesp/exceptions/Exception.h>
+#include <hesp/nav/AdjacencyList.h>
+#include <hesp/nav/GlobalPathfinder.h>
+#include <hesp/nav/NavLink.h>
+#include <hesp/nav/NavDataset.h>
+#include <hesp/nav/NavManager.h>
+#include <hesp/nav/NavMesh.h>
+#include <hesp/nav/NavPolygon.h>
+#include <hesp/nav/PathQueryService.h>
+#include <hesp/nav/PathTable.h>
+#include <hesp/nav/PathTableGenerator.h>
+#include <hesp/nav/WalkLink.h>
+using namespace hesp;
+
+//#################### CONSTANTS ####################
+const int GRID_SIZE = 40;		// the nav mesh is a GRID_SIZE x GRID_SIZE grid of unit squares
+const int QUERY_COUNT = 10000;
+const int AGENT_COUNT = 200;
+const int FRAME_COUNT = 200;
+const int FRAME_BUDGET_MICROSECONDS = 2000;
+
+//#################### HELPER FUNCTIONS ####################
+int cell_index(int x, int y)
+{
+	return y * GRID_SIZE + x;
+}
+
+Vector3d cell_centre(int index)
+{
+	return Vector3d(index % GRID_SIZE + 0.5, index / GRID_SIZE + 0.5, 0);
+}
+
+void add_link(int sourcePoly, int destPoly, const Vector3d& p1, const Vector3d& p2, std::vector<NavPolygon_Ptr>& polygons, std::vector<NavLink_Ptr>& links)
+{
+	int linkIndex = static_cast<int>(links.size());
+	links.push_back(NavLink_Ptr(new WalkLink(sourcePoly, destPoly, p1, p2)));
+	polygons[sourcePoly]->add_out_link(linkIndex);
+	polygons[destPoly]->add_in_link(linkIndex);
+}
+
+NavMesh_Ptr make_grid_nav_mesh()
+{
+	std::vector<NavPolygon_Ptr> polygons;
+	for(int i=0; i<GRID_SIZE*GRID_SIZE; ++i) polygons.push_back(NavPolygon_Ptr(new NavPolygon(i)));
+
+	std::vector<NavLink_Ptr> links;
+	for(int y=0; y<GRID_SIZE; ++y)
+		for(int x=0; x<GRID_SIZE; ++x)
+		{
+			if(x+1 < GRID_SIZE)
+			{
+				Vector3d p1(x+1, y, 0), p2(x+1, y+1, 0);
+				add_link(cell_index(x,y), cell_index(x+1,y), p1, p2, polygons, links);
+				add_link(cell_index(x+1,y), cell_index(x,y), p1, p2, polygons, links);
+			}
+			if(y+1 < GRID_SIZE)
+			{
+				Vector3d p1(x, y+1, 0), p2(x+1, y+1, 0);
+				add_link(cell_index(x,y), cell_index(x,y+1), p1, p2, polygons, links);
+				add_link(cell_index(x,y+1), cell_index(x,y), p1, p2, polygons, links);
+			}
+		}
+
+	return NavMesh_Ptr(new NavMesh(polygons, links));
+}
+
+/**
+Checks that a path is a connected chain of links from sourcePoly to destPoly which doesn't pass through any blocked polygons.
+*/
+bool check_path(const std::list<int>& path, int sourcePoly, int destPoly, const NavMesh_CPtr& navMesh, const GlobalPathfinder& pathfinder)
+{
+	const std::vector<NavLink_Ptr>& links = navMesh->links();
+	int curPoly = sourcePoly;
+	for(std::list<int>::const_iterator it=path.begin(), iend=path.end(); it!=iend; ++it)
+	{
+		const NavLink& link = *links[*it];
+		if(link.source_poly() != curPoly) return false;
+		curPoly = link.dest_poly();
+		if(curPoly != destPoly && pathfinder.is_polygon_blocked(curPoly)) return false;
+	}
+	return curPoly == destPoly;
+}
+
+/**
+Runs a batch of random queries and outputs the number of queries per second.
+*/
+void run_queries(const std::string& name, const NavMesh_CPtr& navMesh, const GlobalPathfinder& pathfinder, int expectedFailures)
+{
+	const int polyCount = GRID_SIZE * GRID_SIZE;
+
+	std::vector<std::pair<int,int> > queries;
+	srand(12345);
+	while(static_cast<int>(queries.size()) < QUERY_COUNT)
+	{
+		int sourcePoly = rand() % polyCount, destPoly = rand() % polyCount;
+		if(!pathfinder.is_polygon_blocked(sourcePoly) && !pathfinder.is_polygon_blocked(destPoly)) queries.push_back(std::make_pair(sourcePoly, destPoly));
+	}
+
+	int failures = 0;
+	std::list<int> path;
+	clock_t start = clock();
+	for(int i=0; i<QUERY_COUNT; ++i)
+	{
+		int sourcePoly = queries[i].first, destPoly = queries[i].second;
+		if(pathfinder.find_path(cell_centre(sourcePoly), sourcePoly, cell_centre(destPoly), destPoly, path))
+		{
+			if(!check_path(path, sourcePoly, destPoly, navMesh, pathfinder)) throw Exception(name + ": Found an invalid path");
+		}
+		else ++failures;
+	}
+	clock_t end = clock();
+
+	if(failures != expectedFailures) throw Exception(name + ": Unexpected number of failed queries");
+
+	double seconds = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+	std::cout << name << ": " << QUERY_COUNT << " queries in " << seconds << "s";
+	if(seconds > 0) std::cout << " (" << static_cast<int>(QUERY_COUNT / seconds) << " queries/s)";
+	std::cout << '\n';
+}
+
+/**
+Simulates a number of agents which each repeatedly ask the path query service for a path to a random
+destination (drawn from a small set of goals), and outputs the average and worst processing time per frame.
+*/
+void run_agents(const NavMesh_CPtr& navMesh, const NavManager_CPtr& navManager)
+{
+	const int polyCount = GRID_SIZE * GRID_SIZE;
+	const int GOAL_COUNT = 8;
+	const GlobalPathfinder& pathfinder = *navManager->dataset(0)->pathfinder();
+
+	PathQueryService service(navManager);
+	std::vector<int> sourcePolys(AGENT_COUNT), destPolys(AGENT_COUNT), queryIDs(AGENT_COUNT, -1);
+
+	srand(12345);
+	std::vector<int> goals;
+	while(static_cast<int>(goals.size()) < GOAL_COUNT)
+	{
+		int poly = rand() % polyCount;
+		if(!pathfinder.is_polygon_blocked(poly)) goals.push_back(poly);
+	}
+
+	int answered = 0;
+	double totalSeconds = 0, worstSeconds = 0;
+	std::list<int> path;
+	for(int frame=0; frame<FRAME_COUNT; ++frame)
+	{
+		for(int i=0; i<AGENT_COUNT; ++i)
+		{
+			if(queryIDs[i] != -1)
+			{
+				PathQueryService::QueryStatus status = service.take_result(queryIDs[i], path);
+				if(status == PathQueryService::QUERY_PENDING) continue;
+				if(status == PathQueryService::QUERY_FAILED || !check_path(path, sourcePolys[i], destPolys[i], navMesh, pathfinder))
+				{
+					throw Exception("Path query service: Found an invalid path");
+				}
+				++answered;
+			}
+
+			do sourcePolys[i] = rand() % polyCount; while(pathfinder.is_polygon_blocked(sourcePolys[i]));
+			destPolys[i] = goals[rand() % GOAL_COUNT];
+			queryIDs[i] = service.submit_query(0, cell_centre(sourcePolys[i]), sourcePolys[i], cell_centre(destPolys[i]), destPolys[i]);
+		}
+
+		clock_t start = clock();
+		service.process_queries(FRAME_BUDGET_MICROSECONDS);
+		clock_t end = clock();
+
+		double seconds = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+		totalSeconds += seconds;
+		if(seconds > worstSeconds) worstSeconds = seconds;
+	}
+
+	std::cout << "Path query service: " << AGENT_COUNT << " agents, " << answered << " queries answered in " << FRAME_COUNT << " frames, "
+			  << totalSeconds * 1000 / FRAME_COUNT << "ms per frame on average (worst " << worstSeconds * 1000 << "ms)\n";
+}
+
+/**
+Simulates an agent walking across the grid while another object patrols up and down across its way, and checks
+that the agent routes round the object. As in the level, the polygons occupied by both of them are blocked.
+*/
+void run_blocker(const NavMesh_CPtr& navMesh, GlobalPathfinder& pathfinder)
+{
+	const int PATROL_LENGTH = 10;
+	const std::vector<NavLink_Ptr>& links = navMesh->links();
+	int agentPoly = cell_index(0, GRID_SIZE/2), destPoly = cell_index(GRID_SIZE-1, GRID_SIZE/2);
+	int blockerY = GRID_SIZE/2 - PATROL_LENGTH/2, blockerDir = 1;
+
+	int steps = 0, detours = 0;
+	std::list<int> path;
+	while(agentPoly != destPoly)
+	{
+		int blockerPoly = cell_index(GRID_SIZE/2, blockerY);
+
+		// Check whether the blocker is in the agent's way (i.e. whether the agent's path would pass through it if it weren't blocked).
+		pathfinder.set_blocked_polygons(std::vector<int>(1, agentPoly));
+		if(pathfinder.find_path(cell_centre(agentPoly), agentPoly, cell_centre(destPoly), destPoly, path))
+		{
+			for(std::list<int>::const_iterator it=path.begin(), iend=path.end(); it!=iend; ++it)
+			{
+				if(links[*it]->dest_poly() == blockerPoly) { ++detours; break; }
+			}
+		}
+
+		std::vector<int> occupiedPolys;
+		occupiedPolys.push_back(agentPoly);
+		occupiedPolys.push_back(blockerPoly);
+		pathfinder.set_blocked_polygons(occupiedPolys);
+
+		if(!pathfinder.find_path(cell_centre(agentPoly), agentPoly, cell_centre(destPoly), destPoly, path) ||
+		   !check_path(path, agentPoly, destPoly, navMesh, pathfinder))
+		{
+			throw Exception("Blocker: Failed to find a valid path round the blocker");
+		}
+
+		// Move the agent into the next polygon on its path, and the blocker one step along its patrol.
+		agentPoly = links[path.front()]->dest_poly();
+		if(++steps > 2 * GRID_SIZE) throw Exception("Blocker: The agent failed to reach its destination");
+
+		if(blockerY + blockerDir < GRID_SIZE/2 - PATROL_LENGTH/2 || blockerY + blockerDir > GRID_SIZE/2 + PATROL_LENGTH/2) blockerDir = -blockerDir;
+		blockerY += blockerDir;
+	}
+
+	pathfinder.set_blocked_polygons(std::vector<int>());
+
+	if(detours == 0) throw Exception("Blocker: The blocker never got in the agent's way");
+	std::cout << "Blocker: Agent reached its destination in " << steps << " steps (" << GRID_SIZE-1 << " if unobstructed), having been blocked on " << detours << " of them\n";
+}
+
+/**
+Checks that an A* search fails once it has expanded the maximum number of nodes, and outputs how long a batch
+of queries which can't succeed (because the wall across the grid is closed) takes with and without a small limit.
+*/
+void run_expansion_limit(GlobalPathfinder& pathfinder)
+{
+	const int SMALL_LIMIT = 50;
+	const int LIMITED_QUERY_COUNT = 1000;
+	const int gapPoly = cell_index(GRID_SIZE/2, 0);
+	std::list<int> path;
+
+	// Reopen the gap: the path round the wall needs far more expansions than the small limit allows.
+	int sourcePoly = cell_index(0, GRID_SIZE-1), destPoly = cell_index(GRID_SIZE-1, GRID_SIZE-1);
+	pathfinder.set_polygon_blocked(gapPoly, false);
+	if(!pathfinder.find_astar_path(cell_centre(sourcePoly), sourcePoly, cell_centre(destPoly), destPoly, path))
+	{
+		throw Exception("Expansion limit: Failed to find the path through the gap");
+	}
+	if(pathfinder.find_astar_path(cell_centre(sourcePoly), sourcePoly, cell_centre(destPoly), destPoly, path, SMALL_LIMIT))
+	{
+		throw Exception("Expansion limit: Found a path which needs more expansions than the limit");
+	}
+	pathfinder.set_polygon_blocked(gapPoly, true);
+
+	// Close the gap again and time queries across the wall, which can now never succeed.
+	const int limits[] = {GlobalPathfinder::DEFAULT_MAX_EXPANSIONS, SMALL_LIMIT};
+	for(int k=0; k<2; ++k)
+	{
+		clock_t start = clock();
+		for(int i=0; i<LIMITED_QUERY_COUNT; ++i)
+		{
+			sourcePoly = cell_index(0, i % GRID_SIZE);
+			destPoly = cell_index(GRID_SIZE-1, (i * 7) % GRID_SIZE);
+			if(pathfinder.find_astar_path(cell_centre(sourcePoly), sourcePoly, cell_centre(destPoly), destPoly, path, limits[k]))
+			{
+				throw Exception("Expansion limit: Found a path across the closed wall");
+			}
+		}
+		clock_t end = clock();
+
+		double seconds = static_cast<double>(end - start) / CLOCKS_PER_SEC;
+		std::cout << "A* (closed wall, at most " << limits[k] << " expansions): " << LIMITED_QUERY_COUNT << " failed queries in " << seconds << "s\n";
+	}
+}
+
+int main()
+try
+{
+	NavMesh_Ptr navMesh = make_grid_nav_mesh();
+	AdjacencyList_Ptr adjList(new AdjacencyList(navMesh));
+	PathTable_Ptr pathTable = PathTableGenerator::dijkstra(*adjList);
+	NavDataset_Ptr navDataset(new NavDataset(adjList, navMesh, pathTable));
+	NavManager_Ptr navManager(new NavManager);
+	navManager->set_dataset(0, navDataset);
+	GlobalPathfinder& pathfinder = *navDataset->pathfinder();
+
+	std::cout << "Grid nav mesh: " << navMesh->polygons().size() << " polygons, " << navMesh->links().size() << " links\n";
+
+	// With nothing blocked, every query should be answered from the path table.
+	run_queries("Path table", navMesh, pathfinder, 0);
+
+	// Make an agent route round another object which keeps getting in its way.
+	run_blocker(navMesh, pathfinder);
+
+	// Block a wall across the middle of the grid, leaving a gap at one end: paths which
+	// cross the wall have to be found using A*.
+	for(int y=1; y<GRID_SIZE; ++y) pathfinder.set_polygon_blocked(cell_index(GRID_SIZE/2, y), true);
+	run_queries("A* (wall with gap)", navMesh, pathfinder, 0);
+	run_agents(navMesh, navManager);
+
+	// Close the gap: paths which cross the wall should no longer be found.
+	pathfinder.set_polygon_blocked(cell_index(GRID_SIZE/2, 0), true);
+	srand(12345);
+	int expectedFailures = 0;
+	for(int found=0; found<QUERY_COUNT;)
+	{
+		int sourcePoly = rand() % (GRID_SIZE * GRID_SIZE), destPoly = rand() % (GRID_SIZE * GRID_SIZE);
+		if(pathfinder.is_polygon_blocked(sourcePoly) || pathfinder.is_polygon_blocked(destPoly)) continue;
+		if((sourcePoly % GRID_SIZE < GRID_SIZE/2) != (destPoly % GRID_SIZE < GRID_SIZE/2)) ++expectedFailures;
+		++found;
+	}
+	run_queries("A* (closed wall)", navMesh, pathfinder, expectedFailures);
+
+	// Check that a search which can't succeed can be cut short.
+	run_expansion_limit(pathfinder);
+
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << std::endl;
+	return EXIT_FAILURE;
+}
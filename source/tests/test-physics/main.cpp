@@ -3,17 +3,76 @@
  * Copyright Stuart Golodetz, 2009. All rights reserved.
  ***/
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <hesp/bounds/AABBBounds.h>
 #include <hesp/bounds/BoundsManager.h>
+#include <hesp/bounds/PointBounds.h>
 #include <hesp/bounds/SphereBounds.h>
 #include <hesp/exceptions/Exception.h>
+#include <hesp/math/geom/GeomUtil.h>
+#include <hesp/math/geom/Plane.h>
+#include <hesp/objects/contactresolvers/BounceContactResolver.h>
 #include <hesp/objects/forcegenerators/SpringForceGenerator.h>
 #include <hesp/objects/forcegenerators/WeightForceGenerator.h>
+#include <hesp/physics/BoundsSupportMapping.h>
+#include <hesp/physics/ContactResolver.h>
+#include <hesp/physics/NarrowPhaseCollisionDetector.h>
 #include <hesp/physics/NormalPhysicsObject.h>
 #include <hesp/physics/PhysicsSystem.h>
+#include <hesp/trees/OnionBranch.h>
+#include <hesp/trees/OnionLeaf.h>
+#include <hesp/trees/OnionTree.h>
+#include <hesp/trees/OnionUtil.h>
 using namespace hesp;
 
+const int CROWD_SIZE = 400;			// the number of spheres dropped into the room in the stress test
+const int CROWD_FRAMES = 300;
+const double ROOM_HALF_WIDTH = 20;	// the room is a 40x40 square with an open top
+const int NARROW_PHASE_PAIRS = 20000;	// the number of random pairs of objects tested by the narrow phase test
+const int NARROW_PHASE_PASSES = 10;		// the number of times the narrow phase benchmark tests each pair
+const int ONION_MAP_COUNT = 3;			// the number of maps in the random onion trees used by the ray test
+const int ONION_TREE_COUNT = 20;
+const int ONION_RAYS_PER_TREE = 2000;
+const int ONION_PASSES = 10;			// the number of times the ray benchmark tests each ray
+const int ONION_MANY_MAP_COUNT = 40;	// the number of maps in the trees used to test leaves with more than one solidity mask
+
+bool equal(const Vector3d& lhs, const Vector3d& rhs)
+{
+	return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+}
+
+int per_second(int count, const boost::posix_time::time_duration& time)
+{
+	double seconds = time.total_microseconds() / 1000000.0;
+	return seconds > 0 ? static_cast<int>(count / seconds) : 0;
+}
+
+/**
+Returns a random point in the cube [-halfWidth,halfWidth]^3.
+*/
+Vector3d random_point(double halfWidth)
+{
+	double x = rand() / (RAND_MAX + 1.0), y = rand() / (RAND_MAX + 1.0), z = rand() / (RAND_MAX + 1.0);
+	return Vector3d((x * 2 - 1) * halfWidth, (y * 2 - 1) * halfWidth, (z * 2 - 1) * halfWidth);
+}
+
+/**
+Makes a physics object which has just moved between two random points near the origin
+(or which hasn't moved at all, if it hasn't got a previous position).
+*/
+PhysicsObject_Ptr make_random_object(const std::string& boundsGroup)
+{
+	PhysicsObject_Ptr object(new NormalPhysicsObject(boundsGroup, 1.0, 1.0, PM_ITEM, ObjectID(), random_point(3), "default"));
+	if(rand() % 4 != 0) object->set_position(object->position() + random_point(1.5));
+	return object;
+}
+
 void output(const PhysicsObject_Ptr& fixed, const PhysicsObject_Ptr& dynamic)
 {
 	std::cout << "Fixed: " << fixed->position() << '\n';
@@ -21,10 +80,461 @@ void output(const PhysicsObject_Ptr& fixed, const PhysicsObject_Ptr& dynamic)
 	std::cout << '\n';
 }
 
+/**
+Makes an onion tree for a room with a floor at z = 0 and four walls, with a single map
+for objects with spherical bounds of radius 1 (so the floor and walls are moved in by 1).
+*/
+OnionTree_CPtr make_room_tree()
+{
+	const double inset = ROOM_HALF_WIDTH - 1;
+	Plane_CPtr planes[] =
+	{
+		Plane_CPtr(new Plane(Vector3d(-1,0,0), -inset)),
+		Plane_CPtr(new Plane(Vector3d(1,0,0), -inset)),
+		Plane_CPtr(new Plane(Vector3d(0,-1,0), -inset)),
+		Plane_CPtr(new Plane(Vector3d(0,1,0), -inset)),
+		Plane_CPtr(new Plane(Vector3d(0,0,1), 1)),
+	};
+
+	// The nodes are stored in postorder: the front of each plane leads further into the room,
+	// and the back of each plane is solid.
+	boost::dynamic_bitset<> empty(1, 0), solid(1, 1);
+	std::vector<OnionNode_Ptr> nodes;
+	nodes.push_back(OnionNode_Ptr(new OnionLeaf(0, empty, std::vector<int>())));
+	for(int i=0; i<5; ++i)
+	{
+		int index = static_cast<int>(nodes.size());
+		OnionNode_Ptr front = nodes.back();
+		nodes.push_back(OnionNode_Ptr(new OnionLeaf(index, solid, std::vector<int>())));
+		nodes.push_back(OnionNode_Ptr(new OnionBranch(index + 1, planes[i], front, nodes.back())));
+	}
+	return OnionTree_CPtr(new OnionTree(nodes, 1));
+}
+
+/**
+Drops a crowd of spheres into the room and lets them settle.
+
+@param startPositions	The starting position of each sphere
+@param threadCount		The number of threads the physics system should use
+@param deterministic	Whether or not the physics system should be in deterministic mode
+@param boundsManager	The bounds manager which contains the bounds for the spheres
+@param tree				The onion tree for the room
+@param finalPositions	Used to return the final position of each sphere
+@return					The time taken (in milliseconds)
+*/
+int run_crowd(const std::vector<Vector3d>& startPositions, int threadCount, bool deterministic,
+			  const BoundsManager_CPtr& boundsManager, const OnionTree_CPtr& tree, std::vector<Vector3d>& finalPositions)
+{
+	PhysicsSystem physicsSystem(threadCount, deterministic);
+	physicsSystem.set_contact_resolver(PM_ITEM, PM_ITEM, ContactResolver_CPtr(new BounceContactResolver(0.2)));
+	physicsSystem.set_contact_resolver(PM_ITEM, PM_WORLD, ContactResolver_CPtr(new BounceContactResolver(0.0)));
+
+	std::vector<PhysicsObject_Ptr> objects;
+	std::vector<PhysicsObjectHandle> handles;
+	ForceGenerator_CPtr weight(new WeightForceGenerator(10.0));
+	for(size_t i=0, size=startPositions.size(); i<size; ++i)
+	{
+		objects.push_back(PhysicsObject_Ptr(new NormalPhysicsObject("sphere", 0.99, 1.0, PM_ITEM, ObjectID(), startPositions[i], "default")));
+		handles.push_back(physicsSystem.register_object(objects.back()));
+		physicsSystem.set_force_generator(handles.back(), "Weight", weight);
+	}
+
+	boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int i=0; i<CROWD_FRAMES; ++i)
+	{
+		physicsSystem.update(boundsManager, tree, 10);
+	}
+	boost::posix_time::time_duration time = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	finalPositions.clear();
+	for(size_t i=0, size=objects.size(); i<size; ++i) finalPositions.push_back(objects[i]->position());
+	return static_cast<int>(time.total_milliseconds());
+}
+
+/**
+Drops hundreds of spheres into a room, and checks that they all stay inside it and that the
+results in deterministic mode don't depend on the number of threads used.
+*/
+void test_crowd(const BoundsManager_CPtr& boundsManager)
+{
+	OnionTree_CPtr tree = make_room_tree();
+
+	// Stack the spheres in loose layers above the floor, so that most of them land on (or near) each other.
+	srand(12345);
+	std::vector<Vector3d> startPositions;
+	for(int i=0; i<CROWD_SIZE; ++i)
+	{
+		int layer = i / 100, x = i % 10, y = (i / 10) % 10;
+		double jitterX = (rand() % 100) / 100.0 - 0.5, jitterY = (rand() % 100) / 100.0 - 0.5;
+		startPositions.push_back(Vector3d(x * 3.6 - 16.2 + jitterX, y * 3.6 - 16.2 + jitterY, 3 + layer * 2.5));
+	}
+
+	std::vector<Vector3d> reference, positions;
+	int referenceTime = run_crowd(startPositions, 1, true, boundsManager, tree, reference);
+	std::cout << "Crowd (deterministic, 1 thread): " << referenceTime << "ms\n";
+
+	const double TOLERANCE = 0.01;
+	for(int i=0; i<CROWD_SIZE; ++i)
+	{
+		const Vector3d& p = reference[i];
+		if(fabs(p.x) > ROOM_HALF_WIDTH - 1 + TOLERANCE || fabs(p.y) > ROOM_HALF_WIDTH - 1 + TOLERANCE || p.z < 1 - TOLERANCE)
+		{
+			throw Exception("A sphere escaped from the room");
+		}
+	}
+
+	int threadCounts[] = { 2, 4, 8 };
+	for(int i=0; i<3; ++i)
+	{
+		int time = run_crowd(startPositions, threadCounts[i], true, boundsManager, tree, positions);
+		std::cout << "Crowd (deterministic, " << threadCounts[i] << " threads): " << time << "ms\n";
+		for(int j=0; j<CROWD_SIZE; ++j)
+		{
+			if(!equal(positions[j], reference[j])) throw Exception("The results in deterministic mode depend on the thread count");
+		}
+	}
+
+	int time = run_crowd(startPositions, 4, false, boundsManager, tree, positions);
+	std::cout << "Crowd (non-deterministic, 4 threads): " << time << "ms\n";
+}
+
+
+/**
+Builds a random subtree of an onion tree, with (mostly) axis-aligned split planes at whole-number
+offsets, so that rays which lie in those planes are easy to generate. The nodes are added in postorder.
+
+@param mapCount	The number of maps in the tree
+@return			The root of the subtree
+*/
+OnionNode_Ptr make_random_onion_subtree(int depth, int mapCount, std::vector<OnionNode_Ptr>& nodes)
+{
+	int index = static_cast<int>(nodes.size());
+	if(depth == 0 || rand() % 8 == 0)
+	{
+		boost::dynamic_bitset<> solidity(mapCount);
+		for(int m=0; m<mapCount; ++m) solidity[m] = rand() % 3 == 0;
+		nodes.push_back(OnionNode_Ptr(new OnionLeaf(index, solidity, std::vector<int>())));
+		return nodes.back();
+	}
+
+	OnionNode_Ptr left = make_random_onion_subtree(depth - 1, mapCount, nodes);
+	OnionNode_Ptr right = make_random_onion_subtree(depth - 1, mapCount, nodes);
+
+	Plane_CPtr splitter;
+	if(rand() % 4 != 0)
+	{
+		Vector3d n(0,0,0);
+		switch(rand() % 3)
+		{
+			case 0:		n.x = rand() % 2 ? 1 : -1; break;
+			case 1:		n.y = rand() % 2 ? 1 : -1; break;
+			default:	n.z = rand() % 2 ? 1 : -1; break;
+		}
+		splitter.reset(new Plane(n, rand() % 17 - 8));
+	}
+	else splitter.reset(new Plane(random_point(1).normalize(), (rand() % 160 - 80) / 10.0));
+
+	nodes.push_back(OnionNode_Ptr(new OnionBranch(static_cast<int>(nodes.size()), splitter, left, right)));
+	return nodes.back();
+}
+
+/**
+The recursive implementation of OnionUtil::find_first_transition which preceded the current
+iterative one. It's kept here as a reference for the results (and speed) of the current one.
+*/
+struct ReferenceTransition
+{
+	OnionUtil::RayClassifier classifier;
+	Vector3d_Ptr location;
+	Plane_CPtr plane;
+
+	explicit ReferenceTransition(OnionUtil::RayClassifier classifier_, const Vector3d_Ptr& location_ = Vector3d_Ptr(), const Plane_CPtr& plane_ = Plane_CPtr())
+	:	classifier(classifier_), location(location_), plane(plane_)
+	{}
+};
+
+ReferenceTransition reference_transition(int mapIndex, const Vector3d& source, const Vector3d& dest, const BakedTree& tree, int n)
+{
+	const BakedTree::Node& node = tree.node(n);
+	if(node.is_leaf())
+	{
+		if(tree.is_solid(node.leafIndex, mapIndex)) return ReferenceTransition(OnionUtil::RAY_SOLID);
+		else return ReferenceTransition(OnionUtil::RAY_EMPTY);
+	}
+
+	const Plane& splitter = tree.plane(node.planeIndex);
+	PlaneClassifier cpSource, cpDest;
+	switch(classify_linesegment_against_plane(source, dest, splitter, cpSource, cpDest))
+	{
+		case CP_BACK:
+		{
+			return reference_transition(mapIndex, source, dest, tree, node.right);
+		}
+		case CP_COPLANAR:
+		{
+			ReferenceTransition trLeft = reference_transition(mapIndex, source, dest, tree, node.left);
+			ReferenceTransition trRight = reference_transition(mapIndex, source, dest, tree, node.right);
+			if(trLeft.classifier == trRight.classifier)
+			{
+				if(!trLeft.location) return trLeft;
+				if(source.distance_squared(*trLeft.location) < source.distance_squared(*trRight.location)) return trLeft;
+				else return trRight;
+			}
+			else if(trLeft.location) return trLeft;
+			else if(trRight.location) return trRight;
+			else return ReferenceTransition(OnionUtil::RAY_EMPTY);
+		}
+		case CP_FRONT:
+		{
+			return reference_transition(mapIndex, source, dest, tree, node.left);
+		}
+		default:	// case CP_STRADDLE
+		{
+			Vector3d mid = determine_linesegment_intersection_with_plane(source, dest, splitter).first;
+			int nearChild = cpSource == CP_FRONT ? node.left : node.right;
+			int farChild = cpSource == CP_FRONT ? node.right : node.left;
+
+			ReferenceTransition trNear = reference_transition(mapIndex, source, mid, tree, nearChild);
+			if(trNear.location) return trNear;
+
+			ReferenceTransition trFar = reference_transition(mapIndex, mid, dest, tree, farChild);
+			bool nearSolid = trNear.classifier == OnionUtil::RAY_SOLID;
+			bool farSolidInitially = trFar.classifier == OnionUtil::RAY_SOLID || trFar.classifier == OnionUtil::RAY_TRANSITION_SE;
+			if(nearSolid == farSolidInitially) return trFar;
+
+			OnionUtil::RayClassifier classifier = nearSolid ? OnionUtil::RAY_TRANSITION_SE : OnionUtil::RAY_TRANSITION_ES;
+			return ReferenceTransition(classifier, Vector3d_Ptr(new Vector3d(mid)), tree.splitter(node.planeIndex));
+		}
+	}
+}
+
+bool same_transition(const OnionUtil::Transition& lhs, const ReferenceTransition& rhs)
+{
+	if(lhs.classifier != rhs.classifier || !lhs.location != !rhs.location) return false;
+	if(!lhs.location) return true;
+	return equal(*lhs.location, *rhs.location) && equal(lhs.plane->normal(), rhs.plane->normal()) &&
+		   lhs.plane->distance_value() == rhs.plane->distance_value();
+}
+
+/**
+Checks that the iterative onion tree ray walker finds exactly the same transitions as the recursive
+one it replaced (both for a single map at a time and for all the maps at once) on random trees and
+rays, and reports how many rays per second each of them handles (for all the maps).
+*/
+void test_onion_rays()
+{
+	srand(24680);
+	std::vector<BakedTree_CPtr> trees;
+	std::vector<std::vector<Vector3d> > sources(ONION_TREE_COUNT), dests(ONION_TREE_COUNT);
+	for(int t=0; t<ONION_TREE_COUNT; ++t)
+	{
+		std::vector<OnionNode_Ptr> nodes;
+		make_random_onion_subtree(12, ONION_MAP_COUNT, nodes);
+		trees.push_back(OnionTree(nodes, ONION_MAP_COUNT).baked_tree());
+
+		for(int i=0; i<ONION_RAYS_PER_TREE; ++i)
+		{
+			Vector3d source = random_point(10), dest = random_point(10);
+
+			// Make about a third of the rays lie in one of the axis-aligned split planes.
+			switch(rand() % 9)
+			{
+				case 0:		source.x = dest.x = rand() % 17 - 8; break;
+				case 1:		source.y = dest.y = rand() % 17 - 8; break;
+				case 2:		source.z = dest.z = rand() % 17 - 8; break;
+				default:	break;
+			}
+
+			sources[t].push_back(source);
+			dests[t].push_back(dest);
+		}
+	}
+
+	const BakedTree::MapMask allMaps = (1 << ONION_MAP_COUNT) - 1;
+	int transitionCount = 0;
+	for(int t=0; t<ONION_TREE_COUNT; ++t)
+	{
+		const BakedTree& tree = *trees[t];
+		for(int i=0; i<ONION_RAYS_PER_TREE; ++i)
+		{
+			OnionUtil::Transition transitions[BakedTree::MAPS_PER_MASK];
+			OnionUtil::find_first_transitions(allMaps, sources[t][i], dests[t][i], tree, transitions);
+			for(int m=0; m<ONION_MAP_COUNT; ++m)
+			{
+				ReferenceTransition reference = reference_transition(m, sources[t][i], dests[t][i], tree, tree.root_index());
+				if(!same_transition(OnionUtil::find_first_transition(m, sources[t][i], dests[t][i], tree), reference))
+				{
+					throw Exception("The iterative ray walker found a different transition to the recursive one");
+				}
+				if(!same_transition(transitions[m], reference)) throw Exception("The multi-map ray walker found a different transition to the recursive one");
+				if(reference.location) ++transitionCount;
+			}
+		}
+	}
+	if(transitionCount == 0) throw Exception("None of the random rays had a transition");
+	std::cout << "Onion rays: " << transitionCount << " transitions in " << ONION_TREE_COUNT * ONION_RAYS_PER_TREE * ONION_MAP_COUNT << " ray/map pairs\n";
+
+	boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int pass=0; pass<ONION_PASSES; ++pass)
+		for(int t=0; t<ONION_TREE_COUNT; ++t)
+			for(int i=0; i<ONION_RAYS_PER_TREE; ++i)
+				for(int m=0; m<ONION_MAP_COUNT; ++m)
+				{
+					reference_transition(m, sources[t][i], dests[t][i], *trees[t], trees[t]->root_index());
+				}
+	boost::posix_time::time_duration recursiveTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int pass=0; pass<ONION_PASSES; ++pass)
+		for(int t=0; t<ONION_TREE_COUNT; ++t)
+			for(int i=0; i<ONION_RAYS_PER_TREE; ++i)
+				for(int m=0; m<ONION_MAP_COUNT; ++m)
+				{
+					OnionUtil::find_first_transition(m, sources[t][i], dests[t][i], *trees[t]);
+				}
+	boost::posix_time::time_duration iterativeTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int pass=0; pass<ONION_PASSES; ++pass)
+		for(int t=0; t<ONION_TREE_COUNT; ++t)
+			for(int i=0; i<ONION_RAYS_PER_TREE; ++i)
+			{
+				OnionUtil::Transition transitions[BakedTree::MAPS_PER_MASK];
+				OnionUtil::find_first_transitions(allMaps, sources[t][i], dests[t][i], *trees[t], transitions);
+			}
+	boost::posix_time::time_duration multiMapTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	const int raysTested = ONION_PASSES * ONION_TREE_COUNT * ONION_RAYS_PER_TREE;
+	std::cout << "Onion rays (recursive, one map at a time): " << per_second(raysTested, recursiveTime) << " rays/s\n";
+	std::cout << "Onion rays (iterative, one map at a time): " << per_second(raysTested, iterativeTime) << " rays/s\n";
+	std::cout << "Onion rays (iterative, all maps at once): " << per_second(raysTested, multiMapTime) << " rays/s\n";
+}
+
+/**
+Checks that onion trees with more maps than fit in a single solidity mask store the solidity of
+every map correctly, and that both ray walkers find the same transitions for all of them as the
+recursive one.
+*/
+void test_many_map_onion_rays()
+{
+	srand(13579);
+	const int maskCount = (ONION_MANY_MAP_COUNT + BakedTree::MAPS_PER_MASK - 1) / BakedTree::MAPS_PER_MASK;
+	int pairsTested = 0;
+	for(int t=0; t<ONION_TREE_COUNT; ++t)
+	{
+		std::vector<OnionNode_Ptr> nodes;
+		make_random_onion_subtree(10, ONION_MANY_MAP_COUNT, nodes);
+		BakedTree_CPtr tree = OnionTree(nodes, ONION_MANY_MAP_COUNT).baked_tree();
+		if(tree->mask_count() != maskCount) throw Exception("The baked tree doesn't have enough solidity masks for all its maps");
+
+		for(int n=0, nodeCount=static_cast<int>(nodes.size()); n<nodeCount; ++n)
+		{
+			if(!nodes[n]->is_leaf()) continue;
+			const OnionLeaf *leaf = nodes[n]->as_leaf();
+			for(int m=0; m<ONION_MANY_MAP_COUNT; ++m)
+			{
+				if(tree->is_solid(tree->node(n).leafIndex, m) != leaf->is_solid(m)) throw Exception("The baked tree has the wrong solidity for one of its maps");
+			}
+		}
+
+		for(int i=0; i<ONION_RAYS_PER_TREE / 10; ++i)
+		{
+			Vector3d source = random_point(10), dest = random_point(10);
+			for(int k=0; k<maskCount; ++k)
+			{
+				int mapsInMask = std::min(ONION_MANY_MAP_COUNT - k * BakedTree::MAPS_PER_MASK, static_cast<int>(BakedTree::MAPS_PER_MASK));
+				BakedTree::MapMask maps = mapsInMask == BakedTree::MAPS_PER_MASK ? ~BakedTree::MapMask(0) : (BakedTree::MapMask(1) << mapsInMask) - 1;
+				OnionUtil::Transition transitions[BakedTree::MAPS_PER_MASK];
+				OnionUtil::find_first_transitions(maps, source, dest, *tree, transitions, k);
+				for(int b=0; b<mapsInMask; ++b)
+				{
+					int m = k * BakedTree::MAPS_PER_MASK + b;
+					ReferenceTransition reference = reference_transition(m, source, dest, *tree, tree->root_index());
+					if(!same_transition(OnionUtil::find_first_transition(m, source, dest, *tree), reference))
+					{
+						throw Exception("The iterative ray walker found a different transition to the recursive one");
+					}
+					if(!same_transition(transitions[b], reference)) throw Exception("The multi-map ray walker found a different transition to the recursive one");
+					++pairsTested;
+				}
+			}
+		}
+	}
+	std::cout << "Onion rays (" << ONION_MANY_MAP_COUNT << " maps): " << pairsTested << " ray/map pairs agree\n";
+}
+
+/**
+Checks that the narrow phase collision detector's specialised object-object test finds exactly the
+same contacts as its general test (which uses heap-allocated, virtual support mappings) on random
+pairs of spheres, AABBs and points, and reports how many pairs per second each of them tests.
+*/
+void test_narrow_phase(const BoundsManager_CPtr& boundsManager)
+{
+	const std::string boundsGroups[] = { "sphere", "box", "point" };
+
+	srand(54321);
+	std::vector<PhysicsObject_Ptr> objectsA, objectsB;
+	std::vector<SupportMapping_CPtr> mappingsA, mappingsB;
+	for(int i=0; i<NARROW_PHASE_PAIRS; ++i)
+	{
+		objectsA.push_back(make_random_object(boundsGroups[rand() % 3]));
+		objectsB.push_back(make_random_object(boundsGroups[rand() % 3]));
+		mappingsA.push_back(SupportMapping_CPtr(new BoundsSupportMapping(objectsA.back()->bounds(boundsManager))));
+		mappingsB.push_back(SupportMapping_CPtr(new BoundsSupportMapping(objectsB.back()->bounds(boundsManager))));
+	}
+
+	NarrowPhaseCollisionDetector detector(boundsManager, OnionTree_CPtr());
+
+	int hits = 0;
+	for(int i=0; i<NARROW_PHASE_PAIRS; ++i)
+	{
+		boost::optional<Contact> contact = detector.object_vs_object(*objectsA[i], *objectsB[i]);
+		boost::optional<Contact> reference = detector.object_vs_object(*objectsA[i], *objectsB[i], mappingsA[i], mappingsB[i]);
+		if(!contact != !reference) throw Exception("The specialised and general narrow phase tests disagree on whether there's a contact");
+		if(!contact) continue;
+
+		++hits;
+		if(!equal(contact->relative_pointA(), reference->relative_pointA()) ||
+		   !equal(contact->relative_pointB(), reference->relative_pointB()) ||
+		   !equal(contact->normal(), reference->normal()) ||
+		   contact->time() != reference->time() ||
+		   contact->map_indexA() != reference->map_indexA() ||
+		   contact->map_indexB() != reference->map_indexB())
+		{
+			throw Exception("The specialised and general narrow phase tests found different contacts");
+		}
+	}
+	if(hits == 0 || hits == NARROW_PHASE_PAIRS) throw Exception("The random pairs didn't include both hits and misses");
+	std::cout << "Narrow phase: " << hits << " hits in " << NARROW_PHASE_PAIRS << " random pairs\n";
+
+	boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int pass=0; pass<NARROW_PHASE_PASSES; ++pass)
+		for(int i=0; i<NARROW_PHASE_PAIRS; ++i)
+		{
+			detector.object_vs_object(*objectsA[i], *objectsB[i]);
+		}
+	boost::posix_time::time_duration specialisedTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	startTime = boost::posix_time::microsec_clock::universal_time();
+	for(int pass=0; pass<NARROW_PHASE_PASSES; ++pass)
+		for(int i=0; i<NARROW_PHASE_PAIRS; ++i)
+		{
+			// Note:	This builds the bounds support mappings for each pair, as the detector used to.
+			SupportMapping_CPtr mappingA(new BoundsSupportMapping(objectsA[i]->bounds(boundsManager)));
+			SupportMapping_CPtr mappingB(new BoundsSupportMapping(objectsB[i]->bounds(boundsManager)));
+			detector.object_vs_object(*objectsA[i], *objectsB[i], mappingA, mappingB);
+		}
+	boost::posix_time::time_duration generalTime = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+	const int pairsTested = NARROW_PHASE_PAIRS * NARROW_PHASE_PASSES;
+	std::cout << "Narrow phase (specialised): " << per_second(pairsTested, specialisedTime) << " pairs/s\n";
+	std::cout << "Narrow phase (general): " << per_second(pairsTested, generalTime) << " pairs/s\n";
+}
+
 int main()
 try
 {
-	// Set up the bounds manager (this is a necessary step, even though we're not resolving any contacts in this test).
+	// Set up the bounds manager (this is a necessary step, even though the spring test doesn't resolve any contacts).
 	std::vector<Bounds_CPtr> bounds;
 	std::map<std::string,BoundsManager::BoundsGroup> groups;
 	std::map<std::string,int> lookup;
@@ -36,6 +546,19 @@ try
 	sphereGroup.insert(std::make_pair("default", "normalsphere"));
 	groups.insert(std::make_pair("sphere", sphereGroup));
 
+	// (The box and point bounds are only used by the narrow phase test.)
+	bounds.push_back(Bounds_CPtr(new AABBBounds(Vector3d(0.5,0.75,1.0))));
+	lookup.insert(std::make_pair("normalbox", 1));
+	BoundsManager::BoundsGroup boxGroup;
+	boxGroup.insert(std::make_pair("default", "normalbox"));
+	groups.insert(std::make_pair("box", boxGroup));
+
+	bounds.push_back(Bounds_CPtr(new PointBounds));
+	lookup.insert(std::make_pair("point", 2));
+	BoundsManager::BoundsGroup pointGroup;
+	pointGroup.insert(std::make_pair("default", "point"));
+	groups.insert(std::make_pair("point", pointGroup));
+
 	BoundsManager_CPtr boundsManager(new BoundsManager(bounds, groups, lookup, navFlags));
 
 	// Set up the physics system.
@@ -84,9 +607,26 @@ try
 		output(fixed, dynamic);
 	}
 
+	std::cout << "\n******\n\n";
+
+	// Drop a crowd of spheres into a room (this resolves lots of contacts).
+	test_crowd(boundsManager);
+
+	std::cout << "\n******\n\n";
+
+	// Compare the specialised and general narrow phase object-object tests.
+	test_narrow_phase(boundsManager);
+
+	std::cout << "\n******\n\n";
+
+	// Compare the iterative onion tree ray walker with the recursive one it replaced.
+	test_onion_rays();
+	test_many_map_onion_rays();
+
 	return 0;
 }
 catch(Exception& e)
 {
 	std::cout << e.cause() << '\n';
+	return EXIT_FAILURE;
 }
@@ -0,0 +1,118 @@
+/***
+ * test-vis: main.cpp
+ * Copyright Stuart Golodetz, 2009. All rights reserved.
+ ***/
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <list>
+
+#include <boost/lexical_cast.hpp>
+using boost::lexical_cast;
+
+#include <hesp/build/BuildUtil.h>
+#include <hesp/csg/CSGUtil.h>
+#include <hesp/exceptions/Exception.h>
+#include <hesp/io/files/MEFFile.h>
+#include <hesp/lighting/Light.h>
+#include <hesp/portals/PortalGenerator.h>
+#include <hesp/trees/BSPCompiler.h>
+#include <hesp/vis/VisCalculator.h>
+using namespace hesp;
+
+//#################### TYPEDEFS ####################
+typedef BuildUtil::TexPolyVector TexPolyVector;
+
+//#################### HELPER FUNCTIONS ####################
+/**
+Builds the rendering tree for a level and generates its portals, as per the
+hdivide, hcsg, hbsp, hportal and hflood stages of the level build.
+*/
+void generate_portals(const std::string& mefFilename, int& emptyLeafCount, std::vector<Portal_Ptr>& portals)
+{
+	BuildUtil::TexPolyBrushVector brushes;
+	std::vector<Light> lights;
+	MEFFile::load(mefFilename, brushes, lights);
+
+	BuildUtil::TexPolyBrushVector renderingBrushes, detailBrushes, specialBrushes;
+	BuildUtil::ColPolyBrushVector collisionBrushes;
+	TexPolyVector hintPolygons;
+	BuildUtil::divide_brushes(brushes, renderingBrushes, collisionBrushes, detailBrushes, hintPolygons, specialBrushes);
+
+	shared_ptr<std::list<TexturedPolygon_Ptr> > fragments = CSGUtil<TexturedPolygon::Vert,TexturedPolygon::AuxData>::union_all(renderingBrushes);
+	TexPolyVector polygons(fragments->begin(), fragments->end());
+
+	// Build the tree once to find the polygons which can't be reached from outside the level, and then build it again from those.
+	for(int pass=0; pass<2; ++pass)
+	{
+		BSPCompiler<TexturedPolygon> compiler(polygons, hintPolygons, 4);
+		compiler.build_tree();
+		BSPTree_Ptr tree = compiler.tree();
+
+		shared_ptr<std::list<Portal_Ptr> > portalList = PortalGenerator().generate_portals(tree);
+		emptyLeafCount = tree->empty_leaf_count();
+		portals.assign(portalList->begin(), portalList->end());
+
+		if(pass == 0) polygons = BuildUtil::flood_fill(compiler.polygons(), tree, emptyLeafCount, portals);
+	}
+}
+
+LeafVisTable_Ptr calculate_leaf_vis(int emptyLeafCount, const std::vector<Portal_Ptr>& portals, int threadCount)
+{
+	clock_t start = clock();
+	VisCalculator visCalc(emptyLeafCount, portals, threadCount);
+	LeafVisTable_Ptr leafVis = visCalc.calculate_leaf_vis_table();
+	clock_t end = clock();
+
+	std::cout << "-j" << threadCount << ": " << (end - start) * 1000 / CLOCKS_PER_SEC << " ms of CPU time\n";
+	return leafVis;
+}
+
+bool same_tables(const LeafVisTable& lhs, const LeafVisTable& rhs)
+{
+	if(lhs.size() != rhs.size()) return false;
+
+	int size = lhs.size();
+	for(int i=0; i<size; ++i)
+		for(int j=0; j<size; ++j)
+		{
+			if(lhs(i,j) != rhs(i,j)) return false;
+		}
+
+	return true;
+}
+
+int main()
+try
+{
+	const std::string mefFilename = "../resources/blakeney_hall.mef";
+
+	int emptyLeafCount;
+	std::vector<Portal_Ptr> portals;
+	generate_portals(mefFilename, emptyLeafCount, portals);
+	std::cout << "Level: " << emptyLeafCount << " empty leaves, " << portals.size() << " portals\n";
+
+	// Calculate the leaf vis table serially, and check that calculating it with several threads (in which case
+	// the portals finish in a different order) gives exactly the same table. Note that the portals are shared
+	// between the calculators, but each one only writes their indices, which are the same every time.
+	LeafVisTable_Ptr serialLeafVis = calculate_leaf_vis(emptyLeafCount, portals, 1);
+
+	const int threadCounts[] = {2, 4, 8};
+	for(int k=0; k<3; ++k)
+	{
+		LeafVisTable_Ptr parallelLeafVis = calculate_leaf_vis(emptyLeafCount, portals, threadCounts[k]);
+		if(!same_tables(*serialLeafVis, *parallelLeafVis))
+		{
+			throw Exception("The leaf vis tables for -j1 and -j" + lexical_cast<std::string>(threadCounts[k]) + " differ");
+		}
+	}
+
+	std::cout << "The leaf vis tables are identical\n";
+	return 0;
+}
+catch(Exception& e)
+{
+	std::cout << e.cause() << '\n';
+	return EXIT_FAILURE;
+}